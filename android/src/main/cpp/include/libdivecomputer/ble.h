@@ -22,6 +22,8 @@
 #ifndef DC_BLE_H
 #define DC_BLE_H
 
+#include "common.h"
+#include "iostream.h"
 #include "ioctl.h"
 
 #ifdef __cplusplus
@@ -60,6 +62,63 @@ extern "C" {
 #define DC_IOCTL_BLE_CHARACTERISTIC_READ  DC_IOCTL_IOR('b', 3, DC_IOCTL_SIZE_VARIABLE)
 #define DC_IOCTL_BLE_CHARACTERISTIC_WRITE DC_IOCTL_IOW('b', 3, DC_IOCTL_SIZE_VARIABLE)
 
+/**
+ * Get/set the ATT MTU of the connection.
+ *
+ * The largest packet that can be sent or received in a single write or
+ * notification is the MTU minus the 3 byte ATT header. Setting the MTU
+ * only requests a new value, which the peer can lower. The transport
+ * returns once the negotiation has finished, and the new value can be
+ * read back afterwards. Transports that can change the MTU must also
+ * report it, because drivers size their buffers to it.
+ *
+ * The data format is an unsigned int.
+ */
+#define DC_IOCTL_BLE_GET_MTU   DC_IOCTL_IOR('b', 4, sizeof(unsigned int))
+#define DC_IOCTL_BLE_SET_MTU   DC_IOCTL_IOW('b', 4, sizeof(unsigned int))
+
+/**
+ * Get/set the physical layer of the connection.
+ *
+ * The data format is an unsigned int, with one of the #dc_ble_phy_t
+ * values. Setting the PHY is a preference, which the peer can decline.
+ */
+#define DC_IOCTL_BLE_GET_PHY   DC_IOCTL_IOR('b', 5, sizeof(unsigned int))
+#define DC_IOCTL_BLE_SET_PHY   DC_IOCTL_IOW('b', 5, sizeof(unsigned int))
+
+/**
+ * Request a connection priority (connection interval and latency).
+ *
+ * The data format is an unsigned int, with one of the
+ * #dc_ble_priority_t values.
+ */
+#define DC_IOCTL_BLE_SET_PRIORITY   DC_IOCTL_IOW('b', 6, sizeof(unsigned int))
+
+/**
+ * The minimum ATT MTU, and the largest one that allows the maximum
+ * attribute size (512 bytes) in a single packet.
+ */
+#define DC_BLE_MTU_MIN 23
+#define DC_BLE_MTU_MAX 515
+
+/**
+ * Bluetooth LE physical layer.
+ */
+typedef enum dc_ble_phy_t {
+	DC_BLE_PHY_1M = 1,
+	DC_BLE_PHY_2M = 2,
+	DC_BLE_PHY_CODED = 3,
+} dc_ble_phy_t;
+
+/**
+ * Bluetooth LE connection priority.
+ */
+typedef enum dc_ble_priority_t {
+	DC_BLE_PRIORITY_BALANCED = 0,
+	DC_BLE_PRIORITY_HIGH = 1,
+	DC_BLE_PRIORITY_LOW_POWER = 2,
+} dc_ble_priority_t;
+
 /**
  * The minimum number of bytes (including the terminating null byte) for
  * formatting a bluetooth UUID as a string.
@@ -101,6 +160,22 @@ dc_ble_uuid2str (const dc_ble_uuid_t uuid, char *str, size_t size);
 int
 dc_ble_str2uuid (const char *str, dc_ble_uuid_t uuid);
 
+/**
+ * Request a link suited for bulk transfers.
+ *
+ * Requests the high connection priority, the 2M PHY and the largest
+ * MTU. Requests the transport doesn't support are ignored, and other
+ * transports are left unchanged.
+ *
+ * @param[in]  iostream    A valid I/O stream.
+ * @param[out] packetsize  The largest packet size of the link, or zero
+ *                         if unknown.
+ * @returns #DC_STATUS_SUCCESS on success, or another #dc_status_t code
+ * on failure.
+ */
+dc_status_t
+dc_ble_setup_link (dc_iostream_t *iostream, unsigned int *packetsize);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -85,6 +85,22 @@ dc_device_set_events (dc_device_t *device, unsigned int events, dc_event_callbac
 dc_status_t
 dc_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsigned int size);
 
+/*
+ * Warm start data, to skip the identification queries on a reconnect.
+ *
+ * After a session, the application can retrieve an opaque blob with the
+ * identification data of the device (empty if the backend doesn't
+ * support it), and store it per device address. Passing it back after
+ * opening the device the next time lets the backend reuse the answers
+ * that can't have changed. The blob is only used if the serial number
+ * (and for most backends the firmware version) still matches the device.
+ */
+dc_status_t
+dc_device_set_warmstart (dc_device_t *device, const unsigned char data[], unsigned int size);
+
+dc_status_t
+dc_device_get_warmstart (dc_device_t *device, dc_buffer_t *buffer);
+
 dc_status_t
 dc_device_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size);
 
@@ -0,0 +1,66 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_EXPORT_H
+#define DC_EXPORT_H
+
+#include "common.h"
+#include "buffer.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Export
+ *
+ * Writes a list of dives as a single UDDF (version 3.2) or Subsurface
+ * XML document. The dives are streamed directly from the parsers, one
+ * sample record at a time, without building an intermediate copy of the
+ * dive. The header fields are obtained with dc_parser_get_field, and the
+ * profile with dc_parser_samples_foreach.
+ *
+ * The document is either appended to a buffer, or written to a file
+ * descriptor. In the latter case, the output is staged in a small
+ * buffer of fixed size, and the memory usage does not depend on the
+ * number or size of the dives.
+ *
+ * All values are written in the units of the format: SI units for UDDF,
+ * and metric units for Subsurface. The export is aborted on the first
+ * dive that fails to parse.
+ */
+
+typedef enum dc_export_format_t {
+	DC_EXPORT_UDDF,
+	DC_EXPORT_SUBSURFACE,
+} dc_export_format_t;
+
+dc_status_t
+dc_export_buffer (dc_export_format_t format, dc_parser_t *parsers[], unsigned int count, dc_buffer_t *buffer);
+
+dc_status_t
+dc_export_fd (dc_export_format_t format, dc_parser_t *parsers[], unsigned int count, int fd);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_EXPORT_H */
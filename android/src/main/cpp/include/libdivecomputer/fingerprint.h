@@ -0,0 +1,78 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_FINGERPRINT_H
+#define DC_FINGERPRINT_H
+
+#include "common.h"
+#include "context.h"
+#include "device.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Fingerprint store
+ *
+ * A persistent store with the fingerprint of the most recent dive of
+ * every dive computer, identified by its family, model and serial
+ * number. The store is a memory mapped file. Every device has two
+ * checksummed slots, and an update always overwrites the older one, so
+ * an interrupted update leaves the previous fingerprint intact.
+ *
+ * Once attached to a device with dc_device_set_fingerprint_store, the
+ * stored fingerprint is applied automatically when the device reports
+ * its identification (DC_EVENT_DEVINFO), and the store is updated with
+ * the fingerprint of the newest dive after a successful
+ * dc_device_foreach. A download stopped early by the dive callback
+ * (returning zero) leaves the store unchanged. A fingerprint set
+ * explicitly by the application with dc_device_set_fingerprint
+ * (including an empty one, to download all dives) takes precedence
+ * over the stored one.
+ *
+ * The store can be shared by multiple devices, and must remain open
+ * while it is attached to a device.
+ */
+
+#define DC_FINGERPRINT_MAXSIZE 512
+
+typedef struct dc_fingerprint_store_t dc_fingerprint_store_t;
+
+dc_status_t
+dc_fingerprint_store_open (dc_fingerprint_store_t **store, dc_context_t *context, const char *filename);
+
+dc_status_t
+dc_fingerprint_store_get (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, unsigned char data[], unsigned int size, unsigned int *actual);
+
+dc_status_t
+dc_fingerprint_store_set (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char data[], unsigned int size);
+
+dc_status_t
+dc_fingerprint_store_close (dc_fingerprint_store_t *store);
+
+dc_status_t
+dc_device_set_fingerprint_store (dc_device_t *device, dc_fingerprint_store_t *store);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_FINGERPRINT_H */
@@ -284,10 +284,218 @@ typedef union dc_sample_value_t {
 	unsigned int gasmix; /* Gas mix index */
 } dc_sample_value_t;
 
+/*
+ * Sample record
+ *
+ * A sample record collects all the sample values that belong to a
+ * single time step. A new record is started by every DC_SAMPLE_TIME
+ * sample. The fields bitmask indicates which values are present, using
+ * one bit per sample type (see DC_SAMPLE_MASK). The value of a field
+ * is only valid if its bit is set.
+ *
+ * Pressure, event and ppO2 values can occur multiple times within a
+ * single time step. They are stored in fixed size arrays, and any
+ * excess values are dropped. Vendor samples are not included.
+ */
+
+#define DC_SAMPLE_MASK(type) (1u << (type))
+
+#define DC_SAMPLE_RECORD_MAXTANKS   8
+#define DC_SAMPLE_RECORD_MAXEVENTS  8
+#define DC_SAMPLE_RECORD_MAXSENSORS 8
+
+typedef struct dc_sample_record_t {
+	unsigned int fields;  /* Bitmask of the available fields */
+	unsigned int time;    /* Milliseconds */
+	double depth;
+	double temperature;
+	unsigned int npressure;
+	struct {
+		unsigned int tank;
+		double value;
+	} pressure[DC_SAMPLE_RECORD_MAXTANKS];
+	unsigned int nevents;
+	struct {
+		unsigned int type;
+		unsigned int time;
+		unsigned int flags;
+		unsigned int value;
+	} event[DC_SAMPLE_RECORD_MAXEVENTS];
+	unsigned int rbt;
+	unsigned int heartbeat;
+	unsigned int bearing;
+	double setpoint;
+	unsigned int nppo2;
+	struct {
+		unsigned int sensor;
+		double value;
+	} ppo2[DC_SAMPLE_RECORD_MAXSENSORS];
+	double cns;
+	struct {
+		unsigned int type;
+		unsigned int time;
+		double depth;
+		unsigned int tts;
+	} deco;
+	unsigned int gasmix; /* Gas mix index */
+} dc_sample_record_t;
+
+/*
+ * Dive
+ *
+ * A complete dive, with the header fields and the full profile. The
+ * fields bitmask indicates which header fields are present, using one
+ * bit per field type (see DC_FIELD_MASK), and DC_DIVE_DATETIME for the
+ * date and time.
+ *
+ * The samples table contains one entry per time step, with the same
+ * bitmask semantics as the sample records. The pressure, event and ppO2
+ * values of all samples are stored in separate tables, and each sample
+ * refers to its own range within those tables.
+ *
+ * The whole dive is stored in a single memory block, which is released
+ * with dc_dive_free.
+ *
+ * With dc_parser_set_downsample, the profile is reduced to at most the
+ * given number of points per series (depth, temperature, heartbeat,
+ * setpoint, CNS, and the pressure of every tank and ppO2 of every
+ * sensor), with a shape preserving algorithm (LTTB). Events and gas
+ * switches are always kept. Analyses that integrate over the profile
+ * (e.g. decompression or gas consumption) need the full resolution
+ * profile, and should be run on a dive parsed without downsampling.
+ */
+
+#define DC_FIELD_MASK(type) (1u << (type))
+#define DC_DIVE_DATETIME    (1u << 31)
+
+typedef struct dc_dive_pressure_t {
+	unsigned int tank;
+	double value;
+} dc_dive_pressure_t;
+
+typedef struct dc_dive_event_t {
+	unsigned int type;
+	unsigned int time;
+	unsigned int flags;
+	unsigned int value;
+} dc_dive_event_t;
+
+typedef struct dc_dive_ppo2_t {
+	unsigned int sensor;
+	double value;
+} dc_dive_ppo2_t;
+
+typedef struct dc_dive_sample_t {
+	unsigned int fields;  /* Bitmask of the available fields */
+	unsigned int time;    /* Milliseconds */
+	double depth;
+	double temperature;
+	unsigned int rbt;
+	unsigned int heartbeat;
+	unsigned int bearing;
+	double setpoint;
+	double cns;
+	struct {
+		unsigned int type;
+		unsigned int time;
+		double depth;
+		unsigned int tts;
+	} deco;
+	unsigned int gasmix; /* Gas mix index */
+	unsigned int pressure, npressure; /* Range in the pressures table */
+	unsigned int event, nevents;      /* Range in the events table */
+	unsigned int ppo2, nppo2;         /* Range in the ppo2 table */
+} dc_dive_sample_t;
+
+typedef struct dc_dive_t {
+	unsigned int fields;  /* Bitmask of the available fields */
+	dc_datetime_t datetime;
+	unsigned int divetime;
+	double maxdepth;
+	double avgdepth;
+	dc_salinity_t salinity;
+	double atmospheric;
+	double temperature_surface;
+	double temperature_minimum;
+	double temperature_maximum;
+	dc_divemode_t divemode;
+	dc_decomodel_t decomodel;
+	dc_location_t location;
+	unsigned int ngasmixes;
+	dc_gasmix_t *gasmixes;
+	unsigned int ntanks;
+	dc_tank_t *tanks;
+	unsigned int nsamples;
+	dc_dive_sample_t *samples;
+	unsigned int npressures;
+	dc_dive_pressure_t *pressures;
+	unsigned int nevents;
+	dc_dive_event_t *events;
+	unsigned int nppo2;
+	dc_dive_ppo2_t *ppo2;
+} dc_dive_t;
+
+/*
+ * Batch
+ *
+ * A batch parses a list of raw dives on a pool of worker threads. Each
+ * worker uses its own context, which forwards the log messages to the
+ * context of the caller. The parsed dives are passed to the callback as
+ * soon as they are available, in completion order. The callback is never
+ * invoked concurrently, and the dive is released when it returns.
+ *
+ * The devtime and systime values are the clock reference of the download,
+ * for the backends that need it to calculate the date and time (see
+ * dc_parser_set_clock). Leave both at zero if not available.
+ */
+
+typedef struct dc_parser_batch_item_t {
+	dc_family_t family;
+	unsigned int model;
+	unsigned int devtime;
+	dc_ticks_t systime;
+	const unsigned char *data;
+	size_t size;
+} dc_parser_batch_item_t;
+
+typedef void (*dc_parser_batch_callback_t) (unsigned int index, dc_status_t status, const dc_dive_t *dive, void *userdata);
+
+/*
+ * Packed samples
+ *
+ * A compact binary encoding of the sample records, for storage and
+ * transfer. The values are delta and varint encoded per column, with a
+ * resolution of 1 mm for depths, 0.01 °C for temperatures, 0.01 bar for
+ * tank pressures, 1 mbar for setpoints and ppO2, and 0.01 % for CNS.
+ * The values are stored as signed 32 bit integers in these units, and
+ * values outside that range are silently clamped to it. For example, a
+ * depth beyond the range reads back as 2147483.647 m.
+ *
+ * The reader decodes the records directly from the packed data, without
+ * allocating memory. The packed data must remain valid while the reader
+ * is in use. The contents of the reader structure are private.
+ */
+
+#define DC_PACKED_VERSION  1
+#define DC_PACKED_NCOLUMNS (DC_SAMPLE_GASMIX + 2)
+
+typedef struct dc_packed_reader_t {
+	const unsigned char *column[DC_PACKED_NCOLUMNS];
+	const unsigned char *end[DC_PACKED_NCOLUMNS];
+	unsigned int nrecords;
+	unsigned int fields;
+	unsigned int time, interval;
+	unsigned int depth, temperature, setpoint, cns;
+	unsigned int pressure[DC_SAMPLE_RECORD_MAXTANKS];
+	unsigned int ppo2[DC_SAMPLE_RECORD_MAXSENSORS];
+} dc_packed_reader_t;
+
 typedef struct dc_parser_t dc_parser_t;
 
 typedef void (*dc_sample_callback_t) (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata);
 
+typedef void (*dc_sample_record_callback_t) (const dc_sample_record_t *record, void *userdata);
+
 dc_status_t
 dc_parser_new (dc_parser_t **parser, dc_device_t *device, const unsigned char data[], size_t size);
 
@@ -306,6 +514,12 @@ dc_parser_set_atmospheric (dc_parser_t *parser, double atmospheric);
 dc_status_t
 dc_parser_set_density (dc_parser_t *parser, double density);
 
+dc_status_t
+dc_parser_set_downsample (dc_parser_t *parser, unsigned int npoints);
+
+unsigned int
+dc_parser_get_downsample (dc_parser_t *parser);
+
 dc_status_t
 dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime);
 
@@ -315,6 +529,27 @@ dc_parser_get_field (dc_parser_t *parser, dc_field_type_t type, unsigned int fla
 dc_status_t
 dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+dc_status_t
+dc_parser_samples_foreach_records (dc_parser_t *parser, dc_sample_record_callback_t callback, void *userdata);
+
+dc_status_t
+dc_parser_parse_dive (dc_parser_t *parser, dc_dive_t **dive);
+
+void
+dc_dive_free (dc_dive_t *dive);
+
+dc_status_t
+dc_parser_samples_pack (dc_parser_t *parser, dc_buffer_t *buffer);
+
+dc_status_t
+dc_packed_reader_init (dc_packed_reader_t *reader, const unsigned char data[], size_t size);
+
+dc_status_t
+dc_packed_reader_next (dc_packed_reader_t *reader, dc_sample_record_t *record);
+
+dc_status_t
+dc_parser_parse_batch (dc_context_t *context, const dc_parser_batch_item_t items[], unsigned int count, unsigned int nthreads, dc_parser_batch_callback_t callback, void *userdata);
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser);
 
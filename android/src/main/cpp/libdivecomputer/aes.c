@@ -60,6 +60,35 @@ NOTE:   String length must be evenly divisible by 16byte (str_len % 16 == 0)
 #include <string.h> // CBC mode, for memset
 #include "aes.h"
 
+// The hardware accelerated ciphers are compiled only if the compiler can
+// generate the instructions. Whether the CPU supports them is checked at runtime.
+// The #ifndef-guard allows them to be disabled at compile time.
+#ifndef AESNI
+  #if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    #define AESNI 1
+  #endif
+#endif
+
+#ifndef ARMV8_CRYPTO
+  #if defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+    #define ARMV8_CRYPTO 1
+  #endif
+#endif
+
+#if defined(AESNI) && AESNI
+  #include <wmmintrin.h>
+#endif
+
+#if defined(ARMV8_CRYPTO) && ARMV8_CRYPTO
+  #include <arm_neon.h>
+  #if defined(__linux__)
+    #include <sys/auxv.h>
+    #ifndef HWCAP_AES
+      #define HWCAP_AES (1 << 3)
+    #endif
+  #endif
+#endif
+
 
 /*****************************************************************************/
 /* Defines:                                                                  */
@@ -164,6 +193,54 @@ static const uint8_t Rcon[255] = {
   0xc6, 0x97, 0x35, 0x6a, 0xd4, 0xb3, 0x7d, 0xfa, 0xef, 0xc5, 0x91, 0x39, 0x72, 0xe4, 0xd3, 0xbd, 
   0x61, 0xc2, 0x9f, 0x25, 0x4a, 0x94, 0x33, 0x66, 0xcc, 0x83, 0x1d, 0x3a, 0x74, 0xe8, 0xcb  };
 
+// The encryption T-table combines SubBytes and MixColumns for one column:
+// Te0[x] = { 02 * S[x], S[x], S[x], 03 * S[x] } as a big-endian word.
+// The tables for the other three rows are byte rotations of this one.
+static const uint32_t Te0[256] = {
+  0xc66363a5, 0xf87c7c84, 0xee777799, 0xf67b7b8d, 0xfff2f20d, 0xd66b6bbd,
+  0xde6f6fb1, 0x91c5c554, 0x60303050, 0x02010103, 0xce6767a9, 0x562b2b7d,
+  0xe7fefe19, 0xb5d7d762, 0x4dababe6, 0xec76769a, 0x8fcaca45, 0x1f82829d,
+  0x89c9c940, 0xfa7d7d87, 0xeffafa15, 0xb25959eb, 0x8e4747c9, 0xfbf0f00b,
+  0x41adadec, 0xb3d4d467, 0x5fa2a2fd, 0x45afafea, 0x239c9cbf, 0x53a4a4f7,
+  0xe4727296, 0x9bc0c05b, 0x75b7b7c2, 0xe1fdfd1c, 0x3d9393ae, 0x4c26266a,
+  0x6c36365a, 0x7e3f3f41, 0xf5f7f702, 0x83cccc4f, 0x6834345c, 0x51a5a5f4,
+  0xd1e5e534, 0xf9f1f108, 0xe2717193, 0xabd8d873, 0x62313153, 0x2a15153f,
+  0x0804040c, 0x95c7c752, 0x46232365, 0x9dc3c35e, 0x30181828, 0x379696a1,
+  0x0a05050f, 0x2f9a9ab5, 0x0e070709, 0x24121236, 0x1b80809b, 0xdfe2e23d,
+  0xcdebeb26, 0x4e272769, 0x7fb2b2cd, 0xea75759f, 0x1209091b, 0x1d83839e,
+  0x582c2c74, 0x341a1a2e, 0x361b1b2d, 0xdc6e6eb2, 0xb45a5aee, 0x5ba0a0fb,
+  0xa45252f6, 0x763b3b4d, 0xb7d6d661, 0x7db3b3ce, 0x5229297b, 0xdde3e33e,
+  0x5e2f2f71, 0x13848497, 0xa65353f5, 0xb9d1d168, 0x00000000, 0xc1eded2c,
+  0x40202060, 0xe3fcfc1f, 0x79b1b1c8, 0xb65b5bed, 0xd46a6abe, 0x8dcbcb46,
+  0x67bebed9, 0x7239394b, 0x944a4ade, 0x984c4cd4, 0xb05858e8, 0x85cfcf4a,
+  0xbbd0d06b, 0xc5efef2a, 0x4faaaae5, 0xedfbfb16, 0x864343c5, 0x9a4d4dd7,
+  0x66333355, 0x11858594, 0x8a4545cf, 0xe9f9f910, 0x04020206, 0xfe7f7f81,
+  0xa05050f0, 0x783c3c44, 0x259f9fba, 0x4ba8a8e3, 0xa25151f3, 0x5da3a3fe,
+  0x804040c0, 0x058f8f8a, 0x3f9292ad, 0x219d9dbc, 0x70383848, 0xf1f5f504,
+  0x63bcbcdf, 0x77b6b6c1, 0xafdada75, 0x42212163, 0x20101030, 0xe5ffff1a,
+  0xfdf3f30e, 0xbfd2d26d, 0x81cdcd4c, 0x180c0c14, 0x26131335, 0xc3ecec2f,
+  0xbe5f5fe1, 0x359797a2, 0x884444cc, 0x2e171739, 0x93c4c457, 0x55a7a7f2,
+  0xfc7e7e82, 0x7a3d3d47, 0xc86464ac, 0xba5d5de7, 0x3219192b, 0xe6737395,
+  0xc06060a0, 0x19818198, 0x9e4f4fd1, 0xa3dcdc7f, 0x44222266, 0x542a2a7e,
+  0x3b9090ab, 0x0b888883, 0x8c4646ca, 0xc7eeee29, 0x6bb8b8d3, 0x2814143c,
+  0xa7dede79, 0xbc5e5ee2, 0x160b0b1d, 0xaddbdb76, 0xdbe0e03b, 0x64323256,
+  0x743a3a4e, 0x140a0a1e, 0x924949db, 0x0c06060a, 0x4824246c, 0xb85c5ce4,
+  0x9fc2c25d, 0xbdd3d36e, 0x43acacef, 0xc46262a6, 0x399191a8, 0x319595a4,
+  0xd3e4e437, 0xf279798b, 0xd5e7e732, 0x8bc8c843, 0x6e373759, 0xda6d6db7,
+  0x018d8d8c, 0xb1d5d564, 0x9c4e4ed2, 0x49a9a9e0, 0xd86c6cb4, 0xac5656fa,
+  0xf3f4f407, 0xcfeaea25, 0xca6565af, 0xf47a7a8e, 0x47aeaee9, 0x10080818,
+  0x6fbabad5, 0xf0787888, 0x4a25256f, 0x5c2e2e72, 0x381c1c24, 0x57a6a6f1,
+  0x73b4b4c7, 0x97c6c651, 0xcbe8e823, 0xa1dddd7c, 0xe874749c, 0x3e1f1f21,
+  0x964b4bdd, 0x61bdbddc, 0x0d8b8b86, 0x0f8a8a85, 0xe0707090, 0x7c3e3e42,
+  0x71b5b5c4, 0xcc6666aa, 0x904848d8, 0x06030305, 0xf7f6f601, 0x1c0e0e12,
+  0xc26161a3, 0x6a35355f, 0xae5757f9, 0x69b9b9d0, 0x17868691, 0x99c1c158,
+  0x3a1d1d27, 0x279e9eb9, 0xd9e1e138, 0xebf8f813, 0x2b9898b3, 0x22111133,
+  0xd26969bb, 0xa9d9d970, 0x078e8e89, 0x339494a7, 0x2d9b9bb6, 0x3c1e1e22,
+  0x15878792, 0xc9e9e920, 0x87cece49, 0xaa5555ff, 0x50282878, 0xa5dfdf7a,
+  0x038c8c8f, 0x59a1a1f8, 0x09898980, 0x1a0d0d17, 0x65bfbfda, 0xd7e6e631,
+  0x844242c6, 0xd06868b8, 0x824141c3, 0x299999b0, 0x5a2d2d77, 0x1e0f0f11,
+  0x7bb0b0cb, 0xa85454fc, 0x6dbbbbd6, 0x2c16163a };
+
 
 /*****************************************************************************/
 /* Private functions:                                                        */
@@ -471,6 +548,108 @@ static void BlockCopy(uint8_t* output, uint8_t* input)
 
 
 
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define LOAD32BE(p) \
+  (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) | ((uint32_t)(p)[2] << 8) | (uint32_t)(p)[3])
+
+#define STORE32BE(p, v) \
+  do { (p)[0] = (uint8_t)((v) >> 24); (p)[1] = (uint8_t)((v) >> 16); (p)[2] = (uint8_t)((v) >> 8); (p)[3] = (uint8_t)(v); } while (0)
+
+#define TROUND(a, b, c, d, k) \
+  (Te0[(a) >> 24] ^ ROTR32(Te0[((b) >> 16) & 0xff], 8) ^ ROTR32(Te0[((c) >> 8) & 0xff], 16) ^ ROTR32(Te0[(d) & 0xff], 24) ^ (k))
+
+#define TFINAL(a, b, c, d, k) \
+  (((uint32_t)sbox[(a) >> 24] << 24) ^ ((uint32_t)sbox[((b) >> 16) & 0xff] << 16) ^ \
+   ((uint32_t)sbox[((c) >> 8) & 0xff] << 8) ^ (uint32_t)sbox[(d) & 0xff] ^ (k))
+
+// Cipher on 32 bit words, with one table lookup per byte and round.
+static void CipherT(const AES128_ctx_t* ctx, const uint8_t* input, uint8_t* output)
+{
+  const uint32_t* rk = ctx->rk;
+  uint32_t s0, s1, s2, s3, t0, t1, t2, t3;
+  uint8_t round;
+
+  s0 = LOAD32BE(input +  0) ^ rk[0];
+  s1 = LOAD32BE(input +  4) ^ rk[1];
+  s2 = LOAD32BE(input +  8) ^ rk[2];
+  s3 = LOAD32BE(input + 12) ^ rk[3];
+
+  for(round = 1; round < Nr; ++round)
+  {
+    rk += 4;
+    t0 = TROUND(s0, s1, s2, s3, rk[0]);
+    t1 = TROUND(s1, s2, s3, s0, rk[1]);
+    t2 = TROUND(s2, s3, s0, s1, rk[2]);
+    t3 = TROUND(s3, s0, s1, s2, rk[3]);
+    s0 = t0; s1 = t1; s2 = t2; s3 = t3;
+  }
+
+  rk += 4;
+  t0 = TFINAL(s0, s1, s2, s3, rk[0]);
+  t1 = TFINAL(s1, s2, s3, s0, rk[1]);
+  t2 = TFINAL(s2, s3, s0, s1, rk[2]);
+  t3 = TFINAL(s3, s0, s1, s2, rk[3]);
+
+  STORE32BE(output +  0, t0);
+  STORE32BE(output +  4, t1);
+  STORE32BE(output +  8, t2);
+  STORE32BE(output + 12, t3);
+}
+
+#if defined(AESNI) && AESNI
+__attribute__((target("aes,sse2")))
+static void CipherAESNI(const AES128_ctx_t* ctx, const uint8_t* input, uint8_t* output)
+{
+  const __m128i* rk = (const __m128i*)ctx->RoundKey;
+  __m128i block = _mm_loadu_si128((const __m128i*)input);
+  uint8_t round;
+
+  block = _mm_xor_si128(block, _mm_loadu_si128(rk));
+  for(round = 1; round < Nr; ++round)
+  {
+    block = _mm_aesenc_si128(block, _mm_loadu_si128(rk + round));
+  }
+  block = _mm_aesenclast_si128(block, _mm_loadu_si128(rk + Nr));
+
+  _mm_storeu_si128((__m128i*)output, block);
+}
+
+static int HaveAESNI(void)
+{
+  return __builtin_cpu_supports("aes");
+}
+#endif
+
+#if defined(ARMV8_CRYPTO) && ARMV8_CRYPTO
+static void CipherARMv8(const AES128_ctx_t* ctx, const uint8_t* input, uint8_t* output)
+{
+  const uint8_t* rk = ctx->RoundKey;
+  uint8x16_t block = vld1q_u8(input);
+  uint8_t round;
+
+  // AESE includes the AddRoundKey step, at the start of the round.
+  for(round = 0; round < Nr - 1; ++round)
+  {
+    block = vaesmcq_u8(vaeseq_u8(block, vld1q_u8(rk + round * 16)));
+  }
+  block = vaeseq_u8(block, vld1q_u8(rk + (Nr - 1) * 16));
+  block = veorq_u8(block, vld1q_u8(rk + Nr * 16));
+
+  vst1q_u8(output, block);
+}
+
+static int HaveARMv8(void)
+{
+#if defined(__linux__)
+  return (getauxval(AT_HWCAP) & HWCAP_AES) != 0;
+#else
+  return 1;
+#endif
+}
+#endif
+
+
 /*****************************************************************************/
 /* Public functions:                                                         */
 /*****************************************************************************/
@@ -479,16 +658,11 @@ static void BlockCopy(uint8_t* output, uint8_t* input)
 
 void AES128_ECB_encrypt(uint8_t* input, const uint8_t* key, uint8_t* output)
 {
-  aes_state_t state;
-  // Copy input to output, and work in-memory on output
-  BlockCopy(output, input);
-  state.state = (state_t*)output;
-
-  state.Key = key;
-  KeyExpansion(&state);
+  AES128_ctx_t ctx;
+  AES128_init_ctx(&ctx, key);
 
   // The next function call encrypts the PlainText with the Key using AES algorithm.
-  Cipher(&state);
+  ctx.encrypt(&ctx, input, output);
 }
 
 void AES128_ECB_decrypt(uint8_t* input, const uint8_t* key, uint8_t *output)
@@ -611,3 +785,109 @@ void AES128_CBC_decrypt_buffer(uint8_t* output, uint8_t* input, uint32_t length,
 #endif // #if defined(CBC) && CBC
 
 
+void AES128_init_ctx(AES128_ctx_t* ctx, const uint8_t* key)
+{
+  aes_state_t state;
+  uint8_t i;
+
+  state.Key = key;
+  KeyExpansion(&state);
+
+  memcpy(ctx->RoundKey, state.RoundKey, sizeof(ctx->RoundKey));
+  for(i = 0; i < Nb * (Nr + 1); ++i)
+  {
+    ctx->rk[i] = LOAD32BE(ctx->RoundKey + i * 4);
+  }
+
+  ctx->encrypt = CipherT;
+#if defined(ARMV8_CRYPTO) && ARMV8_CRYPTO
+  if(HaveARMv8())
+    ctx->encrypt = CipherARMv8;
+#endif
+#if defined(AESNI) && AESNI
+  if(HaveAESNI())
+    ctx->encrypt = CipherAESNI;
+#endif
+}
+
+void AES128_ECB_encrypt_ctx(const AES128_ctx_t* ctx, const uint8_t* input, uint8_t* output)
+{
+  ctx->encrypt(ctx, input, output);
+}
+
+
+#if defined(CFB) && CFB
+
+void AES128_CFB_encrypt_buffer(const AES128_ctx_t* ctx, uint8_t* output, const uint8_t* input, uint32_t length, uint8_t* iv)
+{
+  uint8_t keystream[KEYLEN];
+  uint32_t i, n;
+
+  while(length)
+  {
+    n = length < KEYLEN ? length : KEYLEN;
+    ctx->encrypt(ctx, iv, keystream);
+    for(i = 0; i < n; ++i)
+    {
+      output[i] = input[i] ^ keystream[i];
+    }
+    // The ciphertext is the feedback for the next block.
+    memcpy(iv, output, n);
+    input += n;
+    output += n;
+    length -= n;
+  }
+}
+
+void AES128_CFB_decrypt_buffer(const AES128_ctx_t* ctx, uint8_t* output, const uint8_t* input, uint32_t length, uint8_t* iv)
+{
+  uint8_t keystream[KEYLEN];
+  uint32_t i, n;
+
+  while(length)
+  {
+    n = length < KEYLEN ? length : KEYLEN;
+    ctx->encrypt(ctx, iv, keystream);
+    // Save the ciphertext first, because input and output may overlap.
+    memcpy(iv, input, n);
+    for(i = 0; i < n; ++i)
+    {
+      output[i] = iv[i] ^ keystream[i];
+    }
+    input += n;
+    output += n;
+    length -= n;
+  }
+}
+
+#endif // #if defined(CFB) && CFB
+
+
+#if defined(CTR) && CTR
+
+void AES128_CTR_xcrypt_buffer(const AES128_ctx_t* ctx, uint8_t* output, const uint8_t* input, uint32_t length, uint8_t* counter)
+{
+  uint8_t keystream[KEYLEN];
+  uint32_t i, n;
+  int j;
+
+  while(length)
+  {
+    n = length < KEYLEN ? length : KEYLEN;
+    ctx->encrypt(ctx, counter, keystream);
+    for(i = 0; i < n; ++i)
+    {
+      output[i] = input[i] ^ keystream[i];
+    }
+    for(j = KEYLEN - 1; j >= 0; --j)
+    {
+      if(++counter[j] != 0)
+        break;
+    }
+    input += n;
+    output += n;
+    length -= n;
+  }
+}
+
+#endif // #if defined(CTR) && CTR
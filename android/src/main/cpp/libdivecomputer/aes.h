@@ -49,6 +49,16 @@ typedef unsigned int  uint32_t;
   #define ECB 1
 #endif
 
+// CFB and CTR enable the bulk modes of operation on top of a pre-expanded key
+// context (see AES128_init_ctx). Both only need the forward cipher.
+#ifndef CFB
+  #define CFB 1
+#endif
+
+#ifndef CTR
+  #define CTR 1
+#endif
+
 
 
 #if defined(ECB) && ECB
@@ -67,5 +77,38 @@ void AES128_CBC_decrypt_buffer(uint8_t* output, uint8_t* input, uint32_t length,
 #endif // #if defined(CBC) && CBC
 
 
+// The context holds the expanded key, so the key schedule is computed only once
+// instead of once per block. The encrypt function is selected at runtime, and
+// uses the ARMv8 Crypto Extensions or AES-NI when the CPU supports them.
+typedef struct AES128_ctx_t {
+  uint8_t RoundKey[176];
+  uint32_t rk[44];
+  void (*encrypt)(const struct AES128_ctx_t* ctx, const uint8_t* input, uint8_t* output);
+} AES128_ctx_t;
+
+void AES128_init_ctx(AES128_ctx_t* ctx, const uint8_t* key);
+void AES128_ECB_encrypt_ctx(const AES128_ctx_t* ctx, const uint8_t* input, uint8_t* output);
+
+
+#if defined(CFB) && CFB
+
+// The iv is updated in-place, so a stream can be processed in several calls as
+// long as all but the last length are a multiple of 16 bytes. The input and
+// output buffers may be the same.
+void AES128_CFB_encrypt_buffer(const AES128_ctx_t* ctx, uint8_t* output, const uint8_t* input, uint32_t length, uint8_t* iv);
+void AES128_CFB_decrypt_buffer(const AES128_ctx_t* ctx, uint8_t* output, const uint8_t* input, uint32_t length, uint8_t* iv);
+
+#endif // #if defined(CFB) && CFB
+
+
+#if defined(CTR) && CTR
+
+// The counter block is incremented (big-endian) in-place, with the same rules
+// as the iv in CFB mode. Encryption and decryption are the same operation.
+void AES128_CTR_xcrypt_buffer(const AES128_ctx_t* ctx, uint8_t* output, const uint8_t* input, uint32_t length, uint8_t* counter);
+
+#endif // #if defined(CTR) && CTR
+
+
 
 #endif //_AES_H_
@@ -28,6 +28,9 @@
 #include <libdivecomputer/ble.h>
 
 #include "platform.h"
+#include "iostream-private.h"
+#include "context-private.h"
+#include "array.h"
 
 char *
 dc_ble_uuid2str (const dc_ble_uuid_t uuid, char *str, size_t size)
@@ -95,3 +98,45 @@ dc_ble_str2uuid (const char *str, dc_ble_uuid_t uuid)
 
 	return 1;
 }
+
+dc_status_t
+dc_ble_setup_link (dc_iostream_t *iostream, unsigned int *packetsize)
+{
+	static const struct {
+		unsigned int request;
+		unsigned int value;
+	} requests[] = {
+		{DC_IOCTL_BLE_SET_PRIORITY, DC_BLE_PRIORITY_HIGH},
+		{DC_IOCTL_BLE_SET_PHY,      DC_BLE_PHY_2M},
+		{DC_IOCTL_BLE_SET_MTU,      DC_BLE_MTU_MAX},
+	};
+
+	if (packetsize)
+		*packetsize = 0;
+
+	if (iostream == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (dc_iostream_get_transport (iostream) != DC_TRANSPORT_BLE)
+		return DC_STATUS_SUCCESS;
+
+	// The requests are only preferences, so a failure isn't fatal.
+	for (size_t i = 0; i < C_ARRAY_SIZE (requests); ++i) {
+		unsigned int value = requests[i].value;
+		dc_status_t status = dc_iostream_ioctl (iostream, requests[i].request, &value, sizeof (value));
+		if (status != DC_STATUS_SUCCESS && status != DC_STATUS_UNSUPPORTED) {
+			WARNING (iostream->context, "Failed to configure the BLE link (0x%08x).", requests[i].request);
+		}
+	}
+
+	// The MTU is unknown if the transport doesn't report it.
+	unsigned int mtu = 0;
+	dc_status_t status = dc_iostream_ioctl (iostream, DC_IOCTL_BLE_GET_MTU, &mtu, sizeof (mtu));
+	if (status == DC_STATUS_SUCCESS && mtu >= DC_BLE_MTU_MIN) {
+		DEBUG (iostream->context, "BLE link: mtu=%u", mtu);
+		if (packetsize)
+			*packetsize = mtu - 3;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
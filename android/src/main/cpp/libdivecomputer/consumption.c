@@ -0,0 +1,280 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libdivecomputer/consumption.h>
+#include <libdivecomputer/units.h>
+
+#include "parser-private.h"
+
+#define UNDEFINED 0xFFFFFFFF
+
+#define ALIGN(x) (((x) + 7) & ~(size_t) 7)
+
+/*
+ * A tank pressure sample, with the running integrals of the profile at
+ * the time of the sample. The samples of the same tank are linked.
+ */
+typedef struct consumption_entry_t {
+	unsigned int time;
+	unsigned int next;
+	double pressure;
+	double ambient; // Integral of the relative ambient pressure (min)
+	double depth;   // Integral of the depth (m min)
+} consumption_entry_t;
+
+typedef struct consumption_tank_t {
+	unsigned int id;
+	double volume;
+	unsigned int start; // Start of the smoothing window
+	unsigned int begin; // First sample of the current segment
+	unsigned int last;  // Most recent sample
+} consumption_tank_t;
+
+typedef struct consumption_t {
+	consumption_entry_t *entries;
+	unsigned int nentries;
+	dc_buffer_t *tanks;
+	dc_buffer_t *points;
+	dc_buffer_t *segments;
+	int nomemory;
+} consumption_t;
+
+static consumption_tank_t *
+consumption_tank (consumption_t *state, const dc_dive_t *dive, unsigned int id)
+{
+	consumption_tank_t *tanks = (consumption_tank_t *) dc_buffer_get_data (state->tanks);
+	unsigned int ntanks = dc_buffer_get_size (state->tanks) / sizeof (consumption_tank_t);
+
+	for (unsigned int i = 0; i < ntanks; ++i) {
+		if (tanks[i].id == id)
+			return tanks + i;
+	}
+
+	consumption_tank_t tank = {id, 0.0, UNDEFINED, UNDEFINED, UNDEFINED};
+	if (id < dive->ntanks)
+		tank.volume = dive->tanks[id].volume;
+
+	if (!dc_buffer_append (state->tanks, (const unsigned char *) &tank, sizeof (tank))) {
+		state->nomemory = 1;
+		return NULL;
+	}
+
+	return (consumption_tank_t *) dc_buffer_get_data (state->tanks) + ntanks;
+}
+
+static void
+consumption_segment (consumption_t *state, unsigned int gasmix)
+{
+	consumption_tank_t *tanks = (consumption_tank_t *) dc_buffer_get_data (state->tanks);
+	unsigned int ntanks = dc_buffer_get_size (state->tanks) / sizeof (consumption_tank_t);
+
+	for (unsigned int i = 0; i < ntanks; ++i) {
+		consumption_tank_t *tank = tanks + i;
+		if (tank->begin == UNDEFINED)
+			continue;
+
+		const consumption_entry_t *begin = state->entries + tank->begin;
+		const consumption_entry_t *end = state->entries + tank->last;
+		if (end->time > begin->time) {
+			dc_consumption_segment_t segment;
+			segment.tank = tank->id;
+			segment.gasmix = gasmix;
+			segment.begintime = begin->time;
+			segment.endtime = end->time;
+			segment.beginpressure = begin->pressure;
+			segment.endpressure = end->pressure;
+			segment.avgdepth = (end->depth - begin->depth) * 60000.0 / (end->time - begin->time);
+			segment.volume = (begin->pressure - end->pressure) * tank->volume;
+			segment.sac = 0.0;
+			if (end->ambient > begin->ambient)
+				segment.sac = (begin->pressure - end->pressure) / (end->ambient - begin->ambient);
+			segment.rmv = segment.sac * tank->volume;
+
+			if (!dc_buffer_append (state->segments, (const unsigned char *) &segment, sizeof (segment)))
+				state->nomemory = 1;
+		}
+
+		// The next segment starts where this one ends.
+		tank->begin = tank->last;
+	}
+}
+
+static void *
+consumption_table (unsigned char **p, dc_buffer_t *buffer)
+{
+	size_t size = dc_buffer_get_size (buffer);
+	void *table = *p;
+
+	if (size)
+		memcpy (*p, dc_buffer_get_data (buffer), size);
+	*p += ALIGN (size);
+
+	return table;
+}
+
+dc_status_t
+dc_consumption_compute (const dc_dive_t *dive, unsigned int window, dc_consumption_t **out)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	consumption_t state;
+
+	if (dive == NULL || window == 0 || out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	memset (&state, 0, sizeof (state));
+	state.entries = (consumption_entry_t *) malloc ((dive->npressures ? dive->npressures : 1) * sizeof (consumption_entry_t));
+	state.tanks = dc_buffer_new (0);
+	state.points = dc_buffer_new (0);
+	state.segments = dc_buffer_new (0);
+	if (state.entries == NULL || state.tanks == NULL ||
+		state.points == NULL || state.segments == NULL) {
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	double surface = DEF_ATMOSPHERIC / BAR;
+	if ((dive->fields & DC_FIELD_MASK (DC_FIELD_ATMOSPHERIC)) && dive->atmospheric > 0.0)
+		surface = dive->atmospheric;
+
+	double density = DEF_DENSITY_SALT;
+	if ((dive->fields & DC_FIELD_MASK (DC_FIELD_SALINITY)) && dive->salinity.density > 0.0)
+		density = dive->salinity.density;
+	density = density * GRAVITY / BAR;
+
+	unsigned int time = 0;
+	double depth = 0.0;
+	double ambient = 0.0, integral = 0.0;
+	unsigned int gasmix = DC_GASMIX_UNKNOWN;
+
+	for (unsigned int i = 0; i < dive->nsamples; ++i) {
+		const dc_dive_sample_t *sample = dive->samples + i;
+
+		unsigned int t = time;
+		if ((sample->fields & DC_SAMPLE_MASK (DC_SAMPLE_TIME)) && sample->time > time)
+			t = sample->time;
+
+		double d = depth;
+		if (sample->fields & DC_SAMPLE_MASK (DC_SAMPLE_DEPTH))
+			d = sample->depth > 0.0 ? sample->depth : 0.0;
+
+		// Running integrals of the relative ambient pressure and the
+		// depth, with the trapezoidal rule.
+		if (t > time) {
+			double minutes = (t - time) / 60000.0;
+			ambient += (1.0 + (depth + d) / 2.0 * density / surface) * minutes;
+			integral += (depth + d) / 2.0 * minutes;
+		}
+
+		time = t;
+		depth = d;
+
+		for (unsigned int j = 0; j < sample->npressure; ++j) {
+			if (sample->pressure + j >= dive->npressures)
+				break;
+
+			const dc_dive_pressure_t *pressure = dive->pressures + sample->pressure + j;
+
+			consumption_tank_t *tank = consumption_tank (&state, dive, pressure->tank);
+			if (tank == NULL)
+				continue;
+
+			unsigned int idx = state.nentries++;
+			consumption_entry_t *entry = state.entries + idx;
+			entry->time = time;
+			entry->next = UNDEFINED;
+			entry->pressure = pressure->value;
+			entry->ambient = ambient;
+			entry->depth = integral;
+
+			if (tank->last != UNDEFINED)
+				state.entries[tank->last].next = idx;
+			else
+				tank->start = idx;
+			if (tank->begin == UNDEFINED)
+				tank->begin = idx;
+			tank->last = idx;
+
+			// Smoothed rate over the trailing window.
+			while (state.entries[tank->start].time + (unsigned long long) window * 1000 < time)
+				tank->start = state.entries[tank->start].next;
+
+			const consumption_entry_t *start = state.entries + tank->start;
+			if (tank->start != idx && entry->ambient > start->ambient) {
+				dc_consumption_point_t point;
+				point.tank = tank->id;
+				point.time = time;
+				point.sac = (start->pressure - entry->pressure) / (entry->ambient - start->ambient);
+				if (point.sac < 0.0)
+					point.sac = 0.0;
+				point.rmv = point.sac * tank->volume;
+
+				if (!dc_buffer_append (state.points, (const unsigned char *) &point, sizeof (point)))
+					state.nomemory = 1;
+			}
+		}
+
+		if ((sample->fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX)) && sample->gasmix != gasmix) {
+			consumption_segment (&state, gasmix);
+			gasmix = sample->gasmix;
+		}
+	}
+
+	consumption_segment (&state, gasmix);
+
+	if (state.nomemory) {
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	// Allocate a single block for the result and its tables.
+	size_t size = ALIGN (sizeof (dc_consumption_t)) +
+		ALIGN (dc_buffer_get_size (state.points)) +
+		ALIGN (dc_buffer_get_size (state.segments));
+	dc_consumption_t *consumption = (dc_consumption_t *) malloc (size);
+	if (consumption == NULL) {
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	unsigned char *p = (unsigned char *) consumption + ALIGN (sizeof (dc_consumption_t));
+	consumption->npoints = dc_buffer_get_size (state.points) / sizeof (dc_consumption_point_t);
+	consumption->points = (dc_consumption_point_t *) consumption_table (&p, state.points);
+	consumption->nsegments = dc_buffer_get_size (state.segments) / sizeof (dc_consumption_segment_t);
+	consumption->segments = (dc_consumption_segment_t *) consumption_table (&p, state.segments);
+
+	*out = consumption;
+
+error_free:
+	dc_buffer_free (state.segments);
+	dc_buffer_free (state.points);
+	dc_buffer_free (state.tanks);
+	free (state.entries);
+	return status;
+}
+
+void
+dc_consumption_free (dc_consumption_t *consumption)
+{
+	free (consumption);
+}
@@ -241,6 +241,9 @@ cressi_edy_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t c
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
 
+	if (size < SZ_HEADER)
+		return DC_STATUS_DATAFORMAT;
+
 	unsigned int time = 0;
 	unsigned int interval = 30;
 	if (parser->model == EDY) {
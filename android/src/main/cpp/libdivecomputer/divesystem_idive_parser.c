@@ -412,6 +412,9 @@ divesystem_idive_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callba
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
 
+	if (size < parser->headersize)
+		return DC_STATUS_DATAFORMAT;
+
 	unsigned int time = 0;
 	unsigned int maxdepth = 0;
 	unsigned int ngasmixes = 0;
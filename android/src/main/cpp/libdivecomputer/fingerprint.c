@@ -0,0 +1,362 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#include <libdivecomputer/fingerprint.h>
+
+#include "context-private.h"
+#include "checksum.h"
+
+#define MAGIC   0x50464344 // "DCFP"
+#define VERSION 1
+
+// Number of slots in a new file.
+#define NSLOTS  16
+
+/*
+ * The file starts with a header, followed by an array of fixed size
+ * slots. A slot is valid if its checksum is correct, and the valid slot
+ * with the highest sequence number holds the fingerprint of a device.
+ * Invalid slots (never written, or torn by an interrupted write) are
+ * free. The file only grows, by appending free slots.
+ */
+
+typedef struct fingerprint_header_t {
+	unsigned int magic;
+	unsigned int version;
+	unsigned int slotsize;
+	unsigned int reserved;
+} fingerprint_header_t;
+
+typedef struct fingerprint_slot_t {
+	unsigned int crc; // CRC-32 of the remainder of the slot
+	unsigned int sequence;
+	unsigned int family;
+	unsigned int model;
+	unsigned int serial;
+	unsigned int size;
+	unsigned char data[DC_FINGERPRINT_MAXSIZE];
+} fingerprint_slot_t;
+
+struct dc_fingerprint_store_t {
+	dc_context_t *context;
+	pthread_mutex_t mutex;
+	int fd;
+	unsigned char *mapping;
+	size_t length;
+	fingerprint_slot_t *slots;
+	unsigned int nslots;
+};
+
+static unsigned int
+fingerprint_crc (const fingerprint_slot_t *slot)
+{
+	return checksum_crc32r ((const unsigned char *) slot + sizeof (slot->crc), sizeof (*slot) - sizeof (slot->crc));
+}
+
+static int
+fingerprint_valid (const fingerprint_slot_t *slot)
+{
+	return slot->size <= DC_FINGERPRINT_MAXSIZE && slot->crc == fingerprint_crc (slot);
+}
+
+/*
+ * Locate the newest (and the older) valid slot of a device.
+ */
+static fingerprint_slot_t *
+fingerprint_find (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, fingerprint_slot_t **older)
+{
+	fingerprint_slot_t *newest = NULL;
+
+	*older = NULL;
+
+	for (unsigned int i = 0; i < store->nslots; ++i) {
+		fingerprint_slot_t *slot = store->slots + i;
+		if (slot->family != family || slot->model != model || slot->serial != serial)
+			continue;
+		if (!fingerprint_valid (slot))
+			continue;
+
+		if (newest == NULL || slot->sequence > newest->sequence) {
+			*older = newest;
+			newest = slot;
+		} else {
+			*older = slot;
+		}
+	}
+
+	return newest;
+}
+
+#ifndef _WIN32
+static dc_status_t
+fingerprint_map (dc_fingerprint_store_t *store, size_t length)
+{
+	void *mapping = mmap (NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, store->fd, 0);
+	if (mapping == MAP_FAILED) {
+		SYSERROR (store->context, errno);
+		ERROR (store->context, "Failed to map the file.");
+		return DC_STATUS_IO;
+	}
+
+	if (store->mapping)
+		munmap (store->mapping, store->length);
+
+	store->mapping = (unsigned char *) mapping;
+	store->length = length;
+	store->slots = (fingerprint_slot_t *) (store->mapping + sizeof (fingerprint_header_t));
+	store->nslots = (length - sizeof (fingerprint_header_t)) / sizeof (fingerprint_slot_t);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+fingerprint_grow (dc_fingerprint_store_t *store, unsigned int nslots)
+{
+	size_t length = sizeof (fingerprint_header_t) + (size_t) nslots * sizeof (fingerprint_slot_t);
+
+	// The new slots are filled with zeros, and thus invalid (free).
+	if (ftruncate (store->fd, length) != 0) {
+		SYSERROR (store->context, errno);
+		ERROR (store->context, "Failed to resize the file.");
+		return DC_STATUS_IO;
+	}
+
+	return fingerprint_map (store, length);
+}
+
+static void
+fingerprint_sync (dc_fingerprint_store_t *store, const void *data, size_t size)
+{
+	size_t pagesize = sysconf (_SC_PAGESIZE);
+	size_t begin = ((const unsigned char *) data - store->mapping) / pagesize * pagesize;
+	size_t end = (const unsigned char *) data - store->mapping + size;
+
+	if (msync (store->mapping + begin, end - begin, MS_SYNC) != 0) {
+		SYSERROR (store->context, errno);
+	}
+}
+#endif
+
+dc_status_t
+dc_fingerprint_store_open (dc_fingerprint_store_t **out, dc_context_t *context, const char *filename)
+{
+#ifdef _WIN32
+	return DC_STATUS_UNSUPPORTED;
+#else
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_fingerprint_store_t *store = NULL;
+
+	if (out == NULL || filename == NULL) {
+		ERROR (context, "Invalid arguments.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	store = (dc_fingerprint_store_t *) malloc (sizeof (dc_fingerprint_store_t));
+	if (store == NULL) {
+		ERROR (context, "Failed to allocate memory.");
+		return DC_STATUS_NOMEMORY;
+	}
+
+	store->context = context;
+	store->mapping = NULL;
+	store->length = 0;
+	store->slots = NULL;
+	store->nslots = 0;
+
+	store->fd = open (filename, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (store->fd < 0) {
+		SYSERROR (context, errno);
+		ERROR (context, "Failed to open the file.");
+		status = DC_STATUS_IO;
+		goto error_free;
+	}
+
+	struct stat st;
+	if (fstat (store->fd, &st) != 0) {
+		SYSERROR (context, errno);
+		status = DC_STATUS_IO;
+		goto error_close;
+	}
+
+	if (st.st_size == 0) {
+		status = fingerprint_grow (store, NSLOTS);
+	} else if ((size_t) st.st_size >= sizeof (fingerprint_header_t)) {
+		status = fingerprint_map (store, st.st_size);
+	} else {
+		ERROR (context, "Unexpected file size (%lld).", (long long) st.st_size);
+		status = DC_STATUS_DATAFORMAT;
+	}
+	if (status != DC_STATUS_SUCCESS)
+		goto error_close;
+
+	// Initialize a new file. A header of zeros is also left behind by
+	// an interrupted initialization.
+	fingerprint_header_t *header = (fingerprint_header_t *) store->mapping;
+	if (header->magic == 0 && header->version == 0 && header->slotsize == 0) {
+		header->magic = MAGIC;
+		header->version = VERSION;
+		header->slotsize = sizeof (fingerprint_slot_t);
+		header->reserved = 0;
+		fingerprint_sync (store, header, sizeof (fingerprint_header_t));
+	}
+
+	if (header->magic != MAGIC || header->version != VERSION ||
+		header->slotsize != sizeof (fingerprint_slot_t)) {
+		ERROR (context, "Unsupported file format.");
+		status = DC_STATUS_DATAFORMAT;
+		goto error_unmap;
+	}
+
+	pthread_mutex_init (&store->mutex, NULL);
+
+	*out = store;
+
+	return DC_STATUS_SUCCESS;
+
+error_unmap:
+	munmap (store->mapping, store->length);
+error_close:
+	close (store->fd);
+error_free:
+	free (store);
+	return status;
+#endif
+}
+
+dc_status_t
+dc_fingerprint_store_get (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, unsigned char data[], unsigned int size, unsigned int *actual)
+{
+	fingerprint_slot_t *older = NULL;
+
+	if (store == NULL || actual == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	pthread_mutex_lock (&store->mutex);
+
+	*actual = 0;
+
+	const fingerprint_slot_t *slot = fingerprint_find (store, family, model, serial, &older);
+	if (slot && slot->size) {
+		if (slot->size > size) {
+			pthread_mutex_unlock (&store->mutex);
+			ERROR (store->context, "Insufficient buffer space available.");
+			return DC_STATUS_NOMEMORY;
+		}
+
+		memcpy (data, slot->data, slot->size);
+		*actual = slot->size;
+	}
+
+	pthread_mutex_unlock (&store->mutex);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_fingerprint_store_set (dc_fingerprint_store_t *store, dc_family_t family, unsigned int model, unsigned int serial, const unsigned char data[], unsigned int size)
+{
+#ifdef _WIN32
+	return DC_STATUS_UNSUPPORTED;
+#else
+	dc_status_t status = DC_STATUS_SUCCESS;
+	fingerprint_slot_t *older = NULL;
+
+	if (store == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	if (size > DC_FINGERPRINT_MAXSIZE) {
+		ERROR (store->context, "Fingerprint too large (%u).", size);
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	pthread_mutex_lock (&store->mutex);
+
+	const fingerprint_slot_t *newest = fingerprint_find (store, family, model, serial, &older);
+	unsigned int sequence = newest ? newest->sequence + 1 : 0;
+
+	if (newest && newest->size == size && memcmp (newest->data, data, size) == 0)
+		goto error_unlock;
+
+	// Overwrite the older slot of the device, or else a free slot.
+	fingerprint_slot_t *slot = older;
+	for (unsigned int i = 0; slot == NULL && i < store->nslots; ++i) {
+		if (!fingerprint_valid (store->slots + i))
+			slot = store->slots + i;
+	}
+
+	if (slot == NULL) {
+		unsigned int index = store->nslots;
+		status = fingerprint_grow (store, store->nslots ? store->nslots * 2 : NSLOTS);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_unlock;
+		slot = store->slots + index;
+	}
+
+	// Write the contents first, and the checksum last. A torn write
+	// leaves an invalid slot behind, and the previous fingerprint of
+	// the device remains the newest valid one.
+	slot->crc = ~fingerprint_crc (slot);
+	slot->sequence = sequence;
+	slot->family = family;
+	slot->model = model;
+	slot->serial = serial;
+	slot->size = size;
+	memset (slot->data, 0, sizeof (slot->data));
+	if (size)
+		memcpy (slot->data, data, size);
+	slot->crc = fingerprint_crc (slot);
+
+	fingerprint_sync (store, slot, sizeof (fingerprint_slot_t));
+
+error_unlock:
+	pthread_mutex_unlock (&store->mutex);
+	return status;
+#endif
+}
+
+dc_status_t
+dc_fingerprint_store_close (dc_fingerprint_store_t *store)
+{
+	if (store == NULL)
+		return DC_STATUS_SUCCESS;
+
+#ifndef _WIN32
+	munmap (store->mapping, store->length);
+	close (store->fd);
+#endif
+	pthread_mutex_destroy (&store->mutex);
+	free (store);
+
+	return DC_STATUS_SUCCESS;
+}
@@ -23,6 +23,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 
+#include <libdivecomputer/ble.h>
+
 #include "halcyon_symbios.h"
 #include "context-private.h"
 #include "device-private.h"
@@ -398,6 +400,13 @@ halcyon_symbios_device_open (dc_device_t **out, dc_context_t *context, dc_iostre
 		goto error_free;
 	}
 
+	// Request a fast BLE link.
+	status = dc_ble_setup_link (device->iostream, NULL);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to set up the BLE link.");
+		goto error_free;
+	}
+
 	// Make sure everything is in a sane state.
 	dc_iostream_purge (device->iostream, DC_DIRECTION_ALL);
 
@@ -639,7 +639,7 @@ hw_ostc_extract_dives (dc_device_t *abstract, const unsigned char data[], unsign
 
 
 static dc_status_t
-hw_ostc_firmware_readfile (hw_ostc_firmware_t *firmware, dc_context_t *context, const char *filename)
+hw_ostc_firmware_readfile (hw_ostc_firmware_t *firmware, dc_context_t *context, dc_ihex_file_t *file)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 
@@ -652,14 +652,6 @@ hw_ostc_firmware_readfile (hw_ostc_firmware_t *firmware, dc_context_t *context,
 	memset (firmware->data, 0xFF, sizeof (firmware->data));
 	memset (firmware->bitmap, 0x00, sizeof (firmware->bitmap));
 
-	// Open the hex file.
-	dc_ihex_file_t *file = NULL;
-	rc = dc_ihex_file_open (&file, context, filename);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR (context, "Failed to open the hex file.");
-		return rc;
-	}
-
 	// Read the hex file.
 	unsigned int lba = 0;
 	dc_ihex_entry_t entry;
@@ -689,19 +681,14 @@ hw_ostc_firmware_readfile (hw_ostc_firmware_t *firmware, dc_context_t *context,
 			lba = array_uint16_be (entry.data);
 		} else {
 			ERROR (context, "Unexpected record type.");
-			dc_ihex_file_close (file);
 			return DC_STATUS_DATAFORMAT;
 		}
 	}
 	if (rc != DC_STATUS_SUCCESS && rc != DC_STATUS_DONE) {
 		ERROR (context, "Failed to read the record.");
-		dc_ihex_file_close (file);
 		return rc;
 	}
 
-	// Close the file.
-	dc_ihex_file_close (file);
-
 	// Verify the presence of the first block.
 	if (firmware->bitmap[0] == 0) {
 		ERROR (context, "No first data block.");
@@ -837,16 +824,13 @@ hw_ostc_firmware_write (hw_ostc_device_t *device, unsigned char *data, unsigned
  * brick the device permanently and turn it into an expensive
  * paperweight. You have been warned!
  */
-dc_status_t
-hw_ostc_device_fwupdate (dc_device_t *abstract, const char *filename)
+static dc_status_t
+hw_ostc_device_fwupdate_ihex (dc_device_t *abstract, dc_ihex_file_t *file)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	hw_ostc_device_t *device = (hw_ostc_device_t *) abstract;
 	dc_context_t *context = (abstract ? abstract->context : NULL);
 
-	if (!ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	// Allocate memory for the firmware data.
 	hw_ostc_firmware_t *firmware = (hw_ostc_firmware_t *) malloc (sizeof (hw_ostc_firmware_t));
 	if (firmware == NULL) {
@@ -855,7 +839,7 @@ hw_ostc_device_fwupdate (dc_device_t *abstract, const char *filename)
 	}
 
 	// Read the hex file.
-	rc = hw_ostc_firmware_readfile (firmware, context, filename);
+	rc = hw_ostc_firmware_readfile (firmware, context, file);
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to read the firmware file.");
 		free (firmware);
@@ -942,3 +926,48 @@ hw_ostc_device_fwupdate (dc_device_t *abstract, const char *filename)
 
 	return DC_STATUS_SUCCESS;
 }
+
+dc_status_t
+hw_ostc_device_fwupdate (dc_device_t *abstract, const char *filename)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	// Open the hex file.
+	dc_ihex_file_t *file = NULL;
+	rc = dc_ihex_file_open (&file, abstract->context, filename);
+	if (rc != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to open the hex file.");
+		return rc;
+	}
+
+	rc = hw_ostc_device_fwupdate_ihex (abstract, file);
+
+	dc_ihex_file_close (file);
+
+	return rc;
+}
+
+dc_status_t
+hw_ostc_device_fwupdate_buffer (dc_device_t *abstract, const unsigned char data[], size_t size)
+{
+	dc_status_t rc = DC_STATUS_SUCCESS;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	// Parse the hex data in-place.
+	dc_ihex_file_t *file = NULL;
+	rc = dc_ihex_file_open_buffer (&file, abstract->context, data, size);
+	if (rc != DC_STATUS_SUCCESS) {
+		return rc;
+	}
+
+	rc = hw_ostc_device_fwupdate_ihex (abstract, file);
+
+	dc_ihex_file_close (file);
+
+	return rc;
+}
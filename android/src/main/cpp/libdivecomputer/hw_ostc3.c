@@ -22,13 +22,13 @@
 
 #include <string.h> // memcmp, memcpy
 #include <stdlib.h> // malloc, free
-#include <stdio.h>  // FILE, fopen
 
 #include "hw_ostc3.h"
 #include "context-private.h"
 #include "device-private.h"
 #include "array.h"
 #include "aes.h"
+#include "image.h"
 #include "platform.h"
 #include "packet.h"
 
@@ -597,16 +597,6 @@ hw_ostc3_device_init (hw_ostc3_device_t *device, hw_ostc3_state_t state)
 	if (device->hardware != INVALID)
 		return DC_STATUS_SUCCESS;
 
-	// Read the hardware descriptor.
-	unsigned char hardware[SZ_HARDWARE2] = {0, UNKNOWN};
-	rc = hw_ostc3_device_id (device, hardware, sizeof(hardware));
-	if (rc != DC_STATUS_SUCCESS && rc != DC_STATUS_UNSUPPORTED) {
-		ERROR (abstract->context, "Failed to read the hardware descriptor.");
-		return rc;
-	}
-
-	HEXDUMP (abstract->context, DC_LOGLEVEL_DEBUG, "Hardware", hardware, sizeof(hardware));
-
 	// Read the version information.
 	unsigned char version[SZ_VERSION] = {0};
 	rc = hw_ostc3_transfer (device, NULL, IDENTITY, NULL, 0, version, sizeof(version), NULL, NODELAY);
@@ -617,6 +607,29 @@ hw_ostc3_device_init (hw_ostc3_device_t *device, hw_ostc3_state_t state)
 
 	HEXDUMP (abstract->context, DC_LOGLEVEL_DEBUG, "Version", version, sizeof(version));
 
+	// The hardware descriptor of the previous session can be reused, as
+	// long as the serial number and the firmware version are unchanged.
+	unsigned char hardware[SZ_HARDWARE2] = {0, UNKNOWN};
+	unsigned char warmstart[4 + SZ_HARDWARE2] = {0};
+	unsigned int serial = array_uint16_le (version + 0);
+	if (device_warmstart_get (abstract, serial, warmstart, sizeof(warmstart)) &&
+		memcmp (warmstart, version, 4) == 0) {
+		memcpy (hardware, warmstart + 4, sizeof(hardware));
+	} else {
+		// Read the hardware descriptor.
+		rc = hw_ostc3_device_id (device, hardware, sizeof(hardware));
+		if (rc != DC_STATUS_SUCCESS && rc != DC_STATUS_UNSUPPORTED) {
+			ERROR (abstract->context, "Failed to read the hardware descriptor.");
+			return rc;
+		}
+
+		memcpy (warmstart, version, 4);
+		memcpy (warmstart + 4, hardware, sizeof(hardware));
+		device_warmstart_set (abstract, serial, warmstart, sizeof(warmstart));
+	}
+
+	HEXDUMP (abstract->context, DC_LOGLEVEL_DEBUG, "Hardware", hardware, sizeof(hardware));
+
 	// Cache the descriptor.
 	device->hardware = array_uint16_be(hardware + 0);
 	device->feature = array_uint16_be(hardware + 2);
@@ -1098,45 +1111,45 @@ hw_ostc3_firmware_checksum (const unsigned char data[], unsigned int size)
 }
 
 static dc_status_t
-hw_ostc3_firmware_readline (FILE *fp, dc_context_t *context, unsigned int addr, unsigned char data[], unsigned int size)
+hw_ostc3_firmware_readline (dc_image_t *image, size_t *offset, dc_context_t *context, unsigned int addr, unsigned char data[], unsigned int size)
 {
-	unsigned char ascii[39];
 	unsigned char faddr_byte[3];
 	unsigned int faddr = 0;
-	size_t n = 0;
 
 	if (size > 16) {
 		ERROR (context, "Invalid arguments.");
 		return DC_STATUS_INVALIDARGS;
 	}
 
-	// Read the start code.
+	// Skip to the start code.
 	while (1) {
-		n = fread (ascii, 1, 1, fp);
-		if (n != 1) {
+		if (*offset >= image->size) {
 			ERROR (context, "Failed to read the start code.");
 			return DC_STATUS_IO;
 		}
 
-		if (ascii[0] == ':')
+		unsigned char c = image->data[(*offset)++];
+		if (c == ':')
 			break;
 
 		// Ignore CR and LF characters.
-		if (ascii[0] != '\n' && ascii[0] != '\r') {
-			ERROR (context, "Unexpected character (0x%02x).", ascii[0]);
+		if (c != '\n' && c != '\r') {
+			ERROR (context, "Unexpected character (0x%02x).", c);
 			return DC_STATUS_DATAFORMAT;
 		}
 	}
 
-	// Read the payload.
-	n = fread (ascii + 1, 1, 6 + size * 2, fp);
-	if (n != 6 + size * 2) {
+	// Check the payload size.
+	if (image->size - *offset < 6 + size * 2) {
 		ERROR (context, "Failed to read the data.");
 		return DC_STATUS_IO;
 	}
 
+	const unsigned char *ascii = image->data + *offset;
+	*offset += 6 + size * 2;
+
 	// Convert the address to binary representation.
-	if (array_convert_hex2bin(ascii + 1, 6, faddr_byte, sizeof(faddr_byte)) != 0) {
+	if (array_convert_hex2bin(ascii, 6, faddr_byte, sizeof(faddr_byte)) != 0) {
 		ERROR (context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
@@ -1149,7 +1162,7 @@ hw_ostc3_firmware_readline (FILE *fp, dc_context_t *context, unsigned int addr,
 	}
 
 	// Convert the payload to binary representation.
-	if (array_convert_hex2bin (ascii + 1 + 6, size * 2, data, size) != 0) {
+	if (array_convert_hex2bin (ascii + 6, size * 2, data, size) != 0) {
 		ERROR (context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
@@ -1159,15 +1172,14 @@ hw_ostc3_firmware_readline (FILE *fp, dc_context_t *context, unsigned int addr,
 
 
 static dc_status_t
-hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *context, const char *filename)
+hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *context, dc_image_t *image)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
-	FILE *fp = NULL;
 	unsigned char iv[16] = {0};
-	unsigned char tmpbuf[16] = {0};
-	unsigned char encrypted[16] = {0};
 	unsigned int bytes = 0, addr = 0;
 	unsigned char checksum[4];
+	size_t offset = 0;
+	AES128_ctx_t aes;
 
 	if (firmware == NULL) {
 		ERROR (context, "Invalid arguments.");
@@ -1178,48 +1190,31 @@ hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *contex
 	memset (firmware->data, 0xFF, sizeof (firmware->data));
 	firmware->checksum = 0;
 
-	fp = fopen (filename, "rb");
-	if (fp == NULL) {
-		ERROR (context, "Failed to open the file.");
-		return DC_STATUS_IO;
-	}
-
-	rc = hw_ostc3_firmware_readline (fp, context, 0, iv, sizeof(iv));
+	rc = hw_ostc3_firmware_readline (image, &offset, context, 0, iv, sizeof(iv));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to parse header.");
-		fclose (fp);
 		return rc;
 	}
 	bytes += 16;
 
-	// Load the iv for AES-FCB-mode
-	AES128_ECB_encrypt (iv, ostc3_key, tmpbuf);
-
 	for (addr = 0; addr < SZ_FIRMWARE; addr += 16, bytes += 16) {
-		rc = hw_ostc3_firmware_readline (fp, context, bytes, encrypted, sizeof(encrypted));
+		rc = hw_ostc3_firmware_readline (image, &offset, context, bytes, firmware->data + addr, 16);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (context, "Failed to parse file data.");
-			fclose (fp);
 			return rc;
 		}
-
-		// Decrypt AES-FCB data
-		for (unsigned int i = 0; i < 16; i++)
-			firmware->data[addr + i] = encrypted[i] ^ tmpbuf[i];
-
-		// Run the next round of encryption
-		AES128_ECB_encrypt (encrypted, ostc3_key, tmpbuf);
 	}
 
 	// This file format contains a tail with the checksum in
-	rc = hw_ostc3_firmware_readline (fp, context, bytes, checksum, sizeof(checksum));
+	rc = hw_ostc3_firmware_readline (image, &offset, context, bytes, checksum, sizeof(checksum));
 	if (rc != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to parse file tail.");
-		fclose (fp);
 		return rc;
 	}
 
-	fclose (fp);
+	// Decrypt the AES-CFB data in-place, with the key expanded only once.
+	AES128_init_ctx (&aes, ostc3_key);
+	AES128_CFB_decrypt_buffer (&aes, firmware->data, firmware->data, sizeof(firmware->data), iv);
 
 	unsigned int csum1 = array_uint32_le (checksum);
 	unsigned int csum2 = hw_ostc3_firmware_checksum (firmware->data, sizeof(firmware->data));
@@ -1234,38 +1229,10 @@ hw_ostc3_firmware_readfile3 (hw_ostc3_firmware_t *firmware, dc_context_t *contex
 }
 
 static dc_status_t
-hw_ostc3_firmware_readfile4 (dc_buffer_t *buffer, dc_context_t *context, const char *filename)
+hw_ostc3_firmware_readfile4 (dc_context_t *context, dc_image_t *image, size_t *length)
 {
-	FILE *fp = NULL;
-
-	if (buffer == NULL) {
-		ERROR (context, "Invalid arguments.");
-		return DC_STATUS_INVALIDARGS;
-	}
-
-	// Open the file.
-	fp = fopen (filename, "rb");
-	if (fp == NULL) {
-		ERROR (context, "Failed to open the file.");
-		return DC_STATUS_IO;
-	}
-
-	// Read the entire file into the buffer.
-	size_t n = 0;
-	unsigned char block[1024] = {0};
-	while ((n = fread (block, 1, sizeof (block), fp)) > 0) {
-		if (!dc_buffer_append (buffer, block, n)) {
-			ERROR (context, "Insufficient buffer space available.");
-			fclose (fp);
-			return DC_STATUS_NOMEMORY;
-		}
-	}
-
-	// Close the file.
-	fclose (fp);
-
 	// Verify the minimum size.
-	size_t size = dc_buffer_get_size (buffer);
+	size_t size = image->size;
 	if (size < 4) {
 		ERROR (context, "Invalid file size.");
 		return DC_STATUS_DATAFORMAT;
@@ -1273,7 +1240,7 @@ hw_ostc3_firmware_readfile4 (dc_buffer_t *buffer, dc_context_t *context, const c
 	}
 
 	// Verify the checksum.
-	const unsigned char *data = dc_buffer_get_data (buffer);
+	const unsigned char *data = image->data;
 	unsigned int csum1 = array_uint32_le (data + size - 4);
 	unsigned int csum2 = hw_ostc3_firmware_checksum (data, size - 4);
 	if (csum1 != csum2) {
@@ -1281,8 +1248,8 @@ hw_ostc3_firmware_readfile4 (dc_buffer_t *buffer, dc_context_t *context, const c
 		return DC_STATUS_DATAFORMAT;
 	}
 
-	// Remove the checksum.
-	dc_buffer_slice (buffer, 0, size - 4);
+	// Exclude the checksum.
+	*length = size - 4;
 
 	return DC_STATUS_SUCCESS;
 }
@@ -1400,15 +1367,44 @@ hw_ostc3_firmware_upgrade (dc_device_t *abstract, unsigned int checksum)
 }
 
 
+/*
+ * Update the progress event, and the status message on the display of the
+ * device. The display is only updated when the percentage crosses the next
+ * 10% step, because every update is a full command round-trip.
+ */
+static void
+hw_ostc3_firmware_progress (hw_ostc3_device_t *device, dc_event_progress_t *progress, const char *action, unsigned int *shown, unsigned int current, unsigned int total)
+{
+	dc_device_t *abstract = (dc_device_t *) device;
+
+	device_event_emit (abstract, DC_EVENT_PROGRESS, progress);
+
+	if (action == NULL || total == 0)
+		return;
+
+	unsigned int percent = (100 * current) / total;
+	if (*shown != INVALID && percent / 10 == *shown / 10)
+		return;
+
+	char status[SZ_DISPLAY + 1]; // Status message on the display
+	dc_platform_snprintf (status, sizeof(status), " %s %2d%%", action, percent);
+	hw_ostc3_device_display (abstract, status);
+
+	*shown = percent;
+}
+
 static dc_status_t
-hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
+hw_ostc3_device_fwupdate3 (dc_device_t *abstract, dc_image_t *image)
 {
 	dc_status_t rc = DC_STATUS_SUCCESS;
 	hw_ostc3_device_t *device = (hw_ostc3_device_t *) abstract;
 	dc_context_t *context = (abstract ? abstract->context : NULL);
+	const unsigned int nblocks = SZ_FIRMWARE / SZ_FIRMWARE_BLOCK;
+	unsigned char block[SZ_FIRMWARE_BLOCK];
+	unsigned int shown = INVALID;
 
 	// Enable progress notifications.
-	// load, erase, upload FZ, verify FZ, reprogram
+	// load, resume check + erase, upload FZ, verify FZ, reprogram
 	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
 	progress.maximum = 3 + SZ_FIRMWARE * 2 / SZ_FIRMWARE_BLOCK;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
@@ -1421,7 +1417,7 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 	}
 
 	// Read the hex file.
-	rc = hw_ostc3_firmware_readfile3 (firmware, context, filename);
+	rc = hw_ostc3_firmware_readfile3 (firmware, context, image);
 	if (rc != DC_STATUS_SUCCESS) {
 		free (firmware);
 		return rc;
@@ -1431,26 +1427,47 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 	progress.current++;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	hw_ostc3_device_display (abstract, " Erasing FW...");
+	// Find the first block that still needs to be written. The blocks are
+	// always written in ascending order, after erasing the remainder of the
+	// area. Thus if the first block already matches the new firmware, the
+	// previous update was interrupted (or the same firmware is uploaded
+	// again), and all blocks up to the first mismatch are known to be good.
+	// Those blocks are verified here, and don't need to be written again.
+	// If the first block doesn't match, this costs only a single read.
+	unsigned int first = 0;
+	while (first < nblocks) {
+		rc = hw_ostc3_firmware_block_read (device, FIRMWARE_AREA + first * SZ_FIRMWARE_BLOCK, block, sizeof (block));
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR (context, "Failed to read block.");
+			free (firmware);
+			return rc;
+		}
+		if (memcmp (firmware->data + first * SZ_FIRMWARE_BLOCK, block, sizeof (block)) != 0)
+			break;
+		first++;
+	}
 
-	rc = hw_ostc3_firmware_erase (device, FIRMWARE_AREA, SZ_FIRMWARE);
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR (context, "Failed to erase old firmware");
-		free (firmware);
-		return rc;
+	if (first) {
+		INFO (context, "Resuming the firmware upload at block %u of %u.", first, nblocks);
 	}
 
-	// Memory erased
-	progress.current++;
-	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+	if (first < nblocks) {
+		hw_ostc3_device_display (abstract, " Erasing FW...");
 
-	hw_ostc3_device_display (abstract, " Uploading...");
+		rc = hw_ostc3_firmware_erase (device, FIRMWARE_AREA + first * SZ_FIRMWARE_BLOCK, SZ_FIRMWARE - first * SZ_FIRMWARE_BLOCK);
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR (context, "Failed to erase old firmware");
+			free (firmware);
+			return rc;
+		}
+	}
 
-	for (unsigned int len = 0; len < SZ_FIRMWARE; len += SZ_FIRMWARE_BLOCK) {
-		char status[SZ_DISPLAY + 1]; // Status message on the display
-		dc_platform_snprintf (status, sizeof(status), " Uploading %2d%%", (100 * len) / SZ_FIRMWARE);
-		hw_ostc3_device_display (abstract, status);
+	// Memory erased, and the blocks already present are uploaded and verified.
+	progress.current += 1 + 2 * first;
+	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
+	for (unsigned int i = first; i < nblocks; ++i) {
+		unsigned int len = i * SZ_FIRMWARE_BLOCK;
 		rc = hw_ostc3_firmware_block_write (device, FIRMWARE_AREA + len, firmware->data + len, SZ_FIRMWARE_BLOCK);
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (context, "Failed to write block to device");
@@ -1459,17 +1476,12 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 		}
 		// One block uploaded
 		progress.current++;
-		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		hw_ostc3_firmware_progress (device, &progress, "Uploading", &shown, i + 1, nblocks);
 	}
 
-	hw_ostc3_device_display (abstract, " Verifying...");
-
-	for (unsigned int len = 0; len < SZ_FIRMWARE; len += SZ_FIRMWARE_BLOCK) {
-		unsigned char block[SZ_FIRMWARE_BLOCK];
-		char status[SZ_DISPLAY + 1]; // Status message on the display
-		dc_platform_snprintf (status, sizeof(status), " Verifying %2d%%", (100 * len) / SZ_FIRMWARE);
-		hw_ostc3_device_display (abstract, status);
-
+	shown = INVALID;
+	for (unsigned int i = first; i < nblocks; ++i) {
+		unsigned int len = i * SZ_FIRMWARE_BLOCK;
 		rc = hw_ostc3_firmware_block_read (device, FIRMWARE_AREA + len, block, sizeof (block));
 		if (rc != DC_STATUS_SUCCESS) {
 			ERROR (context, "Failed to read block.");
@@ -1484,7 +1496,7 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 		}
 		// One block verified
 		progress.current++;
-		device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
+		hw_ostc3_firmware_progress (device, &progress, "Verifying", &shown, i + 1, nblocks);
 	}
 
 	hw_ostc3_device_display (abstract, " Programming...");
@@ -1507,42 +1519,35 @@ hw_ostc3_device_fwupdate3 (dc_device_t *abstract, const char *filename)
 }
 
 static dc_status_t
-hw_ostc3_device_fwupdate4 (dc_device_t *abstract, const char *filename)
+hw_ostc3_device_fwupdate4 (dc_device_t *abstract, dc_image_t *image)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	hw_ostc3_device_t *device = (hw_ostc3_device_t *) abstract;
 	dc_context_t *context = (abstract ? abstract->context : NULL);
 
-	// Allocate memory for the firmware data.
-	dc_buffer_t *buffer = dc_buffer_new (0);
-	if (buffer == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		status = DC_STATUS_NOMEMORY;
-		goto error;
-	}
-
-	// Read the firmware file.
-	status = hw_ostc3_firmware_readfile4 (buffer, context, filename);
+	// Verify the firmware file.
+	size_t nbytes = 0;
+	status = hw_ostc3_firmware_readfile4 (context, image, &nbytes);
 	if (status != DC_STATUS_SUCCESS) {
-		goto error;
+		return status;
 	}
 
 	// Enable progress notifications.
 	dc_event_progress_t progress = EVENT_PROGRESS_INITIALIZER;
-	progress.maximum = dc_buffer_get_size (buffer);
+	progress.maximum = nbytes;
 	device_event_emit (abstract, DC_EVENT_PROGRESS, &progress);
 
-	// Cache the pointer and size.
-	const unsigned char *data = dc_buffer_get_data (buffer);
-	unsigned int size = dc_buffer_get_size (buffer);
+	// Cache the pointer and size. The blobs are uploaded directly from
+	// the (mapped) image, without an intermediate copy.
+	const unsigned char *data = image->data;
+	unsigned int size = nbytes;
 
 	unsigned int offset = 0;
 	while (offset + 4 <= size) {
 		// Get the length of the firmware blob.
 		unsigned int length = array_uint32_be(data + offset) + 20;
 		if (offset + length > size) {
-			status = DC_STATUS_DATAFORMAT;
-			goto error;
+			return DC_STATUS_DATAFORMAT;
 		}
 
 		// Get the blob type.
@@ -1572,7 +1577,7 @@ hw_ostc3_device_fwupdate4 (dc_device_t *abstract, const char *filename)
 			data + offset + 4, 1, fwinfo, sizeof(fwinfo), NULL, NODELAY);
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to read the firmware info.");
-			goto error;
+			return status;
 		}
 
 		// Upload the firmware blob.
@@ -1584,7 +1589,7 @@ hw_ostc3_device_fwupdate4 (dc_device_t *abstract, const char *filename)
 			status = hw_ostc3_transfer (device, &progress, S_UPLOAD,
 				data + offset, length, NULL, 0, NULL, usecs / 1000);
 			if (status != DC_STATUS_SUCCESS) {
-				goto error;
+				return status;
 			}
 		} else {
 			// Update and emit a progress event.
@@ -1595,20 +1600,15 @@ hw_ostc3_device_fwupdate4 (dc_device_t *abstract, const char *filename)
 		offset += length;
 	}
 
-error:
-	dc_buffer_free (buffer);
 	return status;
 }
 
-dc_status_t
-hw_ostc3_device_fwupdate (dc_device_t *abstract, const char *filename)
+static dc_status_t
+hw_ostc3_device_fwupdate_image (dc_device_t *abstract, dc_image_t *image)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	hw_ostc3_device_t *device = (hw_ostc3_device_t *) abstract;
 
-	if (!ISINSTANCE (abstract))
-		return DC_STATUS_INVALIDARGS;
-
 	// Make sure the device is in service mode.
 	status = hw_ostc3_device_init (device, SERVICE);
 	if (status != DC_STATUS_SUCCESS) {
@@ -1616,12 +1616,50 @@ hw_ostc3_device_fwupdate (dc_device_t *abstract, const char *filename)
 	}
 
 	if (device->hardware == OSTC4) {
-		return hw_ostc3_device_fwupdate4 (abstract, filename);
+		return hw_ostc3_device_fwupdate4 (abstract, image);
 	} else {
-		return hw_ostc3_device_fwupdate3 (abstract, filename);
+		return hw_ostc3_device_fwupdate3 (abstract, image);
 	}
 }
 
+dc_status_t
+hw_ostc3_device_fwupdate (dc_device_t *abstract, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_image_t image;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_image_open (&image, abstract->context, filename);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to open the file.");
+		return status;
+	}
+
+	status = hw_ostc3_device_fwupdate_image (abstract, &image);
+
+	dc_image_close (&image);
+
+	return status;
+}
+
+dc_status_t
+hw_ostc3_device_fwupdate_buffer (dc_device_t *abstract, const unsigned char data[], size_t size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_image_t image;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_image_open_buffer (&image, abstract->context, data, size);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return hw_ostc3_device_fwupdate_image (abstract, &image);
+}
+
 static dc_status_t
 hw_ostc3_device_read (dc_device_t *abstract, unsigned int address, unsigned char data[], unsigned int size)
 {
@@ -0,0 +1,161 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <errno.h>
+
+#ifdef _WIN32
+#define NOGDI
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#endif
+
+#include "image.h"
+#include "context-private.h"
+
+dc_status_t
+dc_image_open (dc_image_t *image, dc_context_t *context, const char *filename)
+{
+	if (image == NULL || filename == NULL) {
+		ERROR (context, "Invalid arguments.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	image->data = NULL;
+	image->size = 0;
+	image->mapping = NULL;
+	image->length = 0;
+
+#ifdef _WIN32
+	// Read the entire file into memory.
+	FILE *fp = fopen (filename, "rb");
+	if (fp == NULL) {
+		ERROR (context, "Failed to open the file.");
+		return DC_STATUS_IO;
+	}
+
+	unsigned char *buffer = NULL;
+	size_t size = 0, n = 0;
+	unsigned char block[4096];
+	while ((n = fread (block, 1, sizeof (block), fp)) > 0) {
+		unsigned char *tmp = (unsigned char *) realloc (buffer, size + n);
+		if (tmp == NULL) {
+			ERROR (context, "Failed to allocate memory.");
+			free (buffer);
+			fclose (fp);
+			return DC_STATUS_NOMEMORY;
+		}
+		buffer = tmp;
+		memcpy (buffer + size, block, n);
+		size += n;
+	}
+
+	fclose (fp);
+
+	image->mapping = buffer;
+	image->length = size;
+	image->data = buffer;
+	image->size = size;
+#else
+	int fd = open (filename, O_RDONLY);
+	if (fd < 0) {
+		SYSERROR (context, errno);
+		ERROR (context, "Failed to open the file.");
+		return DC_STATUS_IO;
+	}
+
+	struct stat st;
+	if (fstat (fd, &st) != 0) {
+		SYSERROR (context, errno);
+		close (fd);
+		return DC_STATUS_IO;
+	}
+
+	// An empty file can't be mapped, but is still a valid (empty) image.
+	if (st.st_size > 0) {
+		void *mapping = mmap (NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED) {
+			SYSERROR (context, errno);
+			ERROR (context, "Failed to map the file.");
+			close (fd);
+			return DC_STATUS_IO;
+		}
+
+		// The file is parsed from start to end exactly once.
+		madvise (mapping, st.st_size, MADV_SEQUENTIAL);
+
+		image->mapping = mapping;
+		image->length = st.st_size;
+		image->data = (const unsigned char *) mapping;
+		image->size = st.st_size;
+	}
+
+	// The mapping remains valid after closing the descriptor.
+	close (fd);
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_image_open_buffer (dc_image_t *image, dc_context_t *context, const unsigned char data[], size_t size)
+{
+	if (image == NULL || (data == NULL && size)) {
+		ERROR (context, "Invalid arguments.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	image->data = data;
+	image->size = size;
+	image->mapping = NULL;
+	image->length = 0;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_image_close (dc_image_t *image)
+{
+	if (image == NULL)
+		return DC_STATUS_SUCCESS;
+
+	if (image->mapping) {
+#ifdef _WIN32
+		free (image->mapping);
+#else
+		munmap (image->mapping, image->length);
+#endif
+	}
+
+	image->data = NULL;
+	image->size = 0;
+	image->mapping = NULL;
+	image->length = 0;
+
+	return DC_STATUS_SUCCESS;
+}
@@ -0,0 +1,71 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_IMAGE_H
+#define DC_IMAGE_H
+
+#include <stddef.h>
+
+#include <libdivecomputer/common.h>
+#include <libdivecomputer/context.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * A read-only firmware image in memory.
+ *
+ * The image is either a memory mapping of a file, or a caller owned buffer
+ * (for example a download passed in from the application), in which case
+ * the data is used in-place without copying.
+ */
+typedef struct dc_image_t {
+	const unsigned char *data;
+	size_t size;
+	/* Private */
+	void *mapping;
+	size_t length;
+} dc_image_t;
+
+/**
+ * Map the contents of a file into memory.
+ */
+dc_status_t
+dc_image_open (dc_image_t *image, dc_context_t *context, const char *filename);
+
+/**
+ * Wrap a caller owned buffer. The buffer must remain valid until the image
+ * is closed.
+ */
+dc_status_t
+dc_image_open_buffer (dc_image_t *image, dc_context_t *context, const unsigned char data[], size_t size);
+
+/**
+ * Release the memory mapping, if any.
+ */
+dc_status_t
+dc_image_close (dc_image_t *image);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_IMAGE_H */
@@ -64,6 +64,10 @@ struct oceanic_atom2_parser_t {
 	unsigned int helium[NGASMIXES];
 	unsigned int divetime;
 	double maxdepth;
+	double avgdepth;
+	unsigned int ntemperatures;
+	double mintemperature;
+	double maxtemperature;
 };
 
 static dc_status_t oceanic_atom2_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
@@ -165,6 +169,10 @@ oceanic_atom2_parser_create (dc_parser_t **out, dc_context_t *context, const uns
 	}
 	parser->divetime = 0;
 	parser->maxdepth = 0.0;
+	parser->avgdepth = 0.0;
+	parser->ntemperatures = 0;
+	parser->mintemperature = 0.0;
+	parser->maxtemperature = 0.0;
 
 	*out = (dc_parser_t*) parser;
 
@@ -182,6 +190,13 @@ oceanic_atom2_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetim
 		parser->model == F11A || parser->model == F11B ||
 		parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
 		header = 32;
+	else if (parser->model == TX1)
+		header = 16;
+	else if (parser->model == A300CS || parser->model == VTX ||
+		parser->model == I450T || parser->model == I750TC ||
+		parser->model == PROPLUSX || parser->model == I770R ||
+		parser->model == SAGE || parser->model == BEACON)
+		header = 11;
 
 	if (abstract->size < header)
 		return DC_STATUS_DATAFORMAT;
@@ -509,17 +524,21 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (status != DC_STATUS_SUCCESS)
 		return status;
 
-	// Cache the profile data.
-	if (parser->cached < PROFILE) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		status = oceanic_atom2_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+	// Cache the profile data, but only for the fields which are not
+	// available in the logbook entry. The statistics are collected as a
+	// side effect of decoding the profile.
+	unsigned int header_avgdepth = parser->model == I330R ||
+		parser->model == I330R_C || parser->model == DSX;
+	unsigned int header_divetime = parser->model == F10A || parser->model == F10B ||
+		parser->model == F11A || parser->model == F11B ||
+		parser->model == MUNDIAL2 || parser->model == MUNDIAL3;
+	if (parser->cached < PROFILE &&
+		((type == DC_FIELD_DIVETIME && !header_divetime) ||
+		(type == DC_FIELD_AVGDEPTH && !header_avgdepth) ||
+		type == DC_FIELD_TEMPERATURE_MINIMUM || type == DC_FIELD_TEMPERATURE_MAXIMUM)) {
+		status = oceanic_atom2_parser_samples_foreach (abstract, NULL, NULL);
 		if (status != DC_STATUS_SUCCESS)
 			return status;
-
-		parser->cached = PROFILE;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	dc_gasmix_t *gasmix = (dc_gasmix_t *) value;
@@ -528,9 +547,7 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (value) {
 		switch (type) {
 		case DC_FIELD_DIVETIME:
-			if (parser->model == F10A || parser->model == F10B ||
-				parser->model == F11A || parser->model == F11B ||
-				parser->model == MUNDIAL2 || parser->model == MUNDIAL3)
+			if (header_divetime)
 				*((unsigned int *) value) = bcd2dec (data[2]) + bcd2dec (data[3]) * 60;
 			else
 				*((unsigned int *) value) = parser->divetime;
@@ -546,11 +563,20 @@ oceanic_atom2_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 				*((double *) value) = (array_uint16_le (data + parser->footer + 4) & 0x0FFF) / 16.0 * FEET;
 			break;
 		case DC_FIELD_AVGDEPTH:
-			if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX) {
+			if (header_avgdepth)
 				*((double *) value) = array_uint16_le (data + parser->footer + 12) / 10.0 * FEET;
-			} else {
+			else
+				*((double *) value) = parser->avgdepth;
+			break;
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+			if (parser->ntemperatures == 0)
 				return DC_STATUS_UNSUPPORTED;
-			}
+			*((double *) value) = parser->mintemperature;
+			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			if (parser->ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->maxtemperature;
 			break;
 		case DC_FIELD_GASMIX_COUNT:
 			*((unsigned int *) value) = parser->ngasmixes;
@@ -673,12 +699,26 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 	if (status != DC_STATUS_SUCCESS)
 		return status;
 
+	// Collect the statistics during the first pass over the profile.
+	unsigned int collect = parser->cached < PROFILE;
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
+	if (collect) {
+		statistics.callback = callback;
+		statistics.userdata = userdata;
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	unsigned int extratime = 0;
 	unsigned int time = 0;
 	unsigned int interval = 1000;
 	if (!is_freedive (parser->mode, parser->model)) {
 		if (parser->model == I330R || parser->model == I330R_C || parser->model == DSX) {
 			interval = data[parser->logbooksize + 36] * 1000;
+			if (interval == 0) {
+				ERROR (abstract->context, "Invalid sample interval.");
+				return DC_STATUS_DATAFORMAT;
+			}
 		} else {
 			unsigned int offset = 0x17;
 			if (parser->model == A300CS || parser->model == VTX ||
@@ -1133,5 +1173,15 @@ oceanic_atom2_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		offset += length;
 	}
 
+	if (collect) {
+		parser->cached = PROFILE;
+		parser->divetime = statistics.divetime;
+		parser->maxdepth = statistics.maxdepth;
+		parser->avgdepth = statistics.avgdepth;
+		parser->ntemperatures = statistics.ntemperatures;
+		parser->mintemperature = statistics.mintemperature;
+		parser->maxtemperature = statistics.maxtemperature;
+	}
+
 	return DC_STATUS_SUCCESS;
 }
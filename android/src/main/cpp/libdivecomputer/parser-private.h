@@ -43,6 +43,7 @@ struct dc_parser_t {
 	dc_context_t *context;
 	unsigned char *data;
 	unsigned int size;
+	unsigned int downsample;
 };
 
 struct dc_parser_vtable_t {
@@ -77,9 +78,21 @@ dc_parser_isinstance (dc_parser_t *parser, const dc_parser_vtable_t *vtable);
 typedef struct sample_statistics_t {
 	unsigned int divetime;
 	double maxdepth;
+	double avgdepth;
+	double mintemperature;
+	double maxtemperature;
+	unsigned int ntemperatures;
+	// Accumulator state.
+	unsigned int time;
+	unsigned int lasttime;
+	double lastdepth;
+	double area;
+	// Optional callback to forward the samples to.
+	dc_sample_callback_t callback;
+	void *userdata;
 } sample_statistics_t;
 
-#define SAMPLE_STATISTICS_INITIALIZER {0, 0.0}
+#define SAMPLE_STATISTICS_INITIALIZER {0, 0.0, 0.0, 0.0, 0.0, 0, 0, 0, 0.0, 0.0, NULL, NULL}
 
 void
 sample_statistics_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata);
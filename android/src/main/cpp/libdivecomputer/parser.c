@@ -22,6 +22,10 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
 
 #include "suunto_d9.h"
 #include "suunto_eon.h"
@@ -271,6 +275,7 @@ dc_parser_allocate (dc_context_t *context, const dc_parser_vtable_t *vtable, con
 	// Initialize the base class.
 	parser->vtable = vtable;
 	parser->context = context;
+	parser->downsample = 0;
 
 	if (size) {
 		// Allocate memory for the data.
@@ -361,6 +366,30 @@ dc_parser_set_density (dc_parser_t *parser, double density)
 }
 
 
+dc_status_t
+dc_parser_set_downsample (dc_parser_t *parser, unsigned int npoints)
+{
+	if (parser == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (npoints != 0 && npoints < 3)
+		return DC_STATUS_INVALIDARGS;
+
+	parser->downsample = npoints;
+
+	return DC_STATUS_SUCCESS;
+}
+
+unsigned int
+dc_parser_get_downsample (dc_parser_t *parser)
+{
+	if (parser == NULL)
+		return 0;
+
+	return parser->downsample;
+}
+
+
 dc_status_t
 dc_parser_get_datetime (dc_parser_t *parser, dc_datetime_t *datetime)
 {
@@ -399,6 +428,758 @@ dc_parser_samples_foreach (dc_parser_t *parser, dc_sample_callback_t callback, v
 }
 
 
+typedef struct dc_sample_record_state_t {
+	dc_sample_record_t record;
+	dc_sample_record_callback_t callback;
+	void *userdata;
+} dc_sample_record_state_t;
+
+static void
+dc_parser_record_flush (dc_sample_record_state_t *state)
+{
+	dc_sample_record_t *record = &state->record;
+
+	if (record->fields == 0)
+		return;
+
+	state->callback (record, state->userdata);
+
+	// Only the bitmask and the counters need to be reset. The other
+	// values are ignored as long as their bit is not set.
+	record->fields = 0;
+	record->npressure = 0;
+	record->nevents = 0;
+	record->nppo2 = 0;
+}
+
+static void
+dc_parser_record_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	dc_sample_record_state_t *state = (dc_sample_record_state_t *) userdata;
+	dc_sample_record_t *record = &state->record;
+
+	switch (type) {
+	case DC_SAMPLE_TIME:
+		dc_parser_record_flush (state);
+		record->time = value->time;
+		break;
+	case DC_SAMPLE_DEPTH:
+		record->depth = value->depth;
+		break;
+	case DC_SAMPLE_PRESSURE:
+		if (record->npressure >= DC_SAMPLE_RECORD_MAXTANKS)
+			return;
+		record->pressure[record->npressure].tank = value->pressure.tank;
+		record->pressure[record->npressure].value = value->pressure.value;
+		record->npressure++;
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		record->temperature = value->temperature;
+		break;
+	case DC_SAMPLE_EVENT:
+		if (record->nevents >= DC_SAMPLE_RECORD_MAXEVENTS)
+			return;
+		record->event[record->nevents].type = value->event.type;
+		record->event[record->nevents].time = value->event.time;
+		record->event[record->nevents].flags = value->event.flags;
+		record->event[record->nevents].value = value->event.value;
+		record->nevents++;
+		break;
+	case DC_SAMPLE_RBT:
+		record->rbt = value->rbt;
+		break;
+	case DC_SAMPLE_HEARTBEAT:
+		record->heartbeat = value->heartbeat;
+		break;
+	case DC_SAMPLE_BEARING:
+		record->bearing = value->bearing;
+		break;
+	case DC_SAMPLE_SETPOINT:
+		record->setpoint = value->setpoint;
+		break;
+	case DC_SAMPLE_PPO2:
+		if (record->nppo2 >= DC_SAMPLE_RECORD_MAXSENSORS)
+			return;
+		record->ppo2[record->nppo2].sensor = value->ppo2.sensor;
+		record->ppo2[record->nppo2].value = value->ppo2.value;
+		record->nppo2++;
+		break;
+	case DC_SAMPLE_CNS:
+		record->cns = value->cns;
+		break;
+	case DC_SAMPLE_DECO:
+		record->deco.type = value->deco.type;
+		record->deco.time = value->deco.time;
+		record->deco.depth = value->deco.depth;
+		record->deco.tts = value->deco.tts;
+		break;
+	case DC_SAMPLE_GASMIX:
+		record->gasmix = value->gasmix;
+		break;
+	default:
+		return;
+	}
+
+	record->fields |= DC_SAMPLE_MASK (type);
+}
+
+
+dc_status_t
+dc_parser_samples_foreach_records (dc_parser_t *parser, dc_sample_record_callback_t callback, void *userdata)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_sample_record_state_t state;
+
+	if (callback == NULL)
+		return dc_parser_samples_foreach (parser, NULL, NULL);
+
+	memset (&state, 0, sizeof (state));
+	state.callback = callback;
+	state.userdata = userdata;
+
+	status = dc_parser_samples_foreach (parser, dc_parser_record_cb, &state);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	// Emit the last record.
+	dc_parser_record_flush (&state);
+
+	return DC_STATUS_SUCCESS;
+}
+
+
+#define DIVE_ALIGN(x) (((x) + 7) & ~(size_t) 7)
+
+typedef struct dc_dive_state_t {
+	dc_buffer_t *samples;
+	dc_buffer_t *pressures;
+	dc_buffer_t *events;
+	dc_buffer_t *ppo2;
+	int nomemory;
+} dc_dive_state_t;
+
+static void
+dc_parser_dive_cb (const dc_sample_record_t *record, void *userdata)
+{
+	dc_dive_state_t *state = (dc_dive_state_t *) userdata;
+	dc_dive_sample_t sample;
+
+	memset (&sample, 0, sizeof (sample));
+	sample.fields = record->fields;
+	sample.time = record->time;
+	sample.depth = record->depth;
+	sample.temperature = record->temperature;
+	sample.rbt = record->rbt;
+	sample.heartbeat = record->heartbeat;
+	sample.bearing = record->bearing;
+	sample.setpoint = record->setpoint;
+	sample.cns = record->cns;
+	sample.deco.type = record->deco.type;
+	sample.deco.time = record->deco.time;
+	sample.deco.depth = record->deco.depth;
+	sample.deco.tts = record->deco.tts;
+	sample.gasmix = record->gasmix;
+
+	sample.pressure = dc_buffer_get_size (state->pressures) / sizeof (dc_dive_pressure_t);
+	sample.npressure = record->npressure;
+	for (unsigned int i = 0; i < record->npressure; ++i) {
+		dc_dive_pressure_t pressure = {record->pressure[i].tank, record->pressure[i].value};
+		if (!dc_buffer_append (state->pressures, (const unsigned char *) &pressure, sizeof (pressure)))
+			state->nomemory = 1;
+	}
+
+	sample.event = dc_buffer_get_size (state->events) / sizeof (dc_dive_event_t);
+	sample.nevents = record->nevents;
+	for (unsigned int i = 0; i < record->nevents; ++i) {
+		dc_dive_event_t event = {
+			record->event[i].type, record->event[i].time,
+			record->event[i].flags, record->event[i].value};
+		if (!dc_buffer_append (state->events, (const unsigned char *) &event, sizeof (event)))
+			state->nomemory = 1;
+	}
+
+	sample.ppo2 = dc_buffer_get_size (state->ppo2) / sizeof (dc_dive_ppo2_t);
+	sample.nppo2 = record->nppo2;
+	for (unsigned int i = 0; i < record->nppo2; ++i) {
+		dc_dive_ppo2_t ppo2 = {record->ppo2[i].sensor, record->ppo2[i].value};
+		if (!dc_buffer_append (state->ppo2, (const unsigned char *) &ppo2, sizeof (ppo2)))
+			state->nomemory = 1;
+	}
+
+	if (!dc_buffer_append (state->samples, (const unsigned char *) &sample, sizeof (sample)))
+		state->nomemory = 1;
+}
+
+static void *
+dc_dive_table (unsigned char **p, dc_buffer_t *buffer)
+{
+	size_t size = dc_buffer_get_size (buffer);
+	void *table = *p;
+
+	if (size)
+		memcpy (*p, dc_buffer_get_data (buffer), size);
+	*p += DIVE_ALIGN (size);
+
+	return table;
+}
+
+/*
+ * Largest-Triangle-Three-Buckets downsampling. The series is split into
+ * npoints - 2 buckets, and from every bucket the point that forms the
+ * largest triangle with the previously selected point and the average of
+ * the next bucket is selected. The first and last point are always kept.
+ */
+static void
+dc_dive_lttb (const unsigned int x[], const double y[], const unsigned int index[], unsigned int n, unsigned int npoints, unsigned char keep[])
+{
+	if (n == 0)
+		return;
+
+	if (n <= npoints) {
+		for (unsigned int i = 0; i < n; ++i)
+			keep[index[i]] |= 1;
+		return;
+	}
+
+	double every = (double) (n - 2) / (npoints - 2);
+	unsigned int a = 0;
+
+	keep[index[0]] |= 1;
+
+	for (unsigned int i = 0; i < npoints - 2; ++i) {
+		// Average of the next bucket.
+		unsigned int start = (unsigned int) ((i + 1) * every) + 1;
+		unsigned int end = (unsigned int) ((i + 2) * every) + 1;
+		if (end > n)
+			end = n;
+		if (start >= end)
+			start = end - 1;
+
+		double avgx = 0.0, avgy = 0.0;
+		for (unsigned int j = start; j < end; ++j) {
+			avgx += x[j];
+			avgy += y[j];
+		}
+		avgx /= end - start;
+		avgy /= end - start;
+
+		// Point with the largest triangle in the current bucket.
+		unsigned int first = (unsigned int) (i * every) + 1;
+		unsigned int last = (unsigned int) ((i + 1) * every) + 1;
+		if (last > n - 1)
+			last = n - 1;
+
+		double ax = x[a], ay = y[a];
+		double maxarea = -1.0;
+		unsigned int selected = first;
+		for (unsigned int j = first; j < last; ++j) {
+			double area = (ax - avgx) * (y[j] - ay) - (ax - x[j]) * (avgy - ay);
+			if (area < 0.0)
+				area = -area;
+			if (area > maxarea) {
+				maxarea = area;
+				selected = j;
+			}
+		}
+
+		keep[index[selected]] |= 1;
+		a = selected;
+	}
+
+	keep[index[n - 1]] |= 1;
+}
+
+#define DOWNSAMPLE_FIELDS ( \
+	DC_SAMPLE_MASK (DC_SAMPLE_DEPTH) | \
+	DC_SAMPLE_MASK (DC_SAMPLE_TEMPERATURE) | \
+	DC_SAMPLE_MASK (DC_SAMPLE_PRESSURE) | \
+	DC_SAMPLE_MASK (DC_SAMPLE_HEARTBEAT) | \
+	DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT) | \
+	DC_SAMPLE_MASK (DC_SAMPLE_PPO2) | \
+	DC_SAMPLE_MASK (DC_SAMPLE_CNS))
+
+static double
+dc_dive_sample_value (const dc_dive_sample_t *sample, dc_sample_type_t type)
+{
+	switch (type) {
+	case DC_SAMPLE_DEPTH:
+		return sample->depth;
+	case DC_SAMPLE_TEMPERATURE:
+		return sample->temperature;
+	case DC_SAMPLE_HEARTBEAT:
+		return sample->heartbeat;
+	case DC_SAMPLE_SETPOINT:
+		return sample->setpoint;
+	case DC_SAMPLE_CNS:
+		return sample->cns;
+	default:
+		return 0.0;
+	}
+}
+
+/*
+ * Reduce every series of the profile to at most npoints values. The
+ * depth, temperature, heartbeat, setpoint and CNS series, and the
+ * pressure of every tank and the ppO2 of every sensor, are downsampled
+ * independently. A value that is not selected is removed from the
+ * sample by clearing its bit. Samples with events or a gas switch are
+ * always kept. Samples without any remaining value are dropped.
+ */
+static dc_status_t
+dc_dive_downsample (dc_dive_state_t *state, unsigned int npoints)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_dive_sample_t *samples = (dc_dive_sample_t *) dc_buffer_get_data (state->samples);
+	dc_dive_pressure_t *pressures = (dc_dive_pressure_t *) dc_buffer_get_data (state->pressures);
+	dc_dive_ppo2_t *ppo2 = (dc_dive_ppo2_t *) dc_buffer_get_data (state->ppo2);
+	unsigned int nsamples = dc_buffer_get_size (state->samples) / sizeof (dc_dive_sample_t);
+	unsigned int npressures = dc_buffer_get_size (state->pressures) / sizeof (dc_dive_pressure_t);
+	unsigned int nppo2 = dc_buffer_get_size (state->ppo2) / sizeof (dc_dive_ppo2_t);
+
+	const dc_sample_type_t types[] = {
+		DC_SAMPLE_DEPTH, DC_SAMPLE_TEMPERATURE, DC_SAMPLE_HEARTBEAT,
+		DC_SAMPLE_SETPOINT, DC_SAMPLE_CNS};
+	const unsigned int ntypes = sizeof (types) / sizeof (types[0]);
+
+	if (nsamples <= npoints)
+		return DC_STATUS_SUCCESS;
+
+	unsigned int n = nsamples;
+	if (n < npressures)
+		n = npressures;
+	if (n < nppo2)
+		n = nppo2;
+
+	// Scratch tables for the series, and the keep flags of the scalar
+	// series (one table per type), the pressures and the ppO2 values.
+	// Bit 0x80 marks the pressures and ppO2 values that are processed.
+	unsigned int *x = (unsigned int *) malloc (n * sizeof (unsigned int));
+	unsigned int *index = (unsigned int *) malloc (n * sizeof (unsigned int));
+	double *y = (double *) malloc (n * sizeof (double));
+	unsigned char *keep = (unsigned char *) calloc (nsamples * ntypes + npressures + nppo2, 1);
+	if (x == NULL || index == NULL || y == NULL || keep == NULL) {
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	unsigned char *keeppressure = keep + nsamples * ntypes;
+	unsigned char *keepppo2 = keeppressure + npressures;
+
+	// Scalar series.
+	for (unsigned int t = 0; t < ntypes; ++t) {
+		unsigned int count = 0;
+		for (unsigned int i = 0; i < nsamples; ++i) {
+			if ((samples[i].fields & DC_SAMPLE_MASK (types[t])) == 0)
+				continue;
+			x[count] = samples[i].time;
+			y[count] = dc_dive_sample_value (samples + i, types[t]);
+			index[count] = i;
+			count++;
+		}
+		dc_dive_lttb (x, y, index, count, npoints, keep + t * nsamples);
+	}
+
+	// Pressure per tank. Every pass collects the values of the first
+	// tank that has not been processed yet.
+	for (unsigned int k = 0; k < npressures; ++k) {
+		if (keeppressure[k] & 0x80)
+			continue;
+
+		unsigned int tank = pressures[k].tank, count = 0;
+		for (unsigned int i = 0; i < nsamples; ++i) {
+			for (unsigned int j = 0; j < samples[i].npressure; ++j) {
+				unsigned int idx = samples[i].pressure + j;
+				if (pressures[idx].tank != tank)
+					continue;
+				keeppressure[idx] = 0x80;
+				x[count] = samples[i].time;
+				y[count] = pressures[idx].value;
+				index[count] = idx;
+				count++;
+			}
+		}
+		dc_dive_lttb (x, y, index, count, npoints, keeppressure);
+	}
+
+	// ppO2 per sensor.
+	for (unsigned int k = 0; k < nppo2; ++k) {
+		if (keepppo2[k] & 0x80)
+			continue;
+
+		unsigned int sensor = ppo2[k].sensor, count = 0;
+		for (unsigned int i = 0; i < nsamples; ++i) {
+			for (unsigned int j = 0; j < samples[i].nppo2; ++j) {
+				unsigned int idx = samples[i].ppo2 + j;
+				if (ppo2[idx].sensor != sensor)
+					continue;
+				keepppo2[idx] = 0x80;
+				x[count] = samples[i].time;
+				y[count] = ppo2[idx].value;
+				index[count] = idx;
+				count++;
+			}
+		}
+		dc_dive_lttb (x, y, index, count, npoints, keepppo2);
+	}
+
+	// Compact the tables in place.
+	unsigned int nsamples_out = 0, npressures_out = 0, nppo2_out = 0;
+	unsigned int gasmix = 0, havegasmix = 0;
+	for (unsigned int i = 0; i < nsamples; ++i) {
+		dc_dive_sample_t sample = samples[i];
+		unsigned int fields = sample.fields & ~DOWNSAMPLE_FIELDS;
+
+		for (unsigned int t = 0; t < ntypes; ++t) {
+			if (keep[t * nsamples + i])
+				fields |= DC_SAMPLE_MASK (types[t]);
+		}
+
+		unsigned int first = npressures_out;
+		for (unsigned int j = 0; j < sample.npressure; ++j) {
+			unsigned int idx = sample.pressure + j;
+			if (keeppressure[idx] & 0x01)
+				pressures[npressures_out++] = pressures[idx];
+		}
+		sample.pressure = first;
+		sample.npressure = npressures_out - first;
+		if (sample.npressure)
+			fields |= DC_SAMPLE_MASK (DC_SAMPLE_PRESSURE);
+
+		first = nppo2_out;
+		for (unsigned int j = 0; j < sample.nppo2; ++j) {
+			unsigned int idx = sample.ppo2 + j;
+			if (keepppo2[idx] & 0x01)
+				ppo2[nppo2_out++] = ppo2[idx];
+		}
+		sample.ppo2 = first;
+		sample.nppo2 = nppo2_out - first;
+		if (sample.nppo2)
+			fields |= DC_SAMPLE_MASK (DC_SAMPLE_PPO2);
+
+		int gasswitch = 0;
+		if (sample.fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX)) {
+			gasswitch = !havegasmix || sample.gasmix != gasmix;
+			gasmix = sample.gasmix;
+			havegasmix = 1;
+		}
+
+		if ((fields & (DOWNSAMPLE_FIELDS | DC_SAMPLE_MASK (DC_SAMPLE_EVENT))) == 0 && !gasswitch)
+			continue;
+
+		sample.fields = fields;
+		samples[nsamples_out++] = sample;
+	}
+
+	dc_buffer_resize (state->samples, nsamples_out * sizeof (dc_dive_sample_t));
+	dc_buffer_resize (state->pressures, npressures_out * sizeof (dc_dive_pressure_t));
+	dc_buffer_resize (state->ppo2, nppo2_out * sizeof (dc_dive_ppo2_t));
+
+error_free:
+	free (keep);
+	free (y);
+	free (index);
+	free (x);
+	return status;
+}
+
+dc_status_t
+dc_parser_parse_dive (dc_parser_t *parser, dc_dive_t **out)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_dive_t header;
+	dc_dive_t *dive = NULL;
+	dc_dive_state_t state = {NULL, NULL, NULL, NULL, 0};
+	unsigned int ngasmixes = 0, ntanks = 0;
+	unsigned char *p = NULL;
+	size_t size = 0;
+
+	if (parser == NULL || out == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	memset (&header, 0, sizeof (header));
+
+	// Header fields. Fields that are not available are left out of
+	// the bitmask, but don't abort the parsing.
+	if (dc_parser_get_datetime (parser, &header.datetime) == DC_STATUS_SUCCESS)
+		header.fields |= DC_DIVE_DATETIME;
+
+#define DIVE_FIELD(type, value) \
+	if (dc_parser_get_field (parser, type, 0, value) == DC_STATUS_SUCCESS) \
+		header.fields |= DC_FIELD_MASK (type)
+
+	DIVE_FIELD (DC_FIELD_DIVETIME, &header.divetime);
+	DIVE_FIELD (DC_FIELD_MAXDEPTH, &header.maxdepth);
+	DIVE_FIELD (DC_FIELD_AVGDEPTH, &header.avgdepth);
+	DIVE_FIELD (DC_FIELD_SALINITY, &header.salinity);
+	DIVE_FIELD (DC_FIELD_ATMOSPHERIC, &header.atmospheric);
+	DIVE_FIELD (DC_FIELD_TEMPERATURE_SURFACE, &header.temperature_surface);
+	DIVE_FIELD (DC_FIELD_TEMPERATURE_MINIMUM, &header.temperature_minimum);
+	DIVE_FIELD (DC_FIELD_TEMPERATURE_MAXIMUM, &header.temperature_maximum);
+	DIVE_FIELD (DC_FIELD_DIVEMODE, &header.divemode);
+	DIVE_FIELD (DC_FIELD_DECOMODEL, &header.decomodel);
+	DIVE_FIELD (DC_FIELD_LOCATION, &header.location);
+	DIVE_FIELD (DC_FIELD_GASMIX_COUNT, &ngasmixes);
+	DIVE_FIELD (DC_FIELD_TANK_COUNT, &ntanks);
+
+#undef DIVE_FIELD
+
+	// Profile.
+	state.samples = dc_buffer_new (0);
+	state.pressures = dc_buffer_new (0);
+	state.events = dc_buffer_new (0);
+	state.ppo2 = dc_buffer_new (0);
+	if (state.samples == NULL || state.pressures == NULL ||
+		state.events == NULL || state.ppo2 == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	status = dc_parser_samples_foreach_records (parser, dc_parser_dive_cb, &state);
+	if (status != DC_STATUS_SUCCESS) {
+		goto error_free;
+	}
+
+	if (state.nomemory) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	if (parser->downsample) {
+		status = dc_dive_downsample (&state, parser->downsample);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			goto error_free;
+		}
+	}
+
+	// Allocate a single block for the dive and all its tables.
+	size = DIVE_ALIGN (sizeof (dc_dive_t)) +
+		DIVE_ALIGN (ngasmixes * sizeof (dc_gasmix_t)) +
+		DIVE_ALIGN (ntanks * sizeof (dc_tank_t)) +
+		DIVE_ALIGN (dc_buffer_get_size (state.samples)) +
+		DIVE_ALIGN (dc_buffer_get_size (state.pressures)) +
+		DIVE_ALIGN (dc_buffer_get_size (state.events)) +
+		DIVE_ALIGN (dc_buffer_get_size (state.ppo2));
+	dive = (dc_dive_t *) malloc (size);
+	if (dive == NULL) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	*dive = header;
+
+	p = (unsigned char *) dive + DIVE_ALIGN (sizeof (dc_dive_t));
+
+	dive->ngasmixes = ngasmixes;
+	dive->gasmixes = (dc_gasmix_t *) p;
+	p += DIVE_ALIGN (ngasmixes * sizeof (dc_gasmix_t));
+	for (unsigned int i = 0; i < ngasmixes; ++i) {
+		memset (dive->gasmixes + i, 0, sizeof (dc_gasmix_t));
+		dc_parser_get_field (parser, DC_FIELD_GASMIX, i, dive->gasmixes + i);
+	}
+	if (ngasmixes)
+		dive->fields |= DC_FIELD_MASK (DC_FIELD_GASMIX);
+
+	dive->ntanks = ntanks;
+	dive->tanks = (dc_tank_t *) p;
+	p += DIVE_ALIGN (ntanks * sizeof (dc_tank_t));
+	for (unsigned int i = 0; i < ntanks; ++i) {
+		memset (dive->tanks + i, 0, sizeof (dc_tank_t));
+		dc_parser_get_field (parser, DC_FIELD_TANK, i, dive->tanks + i);
+	}
+	if (ntanks)
+		dive->fields |= DC_FIELD_MASK (DC_FIELD_TANK);
+
+	dive->nsamples = dc_buffer_get_size (state.samples) / sizeof (dc_dive_sample_t);
+	dive->samples = (dc_dive_sample_t *) dc_dive_table (&p, state.samples);
+	dive->npressures = dc_buffer_get_size (state.pressures) / sizeof (dc_dive_pressure_t);
+	dive->pressures = (dc_dive_pressure_t *) dc_dive_table (&p, state.pressures);
+	dive->nevents = dc_buffer_get_size (state.events) / sizeof (dc_dive_event_t);
+	dive->events = (dc_dive_event_t *) dc_dive_table (&p, state.events);
+	dive->nppo2 = dc_buffer_get_size (state.ppo2) / sizeof (dc_dive_ppo2_t);
+	dive->ppo2 = (dc_dive_ppo2_t *) dc_dive_table (&p, state.ppo2);
+
+	*out = dive;
+
+error_free:
+	dc_buffer_free (state.ppo2);
+	dc_buffer_free (state.events);
+	dc_buffer_free (state.pressures);
+	dc_buffer_free (state.samples);
+	return status;
+}
+
+void
+dc_dive_free (dc_dive_t *dive)
+{
+	free (dive);
+}
+
+typedef struct dc_parser_batch_t {
+	dc_context_t *context;
+	const dc_parser_batch_item_t *items;
+	unsigned int count;
+	unsigned int next;
+	dc_parser_batch_callback_t callback;
+	void *userdata;
+#ifndef _WIN32
+	pthread_mutex_t mutex;
+	pthread_mutex_t cbmutex;
+	pthread_mutex_t logmutex;
+#endif
+} dc_parser_batch_t;
+
+static void
+dc_parser_batch_logfunc (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *message, void *userdata)
+{
+	dc_parser_batch_t *batch = (dc_parser_batch_t *) userdata;
+
+	UNUSED (context);
+
+#ifndef _WIN32
+	pthread_mutex_lock (&batch->logmutex);
+#endif
+	dc_context_log (batch->context, loglevel, file, line, function, "%s", message);
+#ifndef _WIN32
+	pthread_mutex_unlock (&batch->logmutex);
+#endif
+}
+
+static void *
+dc_parser_batch_run (void *userdata)
+{
+	dc_parser_batch_t *batch = (dc_parser_batch_t *) userdata;
+	dc_context_t *context = NULL;
+
+	// The log message buffer of a context is not thread-safe. Each worker
+	// logs to its own context, and the messages are forwarded to the
+	// context of the caller.
+	if (dc_context_new (&context) == DC_STATUS_SUCCESS) {
+		dc_context_set_loglevel (context, dc_context_get_loglevel (batch->context));
+		dc_context_set_logfunc (context, dc_parser_batch_logfunc, batch);
+	}
+
+	while (1) {
+		dc_status_t status = DC_STATUS_SUCCESS;
+		dc_parser_t *parser = NULL;
+		dc_dive_t *dive = NULL;
+
+		// Take the next item.
+#ifndef _WIN32
+		pthread_mutex_lock (&batch->mutex);
+#endif
+		unsigned int index = batch->next;
+		if (index < batch->count)
+			batch->next++;
+#ifndef _WIN32
+		pthread_mutex_unlock (&batch->mutex);
+#endif
+		if (index >= batch->count)
+			break;
+
+		const dc_parser_batch_item_t *item = batch->items + index;
+
+		status = dc_parser_new_internal (&parser, context, item->data, item->size, item->family, item->model);
+		if (status == DC_STATUS_SUCCESS) {
+			if (item->devtime || item->systime) {
+				status = dc_parser_set_clock (parser, item->devtime, item->systime);
+				if (status == DC_STATUS_UNSUPPORTED)
+					status = DC_STATUS_SUCCESS;
+			}
+			if (status == DC_STATUS_SUCCESS)
+				status = dc_parser_parse_dive (parser, &dive);
+			dc_parser_destroy (parser);
+		}
+
+		// The callback has its own lock, so the other workers can take
+		// their next item while it runs.
+#ifndef _WIN32
+		pthread_mutex_lock (&batch->cbmutex);
+#endif
+		batch->callback (index, status, dive, batch->userdata);
+#ifndef _WIN32
+		pthread_mutex_unlock (&batch->cbmutex);
+#endif
+
+		dc_dive_free (dive);
+	}
+
+	dc_context_free (context);
+
+	return NULL;
+}
+
+dc_status_t
+dc_parser_parse_batch (dc_context_t *context, const dc_parser_batch_item_t items[], unsigned int count, unsigned int nthreads, dc_parser_batch_callback_t callback, void *userdata)
+{
+	dc_parser_batch_t batch;
+
+	if ((items == NULL && count) || callback == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	batch.context = context;
+	batch.items = items;
+	batch.count = count;
+	batch.next = 0;
+	batch.callback = callback;
+	batch.userdata = userdata;
+
+#ifdef _WIN32
+	// No worker threads, parse everything on the calling thread.
+	UNUSED (nthreads);
+	dc_parser_batch_run (&batch);
+#else
+	// Default to one worker per processor.
+	if (nthreads == 0) {
+		long nprocessors = sysconf (_SC_NPROCESSORS_ONLN);
+		nthreads = nprocessors > 0 ? nprocessors : 1;
+	}
+	if (nthreads > count)
+		nthreads = count ? count : 1;
+
+	pthread_t *threads = NULL;
+	if (nthreads > 1) {
+		threads = (pthread_t *) malloc ((nthreads - 1) * sizeof (pthread_t));
+		if (threads == NULL) {
+			ERROR (context, "Failed to allocate memory.");
+			return DC_STATUS_NOMEMORY;
+		}
+	}
+
+	pthread_mutex_init (&batch.mutex, NULL);
+	pthread_mutex_init (&batch.cbmutex, NULL);
+	pthread_mutex_init (&batch.logmutex, NULL);
+
+	// The calling thread is one of the workers. If a thread can't be
+	// started, the remaining workers take over its share of the items.
+	unsigned int nstarted = 0;
+	for (unsigned int i = 0; i < nthreads - 1; ++i) {
+		if (pthread_create (&threads[nstarted], NULL, dc_parser_batch_run, &batch) != 0) {
+			WARNING (context, "Failed to start worker thread %u.", i);
+			break;
+		}
+		nstarted++;
+	}
+
+	dc_parser_batch_run (&batch);
+
+	for (unsigned int i = 0; i < nstarted; ++i) {
+		pthread_join (threads[i], NULL);
+	}
+
+	pthread_mutex_destroy (&batch.logmutex);
+	pthread_mutex_destroy (&batch.cbmutex);
+	pthread_mutex_destroy (&batch.mutex);
+	free (threads);
+#endif
+
+	return DC_STATUS_SUCCESS;
+}
+
+
 dc_status_t
 dc_parser_destroy (dc_parser_t *parser)
 {
@@ -424,13 +1205,32 @@ sample_statistics_cb (dc_sample_type_t type, const dc_sample_value_t *value, voi
 
 	switch (type) {
 	case DC_SAMPLE_TIME:
+		statistics->time = value->time;
 		statistics->divetime = value->time / 1000;
 		break;
 	case DC_SAMPLE_DEPTH:
 		if (statistics->maxdepth < value->depth)
 			statistics->maxdepth = value->depth;
+		// Time weighted average depth (trapezoidal rule).
+		if (statistics->time > statistics->lasttime) {
+			statistics->area += (statistics->lastdepth + value->depth) / 2.0 *
+				(statistics->time - statistics->lasttime);
+			statistics->avgdepth = statistics->area / statistics->time;
+		}
+		statistics->lasttime = statistics->time;
+		statistics->lastdepth = value->depth;
+		break;
+	case DC_SAMPLE_TEMPERATURE:
+		if (statistics->ntemperatures == 0 || statistics->mintemperature > value->temperature)
+			statistics->mintemperature = value->temperature;
+		if (statistics->ntemperatures == 0 || statistics->maxtemperature < value->temperature)
+			statistics->maxtemperature = value->temperature;
+		statistics->ntemperatures++;
 		break;
 	default:
 		break;
 	}
+
+	if (statistics->callback)
+		statistics->callback (type, value, statistics->userdata);
 }
\ No newline at end of file
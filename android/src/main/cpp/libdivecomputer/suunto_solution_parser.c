@@ -217,7 +217,7 @@ suunto_solution_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callbac
 		}
 	}
 
-	if (data[offset] != 0x80)
+	if (offset >= size || data[offset] != 0x80)
 		return DC_STATUS_DATAFORMAT;
 
 	return DC_STATUS_SUCCESS;
@@ -141,6 +141,9 @@ tecdiving_divecomputereu_parser_samples_foreach (dc_parser_t *abstract, dc_sampl
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
 
+	if (size < SZ_HEADER)
+		return DC_STATUS_DATAFORMAT;
+
 	unsigned int time = 0;
 	unsigned int interval = data[47];
 
@@ -33,6 +33,8 @@
 
 #define NBITS 8
 
+#define MULTIBYTE 0xFF
+
 #define SMARTPRO          0x10
 #define GALILEO           0x11
 #define ALADINTEC         0x12
@@ -150,6 +152,8 @@ struct uwatec_smart_parser_t {
 	const uwatec_smart_event_info_t *events[NEVENTS];
 	unsigned int nevents[NEVENTS];
 	unsigned int trimix;
+	unsigned int galileo;
+	unsigned char identify[256];
 	// Cached fields.
 	unsigned int cached;
 	unsigned int ngasmixes;
@@ -166,6 +170,9 @@ static dc_status_t uwatec_smart_parser_samples_foreach (dc_parser_t *abstract, d
 
 static dc_status_t uwatec_smart_parse (uwatec_smart_parser_t *parser, dc_sample_callback_t callback, void *userdata);
 
+static unsigned int uwatec_smart_identify (const unsigned char data[], unsigned int size);
+static unsigned int uwatec_galileo_identify (unsigned char value);
+
 static const dc_parser_vtable_t uwatec_smart_parser_vtable = {
 	sizeof(uwatec_smart_parser_t),
 	DC_FAMILY_UWATEC_SMART,
@@ -470,6 +477,9 @@ uwatec_smart_parser_cache (uwatec_smart_parser_t *parser)
 		}
 	}
 
+	if (size < parser->headersize)
+		return DC_STATUS_DATAFORMAT;
+
 	const uwatec_smart_header_info_t *header = parser->header;
 
 	// Get the settings.
@@ -529,14 +539,7 @@ uwatec_smart_parser_cache (uwatec_smart_parser_t *parser)
 			unsigned int endpressure = 0;
 			if (header->tankpressure != UNSUPPORTED &&
 				divemode != DC_DIVEMODE_FREEDIVE) {
-				if (parser->model == GALILEO || parser->model == GALILEOTRIMIX ||
-					parser->model == ALADIN2G || parser->model == MERIDIAN ||
-					parser->model == CHROMIS || parser->model == MANTIS2 ||
-					parser->model == G2 || parser->model == ALADINSPORTMATRIX ||
-					parser->model == ALADINSQUARE || parser->model == G2HUD ||
-					parser->model == ALADINA1 || parser->model == ALADINA2 ||
-					parser->model == G2TEK || parser->model == G3 ||
-					parser->model == LUNA2AI || parser->model == LUNA2) {
+				if (parser->galileo) {
 					unsigned int offset = header->tankpressure + 2 * i;
 					endpressure   = array_uint16_le(data + offset);
 					beginpressure = array_uint16_le(data + offset + 2 * header->ngases);
@@ -593,6 +596,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 	// Set the default values.
 	parser->model = model;
 	parser->trimix = 0;
+	parser->galileo = 0;
 	for (unsigned int i = 0; i < NEVENTS; ++i) {
 		parser->events[i] = NULL;
 		parser->nevents[i] = 0;
@@ -623,6 +627,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 		parser->nevents[0] = C_ARRAY_SIZE (uwatec_smart_galileo_events_0);
 		parser->nevents[1] = C_ARRAY_SIZE (uwatec_smart_galileo_events_1);
 		parser->nevents[2] = C_ARRAY_SIZE (uwatec_smart_galileo_events_2);
+		parser->galileo = 1;
 		break;
 	case G2:
 	case G2HUD:
@@ -644,6 +649,7 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 		parser->nevents[1] = C_ARRAY_SIZE (uwatec_smart_galileo_events_1);
 		parser->nevents[2] = C_ARRAY_SIZE (uwatec_smart_trimix_events_2);
 		parser->trimix = 1;
+		parser->galileo = 1;
 		break;
 	case ALADINTEC:
 		parser->headersize = 108;
@@ -687,6 +693,23 @@ uwatec_smart_parser_create (dc_parser_t **out, dc_context_t *context, const unsi
 		goto error_free;
 	}
 
+	// Build the lookup table for the type bits. The Galileo encoding is
+	// always contained in the first byte. The Smart encoding is a unary
+	// code, which only continues into the next byte(s) if all bits of
+	// the first byte are set.
+	for (unsigned int i = 0; i < sizeof (parser->identify); ++i) {
+		unsigned char value = i;
+		unsigned int id = 0;
+		if (parser->galileo) {
+			id = uwatec_galileo_identify (value);
+		} else {
+			id = uwatec_smart_identify (&value, 1);
+		}
+		if (id >= MULTIBYTE)
+			id = MULTIBYTE;
+		parser->identify[i] = id;
+	}
+
 	parser->cached = 0;
 	parser->ngasmixes = 0;
 	parser->ntanks = 0;
@@ -928,19 +951,8 @@ uwatec_smart_parse (uwatec_smart_parser_t *parser, dc_sample_callback_t callback
 		dc_sample_value_t sample = {0};
 
 		// Process the type bits in the bitstream.
-		unsigned int id = 0;
-		if (parser->model == GALILEO || parser->model == GALILEOTRIMIX ||
-			parser->model == ALADIN2G || parser->model == MERIDIAN ||
-			parser->model == CHROMIS || parser->model == MANTIS2 ||
-			parser->model == G2 || parser->model == ALADINSPORTMATRIX ||
-			parser->model == ALADINSQUARE || parser->model == G2HUD ||
-			parser->model == ALADINA1 || parser->model == ALADINA2 ||
-			parser->model == G2TEK || parser->model == G3 ||
-			parser->model == LUNA2AI || parser->model == LUNA2) {
-			// Uwatec Galileo
-			id = uwatec_galileo_identify (data[offset]);
-		} else {
-			// Uwatec Smart
+		unsigned int id = parser->identify[data[offset]];
+		if (id == MULTIBYTE) {
 			id = uwatec_smart_identify (data + offset, size - offset);
 		}
 		if (id >= entries) {
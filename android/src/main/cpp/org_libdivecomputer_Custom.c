@@ -1,9 +1,11 @@
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <time.h>
 
 #include <libdivecomputer/custom.h>
 
-#include "org_libdivecomputer_Serial.h"
+#include "org_libdivecomputer_Custom.h"
 
 typedef struct jni_custom_t {
 	JNIEnv *env;
@@ -19,13 +21,62 @@ typedef struct jni_custom_t {
 	jmethodID poll;
 	jmethodID read;
 	jmethodID write;
+	jmethodID write_buffer;
 	jmethodID ioctl;
+	jmethodID ioctl_buffer;
 	jmethodID flush;
 	jmethodID purge;
 	jmethodID sleep;
 	jmethodID close;
+	jobject buffer; // Direct buffer for outgoing data, reused for every call
+	unsigned char *buffer_data; // Owned by the buffer
+	size_t buffer_size;
+	struct jni_queue_t *queue;
 } jni_custom_t;
 
+#define BUFFER_SIZE 1024
+
+/*
+ * Process wide counters of the write and ioctl calls, and of the direct
+ * buffers allocated for them. The byte[] copies of the default Java
+ * callback methods are counted on the Java side.
+ */
+static jlong custom_nwrites = 0;
+static jlong custom_nioctls = 0;
+static jlong custom_nallocations = 0;
+
+/*
+ * Bounded queue of received packets, filled by the application through
+ * Custom.Push and drained by the read callback. The packets are stored
+ * back to back in a ring, each with a two byte length prefix. The queue
+ * is shared by the iostream and the Java object, and freed when both
+ * have released it.
+ */
+typedef struct jni_queue_t {
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	unsigned int refcount;
+	int closed;
+	unsigned int nreaders; // Threads in queue_wait
+	int timeout;
+	size_t capacity;
+	size_t head, tail; // Byte offsets, modulo the capacity
+	size_t used;       // Bytes in the ring, including the headers
+	size_t available;  // Payload bytes
+	unsigned char buffer[];
+} jni_queue_t;
+
+#define QUEUE_HEADER 2
+
+static void
+jni_custom_free (JNIEnv *env, jni_custom_t *jni)
+{
+	if (jni->buffer)
+		(*env)->DeleteGlobalRef(env, jni->buffer);
+	(*env)->DeleteGlobalRef(env, jni->obj);
+	free (jni);
+}
+
 static dc_status_t
 custom_set_timeout (void *userdata, int timeout)
 {
@@ -151,17 +202,75 @@ custom_read (void *userdata, void *data, size_t size, size_t *actual)
 	return status;
 }
 
+/*
+ * Makes the direct buffer large enough for size bytes. The buffer only
+ * grows, so after the first calls no Java objects are allocated anymore.
+ *
+ * The memory is allocated with ByteBuffer.allocateDirect, and owned by
+ * the Java object. A callback that kept a reference to a previous
+ * buffer therefore still holds valid memory after the buffer grew, it
+ * just no longer receives the outgoing data.
+ */
+static int
+custom_buffer_reserve (jni_custom_t *jni, size_t size)
+{
+	JNIEnv *env = jni->env;
+
+	if (size <= jni->buffer_size && jni->buffer != NULL)
+		return 1;
+
+	size_t capacity = jni->buffer_size ? jni->buffer_size : BUFFER_SIZE;
+	while (capacity < size)
+		capacity *= 2;
+
+	if (capacity > 0x7FFFFFFF)
+		return 0;
+
+	if ((*env)->PushLocalFrame(env, 2) != 0)
+		return 0;
+
+	jclass cls = (*env)->FindClass(env, "java/nio/ByteBuffer");
+	jmethodID allocate = cls ? (*env)->GetStaticMethodID(env, cls, "allocateDirect", "(I)Ljava/nio/ByteBuffer;") : NULL;
+	jobject buffer = allocate ? (*env)->CallStaticObjectMethod(env, cls, allocate, (jint) capacity) : NULL;
+	unsigned char *data = buffer ? (*env)->GetDirectBufferAddress(env, buffer) : NULL;
+	if (data == NULL) {
+		// Out of memory, or the lookup failed.
+		(*env)->ExceptionClear(env);
+		(*env)->PopLocalFrame(env, NULL);
+		return 0;
+	}
+
+	if (jni->buffer)
+		(*env)->DeleteGlobalRef(env, jni->buffer);
+
+	jni->buffer = (*env)->NewGlobalRef(env, buffer);
+	jni->buffer_data = data;
+	jni->buffer_size = capacity;
+	__atomic_add_fetch (&custom_nallocations, 1, __ATOMIC_RELAXED);
+
+	(*env)->PopLocalFrame(env, NULL);
+
+	return 1;
+}
+
 static dc_status_t
 custom_write (void *userdata, const void *data, size_t size, size_t *actual)
 {
 	jni_custom_t *jni = userdata;
 
-	jbyteArray array = (*jni->env)->NewByteArray(jni->env, size);
-	(*jni->env)->SetByteArrayRegion (jni->env, array, 0, size, data);
+	if (!custom_buffer_reserve (jni, size)) {
+		*actual = 0;
+		return DC_STATUS_NOMEMORY;
+	}
+
+	memcpy (jni->buffer_data, data, size);
 
 	(*jni->env)->CallVoidMethod(jni->env, jni->obj,
-		jni->write,
-		array);
+		jni->write_buffer,
+		jni->buffer,
+		(jint) size);
+
+	__atomic_add_fetch (&custom_nwrites, 1, __ATOMIC_RELAXED);
 
 	*actual = size;
 
@@ -173,15 +282,35 @@ custom_ioctl (void *userdata, unsigned int request, void *data, size_t size)
 {
 	jni_custom_t *jni = userdata;
 
-	jbyteArray array = (*jni->env)->NewByteArray(jni->env, size);
-	(*jni->env)->SetByteArrayRegion (jni->env, array, 0, size, data);
+	if (!custom_buffer_reserve (jni, size)) {
+		return DC_STATUS_NOMEMORY;
+	}
+
+	if (size)
+		memcpy (jni->buffer_data, data, size);
 
 	(*jni->env)->CallVoidMethod(jni->env, jni->obj,
-		jni->ioctl,
+		jni->ioctl_buffer,
 		request,
-		array);
+		jni->buffer,
+		(jint) size);
+
+	__atomic_add_fetch (&custom_nioctls, 1, __ATOMIC_RELAXED);
+
+	// Callbacks throw an UnsupportedOperationException for the requests
+	// they don't implement.
+	jthrowable exception = (*jni->env)->ExceptionOccurred(jni->env);
+	if (exception) {
+		(*jni->env)->ExceptionClear(jni->env);
+		jclass unsupported = (*jni->env)->FindClass(jni->env, "java/lang/UnsupportedOperationException");
+		jboolean isunsupported = unsupported && (*jni->env)->IsInstanceOf(jni->env, exception, unsupported);
+		(*jni->env)->DeleteLocalRef(jni->env, unsupported);
+		(*jni->env)->DeleteLocalRef(jni->env, exception);
+		return isunsupported ? DC_STATUS_UNSUPPORTED : DC_STATUS_IO;
+	}
 
-	(*jni->env)->GetByteArrayRegion(jni->env, array, 0, size, data);
+	if (size)
+		memcpy (data, jni->buffer_data, size);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -229,12 +358,309 @@ custom_close (void *userdata)
 	(*jni->env)->CallVoidMethod(jni->env, jni->obj,
 		jni->close);
 
-	(*jni->env)->DeleteGlobalRef(jni->env, jni->obj);
-	free (jni);
+	jni_custom_free (jni->env, jni);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static jni_queue_t *
+queue_new (size_t capacity)
+{
+	jni_queue_t *queue = malloc (sizeof(jni_queue_t) + capacity);
+	if (queue == NULL)
+		return NULL;
+
+	pthread_condattr_t attr;
+	pthread_condattr_init (&attr);
+	pthread_condattr_setclock (&attr, CLOCK_MONOTONIC);
+	pthread_cond_init (&queue->cond, &attr);
+	pthread_condattr_destroy (&attr);
+	pthread_mutex_init (&queue->mutex, NULL);
+
+	queue->refcount = 1;
+	queue->closed = 0;
+	queue->nreaders = 0;
+	queue->timeout = -1;
+	queue->capacity = capacity;
+	queue->head = queue->tail = 0;
+	queue->used = queue->available = 0;
+
+	return queue;
+}
+
+static void
+queue_unref (jni_queue_t *queue)
+{
+	pthread_mutex_lock (&queue->mutex);
+	unsigned int refcount = --queue->refcount;
+	pthread_mutex_unlock (&queue->mutex);
+
+	if (refcount == 0) {
+		pthread_cond_destroy (&queue->cond);
+		pthread_mutex_destroy (&queue->mutex);
+		free (queue);
+	}
+}
+
+static void
+queue_copy_in (jni_queue_t *queue, const unsigned char *data, size_t size)
+{
+	size_t first = queue->capacity - queue->head;
+	if (first > size)
+		first = size;
+	memcpy (queue->buffer + queue->head, data, first);
+	memcpy (queue->buffer, data + first, size - first);
+	queue->head = (queue->head + size) % queue->capacity;
+}
+
+static void
+queue_copy_out (jni_queue_t *queue, unsigned char *data, size_t size)
+{
+	size_t first = queue->capacity - queue->tail;
+	if (first > size)
+		first = size;
+	if (data) {
+		memcpy (data, queue->buffer + queue->tail, first);
+		memcpy (data + first, queue->buffer, size - first);
+	}
+	queue->tail = (queue->tail + size) % queue->capacity;
+}
+
+static int
+queue_push (jni_queue_t *queue, const unsigned char *data, size_t size)
+{
+	int success = 0;
+
+	if (size == 0 || size > 0xFFFF)
+		return 0;
+
+	pthread_mutex_lock (&queue->mutex);
+	if (!queue->closed && queue->capacity - queue->used >= QUEUE_HEADER + size) {
+		const unsigned char header[QUEUE_HEADER] = {size & 0xFF, (size >> 8) & 0xFF};
+		queue_copy_in (queue, header, sizeof(header));
+		queue_copy_in (queue, data, size);
+		queue->used += QUEUE_HEADER + size;
+		queue->available += size;
+		pthread_cond_signal (&queue->cond);
+		success = 1;
+	}
+	pthread_mutex_unlock (&queue->mutex);
+
+	return success;
+}
+
+/*
+ * Waits until a packet is queued, with the mutex locked. A negative
+ * timeout waits forever, zero returns immediately. The caller must not
+ * touch the stream after it unlocks the mutex, because a close that
+ * woke it up only waits until then.
+ */
+static int
+queue_wait (jni_queue_t *queue, int timeout)
+{
+	struct timespec deadline;
+
+	if (timeout > 0) {
+		clock_gettime (CLOCK_MONOTONIC, &deadline);
+		deadline.tv_sec += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L) {
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+
+	queue->nreaders++;
+	while (queue->used == 0 && !queue->closed) {
+		if (timeout == 0)
+			break;
+		int rc = timeout < 0 ?
+			pthread_cond_wait (&queue->cond, &queue->mutex) :
+			pthread_cond_timedwait (&queue->cond, &queue->mutex, &deadline);
+		if (rc != 0)
+			break;
+	}
+	queue->nreaders--;
+	if (queue->closed)
+		pthread_cond_broadcast (&queue->cond);
+
+	return queue->used != 0;
+}
+
+static dc_status_t
+queue_set_timeout (void *userdata, int timeout)
+{
+	jni_custom_t *jni = userdata;
+
+	pthread_mutex_lock (&jni->queue->mutex);
+	jni->queue->timeout = timeout;
+	pthread_mutex_unlock (&jni->queue->mutex);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+queue_get_available (void *userdata, size_t *value)
+{
+	jni_custom_t *jni = userdata;
+
+	pthread_mutex_lock (&jni->queue->mutex);
+	*value = jni->queue->available;
+	pthread_mutex_unlock (&jni->queue->mutex);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+queue_poll (void *userdata, int timeout)
+{
+	jni_custom_t *jni = userdata;
+	jni_queue_t *queue = jni->queue;
+
+	pthread_mutex_lock (&queue->mutex);
+	int ready = queue_wait (queue, timeout);
+	pthread_mutex_unlock (&queue->mutex);
+
+	return ready ? DC_STATUS_SUCCESS : DC_STATUS_TIMEOUT;
+}
+
+static dc_status_t
+queue_read (void *userdata, void *data, size_t size, size_t *actual)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	jni_custom_t *jni = userdata;
+	jni_queue_t *queue = jni->queue;
+
+	pthread_mutex_lock (&queue->mutex);
+
+	if (!queue_wait (queue, queue->timeout)) {
+		pthread_mutex_unlock (&queue->mutex);
+		*actual = 0;
+		return DC_STATUS_TIMEOUT;
+	}
+
+	unsigned char header[QUEUE_HEADER];
+	queue_copy_out (queue, header, sizeof(header));
+	size_t len = header[0] | (header[1] << 8);
+
+	// Copy the data.
+	if (len > size) {
+		// Packet is too large. Copy the first size bytes only.
+		queue_copy_out (queue, data, size);
+		queue_copy_out (queue, NULL, len - size);
+		*actual = size;
+		status = DC_STATUS_IO;
+	} else {
+		queue_copy_out (queue, data, len);
+		*actual = len;
+		status = DC_STATUS_SUCCESS;
+	}
+
+	queue->used -= QUEUE_HEADER + len;
+	queue->available -= len;
+
+	pthread_mutex_unlock (&queue->mutex);
+
+	return status;
+}
+
+static dc_status_t
+queue_purge (void *userdata, dc_direction_t direction)
+{
+	jni_custom_t *jni = userdata;
+
+	if (direction & DC_DIRECTION_INPUT) {
+		pthread_mutex_lock (&jni->queue->mutex);
+		jni->queue->head = jni->queue->tail = 0;
+		jni->queue->used = jni->queue->available = 0;
+		pthread_mutex_unlock (&jni->queue->mutex);
+	}
+
+	if (direction & DC_DIRECTION_OUTPUT) {
+		return custom_purge (userdata, DC_DIRECTION_OUTPUT);
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+static dc_status_t
+queue_sleep (void *userdata, unsigned int milliseconds)
+{
+	struct timespec ts;
+	ts.tv_sec  = (milliseconds / 1000);
+	ts.tv_nsec = (milliseconds % 1000) * 1000000;
+
+	while (nanosleep (&ts, &ts) != 0) {
+		// Interrupted, sleep the remaining time.
+	}
 
 	return DC_STATUS_SUCCESS;
 }
 
+static dc_status_t
+queue_close (void *userdata)
+{
+	jni_custom_t *jni = userdata;
+	jni_queue_t *queue = jni->queue;
+
+	// Wake up a blocked reader, and reject further packets. The
+	// callbacks are freed below, so wait until the reader is out.
+	pthread_mutex_lock (&queue->mutex);
+	queue->closed = 1;
+	pthread_cond_broadcast (&queue->cond);
+	while (queue->nreaders)
+		pthread_cond_wait (&queue->cond, &queue->mutex);
+	pthread_mutex_unlock (&queue->mutex);
+
+	dc_status_t status = custom_close (userdata);
+
+	queue_unref (queue);
+
+	return status;
+}
+
+static jni_custom_t *
+jni_custom_new (JNIEnv *env, jobject callback)
+{
+	jni_custom_t *jni = malloc (sizeof(jni_custom_t));
+	if (jni == NULL) {
+		return NULL;
+	}
+
+	jni->env = env;
+	jni->obj = (*env)->NewGlobalRef(env, callback);
+	jni->cls = (*env)->GetObjectClass(env, callback);
+	jni->set_timeout   = (*env)->GetMethodID(env, jni->cls, "SetTimeout", "(I)V");
+	jni->set_break     = (*env)->GetMethodID(env, jni->cls, "SetBreak", "(Z)V");
+	jni->set_dtr       = (*env)->GetMethodID(env, jni->cls, "SetDtr", "(Z)V");
+	jni->set_rts       = (*env)->GetMethodID(env, jni->cls, "SetRts", "(Z)V");
+	jni->get_lines     = (*env)->GetMethodID(env, jni->cls, "GetLines", "()I");
+	jni->get_available = (*env)->GetMethodID(env, jni->cls, "GetAvailable", "()I");
+	jni->configure     = (*env)->GetMethodID(env, jni->cls, "Configure", "(IIIII)V");
+	jni->poll          = (*env)->GetMethodID(env, jni->cls, "Poll", "(I)V");
+	jni->read          = (*env)->GetMethodID(env, jni->cls, "Read", "()[B");
+	jni->write         = (*env)->GetMethodID(env, jni->cls, "Write", "([B)V");
+	jni->write_buffer  = (*env)->GetMethodID(env, jni->cls, "Write", "(Ljava/nio/ByteBuffer;I)V");
+	jni->ioctl         = (*env)->GetMethodID(env, jni->cls, "Ioctl", "(I[B)V");
+	jni->ioctl_buffer  = (*env)->GetMethodID(env, jni->cls, "Ioctl", "(ILjava/nio/ByteBuffer;I)V");
+	jni->flush         = (*env)->GetMethodID(env, jni->cls, "Flush", "()V");
+	jni->purge         = (*env)->GetMethodID(env, jni->cls, "Purge", "(I)V");
+	jni->sleep         = (*env)->GetMethodID(env, jni->cls, "Sleep", "(I)V");
+	jni->close         = (*env)->GetMethodID(env, jni->cls, "Close", "()V");
+	jni->buffer = NULL;
+	jni->buffer_data = NULL;
+	jni->buffer_size = 0;
+	jni->queue = NULL;
+
+	// Preallocate the buffer for the outgoing data.
+	if (!custom_buffer_reserve (jni, BUFFER_SIZE)) {
+		jni_custom_free (env, jni);
+		return NULL;
+	}
+
+	return jni;
+}
+
 JNIEXPORT jlong JNICALL Java_org_libdivecomputer_Custom_Open
   (JNIEnv *env, jobject, jlong context, jint transport, jobject callback)
 {
@@ -263,25 +689,10 @@ JNIEXPORT jlong JNICALL Java_org_libdivecomputer_Custom_Open
 		return 0;
 	}
 
-	jni_custom_t *jni = malloc (sizeof(jni_custom_t));
-	jni->env = env;
-	jni->obj = (*env)->NewGlobalRef(env, callback);
-	jni->cls = (*env)->GetObjectClass(env, callback);
-	jni->set_timeout   = (*env)->GetMethodID(env, jni->cls, "SetTimeout", "(I)V");
-	jni->set_break     = (*env)->GetMethodID(env, jni->cls, "SetBreak", "(Z)V");
-	jni->set_dtr       = (*env)->GetMethodID(env, jni->cls, "SetDtr", "(Z)V");
-	jni->set_rts       = (*env)->GetMethodID(env, jni->cls, "SetRts", "(Z)V");
-	jni->get_lines     = (*env)->GetMethodID(env, jni->cls, "GetLines", "()I");
-	jni->get_available = (*env)->GetMethodID(env, jni->cls, "GetAvailable", "()I");
-	jni->configure     = (*env)->GetMethodID(env, jni->cls, "Configure", "(IIIII)V");
-	jni->poll          = (*env)->GetMethodID(env, jni->cls, "Poll", "(I)V");
-	jni->read          = (*env)->GetMethodID(env, jni->cls, "Read", "()[B");
-	jni->write         = (*env)->GetMethodID(env, jni->cls, "Write", "([B)V");
-	jni->ioctl         = (*env)->GetMethodID(env, jni->cls, "Ioctl", "(I[B)V");
-	jni->flush         = (*env)->GetMethodID(env, jni->cls, "Flush", "()V");
-	jni->purge         = (*env)->GetMethodID(env, jni->cls, "Purge", "(I)V");
-	jni->sleep         = (*env)->GetMethodID(env, jni->cls, "Sleep", "(I)V");
-	jni->close         = (*env)->GetMethodID(env, jni->cls, "Close", "()V");
+	jni_custom_t *jni = jni_custom_new (env, callback);
+	if (jni == NULL) {
+		return 0;
+	}
 
 	status = dc_custom_open (&iostream,
 		(dc_context_t *) context,
@@ -289,8 +700,106 @@ JNIEXPORT jlong JNICALL Java_org_libdivecomputer_Custom_Open
 		&callbacks,
 		jni);
 	if (status != DC_STATUS_SUCCESS) {
+		jni_custom_free (env, jni);
 		return 0;
 	}
 
 	return (jlong) iostream;
 }
+
+JNIEXPORT jlong JNICALL Java_org_libdivecomputer_Custom_OpenQueue
+  (JNIEnv *env, jobject obj, jlong context, jint transport, jobject callback, jint capacity)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_iostream_t *iostream = NULL;
+
+	// Receiving is handled natively, everything else by the callback.
+	static const dc_custom_cbs_t callbacks = {
+		queue_set_timeout, /* set_timeout */
+		custom_set_break, /* set_break */
+		custom_set_dtr, /* set_dtr */
+		custom_set_rts, /* set_rts */
+		custom_get_lines, /* get_lines */
+		queue_get_available, /* get_available */
+		custom_configure, /* configure */
+		queue_poll, /* poll */
+		queue_read, /* read */
+		custom_write, /* write */
+		custom_ioctl, /* ioctl */
+		custom_flush, /* flush */
+		queue_purge, /* purge */
+		queue_sleep, /* sleep */
+		queue_close, /* close */
+	};
+
+	if (callback == NULL || capacity <= QUEUE_HEADER) {
+		return 0;
+	}
+
+	jni_custom_t *jni = jni_custom_new (env, callback);
+	if (jni == NULL) {
+		return 0;
+	}
+
+	jni->queue = queue_new (capacity);
+	if (jni->queue == NULL) {
+		jni_custom_free (env, jni);
+		return 0;
+	}
+
+	status = dc_custom_open (&iostream,
+		(dc_context_t *) context,
+		transport,
+		&callbacks,
+		jni);
+	if (status != DC_STATUS_SUCCESS) {
+		queue_unref (jni->queue);
+		jni_custom_free (env, jni);
+		return 0;
+	}
+
+	// The Java object keeps its own reference, for pushing packets.
+	jni->queue->refcount++;
+	jclass cls = (*env)->GetObjectClass(env, obj);
+	jfieldID fid = (*env)->GetFieldID(env, cls, "queue", "J");
+	(*env)->SetLongField(env, obj, fid, (jlong) jni->queue);
+
+	return (jlong) iostream;
+}
+
+JNIEXPORT jboolean JNICALL Java_org_libdivecomputer_Custom_Push
+  (JNIEnv *env, jclass, jlong queue, jobject buffer, jint offset, jint length)
+{
+	const unsigned char *data = (*env)->GetDirectBufferAddress(env, buffer);
+	if (data == NULL || offset < 0 || length <= 0 ||
+		(jlong) offset + length > (*env)->GetDirectBufferCapacity(env, buffer)) {
+		return JNI_FALSE;
+	}
+
+	return queue_push ((jni_queue_t *) queue, data + offset, length) ? JNI_TRUE : JNI_FALSE;
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Custom_Release
+  (JNIEnv *env, jclass, jlong queue)
+{
+	queue_unref ((jni_queue_t *) queue);
+}
+
+JNIEXPORT jlongArray JNICALL Java_org_libdivecomputer_Custom_GetCounters
+  (JNIEnv *env, jclass)
+{
+	jlong counters[] = {
+		__atomic_load_n (&custom_nwrites, __ATOMIC_RELAXED),
+		__atomic_load_n (&custom_nioctls, __ATOMIC_RELAXED),
+		__atomic_load_n (&custom_nallocations, __ATOMIC_RELAXED),
+	};
+
+	jlongArray result = (*env)->NewLongArray(env, 3);
+	if (result == NULL) {
+		return NULL;
+	}
+
+	(*env)->SetLongArrayRegion(env, result, 0, 3, counters);
+
+	return result;
+}
@@ -15,6 +15,38 @@ extern "C" {
 JNIEXPORT jlong JNICALL Java_org_libdivecomputer_Custom_Open
   (JNIEnv *, jobject, jlong, jint, jobject);
 
+/*
+ * Class:     org_libdivecomputer_Custom
+ * Method:    OpenQueue
+ * Signature: (JILorg/libdivecomputer/Custom/Callback;I)J
+ */
+JNIEXPORT jlong JNICALL Java_org_libdivecomputer_Custom_OpenQueue
+  (JNIEnv *, jobject, jlong, jint, jobject, jint);
+
+/*
+ * Class:     org_libdivecomputer_Custom
+ * Method:    Push
+ * Signature: (JLjava/nio/ByteBuffer;II)Z
+ */
+JNIEXPORT jboolean JNICALL Java_org_libdivecomputer_Custom_Push
+  (JNIEnv *, jclass, jlong, jobject, jint, jint);
+
+/*
+ * Class:     org_libdivecomputer_Custom
+ * Method:    Release
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Custom_Release
+  (JNIEnv *, jclass, jlong);
+
+/*
+ * Class:     org_libdivecomputer_Custom
+ * Method:    GetCounters
+ * Signature: ()[J
+ */
+JNIEXPORT jlongArray JNICALL Java_org_libdivecomputer_Custom_GetCounters
+  (JNIEnv *, jclass);
+
 #ifdef __cplusplus
 }
 #endif
@@ -2,6 +2,11 @@
 #include "exception.h"
 
 #include <libdivecomputer/device.h>
+#include <libdivecomputer/datetime.h>
+#include <libdivecomputer/fingerprint.h>
+#include <libdivecomputer/hw_ostc.h>
+#include <libdivecomputer/hw_ostc3.h>
+#include <libdivecomputer/divesystem_idive.h>
 
 typedef struct jni_device_t {
 	JNIEnv *env;
@@ -147,6 +152,195 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_SetFingerprint
 	}
 }
 
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_SetFingerprintStore
+  (JNIEnv *env, jobject obj, jlong handle, jlong store)
+{
+	DC_EXCEPTION_THROW(dc_device_set_fingerprint_store((dc_device_t *) handle, (dc_fingerprint_store_t *) store));
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_SetWarmstart
+  (JNIEnv *env, jobject obj, jlong handle, jbyteArray data)
+{
+	unsigned char *buf = NULL;
+	unsigned int len = 0;
+
+	// Get the pointer and length.
+	if (data) {
+		jboolean isCopy = 0;
+		len = (*env)->GetArrayLength(env, data);
+		buf = (*env)->GetByteArrayElements(env, data, &isCopy);
+	}
+
+	DC_EXCEPTION_THROW(dc_device_set_warmstart((dc_device_t *) handle, buf, len));
+
+	// Release the pointer.
+	if (data) {
+		(*env)->ReleaseByteArrayElements(env, data, buf, JNI_ABORT);
+	}
+}
+
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Device_GetWarmstart
+  (JNIEnv *env, jobject obj, jlong handle)
+{
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	if (buffer == NULL) {
+		dc_exception_throw (env, DC_STATUS_NOMEMORY);
+		return NULL;
+	}
+
+	dc_status_t status = dc_device_get_warmstart ((dc_device_t *) handle, buffer);
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		dc_buffer_free (buffer);
+		return NULL;
+	}
+
+	// No warm start data available.
+	jsize size = dc_buffer_get_size (buffer);
+	if (size == 0) {
+		dc_buffer_free (buffer);
+		return NULL;
+	}
+
+	jbyteArray array = (*env)->NewByteArray(env, size);
+	if (array)
+		(*env)->SetByteArrayRegion(env, array, 0, size, (const jbyte *) dc_buffer_get_data (buffer));
+
+	dc_buffer_free (buffer);
+
+	return array;
+}
+
+static jbyteArray
+jni_bytearray_new (JNIEnv *env, const unsigned char data[], unsigned int size)
+{
+	jbyteArray array = (*env)->NewByteArray(env, size);
+	if (array)
+		(*env)->SetByteArrayRegion(env, array, 0, size, (const jbyte *) data);
+
+	return array;
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_Timesync
+  (JNIEnv *env, jobject obj, jlong handle, jlong ticks)
+{
+	dc_datetime_t datetime = {0};
+
+	// Dive computers keep the local time.
+	if (dc_datetime_localtime (&datetime, ticks) == NULL) {
+		dc_exception_throw (env, DC_STATUS_INVALIDARGS);
+		return;
+	}
+
+	DC_EXCEPTION_THROW(dc_device_timesync ((dc_device_t *) handle, &datetime));
+}
+
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Device_Version
+  (JNIEnv *env, jobject obj, jlong handle)
+{
+	unsigned char data[HW_OSTC3_CUSTOMTEXT_SIZE + 4] = {0};
+
+	dc_status_t status = hw_ostc3_device_version ((dc_device_t *) handle, data, sizeof (data));
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		return NULL;
+	}
+
+	return jni_bytearray_new (env, data, sizeof (data));
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_Display
+  (JNIEnv *env, jobject obj, jlong handle, jstring text)
+{
+	const char *str = text ? (*env)->GetStringUTFChars(env, text, NULL) : NULL;
+
+	DC_EXCEPTION_THROW(hw_ostc3_device_display ((dc_device_t *) handle, str));
+
+	if (text)
+		(*env)->ReleaseStringUTFChars(env, text, str);
+}
+
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Device_ConfigRead
+  (JNIEnv *env, jobject obj, jlong handle, jint config, jint size)
+{
+	unsigned char data[4] = {0};
+
+	if (size < 0 || size > (jint) sizeof (data)) {
+		dc_exception_throw (env, DC_STATUS_INVALIDARGS);
+		return NULL;
+	}
+
+	dc_status_t status = hw_ostc3_device_config_read ((dc_device_t *) handle, config, data, size);
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		return NULL;
+	}
+
+	return jni_bytearray_new (env, data, size);
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_ConfigWrite
+  (JNIEnv *env, jobject obj, jlong handle, jint config, jbyteArray data)
+{
+	unsigned char *buf = NULL;
+	unsigned int len = 0;
+
+	// Get the pointer and length.
+	if (data) {
+		jboolean isCopy = 0;
+		len = (*env)->GetArrayLength(env, data);
+		buf = (*env)->GetByteArrayElements(env, data, &isCopy);
+	}
+
+	DC_EXCEPTION_THROW(hw_ostc3_device_config_write ((dc_device_t *) handle, config, buf, len));
+
+	// Release the pointer.
+	if (data) {
+		(*env)->ReleaseByteArrayElements(env, data, buf, JNI_ABORT);
+	}
+}
+
+static dc_status_t
+jni_fwupdate (dc_device_t *device, const unsigned char data[], size_t size)
+{
+	switch (dc_device_get_type (device)) {
+	case DC_FAMILY_HW_OSTC:
+		return hw_ostc_device_fwupdate_buffer (device, data, size);
+	case DC_FAMILY_HW_OSTC3:
+		return hw_ostc3_device_fwupdate_buffer (device, data, size);
+	case DC_FAMILY_DIVESYSTEM_IDIVE:
+		return divesystem_idive_device_fwupdate_buffer (device, data, size);
+	default:
+		return DC_STATUS_UNSUPPORTED;
+	}
+}
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    FirmwareUpdate
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_FirmwareUpdate
+  (JNIEnv *env, jobject obj, jlong handle, jbyteArray data)
+{
+	if (data == NULL) {
+		dc_exception_throw (env, DC_STATUS_INVALIDARGS);
+		return;
+	}
+
+	// Get the pointer and length.
+	jboolean isCopy = 0;
+	jsize len = (*env)->GetArrayLength(env, data);
+	jbyte *buf = (*env)->GetByteArrayElements(env, data, &isCopy);
+	if (buf == NULL)
+		return;
+
+	DC_EXCEPTION_THROW(jni_fwupdate ((dc_device_t *) handle, (const unsigned char *) buf, len));
+
+	// Release the pointer.
+	(*env)->ReleaseByteArrayElements(env, data, buf, JNI_ABORT);
+}
+
 /*
  * Class:     org_libdivecomputer_Device
  * Method:    SetEvents
@@ -39,6 +39,78 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_Foreach
 JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_SetFingerprint
   (JNIEnv *, jobject, jlong, jbyteArray);
 
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    SetFingerprintStore
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_SetFingerprintStore
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    SetWarmstart
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_SetWarmstart
+  (JNIEnv *, jobject, jlong, jbyteArray);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    GetWarmstart
+ * Signature: (J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Device_GetWarmstart
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    Timesync
+ * Signature: (JJ)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_Timesync
+  (JNIEnv *, jobject, jlong, jlong);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    Version
+ * Signature: (J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Device_Version
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    Display
+ * Signature: (JLjava/lang/String;)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_Display
+  (JNIEnv *, jobject, jlong, jstring);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    ConfigRead
+ * Signature: (JII)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Device_ConfigRead
+  (JNIEnv *, jobject, jlong, jint, jint);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    ConfigWrite
+ * Signature: (JI[B)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_ConfigWrite
+  (JNIEnv *, jobject, jlong, jint, jbyteArray);
+
+/*
+ * Class:     org_libdivecomputer_Device
+ * Method:    FirmwareUpdate
+ * Signature: (J[B)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Device_FirmwareUpdate
+  (JNIEnv *, jobject, jlong, jbyteArray);
+
 /*
  * Class:     org_libdivecomputer_Device
  * Method:    SetEvents
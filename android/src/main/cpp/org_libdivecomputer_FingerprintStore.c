@@ -0,0 +1,71 @@
+#include "org_libdivecomputer_FingerprintStore.h"
+#include "exception.h"
+
+#include <libdivecomputer/fingerprint.h>
+
+JNIEXPORT jlong JNICALL Java_org_libdivecomputer_FingerprintStore_Open
+  (JNIEnv *env, jobject obj, jlong context, jstring filename)
+{
+	dc_fingerprint_store_t *store = NULL;
+
+	const char *str = (*env)->GetStringUTFChars(env, filename, NULL);
+
+	DC_EXCEPTION_THROW(dc_fingerprint_store_open (&store,
+		(dc_context_t *) context,
+		str));
+
+	(*env)->ReleaseStringUTFChars(env, filename, str);
+
+	return (jlong) store;
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_FingerprintStore_Close
+  (JNIEnv *env, jobject obj, jlong handle)
+{
+	DC_EXCEPTION_THROW(dc_fingerprint_store_close ((dc_fingerprint_store_t *) handle));
+}
+
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_FingerprintStore_Get
+  (JNIEnv *env, jobject obj, jlong handle, jint family, jint model, jint serial)
+{
+	unsigned char data[DC_FINGERPRINT_MAXSIZE];
+	unsigned int size = 0;
+
+	dc_status_t status = dc_fingerprint_store_get ((dc_fingerprint_store_t *) handle,
+		family, model, serial, data, sizeof (data), &size);
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		return NULL;
+	}
+
+	if (size == 0)
+		return NULL;
+
+	jbyteArray array = (*env)->NewByteArray(env, size);
+	if (array)
+		(*env)->SetByteArrayRegion(env, array, 0, size, (const jbyte *) data);
+
+	return array;
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_FingerprintStore_Set
+  (JNIEnv *env, jobject obj, jlong handle, jint family, jint model, jint serial, jbyteArray fingerprint)
+{
+	jbyte *buf = NULL;
+	unsigned int len = 0;
+
+	// Get the pointer and length.
+	if (fingerprint) {
+		jboolean isCopy = 0;
+		len = (*env)->GetArrayLength(env, fingerprint);
+		buf = (*env)->GetByteArrayElements(env, fingerprint, &isCopy);
+	}
+
+	DC_EXCEPTION_THROW(dc_fingerprint_store_set ((dc_fingerprint_store_t *) handle,
+		family, model, serial, (const unsigned char *) buf, len));
+
+	// Release the pointer.
+	if (fingerprint) {
+		(*env)->ReleaseByteArrayElements(env, fingerprint, buf, JNI_ABORT);
+	}
+}
@@ -0,0 +1,45 @@
+/* DO NOT EDIT THIS FILE - it is machine generated */
+#include <jni.h>
+/* Header for class org_libdivecomputer_FingerprintStore */
+
+#ifndef _Included_org_libdivecomputer_FingerprintStore
+#define _Included_org_libdivecomputer_FingerprintStore
+#ifdef __cplusplus
+extern "C" {
+#endif
+/*
+ * Class:     org_libdivecomputer_FingerprintStore
+ * Method:    Open
+ * Signature: (JLjava/lang/String;)J
+ */
+JNIEXPORT jlong JNICALL Java_org_libdivecomputer_FingerprintStore_Open
+  (JNIEnv *, jobject, jlong, jstring);
+
+/*
+ * Class:     org_libdivecomputer_FingerprintStore
+ * Method:    Close
+ * Signature: (J)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_FingerprintStore_Close
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     org_libdivecomputer_FingerprintStore
+ * Method:    Get
+ * Signature: (JIII)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_FingerprintStore_Get
+  (JNIEnv *, jobject, jlong, jint, jint, jint);
+
+/*
+ * Class:     org_libdivecomputer_FingerprintStore
+ * Method:    Set
+ * Signature: (JIII[B)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_FingerprintStore_Set
+  (JNIEnv *, jobject, jlong, jint, jint, jint, jbyteArray);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -1,4 +1,9 @@
+#include <stdlib.h>
+
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/buhlmann.h>
+#include <libdivecomputer/consumption.h>
+#include <libdivecomputer/export.h>
 
 #include "org_libdivecomputer_Parser.h"
 #include "exception.h"
@@ -116,6 +121,137 @@ sample_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata
 	}
 }
 
+static void
+set_datetime (JNIEnv *env, jobject value, const dc_datetime_t *datetime)
+{
+	jclass cls = (*env)->GetObjectClass(env, value);
+	jfieldID fid_year = (*env)->GetFieldID(env, cls, "year", "I");
+	jfieldID fid_month = (*env)->GetFieldID(env, cls, "month", "I");
+	jfieldID fid_day = (*env)->GetFieldID(env, cls, "day", "I");
+	jfieldID fid_hour = (*env)->GetFieldID(env, cls, "hour", "I");
+	jfieldID fid_minute = (*env)->GetFieldID(env, cls, "minute", "I");
+	jfieldID fid_second = (*env)->GetFieldID(env, cls, "second", "I");
+	jfieldID fid_timezone = (*env)->GetFieldID(env, cls, "timezone", "I");
+
+	(*env)->SetIntField(env, value, fid_year, datetime->year);
+	(*env)->SetIntField(env, value, fid_month, datetime->month);
+	(*env)->SetIntField(env, value, fid_day, datetime->day);
+	(*env)->SetIntField(env, value, fid_hour, datetime->hour);
+	(*env)->SetIntField(env, value, fid_minute, datetime->minute);
+	(*env)->SetIntField(env, value, fid_second, datetime->second);
+	(*env)->SetIntField(env, value, fid_timezone, datetime->timezone);
+}
+
+static void
+set_salinity (JNIEnv *env, jobject value, const dc_salinity_t *salinity)
+{
+	jclass cls = (*env)->GetObjectClass(env, value);
+	jfieldID fid_type = (*env)->GetFieldID(env, cls, "type", "I");
+	jfieldID fid_density = (*env)->GetFieldID(env, cls, "density", "D");
+
+	(*env)->SetIntField(env, value, fid_type, salinity->type);
+	(*env)->SetDoubleField(env, value, fid_density, salinity->density);
+}
+
+static void
+set_decomodel (JNIEnv *env, jobject value, const dc_decomodel_t *decomodel)
+{
+	jclass cls = (*env)->GetObjectClass(env, value);
+	jfieldID fid_type = (*env)->GetFieldID(env, cls, "type", "I");
+	jfieldID fid_conservatism = (*env)->GetFieldID(env, cls, "conservatism", "I");
+	jfieldID fid_gf_high = (*env)->GetFieldID(env, cls, "gf_high", "I");
+	jfieldID fid_gf_low = (*env)->GetFieldID(env, cls, "gf_low", "I");
+
+	(*env)->SetIntField(env, value, fid_type, decomodel->type);
+	(*env)->SetIntField(env, value, fid_conservatism, decomodel->conservatism);
+	(*env)->SetIntField(env, value, fid_gf_high, decomodel->params.gf.high);
+	(*env)->SetIntField(env, value, fid_gf_low, decomodel->params.gf.low);
+}
+
+static void
+set_gasmix (JNIEnv *env, jobject value, const dc_gasmix_t *gasmix)
+{
+	jclass cls = (*env)->GetObjectClass(env, value);
+	jfieldID fid_helium = (*env)->GetFieldID(env, cls, "helium", "D");
+	jfieldID fid_oxygen = (*env)->GetFieldID(env, cls, "oxygen", "D");
+	jfieldID fid_nitrogen = (*env)->GetFieldID(env, cls, "nitrogen", "D");
+	jfieldID fid_usage = (*env)->GetFieldID(env, cls, "usage", "I");
+
+	(*env)->SetDoubleField(env, value, fid_helium, gasmix->helium);
+	(*env)->SetDoubleField(env, value, fid_oxygen, gasmix->oxygen);
+	(*env)->SetDoubleField(env, value, fid_nitrogen, gasmix->nitrogen);
+	(*env)->SetIntField(env, value, fid_usage, gasmix->usage);
+}
+
+static void
+set_tank (JNIEnv *env, jobject value, const dc_tank_t *tank)
+{
+	jclass cls = (*env)->GetObjectClass(env, value);
+	jfieldID fid_gasmix = (*env)->GetFieldID(env, cls, "gasmix", "I");
+	jfieldID fid_type = (*env)->GetFieldID(env, cls, "type", "I");
+	jfieldID fid_volume = (*env)->GetFieldID(env, cls, "volume", "D");
+	jfieldID fid_workpressure = (*env)->GetFieldID(env, cls, "workpressure", "D");
+	jfieldID fid_beginpressure = (*env)->GetFieldID(env, cls, "beginpressure", "D");
+	jfieldID fid_endpressure = (*env)->GetFieldID(env, cls, "endpressure", "D");
+	jfieldID fid_usage = (*env)->GetFieldID(env, cls, "usage", "I");
+
+	(*env)->SetIntField(env, value, fid_gasmix, tank->gasmix);
+	(*env)->SetIntField(env, value, fid_type, tank->type);
+	(*env)->SetDoubleField(env, value, fid_volume, tank->volume);
+	(*env)->SetDoubleField(env, value, fid_workpressure, tank->workpressure);
+	(*env)->SetDoubleField(env, value, fid_beginpressure, tank->beginpressure);
+	(*env)->SetDoubleField(env, value, fid_endpressure, tank->endpressure);
+	(*env)->SetIntField(env, value, fid_usage, tank->usage);
+}
+
+static void
+set_int_array (JNIEnv *env, jobject value, jclass cls, const char *name, const jint *data, jsize size)
+{
+	jintArray array = (*env)->NewIntArray(env, size);
+	if (array == NULL)
+		return;
+
+	(*env)->SetIntArrayRegion(env, array, 0, size, data);
+	(*env)->SetObjectField(env, value, (*env)->GetFieldID(env, cls, name, "[I"), array);
+	(*env)->DeleteLocalRef(env, array);
+}
+
+static void
+set_double_array (JNIEnv *env, jobject value, jclass cls, const char *name, const jdouble *data, jsize size)
+{
+	jdoubleArray array = (*env)->NewDoubleArray(env, size);
+	if (array == NULL)
+		return;
+
+	(*env)->SetDoubleArrayRegion(env, array, 0, size, data);
+	(*env)->SetObjectField(env, value, (*env)->GetFieldID(env, cls, name, "[D"), array);
+	(*env)->DeleteLocalRef(env, array);
+}
+
+static jobjectArray
+new_object_array (JNIEnv *env, jobject parser, const char *name, jsize size)
+{
+	jclass cls = (*env)->FindClass(env, name);
+	if (cls == NULL)
+		return NULL;
+
+	// Inner classes take the outer Parser instance as constructor argument.
+	jmethodID ctor = (*env)->GetMethodID(env, cls, "<init>", "(Lorg/libdivecomputer/Parser;)V");
+	jobjectArray array = (*env)->NewObjectArray(env, size, cls, NULL);
+	if (ctor == NULL || array == NULL)
+		return array;
+
+	for (jsize i = 0; i < size; ++i) {
+		jobject item = (*env)->NewObject(env, cls, ctor, parser);
+		if (item == NULL)
+			break;
+		(*env)->SetObjectArrayElement(env, array, i, item);
+		(*env)->DeleteLocalRef(env, item);
+	}
+
+	return array;
+}
+
 JNIEXPORT jlong JNICALL Java_org_libdivecomputer_Parser_New
   (JNIEnv *env, jobject obj, jlong device, jbyteArray data)
 {
@@ -197,28 +333,19 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_Foreach
 	}
 }
 
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_SetDownsample
+  (JNIEnv *env, jobject obj, jlong handle, jint npoints)
+{
+	DC_EXCEPTION_THROW(dc_parser_set_downsample ((dc_parser_t *) handle, npoints));
+}
+
 JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetDatetime
   (JNIEnv *env, jobject obj, jlong handle, jobject value)
 {
 	dc_datetime_t datetime = {0};
 	DC_EXCEPTION_THROW(dc_parser_get_datetime ((dc_parser_t *) handle, &datetime));
 
-	jclass cls = (*env)->GetObjectClass(env, value);
-	jfieldID fid_year = (*env)->GetFieldID(env, cls, "year", "I");
-	jfieldID fid_month = (*env)->GetFieldID(env, cls, "month", "I");
-	jfieldID fid_day = (*env)->GetFieldID(env, cls, "day", "I");
-	jfieldID fid_hour = (*env)->GetFieldID(env, cls, "hour", "I");
-	jfieldID fid_minute = (*env)->GetFieldID(env, cls, "minute", "I");
-	jfieldID fid_second = (*env)->GetFieldID(env, cls, "second", "I");
-	jfieldID fid_timezone = (*env)->GetFieldID(env, cls, "timezone", "I");
-
-	(*env)->SetIntField(env, value, fid_year, datetime.year);
-	(*env)->SetIntField(env, value, fid_month, datetime.month);
-	(*env)->SetIntField(env, value, fid_day, datetime.day);
-	(*env)->SetIntField(env, value, fid_hour, datetime.hour);
-	(*env)->SetIntField(env, value, fid_minute, datetime.minute);
-	(*env)->SetIntField(env, value, fid_second, datetime.second);
-	(*env)->SetIntField(env, value, fid_timezone, datetime.timezone);
+	set_datetime(env, value, &datetime);
 }
 
 JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetSalinity
@@ -227,12 +354,7 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetSalinity
 	dc_salinity_t salinity = {0};
 	DC_EXCEPTION_THROW(dc_parser_get_field ((dc_parser_t *) handle, DC_FIELD_SALINITY, 0, &salinity));
 
-	jclass cls = (*env)->GetObjectClass(env, value);
-	jfieldID fid_type = (*env)->GetFieldID(env, cls, "type", "I");
-	jfieldID fid_density = (*env)->GetFieldID(env, cls, "density", "D");
-
-	(*env)->SetIntField(env, value, fid_type, salinity.type);
-	(*env)->SetDoubleField(env, value, fid_density, salinity.density);
+	set_salinity(env, value, &salinity);
 }
 
 JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetDecomodel
@@ -241,16 +363,7 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetDecomodel
 	dc_decomodel_t decomodel = {0};
 	DC_EXCEPTION_THROW(dc_parser_get_field ((dc_parser_t *) handle, DC_FIELD_DECOMODEL, 0, &decomodel));
 
-	jclass cls = (*env)->GetObjectClass(env, value);
-	jfieldID fid_type = (*env)->GetFieldID(env, cls, "type", "I");
-	jfieldID fid_conservatism = (*env)->GetFieldID(env, cls, "conservatism", "I");
-	jfieldID fid_gf_high = (*env)->GetFieldID(env, cls, "gf_high", "I");
-	jfieldID fid_gf_low = (*env)->GetFieldID(env, cls, "gf_low", "I");
-
-	(*env)->SetIntField(env, value, fid_type, decomodel.type);
-	(*env)->SetIntField(env, value, fid_conservatism, decomodel.conservatism);
-	(*env)->SetIntField(env, value, fid_gf_high, decomodel.params.gf.high);
-	(*env)->SetIntField(env, value, fid_gf_low, decomodel.params.gf.low);
+	set_decomodel(env, value, &decomodel);
 }
 
 JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetGasmix
@@ -259,16 +372,7 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetGasmix
 	dc_gasmix_t gasmix = {0};
 	DC_EXCEPTION_THROW(dc_parser_get_field ((dc_parser_t *) handle, DC_FIELD_GASMIX, idx, &gasmix));
 
-	jclass cls = (*env)->GetObjectClass(env, value);
-	jfieldID fid_helium = (*env)->GetFieldID(env, cls, "helium", "D");
-	jfieldID fid_oxygen = (*env)->GetFieldID(env, cls, "oxygen", "D");
-	jfieldID fid_nitrogen = (*env)->GetFieldID(env, cls, "nitrogen", "D");
-	jfieldID fid_usage = (*env)->GetFieldID(env, cls, "usage", "I");
-
-	(*env)->SetDoubleField(env, value, fid_helium, gasmix.helium);
-	(*env)->SetDoubleField(env, value, fid_oxygen, gasmix.oxygen);
-	(*env)->SetDoubleField(env, value, fid_nitrogen, gasmix.nitrogen);
-	(*env)->SetIntField(env, value, fid_usage, gasmix.usage);
+	set_gasmix(env, value, &gasmix);
 }
 
 JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetTank
@@ -277,22 +381,7 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_GetTank
 	dc_tank_t tank = {0};
 	DC_EXCEPTION_THROW(dc_parser_get_field ((dc_parser_t *) handle, DC_FIELD_TANK, idx, &tank));
 
-	jclass cls = (*env)->GetObjectClass(env, value);
-	jfieldID fid_gasmix = (*env)->GetFieldID(env, cls, "gasmix", "I");
-	jfieldID fid_type = (*env)->GetFieldID(env, cls, "type", "I");
-	jfieldID fid_volume = (*env)->GetFieldID(env, cls, "volume", "D");
-	jfieldID fid_workpressure = (*env)->GetFieldID(env, cls, "workpressure", "D");
-	jfieldID fid_beginpressure = (*env)->GetFieldID(env, cls, "beginpressure", "D");
-	jfieldID fid_endpressure = (*env)->GetFieldID(env, cls, "endpressure", "D");
-	jfieldID fid_usage = (*env)->GetFieldID(env, cls, "usage", "I");
-
-	(*env)->SetIntField(env, value, fid_gasmix, tank.gasmix);
-	(*env)->SetIntField(env, value, fid_type, tank.type);
-	(*env)->SetDoubleField(env, value, fid_volume, tank.volume);
-	(*env)->SetDoubleField(env, value, fid_workpressure, tank.workpressure);
-	(*env)->SetDoubleField(env, value, fid_beginpressure, tank.beginpressure);
-	(*env)->SetDoubleField(env, value, fid_endpressure, tank.endpressure);
-	(*env)->SetIntField(env, value, fid_usage, tank.usage);
+	set_tank(env, value, &tank);
 }
 
 JNIEXPORT jint JNICALL Java_org_libdivecomputer_Parser_GetFieldInt
@@ -310,3 +399,366 @@ JNIEXPORT jdouble JNICALL Java_org_libdivecomputer_Parser_GetFieldDouble
 	DC_EXCEPTION_THROW(dc_parser_get_field ((dc_parser_t *) handle, field, 0, &value));
 	return value;
 }
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ParseDive
+  (JNIEnv *env, jobject obj, jlong handle, jobject value)
+{
+	dc_dive_t *dive = NULL;
+	dc_status_t status = dc_parser_parse_dive ((dc_parser_t *) handle, &dive);
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		return;
+	}
+
+	jclass cls = (*env)->GetObjectClass(env, value);
+
+	// Header fields.
+	(*env)->SetIntField(env, value, (*env)->GetFieldID(env, cls, "fields", "I"), dive->fields);
+	(*env)->SetIntField(env, value, (*env)->GetFieldID(env, cls, "divetime", "I"), dive->divetime);
+	(*env)->SetDoubleField(env, value, (*env)->GetFieldID(env, cls, "maxdepth", "D"), dive->maxdepth);
+	(*env)->SetDoubleField(env, value, (*env)->GetFieldID(env, cls, "avgdepth", "D"), dive->avgdepth);
+	(*env)->SetDoubleField(env, value, (*env)->GetFieldID(env, cls, "atmospheric", "D"), dive->atmospheric);
+	(*env)->SetDoubleField(env, value, (*env)->GetFieldID(env, cls, "temperatureSurface", "D"), dive->temperature_surface);
+	(*env)->SetDoubleField(env, value, (*env)->GetFieldID(env, cls, "temperatureMin", "D"), dive->temperature_minimum);
+	(*env)->SetDoubleField(env, value, (*env)->GetFieldID(env, cls, "temperatureMax", "D"), dive->temperature_maximum);
+	(*env)->SetIntField(env, value, (*env)->GetFieldID(env, cls, "divemode", "I"), dive->divemode);
+
+	set_datetime(env, (*env)->GetObjectField(env, value, (*env)->GetFieldID(env, cls, "datetime", "Lorg/libdivecomputer/Parser$Datetime;")), &dive->datetime);
+	set_salinity(env, (*env)->GetObjectField(env, value, (*env)->GetFieldID(env, cls, "salinity", "Lorg/libdivecomputer/Parser$Salinity;")), &dive->salinity);
+	set_decomodel(env, (*env)->GetObjectField(env, value, (*env)->GetFieldID(env, cls, "decomodel", "Lorg/libdivecomputer/Parser$Decomodel;")), &dive->decomodel);
+
+	// Gas mixes and tanks.
+	jobjectArray gasmixes = new_object_array(env, obj, "org/libdivecomputer/Parser$Gasmix", dive->ngasmixes);
+	if (gasmixes) {
+		for (unsigned int i = 0; i < dive->ngasmixes; ++i) {
+			jobject item = (*env)->GetObjectArrayElement(env, gasmixes, i);
+			if (item == NULL)
+				break;
+			set_gasmix(env, item, &dive->gasmixes[i]);
+			(*env)->DeleteLocalRef(env, item);
+		}
+		(*env)->SetObjectField(env, value, (*env)->GetFieldID(env, cls, "gasmixes", "[Lorg/libdivecomputer/Parser$Gasmix;"), gasmixes);
+		(*env)->DeleteLocalRef(env, gasmixes);
+	}
+
+	jobjectArray tanks = new_object_array(env, obj, "org/libdivecomputer/Parser$Tank", dive->ntanks);
+	if (tanks) {
+		for (unsigned int i = 0; i < dive->ntanks; ++i) {
+			jobject item = (*env)->GetObjectArrayElement(env, tanks, i);
+			if (item == NULL)
+				break;
+			set_tank(env, item, &dive->tanks[i]);
+			(*env)->DeleteLocalRef(env, item);
+		}
+		(*env)->SetObjectField(env, value, (*env)->GetFieldID(env, cls, "tanks", "[Lorg/libdivecomputer/Parser$Tank;"), tanks);
+		(*env)->DeleteLocalRef(env, tanks);
+	}
+
+	// Profile. Every column is copied with a single array region call.
+	unsigned int n = dive->nsamples;
+	if (n < dive->npressures)
+		n = dive->npressures;
+	if (n < dive->nevents)
+		n = dive->nevents;
+	if (n < dive->nppo2)
+		n = dive->nppo2;
+
+	jint *ints = (jint *) malloc ((n ? n : 1) * sizeof (jint));
+	jdouble *doubles = (jdouble *) malloc ((n ? n : 1) * sizeof (jdouble));
+	if (ints == NULL || doubles == NULL) {
+		free (ints);
+		free (doubles);
+		dc_dive_free (dive);
+		dc_exception_throw (env, DC_STATUS_NOMEMORY);
+		return;
+	}
+
+#define INT_COLUMN(name, table, count, member) \
+	for (unsigned int i = 0; i < (count); ++i) \
+		ints[i] = (jint) dive->table[i].member; \
+	set_int_array(env, value, cls, name, ints, (count))
+
+#define DOUBLE_COLUMN(name, table, count, member) \
+	for (unsigned int i = 0; i < (count); ++i) \
+		doubles[i] = dive->table[i].member; \
+	set_double_array(env, value, cls, name, doubles, (count))
+
+	INT_COLUMN("sampleFields", samples, dive->nsamples, fields);
+	INT_COLUMN("sampleTime", samples, dive->nsamples, time);
+	DOUBLE_COLUMN("sampleDepth", samples, dive->nsamples, depth);
+	DOUBLE_COLUMN("sampleTemperature", samples, dive->nsamples, temperature);
+	INT_COLUMN("sampleRbt", samples, dive->nsamples, rbt);
+	INT_COLUMN("sampleHeartbeat", samples, dive->nsamples, heartbeat);
+	INT_COLUMN("sampleBearing", samples, dive->nsamples, bearing);
+	DOUBLE_COLUMN("sampleSetpoint", samples, dive->nsamples, setpoint);
+	DOUBLE_COLUMN("sampleCns", samples, dive->nsamples, cns);
+	INT_COLUMN("sampleDecoType", samples, dive->nsamples, deco.type);
+	INT_COLUMN("sampleDecoTime", samples, dive->nsamples, deco.time);
+	DOUBLE_COLUMN("sampleDecoDepth", samples, dive->nsamples, deco.depth);
+	INT_COLUMN("sampleDecoTts", samples, dive->nsamples, deco.tts);
+	INT_COLUMN("sampleGasmix", samples, dive->nsamples, gasmix);
+	INT_COLUMN("samplePressure", samples, dive->nsamples, pressure);
+	INT_COLUMN("sampleNPressure", samples, dive->nsamples, npressure);
+	INT_COLUMN("sampleEvent", samples, dive->nsamples, event);
+	INT_COLUMN("sampleNEvents", samples, dive->nsamples, nevents);
+	INT_COLUMN("samplePpo2", samples, dive->nsamples, ppo2);
+	INT_COLUMN("sampleNPpo2", samples, dive->nsamples, nppo2);
+
+	INT_COLUMN("pressureTank", pressures, dive->npressures, tank);
+	DOUBLE_COLUMN("pressureValue", pressures, dive->npressures, value);
+
+	INT_COLUMN("eventType", events, dive->nevents, type);
+	INT_COLUMN("eventTime", events, dive->nevents, time);
+	INT_COLUMN("eventFlags", events, dive->nevents, flags);
+	INT_COLUMN("eventValue", events, dive->nevents, value);
+
+	INT_COLUMN("ppo2Sensor", ppo2, dive->nppo2, sensor);
+	DOUBLE_COLUMN("ppo2Value", ppo2, dive->nppo2, value);
+
+#undef INT_COLUMN
+#undef DOUBLE_COLUMN
+
+	free (ints);
+	free (doubles);
+	dc_dive_free (dive);
+}
+
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Parser_PackSamples
+  (JNIEnv *env, jobject obj, jlong handle)
+{
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	if (buffer == NULL) {
+		dc_exception_throw (env, DC_STATUS_NOMEMORY);
+		return NULL;
+	}
+
+	dc_status_t status = dc_parser_samples_pack ((dc_parser_t *) handle, buffer);
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		dc_buffer_free (buffer);
+		return NULL;
+	}
+
+	jsize size = dc_buffer_get_size (buffer);
+	jbyteArray array = (*env)->NewByteArray(env, size);
+	if (array)
+		(*env)->SetByteArrayRegion(env, array, 0, size, (const jbyte *) dc_buffer_get_data (buffer));
+
+	dc_buffer_free (buffer);
+
+	return array;
+}
+
+/*
+ * The analyses integrate over the profile, so they always parse the full
+ * resolution profile, even when downsampling is enabled.
+ */
+static dc_status_t
+parse_full_dive (dc_parser_t *parser, dc_dive_t **dive)
+{
+	unsigned int downsample = dc_parser_get_downsample (parser);
+
+	dc_parser_set_downsample (parser, 0);
+	dc_status_t status = dc_parser_parse_dive (parser, dive);
+	dc_parser_set_downsample (parser, downsample);
+
+	return status;
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ComputeBuhlmann
+  (JNIEnv *env, jobject obj, jlong handle, jint gflow, jint gfhigh, jobject value)
+{
+	dc_dive_t *dive = NULL;
+	dc_status_t status = parse_full_dive ((dc_parser_t *) handle, &dive);
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		return;
+	}
+
+	unsigned int n = dive->nsamples;
+	dc_buhlmann_sample_t *results = (dc_buhlmann_sample_t *) malloc ((n ? n : 1) * sizeof (dc_buhlmann_sample_t));
+	jint *ints = (jint *) malloc ((n ? n : 1) * sizeof (jint));
+	jdouble *doubles = (jdouble *) malloc ((n ? n : 1) * sizeof (jdouble));
+	if (results == NULL || ints == NULL || doubles == NULL) {
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	status = dc_buhlmann_compute (dive, gflow, gfhigh, results);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	jclass cls = (*env)->GetObjectClass(env, value);
+
+	for (unsigned int i = 0; i < n; ++i)
+		ints[i] = (jint) dive->samples[i].time;
+	set_int_array(env, value, cls, "time", ints, n);
+
+#define INT_COLUMN(name, member) \
+	for (unsigned int i = 0; i < n; ++i) \
+		ints[i] = (jint) results[i].member; \
+	set_int_array(env, value, cls, name, ints, n)
+
+#define DOUBLE_COLUMN(name, member) \
+	for (unsigned int i = 0; i < n; ++i) \
+		doubles[i] = results[i].member; \
+	set_double_array(env, value, cls, name, doubles, n)
+
+	DOUBLE_COLUMN("ceiling", ceiling);
+	DOUBLE_COLUMN("gf99", gf99);
+	DOUBLE_COLUMN("surfaceGf", surfacegf);
+	INT_COLUMN("tts", tts);
+
+#undef INT_COLUMN
+#undef DOUBLE_COLUMN
+
+error_free:
+	free (doubles);
+	free (ints);
+	free (results);
+	dc_dive_free (dive);
+
+	if (status != DC_STATUS_SUCCESS)
+		dc_exception_throw (env, status);
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ComputeConsumption
+  (JNIEnv *env, jobject obj, jlong handle, jint window, jobject value)
+{
+	dc_dive_t *dive = NULL;
+	dc_consumption_t *consumption = NULL;
+	jint *ints = NULL;
+	jdouble *doubles = NULL;
+
+	dc_status_t status = parse_full_dive ((dc_parser_t *) handle, &dive);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	status = dc_consumption_compute (dive, window, &consumption);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	unsigned int n = consumption->npoints;
+	if (n < consumption->nsegments)
+		n = consumption->nsegments;
+
+	ints = (jint *) malloc ((n ? n : 1) * sizeof (jint));
+	doubles = (jdouble *) malloc ((n ? n : 1) * sizeof (jdouble));
+	if (ints == NULL || doubles == NULL) {
+		status = DC_STATUS_NOMEMORY;
+		goto error_free;
+	}
+
+	jclass cls = (*env)->GetObjectClass(env, value);
+
+#define INT_COLUMN(name, table, count, member) \
+	for (unsigned int i = 0; i < (count); ++i) \
+		ints[i] = (jint) consumption->table[i].member; \
+	set_int_array(env, value, cls, name, ints, (count))
+
+#define DOUBLE_COLUMN(name, table, count, member) \
+	for (unsigned int i = 0; i < (count); ++i) \
+		doubles[i] = consumption->table[i].member; \
+	set_double_array(env, value, cls, name, doubles, (count))
+
+	INT_COLUMN("pointTank", points, consumption->npoints, tank);
+	INT_COLUMN("pointTime", points, consumption->npoints, time);
+	DOUBLE_COLUMN("pointSac", points, consumption->npoints, sac);
+	DOUBLE_COLUMN("pointRmv", points, consumption->npoints, rmv);
+
+	INT_COLUMN("segmentTank", segments, consumption->nsegments, tank);
+	INT_COLUMN("segmentGasmix", segments, consumption->nsegments, gasmix);
+	INT_COLUMN("segmentBeginTime", segments, consumption->nsegments, begintime);
+	INT_COLUMN("segmentEndTime", segments, consumption->nsegments, endtime);
+	DOUBLE_COLUMN("segmentBeginPressure", segments, consumption->nsegments, beginpressure);
+	DOUBLE_COLUMN("segmentEndPressure", segments, consumption->nsegments, endpressure);
+	DOUBLE_COLUMN("segmentAvgdepth", segments, consumption->nsegments, avgdepth);
+	DOUBLE_COLUMN("segmentVolume", segments, consumption->nsegments, volume);
+	DOUBLE_COLUMN("segmentSac", segments, consumption->nsegments, sac);
+	DOUBLE_COLUMN("segmentRmv", segments, consumption->nsegments, rmv);
+
+#undef INT_COLUMN
+#undef DOUBLE_COLUMN
+
+error_free:
+	free (doubles);
+	free (ints);
+	dc_consumption_free (consumption);
+	dc_dive_free (dive);
+
+	if (status != DC_STATUS_SUCCESS)
+		dc_exception_throw (env, status);
+}
+
+static dc_parser_t **
+parser_handles (JNIEnv *env, jlongArray handles, unsigned int *count)
+{
+	jsize len = (*env)->GetArrayLength(env, handles);
+
+	dc_parser_t **parsers = (dc_parser_t **) malloc ((len ? len : 1) * sizeof (dc_parser_t *));
+	if (parsers == NULL)
+		return NULL;
+
+	jlong *buf = (*env)->GetLongArrayElements(env, handles, NULL);
+	if (buf == NULL) {
+		free (parsers);
+		return NULL;
+	}
+
+	for (jsize i = 0; i < len; ++i)
+		parsers[i] = (dc_parser_t *) buf[i];
+
+	(*env)->ReleaseLongArrayElements(env, handles, buf, JNI_ABORT);
+
+	*count = len;
+
+	return parsers;
+}
+
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Parser_ExportDives
+  (JNIEnv *env, jclass cls, jint format, jlongArray handles)
+{
+	unsigned int count = 0;
+	dc_parser_t **parsers = parser_handles (env, handles, &count);
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	if (parsers == NULL || buffer == NULL) {
+		dc_exception_throw (env, DC_STATUS_NOMEMORY);
+		dc_buffer_free (buffer);
+		free (parsers);
+		return NULL;
+	}
+
+	dc_status_t status = dc_export_buffer (format, parsers, count, buffer);
+	free (parsers);
+	if (status != DC_STATUS_SUCCESS) {
+		dc_exception_throw (env, status);
+		dc_buffer_free (buffer);
+		return NULL;
+	}
+
+	jsize size = dc_buffer_get_size (buffer);
+	jbyteArray array = (*env)->NewByteArray(env, size);
+	if (array)
+		(*env)->SetByteArrayRegion(env, array, 0, size, (const jbyte *) dc_buffer_get_data (buffer));
+
+	dc_buffer_free (buffer);
+
+	return array;
+}
+
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ExportDivesFd
+  (JNIEnv *env, jclass cls, jint format, jlongArray handles, jint fd)
+{
+	unsigned int count = 0;
+	dc_parser_t **parsers = parser_handles (env, handles, &count);
+	if (parsers == NULL) {
+		dc_exception_throw (env, DC_STATUS_NOMEMORY);
+		return;
+	}
+
+	dc_status_t status = dc_export_fd (format, parsers, count, fd);
+	free (parsers);
+
+	if (status != DC_STATUS_SUCCESS)
+		dc_exception_throw (env, status);
+}
@@ -39,6 +39,14 @@ JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_Free
 JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_Foreach
   (JNIEnv *, jobject, jlong, jobject);
 
+/*
+ * Class:     org_libdivecomputer_Parser
+ * Method:    SetDownsample
+ * Signature: (JI)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_SetDownsample
+  (JNIEnv *, jobject, jlong, jint);
+
 /*
  * Class:     org_libdivecomputer_Parser
  * Method:    GetDatetime
@@ -95,6 +103,54 @@ JNIEXPORT jint JNICALL Java_org_libdivecomputer_Parser_GetFieldInt
 JNIEXPORT jdouble JNICALL Java_org_libdivecomputer_Parser_GetFieldDouble
   (JNIEnv *, jobject, jlong, jint);
 
+/*
+ * Class:     org_libdivecomputer_Parser
+ * Method:    ParseDive
+ * Signature: (JLorg/libdivecomputer/Parser/Dive;)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ParseDive
+  (JNIEnv *, jobject, jlong, jobject);
+
+/*
+ * Class:     org_libdivecomputer_Parser
+ * Method:    PackSamples
+ * Signature: (J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Parser_PackSamples
+  (JNIEnv *, jobject, jlong);
+
+/*
+ * Class:     org_libdivecomputer_Parser
+ * Method:    ComputeBuhlmann
+ * Signature: (JIILorg/libdivecomputer/Parser/Buhlmann;)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ComputeBuhlmann
+  (JNIEnv *, jobject, jlong, jint, jint, jobject);
+
+/*
+ * Class:     org_libdivecomputer_Parser
+ * Method:    ComputeConsumption
+ * Signature: (JILorg/libdivecomputer/Parser/Consumption;)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ComputeConsumption
+  (JNIEnv *, jobject, jlong, jint, jobject);
+
+/*
+ * Class:     org_libdivecomputer_Parser
+ * Method:    ExportDives
+ * Signature: (I[J)[B
+ */
+JNIEXPORT jbyteArray JNICALL Java_org_libdivecomputer_Parser_ExportDives
+  (JNIEnv *, jclass, jint, jlongArray);
+
+/*
+ * Class:     org_libdivecomputer_Parser
+ * Method:    ExportDivesFd
+ * Signature: (I[JI)V
+ */
+JNIEXPORT void JNICALL Java_org_libdivecomputer_Parser_ExportDivesFd
+  (JNIEnv *, jclass, jint, jlongArray, jint);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,243 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * Bühlmann benchmark
+ *
+ * Runs dc_buhlmann_compute over a long synthetic profile: a 4 hour CCR
+ * trimix dive to 70 m with 1 s samples, with diluent switches (air, 10/50
+ * and 21/35) and setpoint switches (0.7, 1.3 and 1.6 bar), and decompression
+ * stops every 3 m from 21 m. It reports the time per sample, the fastest of
+ * several rounds.
+ *
+ *   dc_buhlmann_bench [-r rounds] [-l gflow] [-h gfhigh]
+ *
+ * The check fails if the computation fails, or if the dive never has a
+ * ceiling.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libdivecomputer/parser.h>
+#include <libdivecomputer/buhlmann.h>
+
+#define DURATION  (4 * 3600) // Seconds
+#define MAXDEPTH  70.0
+#define BOTTOM    (40 * 60)  // End of the bottom time (s)
+#define DESCENT   20.0       // m/min
+#define ASCENT    9.0        // m/min
+#define FIRSTSTOP 21
+#define STOPSTEP  3
+
+enum {
+	MIX_AIR,
+	MIX_TX1050,
+	MIX_TX2135,
+	NMIXES
+};
+
+static unsigned long long
+now (void)
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Depth (m) at the given time (s). The stop time left after the bottom
+ * phase and the ascents is spread over the stops, with longer stops in
+ * the shallow water.
+ */
+static double
+profile_depth (unsigned int t)
+{
+	const double descent = MAXDEPTH / DESCENT * 60.0;
+	const double ascent = (MAXDEPTH - FIRSTSTOP) / ASCENT * 60.0;
+	const double travel = STOPSTEP / ASCENT * 60.0;
+	const unsigned int nstops = FIRSTSTOP / STOPSTEP;
+
+	if (t < descent)
+		return t * DESCENT / 60.0;
+	if (t < BOTTOM)
+		return MAXDEPTH;
+	if (t < BOTTOM + ascent)
+		return MAXDEPTH - (t - BOTTOM) * ASCENT / 60.0;
+
+	// The stop at depth (nstops - i) * STOPSTEP lasts (i + 1) units.
+	double remaining = DURATION - BOTTOM - ascent - nstops * travel;
+	double unit = remaining / (nstops * (nstops + 1) / 2);
+	double elapsed = t - BOTTOM - ascent;
+	for (unsigned int i = 0; i < nstops; ++i) {
+		double depth = (nstops - i) * STOPSTEP;
+		double stop = (i + 1) * unit;
+		if (elapsed < stop)
+			return depth;
+		elapsed -= stop;
+		if (elapsed < travel)
+			return depth - elapsed * ASCENT / 60.0;
+		elapsed -= travel;
+	}
+
+	return 0.0;
+}
+
+static dc_dive_t *
+profile_new (void)
+{
+	static dc_gasmix_t gasmixes[NMIXES] = {
+		{0.00, 0.21, 0.79, DC_USAGE_DILUENT},
+		{0.50, 0.10, 0.40, DC_USAGE_DILUENT},
+		{0.35, 0.21, 0.44, DC_USAGE_DILUENT},
+	};
+
+	dc_dive_t *dive = (dc_dive_t *) calloc (1, sizeof (dc_dive_t));
+	dc_dive_sample_t *samples = (dc_dive_sample_t *) calloc (DURATION + 1, sizeof (dc_dive_sample_t));
+	if (dive == NULL || samples == NULL) {
+		free (dive);
+		free (samples);
+		return NULL;
+	}
+
+	dive->fields = DC_FIELD_MASK (DC_FIELD_DIVEMODE) | DC_FIELD_MASK (DC_FIELD_GASMIX);
+	dive->divemode = DC_DIVEMODE_CCR;
+	dive->divetime = DURATION;
+	dive->maxdepth = MAXDEPTH;
+	dive->ngasmixes = NMIXES;
+	dive->gasmixes = gasmixes;
+	dive->nsamples = DURATION + 1;
+	dive->samples = samples;
+
+	unsigned int mix = MIX_AIR;
+	double setpoint = 0.7;
+	for (unsigned int t = 0; t <= DURATION; ++t) {
+		dc_dive_sample_t *sample = samples + t;
+		double depth = profile_depth (t);
+
+		sample->fields = DC_SAMPLE_MASK (DC_SAMPLE_TIME) | DC_SAMPLE_MASK (DC_SAMPLE_DEPTH);
+		sample->time = t * 1000;
+		sample->depth = depth;
+
+		// Hypoxic diluent below 6 m on the way down, and the deco
+		// diluent above 40 m on the way up.
+		unsigned int m = mix;
+		if (t < BOTTOM && depth > 6.0)
+			m = MIX_TX1050;
+		else if (t >= BOTTOM && depth <= 40.0)
+			m = MIX_TX2135;
+
+		double sp = setpoint;
+		if (t < BOTTOM && depth > 10.0)
+			sp = 1.3;
+		else if (t >= BOTTOM && depth <= 6.0)
+			sp = 1.6;
+
+		if (t == 0 || m != mix) {
+			sample->fields |= DC_SAMPLE_MASK (DC_SAMPLE_GASMIX);
+			sample->gasmix = m;
+			mix = m;
+		}
+
+		if (t == 0 || sp != setpoint) {
+			sample->fields |= DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT);
+			sample->setpoint = sp;
+			setpoint = sp;
+		}
+	}
+
+	return dive;
+}
+
+int
+main (int argc, char *argv[])
+{
+	unsigned int rounds = 5, gflow = 30, gfhigh = 80;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "r:l:h:")) != -1) {
+		switch (opt) {
+		case 'r':
+			rounds = strtoul (optarg, NULL, 10);
+			break;
+		case 'l':
+			gflow = strtoul (optarg, NULL, 10);
+			break;
+		case 'h':
+			gfhigh = strtoul (optarg, NULL, 10);
+			break;
+		default:
+			fprintf (stderr, "Usage: %s [-r rounds] [-l gflow] [-h gfhigh]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (rounds == 0)
+		rounds = 1;
+
+	dc_dive_t *dive = profile_new ();
+	dc_buhlmann_sample_t *results = (dc_buhlmann_sample_t *) calloc (DURATION + 1, sizeof (dc_buhlmann_sample_t));
+	if (dive == NULL || results == NULL) {
+		fprintf (stderr, "Out of memory.\n");
+		return EXIT_FAILURE;
+	}
+
+	unsigned long long best = 0;
+	for (unsigned int round = 0; round < rounds; ++round) {
+		unsigned long long start = now ();
+		dc_status_t status = dc_buhlmann_compute (dive, gflow, gfhigh, results);
+		unsigned long long elapsed = now () - start;
+		if (status != DC_STATUS_SUCCESS) {
+			fprintf (stderr, "dc_buhlmann_compute failed (%d).\n", status);
+			return EXIT_FAILURE;
+		}
+		if (round == 0 || elapsed < best)
+			best = elapsed;
+	}
+
+	double ceiling = 0.0;
+	unsigned int tts = 0;
+	for (unsigned int i = 0; i < dive->nsamples; ++i) {
+		if (ceiling < results[i].ceiling)
+			ceiling = results[i].ceiling;
+		if (tts < results[i].tts)
+			tts = results[i].tts;
+	}
+
+	printf ("%u samples, GF %u/%u, best of %u rounds: %.3f ms, %.1f ns/sample\n",
+		dive->nsamples, gflow, gfhigh, rounds, best / 1e6, (double) best / dive->nsamples);
+	printf ("Deepest ceiling %.1f m, longest time to surface %u min, surface GF at the end %.0f%%\n",
+		ceiling, tts / 60, results[dive->nsamples - 1].surfacegf);
+
+	int ok = ceiling > 0.0;
+	if (!ok)
+		fprintf (stderr, "The dive never had a ceiling.\n");
+
+	free (results);
+	free (dive->samples);
+	free (dive);
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,751 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * Custom iostream replay
+ *
+ * Runs the JNI bindings of the Custom iostream (org_libdivecomputer_Custom.c)
+ * against a mock JNIEnv, and replays the traffic of a chatty download: many
+ * small commands, BLE ioctls (one of them unsupported by the callback) and
+ * a single large write that grows the direct buffer. The callback behaves
+ * like one that overrides Callback.Write(ByteBuffer, int) and
+ * Callback.Ioctl(int, ByteBuffer, int), and keeps a reference to the first
+ * buffer it was given.
+ *
+ * The packet queue of the push mode (Custom.OpenQueue) is replayed as
+ * well: packets pushed across the wrap point of the ring and read back,
+ * truncated reads, purging, a close that wakes a blocked reader, and both
+ * release orders of the two owners of the queue.
+ *
+ *   dc_custom_replay [-n count]
+ *
+ * The replay fails if the bindings allocate Java objects or leak local
+ * references per call, if the data or the counters of Custom.Counters()
+ * are wrong, if a queued packet is lost or corrupted, or if the kept
+ * buffer no longer points to valid memory after the buffer grew. With
+ * the sanitizers, a queue that is freed too early or never is reported
+ * as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/iostream.h>
+#include <libdivecomputer/ble.h>
+
+#include "org_libdivecomputer_Custom.h"
+
+#define MTU 247
+#define QUEUE_CAPACITY 64
+
+typedef enum mock_type_t {
+	MOCK_CLASS,
+	MOCK_CALLBACK,
+	MOCK_BUFFER,
+	MOCK_LONGARRAY,
+	MOCK_EXCEPTION,
+} mock_type_t;
+
+struct _jobject {
+	mock_type_t type;
+	const char *name;       // Class name
+	unsigned char *data;    // Buffer and array contents
+	jlong capacity;
+	jlong field;            // Custom.queue
+	struct _jobject *next;
+};
+
+struct _jmethodID {
+	const char *name;
+	const char *signature;
+};
+
+/*
+ * State of the mock JVM. The objects are never collected, like objects
+ * that are still referenced from Java, and freed at the end.
+ */
+static struct {
+	struct _jobject *objects;
+	unsigned int nallocations;  // Objects created for Java code
+	unsigned int nlocals;       // Live local references
+	unsigned int nglobals;      // Live global references
+	unsigned int frames[16];
+	unsigned int nframes;
+	jthrowable exception;       // Pending exception
+
+	// The Java callback.
+	jobject kept;               // First buffer, kept by the callback
+	unsigned int nwrites;
+	unsigned int nioctls;
+	unsigned int nbytes;
+	unsigned int hash;
+} mock;
+
+static struct _jmethodID methods[32];
+static unsigned int nmethods = 0;
+
+static unsigned int
+hash_update (unsigned int hash, const unsigned char data[], size_t size)
+{
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= data[i];
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static jobject
+mock_object (mock_type_t type, const char *name, jlong capacity)
+{
+	jobject obj = calloc (1, sizeof (struct _jobject));
+	if (obj == NULL)
+		abort ();
+
+	obj->type = type;
+	obj->name = name;
+	obj->capacity = capacity;
+	if (capacity) {
+		obj->data = calloc (capacity, 1);
+		if (obj->data == NULL)
+			abort ();
+	}
+
+	obj->next = mock.objects;
+	mock.objects = obj;
+
+	mock.nlocals++;
+
+	return obj;
+}
+
+static jclass
+mock_FindClass (JNIEnv *env, const char *name)
+{
+	return mock_object (MOCK_CLASS, name, 0);
+}
+
+static jthrowable
+mock_ExceptionOccurred (JNIEnv *env)
+{
+	if (mock.exception)
+		mock.nlocals++;
+
+	return mock.exception;
+}
+
+static void
+mock_ExceptionClear (JNIEnv *env)
+{
+	mock.exception = NULL;
+}
+
+static jboolean
+mock_IsInstanceOf (JNIEnv *env, jobject obj, jclass cls)
+{
+	return obj && cls && strcmp (obj->name, cls->name) == 0;
+}
+
+static jint
+mock_PushLocalFrame (JNIEnv *env, jint capacity)
+{
+	if (mock.nframes == sizeof (mock.frames) / sizeof (mock.frames[0]))
+		return -1;
+
+	mock.frames[mock.nframes++] = mock.nlocals;
+
+	return 0;
+}
+
+static jobject
+mock_PopLocalFrame (JNIEnv *env, jobject result)
+{
+	mock.nlocals = mock.frames[--mock.nframes];
+	if (result)
+		mock.nlocals++;
+
+	return result;
+}
+
+static jobject
+mock_NewGlobalRef (JNIEnv *env, jobject obj)
+{
+	mock.nglobals++;
+
+	return obj;
+}
+
+static void
+mock_DeleteGlobalRef (JNIEnv *env, jobject obj)
+{
+	mock.nglobals--;
+}
+
+static void
+mock_DeleteLocalRef (JNIEnv *env, jobject obj)
+{
+	if (obj)
+		mock.nlocals--;
+}
+
+static jclass
+mock_GetObjectClass (JNIEnv *env, jobject obj)
+{
+	return mock_object (MOCK_CLASS, obj->name, 0);
+}
+
+static jmethodID
+mock_GetMethodID (JNIEnv *env, jclass cls, const char *name, const char *signature)
+{
+	for (unsigned int i = 0; i < nmethods; ++i) {
+		if (strcmp (methods[i].name, name) == 0 && strcmp (methods[i].signature, signature) == 0)
+			return &methods[i];
+	}
+
+	if (nmethods == sizeof (methods) / sizeof (methods[0]))
+		abort ();
+
+	methods[nmethods].name = name;
+	methods[nmethods].signature = signature;
+
+	return &methods[nmethods++];
+}
+
+static jobject
+mock_CallObjectMethod (JNIEnv *env, jobject obj, jmethodID method, ...)
+{
+	return NULL;
+}
+
+static jint
+mock_CallIntMethod (JNIEnv *env, jobject obj, jmethodID method, ...)
+{
+	return 0;
+}
+
+/*
+ * The Java callback. The buffer methods use the direct buffer in place,
+ * without allocating.
+ */
+static void
+mock_CallVoidMethod (JNIEnv *env, jobject obj, jmethodID method, ...)
+{
+	va_list ap;
+
+	va_start (ap, method);
+
+	if (strcmp (method->signature, "(Ljava/nio/ByteBuffer;I)V") == 0) {
+		jobject buffer = va_arg (ap, jobject);
+		jint size = va_arg (ap, jint);
+
+		if (mock.kept == NULL)
+			mock.kept = buffer;
+
+		mock.hash = hash_update (mock.hash, buffer->data, size);
+		mock.nbytes += size;
+		mock.nwrites++;
+	} else if (strcmp (method->signature, "(ILjava/nio/ByteBuffer;I)V") == 0) {
+		unsigned int request = va_arg (ap, jint);
+		jobject buffer = va_arg (ap, jobject);
+		jint size = va_arg (ap, jint);
+
+		mock.nioctls++;
+
+		if (request == DC_IOCTL_BLE_GET_MTU && size == sizeof (unsigned int)) {
+			unsigned int value = MTU;
+			memcpy (buffer->data, &value, sizeof (value));
+		} else if (mock.exception == NULL) {
+			static struct _jobject unsupported = {
+				MOCK_EXCEPTION, "java/lang/UnsupportedOperationException", NULL, 0, 0, NULL
+			};
+			mock.exception = &unsupported;
+		}
+	}
+
+	va_end (ap);
+}
+
+static jmethodID
+mock_GetStaticMethodID (JNIEnv *env, jclass cls, const char *name, const char *signature)
+{
+	return mock_GetMethodID (env, cls, name, signature);
+}
+
+static jobject
+mock_CallStaticObjectMethod (JNIEnv *env, jclass cls, jmethodID method, ...)
+{
+	va_list ap;
+	jobject result = NULL;
+
+	va_start (ap, method);
+
+	if (strcmp (cls->name, "java/nio/ByteBuffer") == 0 && strcmp (method->name, "allocateDirect") == 0) {
+		jint capacity = va_arg (ap, jint);
+		result = mock_object (MOCK_BUFFER, "java/nio/DirectByteBuffer", capacity);
+		mock.nallocations++;
+	}
+
+	va_end (ap);
+
+	return result;
+}
+
+static jfieldID
+mock_GetFieldID (JNIEnv *env, jclass cls, const char *name, const char *signature)
+{
+	return NULL;
+}
+
+static void
+mock_SetLongField (JNIEnv *env, jobject obj, jfieldID field, jlong value)
+{
+	obj->field = value;
+}
+
+static jsize
+mock_GetArrayLength (JNIEnv *env, jarray array)
+{
+	return array->capacity;
+}
+
+static void
+mock_GetByteArrayRegion (JNIEnv *env, jbyteArray array, jsize start, jsize len, jbyte *buf)
+{
+	memcpy (buf, array->data + start, len);
+}
+
+static jlongArray
+mock_NewLongArray (JNIEnv *env, jsize length)
+{
+	mock.nallocations++;
+
+	return mock_object (MOCK_LONGARRAY, "[J", length * sizeof (jlong));
+}
+
+static void
+mock_SetLongArrayRegion (JNIEnv *env, jlongArray array, jsize start, jsize len, const jlong *buf)
+{
+	memcpy (array->data + start * sizeof (jlong), buf, len * sizeof (jlong));
+}
+
+static void *
+mock_GetDirectBufferAddress (JNIEnv *env, jobject buffer)
+{
+	return buffer->type == MOCK_BUFFER ? buffer->data : NULL;
+}
+
+static jlong
+mock_GetDirectBufferCapacity (JNIEnv *env, jobject buffer)
+{
+	return buffer->type == MOCK_BUFFER ? buffer->capacity : -1;
+}
+
+static const struct JNINativeInterface_ functions = {
+	.FindClass = mock_FindClass,
+	.ExceptionOccurred = mock_ExceptionOccurred,
+	.ExceptionClear = mock_ExceptionClear,
+	.IsInstanceOf = mock_IsInstanceOf,
+	.PushLocalFrame = mock_PushLocalFrame,
+	.PopLocalFrame = mock_PopLocalFrame,
+	.NewGlobalRef = mock_NewGlobalRef,
+	.DeleteGlobalRef = mock_DeleteGlobalRef,
+	.DeleteLocalRef = mock_DeleteLocalRef,
+	.GetObjectClass = mock_GetObjectClass,
+	.GetMethodID = mock_GetMethodID,
+	.CallObjectMethod = mock_CallObjectMethod,
+	.CallIntMethod = mock_CallIntMethod,
+	.CallVoidMethod = mock_CallVoidMethod,
+	.GetStaticMethodID = mock_GetStaticMethodID,
+	.CallStaticObjectMethod = mock_CallStaticObjectMethod,
+	.GetFieldID = mock_GetFieldID,
+	.SetLongField = mock_SetLongField,
+	.GetArrayLength = mock_GetArrayLength,
+	.GetByteArrayRegion = mock_GetByteArrayRegion,
+	.NewLongArray = mock_NewLongArray,
+	.SetLongArrayRegion = mock_SetLongArrayRegion,
+	.GetDirectBufferAddress = mock_GetDirectBufferAddress,
+	.GetDirectBufferCapacity = mock_GetDirectBufferCapacity,
+};
+
+static int
+check (int condition, const char *message)
+{
+	if (!condition)
+		fprintf (stderr, "FAIL: %s\n", message);
+
+	return condition;
+}
+
+/*
+ * Sends count commands of 1 to 32 bytes, like the page reads of a chatty
+ * protocol, and an ioctl after every command.
+ */
+static int
+replay_commands (dc_iostream_t *iostream, unsigned int count, unsigned int *hash, unsigned int *nunsupported)
+{
+	for (unsigned int i = 0; i < count; ++i) {
+		unsigned char command[32];
+		size_t size = 1 + i % sizeof (command);
+		for (size_t j = 0; j < size; ++j)
+			command[j] = (i * 31 + j) & 0xFF;
+
+		size_t actual = 0;
+		dc_status_t status = dc_iostream_write (iostream, command, size, &actual);
+		if (status != DC_STATUS_SUCCESS || actual != size) {
+			fprintf (stderr, "FAIL: write %u returned %d\n", i, status);
+			return 0;
+		}
+
+		*hash = hash_update (*hash, command, size);
+
+		if (i % 2 == 0) {
+			unsigned int mtu = 0;
+			status = dc_iostream_ioctl (iostream, DC_IOCTL_BLE_GET_MTU, &mtu, sizeof (mtu));
+			if (status != DC_STATUS_SUCCESS || mtu != MTU) {
+				fprintf (stderr, "FAIL: ioctl %u returned %d (mtu %u)\n", i, status, mtu);
+				return 0;
+			}
+		} else {
+			unsigned int priority = DC_BLE_PRIORITY_HIGH;
+			status = dc_iostream_ioctl (iostream, DC_IOCTL_BLE_SET_PRIORITY, &priority, sizeof (priority));
+			if (status != DC_STATUS_UNSUPPORTED) {
+				fprintf (stderr, "FAIL: unsupported ioctl %u returned %d\n", i, status);
+				return 0;
+			}
+			(*nunsupported)++;
+		}
+	}
+
+	return 1;
+}
+
+typedef struct reader_t {
+	dc_iostream_t *iostream;
+	dc_status_t status;
+	size_t actual;
+	int done;
+} reader_t;
+
+static void *
+reader_thread (void *userdata)
+{
+	reader_t *reader = (reader_t *) userdata;
+	unsigned char data[QUEUE_CAPACITY];
+
+	reader->status = dc_iostream_read (reader->iostream, data, sizeof (data), &reader->actual);
+	__atomic_store_n (&reader->done, 1, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+static void
+packet_fill (unsigned char data[], size_t size, unsigned int seed)
+{
+	for (size_t i = 0; i < size; ++i)
+		data[i] = (seed * 131 + i * 7) & 0xFF;
+}
+
+/*
+ * Reads one packet, and compares it with the expected one.
+ */
+static int
+queue_expect (dc_iostream_t *iostream, unsigned int seed, size_t size)
+{
+	unsigned char expected[QUEUE_CAPACITY], data[QUEUE_CAPACITY];
+	size_t actual = 0;
+
+	packet_fill (expected, size, seed);
+
+	dc_status_t status = dc_iostream_read (iostream, data, sizeof (data), &actual);
+
+	return status == DC_STATUS_SUCCESS && actual == size && memcmp (data, expected, size) == 0;
+}
+
+static jboolean
+queue_push (JNIEnv *env, jlong queue, jobject buffer, unsigned int seed, size_t size)
+{
+	packet_fill (buffer->data, size, seed);
+
+	return Java_org_libdivecomputer_Custom_Push (env, NULL, queue, buffer, 0, size);
+}
+
+/*
+ * Opens a stream in push mode. Returns the stream, and the handle the
+ * Java object keeps for pushing.
+ */
+static dc_iostream_t *
+queue_open (JNIEnv *env, dc_context_t *context, jobject callback, jlong *queue)
+{
+	jobject custom = mock_object (MOCK_CALLBACK, "org/libdivecomputer/Custom", 0);
+
+	dc_iostream_t *iostream = (dc_iostream_t *) Java_org_libdivecomputer_Custom_OpenQueue (env, custom, (jlong) context, DC_TRANSPORT_BLE, callback, QUEUE_CAPACITY);
+
+	*queue = custom->field;
+
+	return iostream;
+}
+
+static int
+replay_queue (JNIEnv *env, dc_context_t *context, unsigned int count)
+{
+	int ok = 1;
+
+	jobject callback = mock_object (MOCK_CALLBACK, "org/libdivecomputer/Callback", 0);
+	jobject buffer = mock_object (MOCK_BUFFER, "java/nio/DirectByteBuffer", QUEUE_CAPACITY);
+
+	jobject custom = mock_object (MOCK_CALLBACK, "org/libdivecomputer/Custom", 0);
+	ok &= check (Java_org_libdivecomputer_Custom_OpenQueue (env, custom, (jlong) context, DC_TRANSPORT_BLE, callback, 2) == 0,
+		"a queue without room for a packet was accepted");
+
+	jlong queue = 0;
+	dc_iostream_t *iostream = queue_open (env, context, callback, &queue);
+	if (iostream == NULL || queue == 0) {
+		fprintf (stderr, "FAIL: failed to open the queue\n");
+		return 0;
+	}
+
+	dc_iostream_set_timeout (iostream, 0);
+
+	size_t actual = 0;
+	unsigned char data[QUEUE_CAPACITY];
+	ok &= check (dc_iostream_read (iostream, data, sizeof (data), &actual) == DC_STATUS_TIMEOUT && actual == 0,
+		"a read from the empty queue did not time out");
+
+	// Invalid packets.
+	ok &= check (!Java_org_libdivecomputer_Custom_Push (env, NULL, queue, buffer, 0, 0), "an empty packet was queued");
+	ok &= check (!Java_org_libdivecomputer_Custom_Push (env, NULL, queue, buffer, 1, QUEUE_CAPACITY), "a packet past the end of the buffer was queued");
+	ok &= check (!Java_org_libdivecomputer_Custom_Push (env, NULL, queue, buffer, -1, 1), "a packet before the start of the buffer was queued");
+	ok &= check (!queue_push (env, queue, buffer, 0, QUEUE_CAPACITY - 1), "a packet larger than the queue was queued");
+
+	// Pairs of packets of varying size, so the ring wraps at every offset,
+	// in the middle of the headers as well as the data. The second packet
+	// is only accepted if both fit.
+	unsigned int position = 0, nsplit_header = 0, nsplit_data = 0, nfull = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		size_t first = 1 + (i * 7) % 40;
+		size_t second = 1 + (i * 13) % 30;
+		int fits = 2 * 2 + first + second <= QUEUE_CAPACITY;
+
+		if (!queue_push (env, queue, buffer, 2 * i, first)) {
+			fprintf (stderr, "FAIL: packet %u was not queued\n", i);
+			return 0;
+		}
+		if (queue_push (env, queue, buffer, 2 * i + 1, second) != fits) {
+			fprintf (stderr, "FAIL: packet %u was %s\n", i, fits ? "not queued" : "queued in a full queue");
+			return 0;
+		}
+
+		size_t sizes[] = {first, second};
+		for (unsigned int j = 0; j < 1u + fits; ++j) {
+			if ((position + 1) % QUEUE_CAPACITY == 0)
+				nsplit_header++;
+			else if ((position + 2) % QUEUE_CAPACITY + sizes[j] > QUEUE_CAPACITY)
+				nsplit_data++;
+			position = (position + 2 + sizes[j]) % QUEUE_CAPACITY;
+		}
+		nfull += !fits;
+
+		size_t available = 0;
+		dc_iostream_get_available (iostream, &available);
+		if (available != first + (fits ? second : 0)) {
+			fprintf (stderr, "FAIL: %zu bytes available after packet %u\n", available, i);
+			return 0;
+		}
+
+		if (!queue_expect (iostream, 2 * i, first) ||
+			(fits && !queue_expect (iostream, 2 * i + 1, second))) {
+			fprintf (stderr, "FAIL: packet %u was not read back\n", i);
+			return 0;
+		}
+	}
+
+	ok &= check (nsplit_header && nsplit_data && nfull, "the packets did not cover the wrap point and a full queue");
+
+	// A packet larger than the read is truncated, and the rest of it
+	// dropped.
+	queue_push (env, queue, buffer, 1000, 30);
+	queue_push (env, queue, buffer, 1001, 5);
+	unsigned char expected[30];
+	packet_fill (expected, sizeof (expected), 1000);
+	dc_status_t status = dc_iostream_read (iostream, data, 10, &actual);
+	ok &= check (status == DC_STATUS_IO && actual == 10 && memcmp (data, expected, 10) == 0,
+		"a long packet was not truncated");
+	ok &= check (queue_expect (iostream, 1001, 5), "the packet after a truncated one was lost");
+
+	// Purging the input empties the queue.
+	queue_push (env, queue, buffer, 1002, 20);
+	queue_push (env, queue, buffer, 1003, 20);
+	dc_iostream_purge (iostream, DC_DIRECTION_INPUT);
+	size_t available = 0;
+	dc_iostream_get_available (iostream, &available);
+	ok &= check (available == 0 && dc_iostream_read (iostream, data, sizeof (data), &actual) == DC_STATUS_TIMEOUT,
+		"purging did not empty the queue");
+	ok &= check (queue_push (env, queue, buffer, 1004, 40) && queue_expect (iostream, 1004, 40),
+		"the queue was not usable after purging");
+
+	// Closing wakes a reader blocked without a timeout.
+	reader_t reader = {iostream, DC_STATUS_SUCCESS, 0, 0};
+	pthread_t thread;
+	dc_iostream_set_timeout (iostream, -1);
+	if (pthread_create (&thread, NULL, reader_thread, &reader) != 0) {
+		fprintf (stderr, "FAIL: failed to start the reader\n");
+		return 0;
+	}
+
+	usleep (100000);
+	ok &= check (!__atomic_load_n (&reader.done, __ATOMIC_ACQUIRE), "the reader did not block");
+
+	dc_iostream_close (iostream);
+	pthread_join (thread, NULL);
+	ok &= check (reader.status == DC_STATUS_TIMEOUT && reader.actual == 0, "the blocked reader was not woken by the close");
+
+	// The Java object still owns the queue, which rejects the packets.
+	ok &= check (!queue_push (env, queue, buffer, 1005, 10), "a packet was queued after the close");
+	Java_org_libdivecomputer_Custom_Release (env, NULL, queue);
+
+	// The other order: the Java object releases the queue first.
+	iostream = queue_open (env, context, callback, &queue);
+	if (iostream == NULL || queue == 0) {
+		fprintf (stderr, "FAIL: failed to open the queue\n");
+		return 0;
+	}
+	ok &= check (queue_push (env, queue, buffer, 1006, 10), "a packet was not queued");
+	Java_org_libdivecomputer_Custom_Release (env, NULL, queue);
+	dc_iostream_set_timeout (iostream, 0);
+	ok &= check (queue_expect (iostream, 1006, 10), "a packet was lost after the release");
+	dc_iostream_close (iostream);
+
+	return ok;
+}
+
+int
+main (int argc, char *argv[])
+{
+	unsigned int count = 10000;
+	int ok = 1;
+
+	int opt = 0;
+	while ((opt = getopt (argc, argv, "n:")) != -1) {
+		switch (opt) {
+		case 'n':
+			count = strtoul (optarg, NULL, 10);
+			break;
+		default:
+			fprintf (stderr, "Usage: %s [-n count]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	JNIEnv env = &functions;
+	JNIEnv *penv = &env;
+
+	dc_context_t *context = NULL;
+	if (dc_context_new (&context) != DC_STATUS_SUCCESS) {
+		fprintf (stderr, "Failed to create the context.\n");
+		return EXIT_FAILURE;
+	}
+
+	jobject callback = mock_object (MOCK_CALLBACK, "org/libdivecomputer/Callback", 0);
+	jobject custom = mock_object (MOCK_CALLBACK, "org/libdivecomputer/Custom", 0);
+
+	dc_iostream_t *iostream = (dc_iostream_t *) Java_org_libdivecomputer_Custom_Open (penv, custom, (jlong) context, DC_TRANSPORT_BLE, callback);
+	if (iostream == NULL) {
+		fprintf (stderr, "Failed to open the custom iostream.\n");
+		return EXIT_FAILURE;
+	}
+
+	unsigned int nallocations = mock.nallocations;
+	unsigned int nlocals = mock.nlocals;
+	unsigned int hash = 2166136261u;
+	unsigned int nunsupported = 0;
+	mock.hash = hash;
+
+	// The small commands fit in the preallocated buffer.
+	if (!replay_commands (iostream, count, &hash, &nunsupported))
+		return EXIT_FAILURE;
+
+	ok &= check (mock.nallocations == nallocations, "small writes and ioctls allocated Java objects");
+	ok &= check (mock.nlocals == nlocals, "small writes and ioctls leaked local references");
+
+	// A large write grows the buffer once.
+	jobject kept = mock.kept;
+	jlong keptsize = kept ? kept->capacity : 0;
+	unsigned char large[3000];
+	for (size_t i = 0; i < sizeof (large); ++i)
+		large[i] = i & 0xFF;
+
+	size_t actual = 0;
+	dc_status_t status = dc_iostream_write (iostream, large, sizeof (large), &actual);
+	ok &= check (status == DC_STATUS_SUCCESS && actual == sizeof (large), "large write failed");
+	hash = hash_update (hash, large, sizeof (large));
+
+	ok &= check (mock.nallocations == nallocations + 1, "the buffer did not grow exactly once");
+
+	// The buffer kept by the callback is a different, still valid object.
+	// Its memory belongs to the mock JVM, so the sanitizers report it if
+	// the bindings free it.
+	ok &= check (kept != NULL && kept->capacity == keptsize, "the callback did not receive a buffer");
+	ok &= check (mock.kept == kept && kept->data != NULL, "the kept buffer was invalidated");
+
+	if (!replay_commands (iostream, count, &hash, &nunsupported))
+		return EXIT_FAILURE;
+
+	ok &= check (mock.nallocations == nallocations + 1, "writes after the growth allocated Java objects");
+	ok &= check (mock.nlocals == nlocals, "the writes leaked local references");
+	ok &= check (mock.hash == hash, "the callback received different data");
+	ok &= check (mock.nwrites == 2 * count + 1, "wrong number of callback writes");
+	ok &= check (mock.nioctls == 2 * count, "wrong number of callback ioctls");
+
+	jlongArray array = Java_org_libdivecomputer_Custom_GetCounters (penv, NULL);
+	jlong counters[3] = {0};
+	if (array)
+		memcpy (counters, array->data, sizeof (counters));
+
+	ok &= check (counters[0] == 2 * count + 1, "wrong write counter");
+	ok &= check (counters[1] == 2 * count, "wrong ioctl counter");
+	ok &= check (counters[2] == 2, "wrong allocation counter");
+
+	dc_iostream_close (iostream);
+
+	ok &= replay_queue (penv, context, count);
+
+	dc_context_free (context);
+
+	ok &= check (mock.nglobals == 0, "global references leaked");
+
+	printf ("%u writes (%u bytes), %u ioctls (%u unsupported), %lld buffer allocations\n",
+		mock.nwrites, mock.nbytes, mock.nioctls, nunsupported,
+		(long long) counters[2]);
+
+	while (mock.objects) {
+		jobject next = mock.objects->next;
+		free (mock.objects->data);
+		free (mock.objects);
+		mock.objects = next;
+	}
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
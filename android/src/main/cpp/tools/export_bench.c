@@ -0,0 +1,232 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * Export benchmark
+ *
+ * Exports the synthetic seed dives (see parser_seeds.h) as a single UDDF
+ * and Subsurface document, with dc_export_buffer and dc_export_fd, and
+ * reports the throughput in bytes/s of output. The seeds that don't
+ * parse, or that the exporter rejects, are left out.
+ *
+ *   dc_export_bench [-r rounds]
+ *
+ * The check fails if an export fails, or if the document written to the
+ * file descriptor differs from the one in the buffer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/parser.h>
+#include <libdivecomputer/export.h>
+
+#include "parser_seeds.h"
+
+typedef struct bench_dive_t {
+	unsigned char *data;
+	dc_parser_t *parser;
+} bench_dive_t;
+
+static unsigned long long
+now (void)
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/*
+ * Creates a parser for every seed that can be exported on its own.
+ */
+static unsigned int
+bench_dives (dc_context_t *context, bench_dive_t **result)
+{
+	dc_descriptor_t **descriptors = NULL;
+	unsigned int ndescriptors = parser_seed_descriptors (&descriptors);
+
+	bench_dive_t *dives = (bench_dive_t *) calloc (ndescriptors * PARSER_SEED_COUNT + 1, sizeof (bench_dive_t));
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	if (dives == NULL || buffer == NULL) {
+		free (dives);
+		dc_buffer_free (buffer);
+		return 0;
+	}
+
+	unsigned int count = 0;
+	for (unsigned int i = 0; i < ndescriptors; ++i) {
+		for (unsigned int j = 0; j < PARSER_SEED_COUNT; ++j) {
+			size_t size = parser_seed (i, j, NULL);
+			unsigned char *data = (unsigned char *) malloc (size);
+			if (data == NULL)
+				continue;
+			parser_seed (i, j, data);
+
+			dc_parser_t *parser = NULL;
+			if (dc_parser_new2 (&parser, context, descriptors[i], data, size) != DC_STATUS_SUCCESS) {
+				free (data);
+				continue;
+			}
+
+			dc_buffer_clear (buffer);
+			if (dc_export_buffer (DC_EXPORT_UDDF, &parser, 1, buffer) != DC_STATUS_SUCCESS ||
+				dc_export_buffer (DC_EXPORT_SUBSURFACE, &parser, 1, buffer) != DC_STATUS_SUCCESS) {
+				dc_parser_destroy (parser);
+				free (data);
+				continue;
+			}
+
+			dives[count].data = data;
+			dives[count].parser = parser;
+			count++;
+		}
+	}
+
+	dc_buffer_free (buffer);
+
+	*result = dives;
+
+	return count;
+}
+
+/*
+ * Exports the dives to the buffer and to a temporary file, and compares
+ * the two documents. Returns the size of the document, or zero on error.
+ */
+static size_t
+bench_format (dc_export_format_t format, const char *name, dc_parser_t *parsers[], unsigned int count, unsigned int rounds)
+{
+	size_t size = 0;
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	unsigned char *data = NULL;
+	FILE *fp = tmpfile ();
+	if (buffer == NULL || fp == NULL) {
+		fprintf (stderr, "Failed to create the output.\n");
+		goto error;
+	}
+
+	unsigned long long tbuffer = 0, tfd = 0;
+	for (unsigned int round = 0; round < rounds; ++round) {
+		dc_buffer_clear (buffer);
+		unsigned long long start = now ();
+		dc_status_t status = dc_export_buffer (format, parsers, count, buffer);
+		unsigned long long elapsed = now () - start;
+		if (status != DC_STATUS_SUCCESS) {
+			fprintf (stderr, "%s: dc_export_buffer failed (%d).\n", name, status);
+			goto error;
+		}
+		if (round == 0 || elapsed < tbuffer)
+			tbuffer = elapsed;
+
+		if (ftruncate (fileno (fp), 0) != 0 || lseek (fileno (fp), 0, SEEK_SET) != 0) {
+			fprintf (stderr, "Failed to truncate the output.\n");
+			goto error;
+		}
+		start = now ();
+		status = dc_export_fd (format, parsers, count, fileno (fp));
+		elapsed = now () - start;
+		if (status != DC_STATUS_SUCCESS) {
+			fprintf (stderr, "%s: dc_export_fd failed (%d).\n", name, status);
+			goto error;
+		}
+		if (round == 0 || elapsed < tfd)
+			tfd = elapsed;
+	}
+
+	// The file holds the same document as the buffer.
+	size = dc_buffer_get_size (buffer);
+	data = (unsigned char *) malloc (size + 1);
+	off_t length = lseek (fileno (fp), 0, SEEK_END);
+	if (data == NULL || length != (off_t) size || lseek (fileno (fp), 0, SEEK_SET) != 0 ||
+		read (fileno (fp), data, size + 1) != (ssize_t) size ||
+		memcmp (data, dc_buffer_get_data (buffer), size) != 0) {
+		fprintf (stderr, "%s: the dc_export_fd output differs from dc_export_buffer.\n", name);
+		size = 0;
+		goto error;
+	}
+
+	printf ("%-10s %10zu bytes  buffer %7.1f MB/s  fd %7.1f MB/s\n", name, size,
+		size * 1000.0 / tbuffer, size * 1000.0 / tfd);
+
+error:
+	free (data);
+	if (fp)
+		fclose (fp);
+	dc_buffer_free (buffer);
+	return size;
+}
+
+int
+main (int argc, char *argv[])
+{
+	unsigned int rounds = 5;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "r:h")) != -1) {
+		switch (opt) {
+		case 'r':
+			rounds = strtoul (optarg, NULL, 10);
+			break;
+		default:
+			fprintf (stderr, "Usage: %s [-r rounds]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (rounds == 0)
+		rounds = 1;
+
+	dc_context_t *context = NULL;
+	dc_context_new (&context);
+	dc_context_set_loglevel (context, DC_LOGLEVEL_NONE);
+
+	bench_dive_t *dives = NULL;
+	unsigned int count = bench_dives (context, &dives);
+	dc_parser_t **parsers = (dc_parser_t **) calloc (count + 1, sizeof (dc_parser_t *));
+	if (count == 0 || parsers == NULL) {
+		fprintf (stderr, "No dives to export.\n");
+		return EXIT_FAILURE;
+	}
+
+	for (unsigned int i = 0; i < count; ++i)
+		parsers[i] = dives[i].parser;
+
+	printf ("%u dives, best of %u rounds\n", count, rounds);
+
+	int ok = 1;
+	ok &= bench_format (DC_EXPORT_UDDF, "UDDF", parsers, count, rounds) != 0;
+	ok &= bench_format (DC_EXPORT_SUBSURFACE, "Subsurface", parsers, count, rounds) != 0;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		dc_parser_destroy (dives[i].parser);
+		free (dives[i].data);
+	}
+	free (parsers);
+	free (dives);
+	dc_context_free (context);
+
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,181 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * Standalone driver for the parser fuzz target, for compilers without
+ * libFuzzer. Without arguments it runs the synthetic seeds of every
+ * descriptor, and a fixed set of mutations of them, which makes it a
+ * regression test when built with the sanitizers. Files given on the
+ * command line (e.g. crash reproducers) are run as they are.
+ *
+ *   dc_parser_fuzz_seeds [-m mutations] [-w directory] [file...]
+ *
+ * With -w the seeds are written to the directory instead, as the initial
+ * corpus for the libFuzzer build.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "parser_seeds.h"
+
+int
+LLVMFuzzerTestOneInput (const uint8_t *data, size_t size);
+
+static int
+run_file (const char *filename)
+{
+	FILE *fp = fopen (filename, "rb");
+	if (fp == NULL) {
+		fprintf (stderr, "Failed to open '%s'.\n", filename);
+		return -1;
+	}
+
+	unsigned char *data = NULL;
+	size_t size = 0, capacity = 0;
+	while (1) {
+		if (size == capacity) {
+			capacity = capacity ? capacity * 2 : 4096;
+			unsigned char *tmp = (unsigned char *) realloc (data, capacity);
+			if (tmp == NULL)
+				break;
+			data = tmp;
+		}
+		size_t n = fread (data + size, 1, capacity - size, fp);
+		if (n == 0)
+			break;
+		size += n;
+	}
+	fclose (fp);
+
+	LLVMFuzzerTestOneInput (data, size);
+	free (data);
+
+	return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+	const char *directory = NULL;
+	unsigned int nmutations = 8;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "m:w:h")) != -1) {
+		switch (opt) {
+		case 'm':
+			nmutations = strtoul (optarg, NULL, 0);
+			break;
+		case 'w':
+			directory = optarg;
+			break;
+		default:
+			fprintf (stderr, "Usage: %s [-m mutations] [-w directory] [file...]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind < argc) {
+		for (int i = optind; i < argc; ++i) {
+			if (run_file (argv[i]) != 0)
+				return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	dc_descriptor_t **descriptors = NULL;
+	unsigned int ndescriptors = parser_seed_descriptors (&descriptors);
+	if (ndescriptors == 0) {
+		fprintf (stderr, "No descriptors.\n");
+		return EXIT_FAILURE;
+	}
+
+	unsigned int ninputs = 0;
+	for (unsigned int i = 0; i < ndescriptors; ++i) {
+		for (unsigned int j = 0; j < PARSER_SEED_COUNT; ++j) {
+			size_t size = parser_seed (i, j, NULL);
+			unsigned char *input = (unsigned char *) malloc (size + 2);
+			if (input == NULL)
+				return EXIT_FAILURE;
+
+			input[0] = i & 0xFF;
+			input[1] = (i >> 8) & 0xFF;
+			parser_seed (i, j, input + 2);
+
+			if (directory) {
+				char filename[1024];
+				snprintf (filename, sizeof (filename), "%s/seed-%03u-%u", directory, i, j);
+				FILE *fp = fopen (filename, "wb");
+				if (fp == NULL || fwrite (input, 1, size + 2, fp) != size + 2) {
+					fprintf (stderr, "Failed to write '%s'.\n", filename);
+					if (fp)
+						fclose (fp);
+					free (input);
+					return EXIT_FAILURE;
+				}
+				fclose (fp);
+				free (input);
+				ninputs++;
+				continue;
+			}
+
+			LLVMFuzzerTestOneInput (input, size + 2);
+			ninputs++;
+
+			// Fixed mutations: truncate, and overwrite a few bytes. Every
+			// mutant is a separate allocation of the exact size, so the
+			// sanitizers catch a read past the end.
+			unsigned int state = 0x2545F491u ^ (i << 8) ^ j;
+			for (unsigned int k = 0; k < nmutations; ++k) {
+				state ^= state << 13;
+				state ^= state >> 17;
+				state ^= state << 5;
+
+				size_t length = (k & 1) ? state % (size + 1) : size;
+				unsigned char *mutant = (unsigned char *) malloc (length + 2);
+				if (mutant == NULL)
+					break;
+				memcpy (mutant, input, length + 2);
+
+				for (unsigned int n = 0; n < 4 && length; ++n) {
+					state ^= state << 13;
+					state ^= state >> 17;
+					state ^= state << 5;
+					mutant[2 + state % length] = state >> 24;
+				}
+
+				LLVMFuzzerTestOneInput (mutant, length + 2);
+				free (mutant);
+				ninputs++;
+			}
+
+			free (input);
+		}
+	}
+
+	printf ("%s %u inputs for %u descriptors.\n", directory ? "Wrote" : "Ran", ninputs, ndescriptors);
+
+	return EXIT_SUCCESS;
+}
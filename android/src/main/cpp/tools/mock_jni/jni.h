@@ -0,0 +1,89 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+/*
+ * Mock JNI header
+ *
+ * The subset of the JNI interface used by org_libdivecomputer_Custom.c,
+ * with the names of the real jni.h, so the bindings can be compiled on
+ * the host and run against the mock JNIEnv of custom_replay.c. The
+ * layout of the function table is not the one of a real JVM.
+ */
+
+#ifndef MOCK_JNI_H
+#define MOCK_JNI_H
+
+#include <stdarg.h>
+#include <stdint.h>
+
+typedef uint8_t jboolean;
+typedef int8_t jbyte;
+typedef int32_t jint;
+typedef int64_t jlong;
+typedef jint jsize;
+
+typedef struct _jobject *jobject;
+typedef jobject jclass;
+typedef jobject jthrowable;
+typedef jobject jarray;
+typedef jarray jbyteArray;
+typedef jarray jlongArray;
+
+typedef struct _jfieldID *jfieldID;
+typedef struct _jmethodID *jmethodID;
+
+#define JNI_FALSE 0
+#define JNI_TRUE 1
+
+#define JNIEXPORT
+#define JNICALL
+
+struct JNINativeInterface_;
+typedef const struct JNINativeInterface_ *JNIEnv;
+
+struct JNINativeInterface_ {
+	jclass (*FindClass)(JNIEnv *, const char *);
+	jthrowable (*ExceptionOccurred)(JNIEnv *);
+	void (*ExceptionClear)(JNIEnv *);
+	jboolean (*IsInstanceOf)(JNIEnv *, jobject, jclass);
+	jint (*PushLocalFrame)(JNIEnv *, jint);
+	jobject (*PopLocalFrame)(JNIEnv *, jobject);
+	jobject (*NewGlobalRef)(JNIEnv *, jobject);
+	void (*DeleteGlobalRef)(JNIEnv *, jobject);
+	void (*DeleteLocalRef)(JNIEnv *, jobject);
+	jclass (*GetObjectClass)(JNIEnv *, jobject);
+	jmethodID (*GetMethodID)(JNIEnv *, jclass, const char *, const char *);
+	jobject (*CallObjectMethod)(JNIEnv *, jobject, jmethodID, ...);
+	jint (*CallIntMethod)(JNIEnv *, jobject, jmethodID, ...);
+	void (*CallVoidMethod)(JNIEnv *, jobject, jmethodID, ...);
+	jmethodID (*GetStaticMethodID)(JNIEnv *, jclass, const char *, const char *);
+	jobject (*CallStaticObjectMethod)(JNIEnv *, jclass, jmethodID, ...);
+	jfieldID (*GetFieldID)(JNIEnv *, jclass, const char *, const char *);
+	void (*SetLongField)(JNIEnv *, jobject, jfieldID, jlong);
+	jsize (*GetArrayLength)(JNIEnv *, jarray);
+	void (*GetByteArrayRegion)(JNIEnv *, jbyteArray, jsize, jsize, jbyte *);
+	jlongArray (*NewLongArray)(JNIEnv *, jsize);
+	void (*SetLongArrayRegion)(JNIEnv *, jlongArray, jsize, jsize, const jlong *);
+	void *(*GetDirectBufferAddress)(JNIEnv *, jobject);
+	jlong (*GetDirectBufferCapacity)(JNIEnv *, jobject);
+};
+
+#endif /* MOCK_JNI_H */
@@ -0,0 +1,315 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * Packed samples round trip
+ *
+ * Packs the samples of every seed dive (see parser_seeds.h) with
+ * dc_parser_samples_pack, reads them back with dc_packed_reader_next, and
+ * compares the records with those of dc_parser_samples_foreach_records.
+ * The values must match after quantization to the resolution of the
+ * packed format, with the out of range values clamped.
+ *
+ *   dc_packed_roundtrip [-v]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <unistd.h>
+
+#include <libdivecomputer/buffer.h>
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/parser.h>
+
+#include "parser_seeds.h"
+
+// Resolution of the packed format (units per unit of the record).
+#define DEPTH       1000.0
+#define TEMPERATURE 100.0
+#define PRESSURE    100.0
+#define PPO2        1000.0
+#define CNS         10000.0
+
+typedef struct roundtrip_t {
+	dc_sample_record_t *records;
+	unsigned int count, capacity;
+	int nomemory;
+} roundtrip_t;
+
+static void
+record_cb (const dc_sample_record_t *record, void *userdata)
+{
+	roundtrip_t *state = (roundtrip_t *) userdata;
+
+	if (state->count == state->capacity) {
+		unsigned int capacity = state->capacity ? state->capacity * 2 : 256;
+		dc_sample_record_t *records = (dc_sample_record_t *) realloc (state->records, capacity * sizeof (dc_sample_record_t));
+		if (records == NULL) {
+			state->nomemory = 1;
+			return;
+		}
+		state->records = records;
+		state->capacity = capacity;
+	}
+
+	state->records[state->count++] = *record;
+}
+
+/*
+ * The value the packed format stores for the original value: rounded to
+ * the resolution, and clamped to the range of a signed 32 bit integer.
+ */
+static double
+quantized (double value, double scale)
+{
+	double scaled = value * scale;
+
+	if (scaled >= INT_MAX)
+		return INT_MAX / scale;
+	if (scaled <= INT_MIN)
+		return INT_MIN / scale;
+
+	return (scaled >= 0.0 ? floor (scaled + 0.5) : -floor (0.5 - scaled)) / scale;
+}
+
+static int
+same (double expected, double actual, double scale)
+{
+	// NaN has no packed representation.
+	if (isnan (expected))
+		return 1;
+
+	return fabs (quantized (expected, scale) - actual) <= 1e-9 * (1.0 + fabs (actual));
+}
+
+/*
+ * Compares a record read back with the original. Returns the name of the
+ * first field that differs, or NULL.
+ */
+static const char *
+compare (const dc_sample_record_t *a, const dc_sample_record_t *b)
+{
+	unsigned int fields = a->fields;
+
+	if (a->fields != b->fields)
+		return "fields";
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_TIME)) && a->time != b->time)
+		return "time";
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_DEPTH)) && !same (a->depth, b->depth, DEPTH))
+		return "depth";
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_TEMPERATURE)) && !same (a->temperature, b->temperature, TEMPERATURE))
+		return "temperature";
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_PRESSURE)) {
+		if (a->npressure != b->npressure)
+			return "pressure count";
+		for (unsigned int i = 0; i < a->npressure; ++i) {
+			if (a->pressure[i].tank != b->pressure[i].tank)
+				return "pressure tank";
+			if (!same (a->pressure[i].value, b->pressure[i].value, PRESSURE))
+				return "pressure";
+		}
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_EVENT)) {
+		if (a->nevents != b->nevents)
+			return "event count";
+		for (unsigned int i = 0; i < a->nevents; ++i) {
+			if (a->event[i].type != b->event[i].type ||
+				a->event[i].time != b->event[i].time ||
+				a->event[i].flags != b->event[i].flags ||
+				a->event[i].value != b->event[i].value)
+				return "event";
+		}
+	}
+
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_RBT)) && a->rbt != b->rbt)
+		return "rbt";
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_HEARTBEAT)) && a->heartbeat != b->heartbeat)
+		return "heartbeat";
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_BEARING)) && a->bearing != b->bearing)
+		return "bearing";
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT)) && !same (a->setpoint, b->setpoint, PPO2))
+		return "setpoint";
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_PPO2)) {
+		if (a->nppo2 != b->nppo2)
+			return "ppo2 count";
+		for (unsigned int i = 0; i < a->nppo2; ++i) {
+			if (a->ppo2[i].sensor != b->ppo2[i].sensor)
+				return "ppo2 sensor";
+			if (!same (a->ppo2[i].value, b->ppo2[i].value, PPO2))
+				return "ppo2";
+		}
+	}
+
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_CNS)) && !same (a->cns, b->cns, CNS))
+		return "cns";
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_DECO)) {
+		if (a->deco.type != b->deco.type ||
+			a->deco.time != b->deco.time ||
+			a->deco.tts != b->deco.tts ||
+			!same (a->deco.depth, b->deco.depth, DEPTH))
+			return "deco";
+	}
+
+	if ((fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX)) && a->gasmix != b->gasmix)
+		return "gasmix";
+
+	return NULL;
+}
+
+/*
+ * Returns 1 if the round trip matches, 0 if it doesn't, and -1 if the dive
+ * has no samples to compare.
+ */
+static int
+roundtrip (dc_parser_t *parser, dc_buffer_t *buffer, const char *name, unsigned int seed, int verbose)
+{
+	roundtrip_t state = {NULL, 0, 0, 0};
+	int result = 1;
+
+	if (dc_parser_samples_foreach_records (parser, record_cb, &state) != DC_STATUS_SUCCESS) {
+		free (state.records);
+		return -1;
+	}
+
+	if (state.nomemory) {
+		fprintf (stderr, "%s, seed %u: out of memory\n", name, seed);
+		free (state.records);
+		return 0;
+	}
+
+	dc_status_t status = dc_parser_samples_pack (parser, buffer);
+	if (status != DC_STATUS_SUCCESS) {
+		fprintf (stderr, "%s, seed %u: dc_parser_samples_pack failed (%d)\n", name, seed, status);
+		free (state.records);
+		return 0;
+	}
+
+	dc_packed_reader_t reader;
+	status = dc_packed_reader_init (&reader, dc_buffer_get_data (buffer), dc_buffer_get_size (buffer));
+	if (status != DC_STATUS_SUCCESS) {
+		fprintf (stderr, "%s, seed %u: dc_packed_reader_init failed (%d)\n", name, seed, status);
+		free (state.records);
+		return 0;
+	}
+
+	dc_sample_record_t record;
+	for (unsigned int i = 0; i < state.count; ++i) {
+		status = dc_packed_reader_next (&reader, &record);
+		if (status != DC_STATUS_SUCCESS) {
+			fprintf (stderr, "%s, seed %u: record %u of %u failed (%d)\n", name, seed, i, state.count, status);
+			result = 0;
+			break;
+		}
+
+		const char *field = compare (state.records + i, &record);
+		if (field) {
+			fprintf (stderr, "%s, seed %u: record %u differs (%s)\n", name, seed, i, field);
+			result = 0;
+			break;
+		}
+	}
+
+	if (result && dc_packed_reader_next (&reader, &record) != DC_STATUS_DONE) {
+		fprintf (stderr, "%s, seed %u: more than %u records\n", name, seed, state.count);
+		result = 0;
+	}
+
+	if (result && verbose)
+		printf ("%s, seed %u: %u records in %u bytes\n", name, seed, state.count, (unsigned int) dc_buffer_get_size (buffer));
+
+	free (state.records);
+
+	return result;
+}
+
+int
+main (int argc, char *argv[])
+{
+	int verbose = 0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "v")) != -1) {
+		switch (opt) {
+		case 'v':
+			verbose = 1;
+			break;
+		default:
+			fprintf (stderr, "Usage: %s [-v]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	dc_descriptor_t **descriptors = NULL;
+	unsigned int ndescriptors = parser_seed_descriptors (&descriptors);
+
+	dc_context_t *context = NULL;
+	dc_context_new (&context);
+	dc_context_set_loglevel (context, DC_LOGLEVEL_NONE);
+
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	if (ndescriptors == 0 || buffer == NULL) {
+		fprintf (stderr, "No descriptors.\n");
+		return EXIT_FAILURE;
+	}
+
+	unsigned int ndives = 0, nfailed = 0;
+	for (unsigned int i = 0; i < ndescriptors; ++i) {
+		char name[64];
+		snprintf (name, sizeof (name), "%s %s",
+			dc_descriptor_get_vendor (descriptors[i]),
+			dc_descriptor_get_product (descriptors[i]));
+
+		for (unsigned int j = 0; j < PARSER_SEED_COUNT; ++j) {
+			size_t size = parser_seed (i, j, NULL);
+			unsigned char *data = (unsigned char *) malloc (size);
+			if (data == NULL)
+				continue;
+			parser_seed (i, j, data);
+
+			dc_parser_t *parser = NULL;
+			if (dc_parser_new2 (&parser, context, descriptors[i], data, size) == DC_STATUS_SUCCESS) {
+				int rc = roundtrip (parser, buffer, name, j, verbose);
+				if (rc >= 0)
+					ndives++;
+				if (rc == 0)
+					nfailed++;
+				dc_parser_destroy (parser);
+			}
+
+			free (data);
+		}
+	}
+
+	printf ("%u dives packed and read back, %u mismatches.\n", ndives, nfailed);
+
+	dc_buffer_free (buffer);
+	dc_context_free (context);
+
+	return nfailed || ndives == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * Parses raw dive files on the batch thread pool, and reports the
+ * throughput (dives/s and samples/s), to size re-parse jobs.
+ *
+ *   dc_parse_batch -d "Shearwater Petrel 3" [-j threads] [-r repeat] file...
+ *
+ * Every file contains one raw dive, as downloaded from the device.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/descriptor.h>
+#include <libdivecomputer/iterator.h>
+#include <libdivecomputer/parser.h>
+
+typedef struct batch_stats_t {
+	unsigned int ndives;
+	unsigned int nfailed;
+	unsigned long long nsamples;
+} batch_stats_t;
+
+static void
+usage (const char *name)
+{
+	fprintf (stderr, "Usage: %s -d \"vendor product\" [-j threads] [-r repeat] [-v] file...\n", name);
+}
+
+static double
+now (void)
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static dc_status_t
+find_descriptor (dc_descriptor_t **out, const char *name)
+{
+	dc_iterator_t *iterator = NULL;
+	dc_descriptor_t *descriptor = NULL;
+	dc_status_t rc;
+
+	rc = dc_descriptor_iterator (&iterator);
+	if (rc != DC_STATUS_SUCCESS)
+		return rc;
+
+	while ((rc = dc_iterator_next (iterator, &descriptor)) == DC_STATUS_SUCCESS) {
+		char fullname[128];
+		snprintf (fullname, sizeof (fullname), "%s %s",
+			dc_descriptor_get_vendor (descriptor),
+			dc_descriptor_get_product (descriptor));
+		if (strcasecmp (fullname, name) == 0) {
+			*out = descriptor;
+			dc_iterator_free (iterator);
+			return DC_STATUS_SUCCESS;
+		}
+		dc_descriptor_free (descriptor);
+	}
+
+	dc_iterator_free (iterator);
+	return DC_STATUS_UNSUPPORTED;
+}
+
+static unsigned char *
+read_file (const char *filename, size_t *size)
+{
+	FILE *fp = fopen (filename, "rb");
+	if (fp == NULL)
+		return NULL;
+
+	unsigned char *data = NULL;
+	if (fseek (fp, 0, SEEK_END) == 0) {
+		long length = ftell (fp);
+		if (length > 0 && fseek (fp, 0, SEEK_SET) == 0) {
+			data = (unsigned char *) malloc (length);
+			if (data && fread (data, 1, length, fp) != (size_t) length) {
+				free (data);
+				data = NULL;
+			}
+			*size = length;
+		}
+	}
+
+	fclose (fp);
+	return data;
+}
+
+static void
+batch_cb (unsigned int index, dc_status_t status, const dc_dive_t *dive, void *userdata)
+{
+	batch_stats_t *stats = (batch_stats_t *) userdata;
+
+	(void) index;
+
+	stats->ndives++;
+	if (status != DC_STATUS_SUCCESS) {
+		stats->nfailed++;
+		return;
+	}
+
+	stats->nsamples += dive->nsamples;
+}
+
+int
+main (int argc, char *argv[])
+{
+	const char *name = NULL;
+	unsigned int nthreads = 0;
+	unsigned int repeat = 1;
+	int verbose = 0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "d:j:r:vh")) != -1) {
+		switch (opt) {
+		case 'd':
+			name = optarg;
+			break;
+		case 'j':
+			nthreads = strtoul (optarg, NULL, 0);
+			break;
+		case 'r':
+			repeat = strtoul (optarg, NULL, 0);
+			break;
+		case 'v':
+			verbose = 1;
+			break;
+		default:
+			usage (argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (name == NULL || optind >= argc || repeat == 0) {
+		usage (argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	dc_descriptor_t *descriptor = NULL;
+	if (find_descriptor (&descriptor, name) != DC_STATUS_SUCCESS) {
+		fprintf (stderr, "Unknown device '%s'.\n", name);
+		return EXIT_FAILURE;
+	}
+
+	unsigned int nfiles = argc - optind;
+	unsigned char **blobs = (unsigned char **) calloc (nfiles, sizeof (unsigned char *));
+	size_t *sizes = (size_t *) calloc (nfiles, sizeof (size_t));
+	dc_parser_batch_item_t *items = (dc_parser_batch_item_t *) calloc ((size_t) nfiles * repeat, sizeof (dc_parser_batch_item_t));
+	if (blobs == NULL || sizes == NULL || items == NULL) {
+		fprintf (stderr, "Out of memory.\n");
+		return EXIT_FAILURE;
+	}
+
+	size_t nbytes = 0;
+	for (unsigned int i = 0; i < nfiles; ++i) {
+		blobs[i] = read_file (argv[optind + i], &sizes[i]);
+		if (blobs[i] == NULL) {
+			fprintf (stderr, "Failed to read '%s'.\n", argv[optind + i]);
+			return EXIT_FAILURE;
+		}
+		nbytes += sizes[i];
+	}
+
+	unsigned int count = nfiles * repeat;
+	for (unsigned int i = 0; i < count; ++i) {
+		items[i].family = dc_descriptor_get_type (descriptor);
+		items[i].model = dc_descriptor_get_model (descriptor);
+		items[i].data = blobs[i % nfiles];
+		items[i].size = sizes[i % nfiles];
+	}
+
+	dc_context_t *context = NULL;
+	dc_context_new (&context);
+	dc_context_set_loglevel (context, verbose ? DC_LOGLEVEL_WARNING : DC_LOGLEVEL_NONE);
+
+	batch_stats_t stats = {0, 0, 0};
+	double start = now ();
+	dc_status_t rc = dc_parser_parse_batch (context, items, count, nthreads, batch_cb, &stats);
+	double elapsed = now () - start;
+
+	if (rc != DC_STATUS_SUCCESS) {
+		fprintf (stderr, "Batch failed (%d).\n", rc);
+		return EXIT_FAILURE;
+	}
+
+	if (elapsed <= 0.0)
+		elapsed = 1e-9;
+
+	printf ("Dives:     %u (%u failed)\n", stats.ndives, stats.nfailed);
+	printf ("Samples:   %llu\n", stats.nsamples);
+	printf ("Bytes:     %zu\n", nbytes * repeat);
+	printf ("Elapsed:   %.3f s\n", elapsed);
+	printf ("Dives/s:   %.0f\n", stats.ndives / elapsed);
+	printf ("Samples/s: %.0f\n", stats.nsamples / elapsed);
+
+	dc_context_free (context);
+	dc_descriptor_free (descriptor);
+	for (unsigned int i = 0; i < nfiles; ++i)
+		free (blobs[i]);
+	free (items);
+	free (sizes);
+	free (blobs);
+
+	return stats.nfailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,331 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * Parser benchmark and regression check
+ *
+ * Runs the parser of every descriptor over the synthetic seeds (see
+ * parser_seeds.h), and measures per descriptor the time and the bytes
+ * allocated for dc_parser_new2 and dc_parser_samples_foreach, and the ns
+ * per sample. A checksum of the status and samples of every seed records
+ * the output.
+ *
+ *   dc_parser_bench [-w baseline] [-c baseline] [-t tolerance]
+ *
+ * With -w the results are written as the new baseline. With -c they are
+ * compared against the baseline, and the check fails if the output of a
+ * parser changed, if it allocates more, or if it is more than tolerance
+ * times slower (default 3). The timings depend on the machine, so the
+ * baseline is regenerated whenever the reference machine changes.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/parser.h>
+
+#include "parser_seeds.h"
+
+// Minimum measuring time per seed (nanoseconds), split over the rounds
+#define MIN_TIME 2000000ULL
+#define ROUNDS   5
+// Slack for the timing check, to ignore noise on the fastest parsers
+#define MIN_SLACK 20000.0
+
+typedef struct bench_result_t {
+	unsigned int family;
+	unsigned int model;
+	unsigned int checksum;
+	unsigned long long nsamples;
+	unsigned long long nbytes;
+	double ns;
+	char name[64];
+} bench_result_t;
+
+/*
+ * Allocation counting, with the malloc family wrapped by the linker
+ * (-Wl,--wrap). Only the allocations inside the measured calls count.
+ */
+void *__real_malloc (size_t size);
+void *__real_calloc (size_t nmemb, size_t size);
+void *__real_realloc (void *ptr, size_t size);
+void *__wrap_malloc (size_t size);
+void *__wrap_calloc (size_t nmemb, size_t size);
+void *__wrap_realloc (void *ptr, size_t size);
+
+static int counting = 0;
+static unsigned long long allocated = 0;
+
+void *
+__wrap_malloc (size_t size)
+{
+	if (counting)
+		allocated += size;
+	return __real_malloc (size);
+}
+
+void *
+__wrap_calloc (size_t nmemb, size_t size)
+{
+	if (counting)
+		allocated += nmemb * size;
+	return __real_calloc (nmemb, size);
+}
+
+void *
+__wrap_realloc (void *ptr, size_t size)
+{
+	if (counting)
+		allocated += size;
+	return __real_realloc (ptr, size);
+}
+
+static unsigned long long
+now (void)
+{
+	struct timespec ts;
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void
+sample_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	unsigned long long *nsamples = (unsigned long long *) userdata;
+
+	(void) value;
+
+	if (type == DC_SAMPLE_TIME)
+		(*nsamples)++;
+}
+
+static dc_status_t
+bench_pass (dc_context_t *context, dc_descriptor_t *descriptor, const unsigned char *data, size_t size, unsigned long long *nsamples)
+{
+	dc_parser_t *parser = NULL;
+	dc_status_t status;
+
+	status = dc_parser_new2 (&parser, context, descriptor, data, size);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_parser_samples_foreach (parser, sample_cb, nsamples);
+	dc_parser_destroy (parser);
+
+	return status;
+}
+
+static void
+bench_descriptor (dc_context_t *context, dc_descriptor_t *descriptor, unsigned int index, bench_result_t *result)
+{
+	memset (result, 0, sizeof (*result));
+	result->family = dc_descriptor_get_type (descriptor);
+	result->model = dc_descriptor_get_model (descriptor);
+	snprintf (result->name, sizeof (result->name), "%s %s",
+		dc_descriptor_get_vendor (descriptor),
+		dc_descriptor_get_product (descriptor));
+
+	for (unsigned int i = 0; i < PARSER_SEED_COUNT; ++i) {
+		size_t size = parser_seed (index, i, NULL);
+		unsigned char *data = (unsigned char *) malloc (size);
+		if (data == NULL)
+			continue;
+		parser_seed (index, i, data);
+
+		// The first pass records the output and the allocations.
+		unsigned long long nsamples = 0;
+		allocated = 0;
+		counting = 1;
+		dc_status_t status = bench_pass (context, descriptor, data, size, &nsamples);
+		counting = 0;
+
+		result->checksum = result->checksum * 31 + (unsigned int) (status + 16);
+		result->checksum = result->checksum * 31 + (unsigned int) nsamples;
+		result->nsamples += nsamples;
+		result->nbytes += allocated;
+
+		// The fastest of several rounds, so a preempted round is ignored.
+		double best = 0.0;
+		for (unsigned int round = 0; round < ROUNDS; ++round) {
+			unsigned long long npasses = 0, elapsed = 0;
+			unsigned long long start = now ();
+			do {
+				unsigned long long dummy = 0;
+				bench_pass (context, descriptor, data, size, &dummy);
+				npasses++;
+				elapsed = now () - start;
+			} while (elapsed < MIN_TIME / ROUNDS);
+
+			double ns = (double) elapsed / npasses;
+			if (round == 0 || ns < best)
+				best = ns;
+		}
+
+		result->ns += best;
+
+		free (data);
+	}
+}
+
+static int
+write_results (const char *filename, const bench_result_t *results, unsigned int count)
+{
+	FILE *fp = fopen (filename, "w");
+	if (fp == NULL) {
+		fprintf (stderr, "Failed to open '%s'.\n", filename);
+		return -1;
+	}
+
+	fprintf (fp, "# family\tmodel\tchecksum\tsamples\tbytes\tns\tname\n");
+	for (unsigned int i = 0; i < count; ++i) {
+		const bench_result_t *r = results + i;
+		fprintf (fp, "0x%08x\t%u\t0x%08x\t%llu\t%llu\t%.0f\t%s\n",
+			r->family, r->model, r->checksum, r->nsamples, r->nbytes, r->ns, r->name);
+	}
+
+	fclose (fp);
+	return 0;
+}
+
+static int
+check_results (const char *filename, const bench_result_t *results, unsigned int count, double tolerance)
+{
+	FILE *fp = fopen (filename, "r");
+	if (fp == NULL) {
+		fprintf (stderr, "Failed to open '%s'.\n", filename);
+		return -1;
+	}
+
+	unsigned int nfailed = 0, nchecked = 0;
+	char line[256];
+	while (fgets (line, sizeof (line), fp)) {
+		bench_result_t base;
+		if (line[0] == '#')
+			continue;
+		if (sscanf (line, "%x\t%u\t%x\t%llu\t%llu\t%lf", &base.family, &base.model,
+			&base.checksum, &base.nsamples, &base.nbytes, &base.ns) != 6)
+			continue;
+
+		const bench_result_t *r = NULL;
+		for (unsigned int i = 0; i < count; ++i) {
+			if (results[i].family == base.family && results[i].model == base.model) {
+				r = results + i;
+				break;
+			}
+		}
+		if (r == NULL) {
+			printf ("MISSING  0x%08x %u\n", base.family, base.model);
+			nfailed++;
+			continue;
+		}
+
+		nchecked++;
+		if (r->checksum != base.checksum || r->nsamples != base.nsamples) {
+			printf ("OUTPUT   %s: %llu samples (baseline %llu)\n", r->name, r->nsamples, base.nsamples);
+			nfailed++;
+		}
+		if (r->nbytes > base.nbytes + base.nbytes / 4 + 256) {
+			printf ("ALLOC    %s: %llu bytes (baseline %llu)\n", r->name, r->nbytes, base.nbytes);
+			nfailed++;
+		}
+		if (r->ns > base.ns * tolerance + MIN_SLACK) {
+			printf ("SLOWER   %s: %.0f ns (baseline %.0f)\n", r->name, r->ns, base.ns);
+			nfailed++;
+		}
+	}
+
+	fclose (fp);
+
+	printf ("Checked %u parsers against the baseline, %u regressions.\n", nchecked, nfailed);
+
+	return nfailed || nchecked == 0 ? -1 : 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+	const char *output = NULL, *baseline = NULL;
+	double tolerance = 3.0;
+	int opt;
+
+	while ((opt = getopt (argc, argv, "w:c:t:h")) != -1) {
+		switch (opt) {
+		case 'w':
+			output = optarg;
+			break;
+		case 'c':
+			baseline = optarg;
+			break;
+		case 't':
+			tolerance = strtod (optarg, NULL);
+			break;
+		default:
+			fprintf (stderr, "Usage: %s [-w baseline] [-c baseline] [-t tolerance]\n", argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	dc_descriptor_t **descriptors = NULL;
+	unsigned int ndescriptors = parser_seed_descriptors (&descriptors);
+	bench_result_t *results = (bench_result_t *) calloc (ndescriptors ? ndescriptors : 1, sizeof (bench_result_t));
+	if (ndescriptors == 0 || results == NULL) {
+		fprintf (stderr, "No descriptors.\n");
+		return EXIT_FAILURE;
+	}
+
+	dc_context_t *context = NULL;
+	dc_context_new (&context);
+	dc_context_set_loglevel (context, DC_LOGLEVEL_NONE);
+
+	unsigned long long nsamples = 0;
+	double ns = 0.0;
+	for (unsigned int i = 0; i < ndescriptors; ++i) {
+		bench_result_t *r = results + i;
+		bench_descriptor (context, descriptors[i], i, r);
+		nsamples += r->nsamples;
+		ns += r->ns;
+
+		if (output == NULL && baseline == NULL) {
+			printf ("%-40s %8llu samples %10llu bytes %12.0f ns", r->name, r->nsamples, r->nbytes, r->ns);
+			if (r->nsamples)
+				printf (" %8.1f ns/sample", r->ns / r->nsamples);
+			printf ("\n");
+		}
+	}
+
+	printf ("%u parsers, %llu samples, %.1f ns/sample\n", ndescriptors, nsamples, nsamples ? ns / nsamples : 0.0);
+
+	int rc = 0;
+	if (output)
+		rc = write_results (output, results, ndescriptors);
+	if (baseline && rc == 0)
+		rc = check_results (baseline, results, ndescriptors, tolerance);
+
+	dc_context_free (context);
+	free (results);
+
+	return rc ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,147 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+/*
+ * libFuzzer entry point for the dive parsers
+ *
+ * The first two bytes of the input select the descriptor (little endian,
+ * modulo the number of descriptors), and the remainder is the raw dive.
+ * The dive is parsed with dc_parser_new2, and decoded with the datetime,
+ * dc_parser_samples_foreach and dc_parser_parse_dive.
+ *
+ * The packed sample reader gets the raw input as well, and the packed
+ * samples of the dive, both as they are and with bytes corrupted by the
+ * input.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libdivecomputer/buffer.h>
+#include <libdivecomputer/context.h>
+#include <libdivecomputer/parser.h>
+
+#include "parser_seeds.h"
+
+int
+LLVMFuzzerTestOneInput (const uint8_t *data, size_t size);
+
+static void
+sample_cb (dc_sample_type_t type, const dc_sample_value_t *value, void *userdata)
+{
+	unsigned int *nsamples = (unsigned int *) userdata;
+
+	(void) value;
+
+	if (type == DC_SAMPLE_TIME)
+		(*nsamples)++;
+}
+
+static void
+packed_read_all (const unsigned char *data, size_t size)
+{
+	dc_packed_reader_t reader;
+	dc_sample_record_t record;
+
+	if (dc_packed_reader_init (&reader, data, size) != DC_STATUS_SUCCESS)
+		return;
+
+	while (dc_packed_reader_next (&reader, &record) == DC_STATUS_SUCCESS)
+		;
+}
+
+/*
+ * Reads the packed samples of the dive, and a copy with up to eight bytes
+ * after the magic replaced by the input. The copy has the exact size, so
+ * the sanitizers catch reads past the end.
+ */
+static void
+packed_fuzz (dc_parser_t *parser, const uint8_t *data, size_t size)
+{
+	dc_buffer_t *buffer = dc_buffer_new (0);
+	if (buffer == NULL)
+		return;
+
+	if (dc_parser_samples_pack (parser, buffer) == DC_STATUS_SUCCESS) {
+		const unsigned char *packed = dc_buffer_get_data (buffer);
+		size_t length = dc_buffer_get_size (buffer);
+
+		packed_read_all (packed, length);
+
+		unsigned char *mutant = length > 4 ? (unsigned char *) malloc (length) : NULL;
+		if (mutant) {
+			memcpy (mutant, packed, length);
+			for (size_t i = 0; i + 1 < size && i < 16; i += 2)
+				mutant[4 + data[i] % (length - 4)] = data[i + 1];
+			packed_read_all (mutant, length);
+			free (mutant);
+		}
+	}
+
+	dc_buffer_free (buffer);
+}
+
+int
+LLVMFuzzerTestOneInput (const uint8_t *data, size_t size)
+{
+	static dc_context_t *context = NULL;
+	dc_descriptor_t **descriptors = NULL;
+	dc_parser_t *parser = NULL;
+
+	packed_read_all (data, size);
+
+	if (size < 2)
+		return 0;
+
+	unsigned int ndescriptors = parser_seed_descriptors (&descriptors);
+	if (ndescriptors == 0)
+		return 0;
+
+	if (context == NULL) {
+		if (dc_context_new (&context) != DC_STATUS_SUCCESS)
+			return 0;
+		dc_context_set_loglevel (context, DC_LOGLEVEL_NONE);
+	}
+
+	unsigned int index = (data[0] | (data[1] << 8)) % ndescriptors;
+
+	if (dc_parser_new2 (&parser, context, descriptors[index], data + 2, size - 2) != DC_STATUS_SUCCESS)
+		return 0;
+
+	dc_datetime_t datetime;
+	dc_parser_get_datetime (parser, &datetime);
+
+	unsigned int nsamples = 0;
+	dc_parser_samples_foreach (parser, sample_cb, &nsamples);
+
+	dc_dive_t *dive = NULL;
+	if (dc_parser_parse_dive (parser, &dive) == DC_STATUS_SUCCESS)
+		dc_dive_free (dive);
+
+	packed_fuzz (parser, data + 2, size - 2);
+
+	dc_parser_destroy (parser);
+
+	return 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <libdivecomputer/iterator.h>
+
+#include "parser_seeds.h"
+
+static const struct {
+	size_t size;
+	int fill; // Fill byte, or -1 for pseudo random data
+} seeds[PARSER_SEED_COUNT] = {
+	{16,    0x00},
+	{512,   0x00},
+	{512,   0xFF},
+	{16,    -1},
+	{64,    -1},
+	{256,   -1},
+	{1024,  -1},
+	{4096,  -1},
+	{16384, -1},
+};
+
+static dc_descriptor_t **table = NULL;
+static unsigned int ntable = 0;
+
+unsigned int
+parser_seed_descriptors (dc_descriptor_t ***descriptors)
+{
+	if (table == NULL) {
+		dc_iterator_t *iterator = NULL;
+		dc_descriptor_t *descriptor = NULL;
+		unsigned int capacity = 0;
+
+		if (dc_descriptor_iterator (&iterator) != DC_STATUS_SUCCESS)
+			return 0;
+
+		while (dc_iterator_next (iterator, &descriptor) == DC_STATUS_SUCCESS) {
+			// The parser only depends on the family and model.
+			unsigned int duplicate = 0;
+			for (unsigned int i = 0; i < ntable; ++i) {
+				if (dc_descriptor_get_type (table[i]) == dc_descriptor_get_type (descriptor) &&
+					dc_descriptor_get_model (table[i]) == dc_descriptor_get_model (descriptor)) {
+					duplicate = 1;
+					break;
+				}
+			}
+			if (duplicate) {
+				dc_descriptor_free (descriptor);
+				continue;
+			}
+
+			if (ntable == capacity) {
+				capacity = capacity ? capacity * 2 : 64;
+				dc_descriptor_t **tmp = (dc_descriptor_t **) realloc (table, capacity * sizeof (dc_descriptor_t *));
+				if (tmp == NULL) {
+					dc_descriptor_free (descriptor);
+					break;
+				}
+				table = tmp;
+			}
+			table[ntable++] = descriptor;
+		}
+
+		dc_iterator_free (iterator);
+	}
+
+	*descriptors = table;
+	return ntable;
+}
+
+size_t
+parser_seed (unsigned int descriptor, unsigned int seed, unsigned char *buffer)
+{
+	if (seed >= PARSER_SEED_COUNT)
+		return 0;
+
+	size_t size = seeds[seed].size;
+	if (buffer == NULL)
+		return size;
+
+	if (seeds[seed].fill >= 0) {
+		memset (buffer, seeds[seed].fill, size);
+	} else {
+		// Xorshift, seeded from the descriptor and seed index.
+		unsigned int state = 0x9E3779B9u ^ (descriptor * 0x85EBCA6Bu) ^ (seed * 0xC2B2AE35u);
+		if (state == 0)
+			state = 1;
+		for (size_t i = 0; i < size; ++i) {
+			state ^= state << 13;
+			state ^= state >> 17;
+			state ^= state << 5;
+			buffer[i] = state & 0xFF;
+		}
+	}
+
+	return size;
+}
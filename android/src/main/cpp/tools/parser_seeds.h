@@ -0,0 +1,64 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+
+#ifndef PARSER_SEEDS_H
+#define PARSER_SEEDS_H
+
+#include <stddef.h>
+
+#include <libdivecomputer/descriptor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Synthetic parser inputs
+ *
+ * There is no corpus of captured dives, so the fuzz target and the
+ * benchmark run the parsers over synthetic blobs: all zero, all 0xFF and
+ * pseudo random data, in sizes from a truncated header to a long profile.
+ * These are the inputs that found the out of bounds reads in the parsers.
+ * The blobs are deterministic, so the benchmark results can be compared
+ * against a baseline.
+ */
+
+#define PARSER_SEED_COUNT 9
+
+/*
+ * The descriptors with a parser, in iteration order. The table is
+ * created on the first call, and never released.
+ */
+unsigned int
+parser_seed_descriptors (dc_descriptor_t ***descriptors);
+
+/*
+ * Fills the buffer with the seed data (buffer may be NULL to get the
+ * size), and returns the size of the seed.
+ */
+size_t
+parser_seed (unsigned int descriptor, unsigned int seed, unsigned char *buffer);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* PARSER_SEEDS_H */
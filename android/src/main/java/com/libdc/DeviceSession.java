@@ -0,0 +1,180 @@
+package com.libdc;
+
+import android.util.Log;
+
+import java.util.ArrayList;
+import java.util.List;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.ScheduledExecutorService;
+import java.util.concurrent.ScheduledFuture;
+import java.util.concurrent.ThreadFactory;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * A connection to a dive computer that stays open for several operations
+ *
+ * The native callbacks of the libdivecomputer objects are bound to the
+ * thread that created them, so the session runs the open, every operation
+ * and the close on a single worker thread, in submission order. While the
+ * queue is idle, an optional keep-alive operation prevents the device from
+ * leaving its download mode.
+ */
+public class DeviceSession implements AutoCloseable {
+    private static final String TAG = "DeviceSession";
+
+    // Number of operations kept in the statistics
+    private static final int MAX_STATS = 64;
+
+    public interface Operation<T> {
+        T run() throws Exception;
+    }
+
+    public static class OperationStats {
+        private final String name;
+        private final long queued;
+        private final long latency;
+        private final boolean success;
+
+        public OperationStats(String name, long queued, long latency, boolean success) {
+            this.name = name;
+            this.queued = queued;
+            this.latency = latency;
+            this.success = success;
+        }
+
+        public String getName() { return name; }
+        public long getQueued() { return queued; }     // Milliseconds waiting in the queue
+        public long getLatency() { return latency; }   // Milliseconds running
+        public boolean isSuccess() { return success; }
+    }
+
+    private final ScheduledExecutorService executor;
+    private final List<OperationStats> stats = new ArrayList<>();
+    private ScheduledFuture<?> keepalive;
+
+    // Only accessed from the worker thread
+    private long lastActivity = System.nanoTime();
+
+    public DeviceSession() {
+        executor = Executors.newSingleThreadScheduledExecutor(new ThreadFactory() {
+            @Override
+            public Thread newThread(Runnable runnable) {
+                Thread thread = new Thread(runnable, "libdc-session");
+                thread.setDaemon(true);
+                return thread;
+            }
+        });
+    }
+
+    /**
+     * Queue an operation, and return immediately
+     */
+    public <T> Future<T> submit(final String name, final Operation<T> operation) {
+        final long submitted = System.nanoTime();
+        return executor.submit(new Callable<T>() {
+            @Override
+            public T call() throws Exception {
+                long started = System.nanoTime();
+                boolean success = false;
+                try {
+                    T result = operation.run();
+                    success = true;
+                    return result;
+                } finally {
+                    long finished = System.nanoTime();
+                    lastActivity = finished;
+                    record(new OperationStats(name,
+                        TimeUnit.NANOSECONDS.toMillis(started - submitted),
+                        TimeUnit.NANOSECONDS.toMillis(finished - started),
+                        success));
+                }
+            }
+        });
+    }
+
+    /**
+     * Queue an operation, and wait for its result
+     */
+    public <T> T run(String name, Operation<T> operation) throws Exception {
+        Future<T> future = submit(name, operation);
+        try {
+            return future.get();
+        } catch (ExecutionException e) {
+            Throwable cause = e.getCause();
+            if (cause instanceof Exception) {
+                throw (Exception) cause;
+            }
+            throw new Exception(cause);
+        }
+    }
+
+    /**
+     * Run the operation whenever the session has been idle for the interval
+     * (in milliseconds). The keep-alive is disabled as soon as it fails, which
+     * is how protocols without a harmless command opt out. Pass null to
+     * disable it.
+     */
+    public synchronized void setKeepalive(final Operation<?> operation, final long interval) {
+        if (keepalive != null) {
+            keepalive.cancel(false);
+            keepalive = null;
+        }
+
+        if (operation == null || interval <= 0) {
+            return;
+        }
+
+        keepalive = executor.scheduleWithFixedDelay(new Runnable() {
+            @Override
+            public void run() {
+                long now = System.nanoTime();
+                if (now - lastActivity < TimeUnit.MILLISECONDS.toNanos(interval)) {
+                    return;
+                }
+
+                try {
+                    operation.run();
+                    lastActivity = System.nanoTime();
+                } catch (Exception e) {
+                    Log.d(TAG, "Keep-alive not supported, disabled", e);
+                    throw new RuntimeException(e);
+                }
+            }
+        }, interval, interval, TimeUnit.MILLISECONDS);
+    }
+
+    /**
+     * Latency of the most recent operations, oldest first
+     */
+    public synchronized List<OperationStats> getStats() {
+        return new ArrayList<>(stats);
+    }
+
+    private synchronized void record(OperationStats entry) {
+        if (stats.size() == MAX_STATS) {
+            stats.remove(0);
+        }
+        stats.add(entry);
+
+        Log.d(TAG, String.format("%s: queued %d ms, ran %d ms%s",
+            entry.getName(), entry.getQueued(), entry.getLatency(),
+            entry.isSuccess() ? "" : " (failed)"));
+    }
+
+    /**
+     * Stop the worker thread, after the queued operations are finished
+     */
+    @Override
+    public void close() {
+        setKeepalive(null, 0);
+        executor.shutdown();
+        try {
+            executor.awaitTermination(30, TimeUnit.SECONDS);
+        } catch (InterruptedException e) {
+            Thread.currentThread().interrupt();
+        }
+    }
+}
@@ -9,8 +9,12 @@ import android.util.Log;
 import org.libdivecomputer.Context;
 import org.libdivecomputer.Descriptor;
 import org.libdivecomputer.Device;
+import org.libdivecomputer.FingerprintStore;
 import org.libdivecomputer.Serial;
 
+import java.io.File;
+import java.io.FileOutputStream;
+import java.io.FileInputStream;
 import java.text.SimpleDateFormat;
 import java.util.ArrayList;
 import java.util.Date;
@@ -29,11 +33,17 @@ import java.util.UUID;
 public class LibDCImplementation {
     private static final String TAG = "LibDCImplementation";
     
+    // Idle time before the device is pinged to stay in download mode
+    private static final long KEEPALIVE_INTERVAL = 30000;
+    
     private final android.content.Context androidContext;
     private Context libdcContext;
     private Descriptor descriptor;
     private Device device;
     private Serial serial;
+    private FingerprintStore fingerprintStore;
+    private String deviceAddress;
+    private DeviceSession session;
     
     // Device models
     public static class DeviceInfo {
@@ -102,6 +112,15 @@ public class LibDCImplementation {
                 Log.d(TAG, String.format("[%s:%d] %s", file, line, message));
             }
         });
+        
+        // Open the persistent fingerprint store, for incremental downloads
+        try {
+            File file = new File(androidContext.getFilesDir(), "fingerprints.db");
+            fingerprintStore = new FingerprintStore(libdcContext, file.getPath());
+        } catch (Exception e) {
+            Log.w(TAG, "Failed to open the fingerprint store", e);
+            fingerprintStore = null;
+        }
     }
     
     /**
@@ -151,7 +170,7 @@ public class LibDCImplementation {
     /**
      * Connect to a specific dive computer
      */
-    public boolean connectDevice(String address, String family, Integer timeout) throws Exception {
+    public boolean connectDevice(final String address, final String family, final Integer timeout) throws Exception {
         // Get the Bluetooth adapter
         BluetoothAdapter bluetoothAdapter = BluetoothAdapter.getDefaultAdapter();
         if (bluetoothAdapter == null) {
@@ -164,6 +183,42 @@ public class LibDCImplementation {
             throw new Exception("Device not found");
         }
         
+        if (session != null) {
+            throw new Exception("A device is already connected");
+        }
+        
+        // All native calls of the connection run on the session thread
+        session = new DeviceSession();
+        try {
+            session.run("open", new DeviceSession.Operation<Void>() {
+                @Override
+                public Void run() throws Exception {
+                    openDevice(address, family, timeout);
+                    return null;
+                }
+            });
+        } catch (Exception e) {
+            try {
+                disconnectDevice();
+            } catch (Exception ignored) {
+                // Report the failure to open instead
+            }
+            throw e;
+        }
+        
+        // Protocols without a version query disable the keep-alive
+        session.setKeepalive(new DeviceSession.Operation<Void>() {
+            @Override
+            public Void run() throws Exception {
+                device.Version();
+                return null;
+            }
+        }, KEEPALIVE_INTERVAL);
+        
+        return true;
+    }
+    
+    private void openDevice(String address, String family, Integer timeout) throws Exception {
         // Create a descriptor for the device
         // In a real implementation, we would determine the correct device type based on the family
         // For now, we'll use a placeholder approach
@@ -181,21 +236,54 @@ public class LibDCImplementation {
         // Open the device
         device = new Device(libdcContext, descriptor, serial);
         
-        return true;
+        // Resume from the newest dive of the previous download
+        if (fingerprintStore != null) {
+            device.SetFingerprintStore(fingerprintStore);
+        }
+        
+        // Skip the identification queries answered in the previous session
+        deviceAddress = address;
+        File warmstart = getWarmstartFile(address);
+        if (warmstart.exists()) {
+            try {
+                byte[] data = new byte[(int) warmstart.length()];
+                try (FileInputStream in = new FileInputStream(warmstart)) {
+                    int n = 0;
+                    while (n < data.length) {
+                        int count = in.read(data, n, data.length - n);
+                        if (count < 0) {
+                            break;
+                        }
+                        n += count;
+                    }
+                }
+                device.SetWarmstart(data);
+            } catch (Exception e) {
+                Log.w(TAG, "Ignoring the warm start data", e);
+            }
+        }
     }
     
     /**
      * Download dives from the connected device
      */
-    public List<DiveLog> downloadDives(boolean forceAll, String fingerprintStr) throws Exception {
-        if (device == null) {
-            throw new Exception("No device connected");
-        }
-        
+    public List<DiveLog> downloadDives(final boolean forceAll, final String fingerprintStr) throws Exception {
+        return getSession().run("download", new DeviceSession.Operation<List<DiveLog>>() {
+            @Override
+            public List<DiveLog> run() throws Exception {
+                return download(forceAll, fingerprintStr);
+            }
+        });
+    }
+    
+    private List<DiveLog> download(boolean forceAll, String fingerprintStr) throws Exception {
         final List<DiveLog> dives = new ArrayList<>();
         
-        // Set fingerprint if provided and not forcing all dives
-        if (fingerprintStr != null && !forceAll) {
+        // Set fingerprint if provided and not forcing all dives. Without
+        // one, the fingerprint store resumes from the previous download.
+        if (forceAll) {
+            device.SetFingerprint(new byte[0]);
+        } else if (fingerprintStr != null) {
             byte[] fingerprint = Base64.decode(fingerprintStr, Base64.DEFAULT);
             device.SetFingerprint(fingerprint);
         }
@@ -275,7 +363,99 @@ public class LibDCImplementation {
      * Disconnect from the device
      */
     public boolean disconnectDevice() throws Exception {
+        if (session == null) {
+            return true;
+        }
+        
+        session.setKeepalive(null, 0);
+        try {
+            session.run("close", new DeviceSession.Operation<Void>() {
+                @Override
+                public Void run() throws Exception {
+                    closeDevice();
+                    return null;
+                }
+            });
+        } finally {
+            closeSession();
+        }
+        
+        return true;
+    }
+    
+    /**
+     * Synchronize the device clock with the local time
+     */
+    public void timesync() throws Exception {
+        getSession().run("timesync", new DeviceSession.Operation<Void>() {
+            @Override
+            public Void run() throws Exception {
+                device.Timesync(System.currentTimeMillis() / 1000);
+                return null;
+            }
+        });
+    }
+    
+    /**
+     * Show a text on the device screen
+     */
+    public void displayText(final String text) throws Exception {
+        getSession().run("display", new DeviceSession.Operation<Void>() {
+            @Override
+            public Void run() throws Exception {
+                device.Display(text);
+                return null;
+            }
+        });
+    }
+    
+    /**
+     * Read a device setting
+     */
+    public byte[] readConfig(final int config, final int size) throws Exception {
+        return getSession().run("config_read", new DeviceSession.Operation<byte[]>() {
+            @Override
+            public byte[] run() throws Exception {
+                return device.ConfigRead(config, size);
+            }
+        });
+    }
+    
+    /**
+     * Write a device setting
+     */
+    public void writeConfig(final int config, final byte[] data) throws Exception {
+        getSession().run("config_write", new DeviceSession.Operation<Void>() {
+            @Override
+            public Void run() throws Exception {
+                device.ConfigWrite(config, data);
+                return null;
+            }
+        });
+    }
+    
+    /**
+     * Latency of the operations of the current connection
+     */
+    public List<DeviceSession.OperationStats> getSessionStats() throws Exception {
+        return getSession().getStats();
+    }
+    
+    private DeviceSession getSession() throws Exception {
+        if (session == null) {
+            throw new Exception("No device connected");
+        }
+        return session;
+    }
+    
+    private void closeSession() {
+        session.close();
+        session = null;
+    }
+    
+    private void closeDevice() throws Exception {
         if (device != null) {
+            saveWarmstart();
             device.close();
             device = null;
         }
@@ -289,8 +469,30 @@ public class LibDCImplementation {
             descriptor.close();
             descriptor = null;
         }
-        
-        return true;
+    }
+    
+    /**
+     * Warm start data is stored per device address
+     */
+    private File getWarmstartFile(String address) {
+        File directory = new File(androidContext.getFilesDir(), "warmstart");
+        return new File(directory, address.replace(":", ""));
+    }
+    
+    private void saveWarmstart() {
+        try {
+            byte[] data = device.GetWarmstart();
+            if (data == null || deviceAddress == null) {
+                return;
+            }
+            File file = getWarmstartFile(deviceAddress);
+            file.getParentFile().mkdirs();
+            try (FileOutputStream out = new FileOutputStream(file)) {
+                out.write(data);
+            }
+        } catch (Exception e) {
+            Log.w(TAG, "Failed to save the warm start data", e);
+        }
     }
     
     /**
@@ -7,6 +7,7 @@ import android.bluetooth.BluetoothManager;
 import android.content.Context;
 import android.content.pm.PackageManager;
 import android.os.Build;
+import android.util.Base64;
 import android.util.Log;
 
 import com.getcapacitor.JSArray;
@@ -231,6 +232,91 @@ public class LibDCPlugin extends Plugin {
         }
     }
     
+    @PluginMethod
+    public void timesync(PluginCall call) {
+        try {
+            implementation.timesync();
+            JSObject result = new JSObject();
+            result.put("success", true);
+            call.resolve(result);
+        } catch (Exception e) {
+            call.reject("Failed to synchronize the clock: " + e.getMessage(), e);
+        }
+    }
+    
+    @PluginMethod
+    public void displayText(PluginCall call) {
+        String text = call.getString("text", "");
+        
+        try {
+            implementation.displayText(text);
+            JSObject result = new JSObject();
+            result.put("success", true);
+            call.resolve(result);
+        } catch (Exception e) {
+            call.reject("Failed to display text: " + e.getMessage(), e);
+        }
+    }
+    
+    @PluginMethod
+    public void readConfig(PluginCall call) {
+        Integer config = call.getInt("config");
+        Integer size = call.getInt("size");
+        if (config == null || size == null) {
+            call.reject("Config and size are required");
+            return;
+        }
+        
+        try {
+            byte[] data = implementation.readConfig(config, size);
+            JSObject result = new JSObject();
+            result.put("data", Base64.encodeToString(data, Base64.NO_WRAP));
+            call.resolve(result);
+        } catch (Exception e) {
+            call.reject("Failed to read config: " + e.getMessage(), e);
+        }
+    }
+    
+    @PluginMethod
+    public void writeConfig(PluginCall call) {
+        Integer config = call.getInt("config");
+        String data = call.getString("data");
+        if (config == null || data == null) {
+            call.reject("Config and data are required");
+            return;
+        }
+        
+        try {
+            implementation.writeConfig(config, Base64.decode(data, Base64.DEFAULT));
+            JSObject result = new JSObject();
+            result.put("success", true);
+            call.resolve(result);
+        } catch (Exception e) {
+            call.reject("Failed to write config: " + e.getMessage(), e);
+        }
+    }
+    
+    @PluginMethod
+    public void getSessionStats(PluginCall call) {
+        try {
+            JSArray operations = new JSArray();
+            for (DeviceSession.OperationStats stats : implementation.getSessionStats()) {
+                JSObject operation = new JSObject();
+                operation.put("name", stats.getName());
+                operation.put("queued", stats.getQueued());
+                operation.put("latency", stats.getLatency());
+                operation.put("success", stats.isSuccess());
+                operations.put(operation);
+            }
+            
+            JSObject result = new JSObject();
+            result.put("operations", operations);
+            call.resolve(result);
+        } catch (Exception e) {
+            call.reject("Failed to get session statistics: " + e.getMessage(), e);
+        }
+    }
+    
     private boolean hasRequiredPermissions() {
         if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.S) {
             return hasPermission(Manifest.permission.BLUETOOTH_SCAN) && 
@@ -1,8 +1,38 @@
 package org.libdivecomputer;
 
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.concurrent.atomic.AtomicLong;
+
 public class Custom extends IOStream
 {
 	private native long Open(long context, int transport, Callback callback);
+	private native long OpenQueue(long context, int transport, Callback callback, int capacity);
+	private static native boolean Push(long queue, ByteBuffer buffer, int offset, int length);
+	private static native void Release(long queue);
+	private static native long[] GetCounters();
+
+	private long queue = 0;
+
+	// BLE link requests (see libdivecomputer/ble.h). The PHY values match
+	// BluetoothDevice.PHY_LE_1M, PHY_LE_2M and PHY_LE_CODED (as reported by
+	// onPhyRead), and the priority values BluetoothGatt.CONNECTION_PRIORITY_*.
+	// setPreferredPhy() takes a mask instead, see PhyMask().
+	public static final int IOCTL_BLE_GET_MTU = 0x40046204;
+	public static final int IOCTL_BLE_SET_MTU = 0x80046204;
+	public static final int IOCTL_BLE_GET_PHY = 0x40046205;
+	public static final int IOCTL_BLE_SET_PHY = 0x80046205;
+	public static final int IOCTL_BLE_SET_PRIORITY = 0x80046206;
+
+	// Converts a PHY value (1M, 2M or coded) to the PHY_LE_*_MASK bit for
+	// BluetoothDevice.setPreferredPhy(), where the coded PHY is 4 and not 3.
+	public static int PhyMask(int phy)
+	{
+		if (phy < 1 || phy > 3) {
+			throw new IllegalArgumentException("Invalid PHY " + phy);
+		}
+		return 1 << (phy - 1);
+	}
 
 	public interface Callback {
 		default void SetTimeout(int timeout) {};
@@ -16,6 +46,62 @@ public class Custom extends IOStream
 		default byte[] Read() {return null;};
 		default void Write(byte[] data) {};
 		default void Ioctl(int request, byte[] data) {};
+
+		// Outgoing data is passed in a direct buffer that is reused for
+		// every call, with the data at the start. The contents are only
+		// valid during the call, and a larger buffer replaces it when
+		// needed. Override these to avoid the byte[] copies of the default
+		// implementations. The copies are handed over to the byte[]
+		// methods, which may keep them, so they can't be reused and are
+		// counted in COUNTER_ALLOCATIONS instead.
+		default void Write(ByteBuffer buffer, int size) {
+			byte[] data = new byte[size];
+			allocations.incrementAndGet();
+			buffer.clear();
+			buffer.get(data, 0, size);
+			Write(data);
+		};
+		default void Ioctl(int request, ByteBuffer buffer, int size) {
+			ByteBuffer value = buffer.duplicate().order(ByteOrder.nativeOrder());
+			switch (request) {
+			case IOCTL_BLE_GET_MTU:
+				value.putInt(0, GetMtu());
+				return;
+			case IOCTL_BLE_SET_MTU:
+				SetMtu(value.getInt(0));
+				return;
+			case IOCTL_BLE_GET_PHY:
+				value.putInt(0, GetPhy());
+				return;
+			case IOCTL_BLE_SET_PHY:
+				SetPhy(value.getInt(0));
+				return;
+			case IOCTL_BLE_SET_PRIORITY:
+				SetPriority(value.getInt(0));
+				return;
+			default:
+				break;
+			}
+
+			byte[] data = new byte[size];
+			allocations.incrementAndGet();
+			buffer.clear();
+			buffer.get(data, 0, size);
+			Ioctl(request, data);
+			buffer.clear();
+			buffer.put(data, 0, size);
+		};
+
+		// The BLE link, e.g. with BluetoothGatt.requestMtu(),
+		// setPreferredPhy(PhyMask(phy)) and requestConnectionPriority().
+		// The setters return once the change is negotiated. Unsupported
+		// by default.
+		default int GetMtu() {throw new UnsupportedOperationException();};
+		default void SetMtu(int mtu) {throw new UnsupportedOperationException();};
+		default int GetPhy() {throw new UnsupportedOperationException();};
+		default void SetPhy(int phy) {throw new UnsupportedOperationException();};
+		default void SetPriority(int priority) {throw new UnsupportedOperationException();};
+
 		default void Flush() {};
 		default void Purge(int direction) {};
 		default void Sleep(int milliseconds) {};
@@ -27,6 +113,56 @@ public class Custom extends IOStream
 		this.handle = Open(context.handle, transport, callback);
 	}
 
+	// Received packets are pushed with Push() into a native queue of the
+	// given capacity (bytes), instead of being pulled with Callback.Read().
+	// Reading, polling and purging the input never call back into Java.
+	// Closing the stream wakes up a read blocked on another thread, and
+	// waits for it to return, but the stream must not be used afterwards.
+	public Custom(Context context, int transport, Callback callback, int capacity)
+	{
+		this.handle = OpenQueue(context.handle, transport, callback, capacity);
+	}
+
+	// Queues a received packet from a direct buffer. Returns false if the
+	// queue is full or the stream is closed.
+	public synchronized boolean Push(ByteBuffer buffer, int offset, int length)
+	{
+		if (queue == 0) {
+			return false;
+		}
+		return Push(queue, buffer, offset, length);
+	}
+
+	// Number of write and ioctl calls, and of the Java objects allocated
+	// for them (the direct buffers, and the byte[] copies of the default
+	// Callback methods), by all Custom streams.
+	public static final int COUNTER_WRITES = 0;
+	public static final int COUNTER_IOCTLS = 1;
+	public static final int COUNTER_ALLOCATIONS = 2;
+
+	private static final AtomicLong allocations = new AtomicLong();
+
+	public static long[] Counters()
+	{
+		long[] counters = GetCounters();
+		if (counters != null) {
+			counters[COUNTER_ALLOCATIONS] += allocations.get();
+		}
+		return counters;
+	}
+
+	@Override
+	public void close()
+	{
+		super.close();
+		synchronized (this) {
+			if (queue != 0) {
+				Release(queue);
+				queue = 0;
+			}
+		}
+	}
+
 	static {
 		System.loadLibrary("divecomputer-java");
 	}
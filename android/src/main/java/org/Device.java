@@ -6,6 +6,15 @@ public class Device extends Handle
 	private native void Close(long handle);
 	private native void Foreach(long handle, Callback callback);
 	private native void SetFingerprint(long handle, byte[] fingerprint);
+	private native void SetFingerprintStore(long handle, long store);
+	private native void SetWarmstart(long handle, byte[] data);
+	private native byte[] GetWarmstart(long handle);
+	private native void Timesync(long handle, long ticks);
+	private native byte[] Version(long handle);
+	private native void Display(long handle, String text);
+	private native byte[] ConfigRead(long handle, int config, int size);
+	private native void ConfigWrite(long handle, int config, byte[] data);
+	private native void FirmwareUpdate(long handle, byte[] data);
 	private native void SetEvents(long handle, Events events);
 	private native void SetCancel(long handle, Cancel cancel);
 
@@ -40,6 +49,58 @@ public class Device extends Handle
 		SetFingerprint(handle, fingerprint);
 	}
 
+	public void SetFingerprintStore(FingerprintStore store)
+	{
+		SetFingerprintStore(handle, store != null ? store.handle : 0);
+	}
+
+	// Identification data from a previous session, to skip the handshake
+	// queries whose answers can't have changed. Returns null if none.
+	public void SetWarmstart(byte[] data)
+	{
+		SetWarmstart(handle, data);
+	}
+
+	public byte[] GetWarmstart()
+	{
+		return GetWarmstart(handle);
+	}
+
+	// Set the device clock to the local time (seconds since the epoch).
+	public void Timesync(long ticks)
+	{
+		Timesync(handle, ticks);
+	}
+
+	// Only supported by the hw_ostc3 family.
+	public byte[] Version()
+	{
+		return Version(handle);
+	}
+
+	public void Display(String text)
+	{
+		Display(handle, text);
+	}
+
+	public byte[] ConfigRead(int config, int size)
+	{
+		return ConfigRead(handle, config, size);
+	}
+
+	public void ConfigWrite(int config, byte[] data)
+	{
+		ConfigWrite(handle, config, data);
+	}
+
+	// Upload a firmware image, the contents of the firmware file of the
+	// manufacturer. Only supported by the hw_ostc, hw_ostc3 and
+	// divesystem_idive families. The progress is reported to the Events.
+	public void FirmwareUpdate(byte[] data)
+	{
+		FirmwareUpdate(handle, data);
+	}
+
 	public void SetEvents(Events events)
 	{
 		SetEvents(handle, events);
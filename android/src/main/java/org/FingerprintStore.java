@@ -0,0 +1,35 @@
+package org.libdivecomputer;
+
+public class FingerprintStore extends Handle
+{
+	private native long Open(long context, String filename);
+	private native void Close(long handle);
+	private native byte[] Get(long handle, int family, int model, int serial);
+	private native void Set(long handle, int family, int model, int serial, byte[] fingerprint);
+
+	public FingerprintStore(Context context, String filename)
+	{
+		this.handle = Open(context.handle, filename);
+	}
+
+	public byte[] Get(int family, int model, int serial)
+	{
+		return Get(handle, family, model, serial);
+	}
+
+	public void Set(int family, int model, int serial, byte[] fingerprint)
+	{
+		Set(handle, family, model, serial, fingerprint);
+	}
+
+	@Override
+	public void close()
+	{
+		Close(handle);
+		handle = 0;
+	}
+
+	static {
+		System.loadLibrary("divecomputer-java");
+	}
+}
@@ -6,6 +6,7 @@ public class Parser extends Handle
 	private native long New2(long context, long descriptor, byte[] data);
 	private native void Free(long handle);
 	private native void Foreach(long handle, Callback callback);
+	private native void SetDownsample(long handle, int npoints);
 	private native void GetDatetime(long handle, Datetime datetime);
 	private native void GetSalinity(long handle, Salinity salinity);
 	private native void GetDecomodel(long handle, Decomodel decomodel);
@@ -13,6 +14,12 @@ public class Parser extends Handle
 	private native void GetTank(long handle, Tank tank, int idx);
 	private native int GetFieldInt(long handle, int field);
 	private native double GetFieldDouble(long handle, int field);
+	private native void ParseDive(long handle, Dive dive);
+	private native byte[] PackSamples(long handle);
+	private native void ComputeBuhlmann(long handle, int gflow, int gfhigh, Buhlmann buhlmann);
+	private native void ComputeConsumption(long handle, int window, Consumption consumption);
+	private static native byte[] ExportDives(int format, long[] handles);
+	private static native void ExportDivesFd(int format, long[] handles, int fd);
 
 	private int DC_FIELD_DIVETIME = 0;
 	private int DC_FIELD_MAXDEPTH = 1;
@@ -29,6 +36,24 @@ public class Parser extends Handle
 	private int DC_FIELD_DIVEMODE = 12;
 	private int DC_FIELD_DECOMODEL = 13;
 
+	public static final int DC_DIVE_DATETIME = 0x80000000;
+
+	// dc_sample_type_t
+	public static final int DC_SAMPLE_TIME = 0;
+	public static final int DC_SAMPLE_DEPTH = 1;
+	public static final int DC_SAMPLE_PRESSURE = 2;
+	public static final int DC_SAMPLE_TEMPERATURE = 3;
+	public static final int DC_SAMPLE_EVENT = 4;
+	public static final int DC_SAMPLE_RBT = 5;
+	public static final int DC_SAMPLE_HEARTBEAT = 6;
+	public static final int DC_SAMPLE_BEARING = 7;
+	public static final int DC_SAMPLE_VENDOR = 8;
+	public static final int DC_SAMPLE_SETPOINT = 9;
+	public static final int DC_SAMPLE_PPO2 = 10;
+	public static final int DC_SAMPLE_CNS = 11;
+	public static final int DC_SAMPLE_DECO = 12;
+	public static final int DC_SAMPLE_GASMIX = 13;
+
 	// dc_water_t
 	public static final int DC_WATER_FRESH = 0;
 	public static final int DC_WATER_SALT = 1;
@@ -64,6 +89,10 @@ public class Parser extends Handle
 	public static final int DC_DECOMODEL_RGBM = 3;
 	public static final int DC_DECOMODEL_DCIEM = 4;
 
+	// dc_export_format_t
+	public static final int DC_EXPORT_UDDF = 0;
+	public static final int DC_EXPORT_SUBSURFACE = 1;
+
 	public static final int DC_SENSOR_NONE = 0xFFFFFFFF;
 	public static final int DC_GASMIX_UNKNOWN = 0xFFFFFFFF;
 
@@ -107,6 +136,104 @@ public class Parser extends Handle
 		public int gf_low;
 	}
 
+	public class Dive {
+		public int fields;
+		public Datetime datetime = new Datetime();
+		public int divetime;
+		public double maxdepth;
+		public double avgdepth;
+		public Salinity salinity = new Salinity();
+		public double atmospheric;
+		public double temperatureSurface;
+		public double temperatureMin;
+		public double temperatureMax;
+		public int divemode;
+		public Decomodel decomodel = new Decomodel();
+		public Gasmix[] gasmixes;
+		public Tank[] tanks;
+
+		// Profile, one entry per time step.
+		public int[] sampleFields;
+		public int[] sampleTime;
+		public double[] sampleDepth;
+		public double[] sampleTemperature;
+		public int[] sampleRbt;
+		public int[] sampleHeartbeat;
+		public int[] sampleBearing;
+		public double[] sampleSetpoint;
+		public double[] sampleCns;
+		public int[] sampleDecoType;
+		public int[] sampleDecoTime;
+		public double[] sampleDecoDepth;
+		public int[] sampleDecoTts;
+		public int[] sampleGasmix;
+
+		// Range of each sample in the pressure, event and ppo2 tables.
+		public int[] samplePressure;
+		public int[] sampleNPressure;
+		public int[] sampleEvent;
+		public int[] sampleNEvents;
+		public int[] samplePpo2;
+		public int[] sampleNPpo2;
+
+		public int[] pressureTank;
+		public double[] pressureValue;
+
+		public int[] eventType;
+		public int[] eventTime;
+		public int[] eventFlags;
+		public int[] eventValue;
+
+		public int[] ppo2Sensor;
+		public double[] ppo2Value;
+
+		public boolean HasField(int field)
+		{
+			return (fields & (1 << field)) != 0;
+		}
+
+		public boolean HasDatetime()
+		{
+			return (fields & DC_DIVE_DATETIME) != 0;
+		}
+
+		public boolean HasSample(int idx, int type)
+		{
+			return (sampleFields[idx] & (1 << type)) != 0;
+		}
+	}
+
+	public class Buhlmann {
+		// Decompression status, one entry per sample of the full resolution
+		// profile (the downsampling setting does not apply).
+		public int[] time;
+		public double[] ceiling;
+		public double[] gf99;
+		public double[] surfaceGf;
+		public int[] tts;
+	}
+
+	public class Consumption {
+		// Smoothed SAC (bar/min) and RMV (l/min) series of all tanks, computed
+		// on the full resolution profile (the downsampling setting does not apply).
+		public int[] pointTank;
+		public int[] pointTime;
+		public double[] pointSac;
+		public double[] pointRmv;
+
+		// Consumption of every tank between gas switches.
+		public int[] segmentTank;
+		public int[] segmentGasmix;
+		public int[] segmentBeginTime;
+		public int[] segmentEndTime;
+		public double[] segmentBeginPressure;
+		public double[] segmentEndPressure;
+		public double[] segmentAvgdepth;
+		public double[] segmentVolume;
+		public double[] segmentSac;
+		public double[] segmentRmv;
+	}
+
 	public interface Callback {
 		void Time(int value);
 		void Depth(double value);
@@ -134,6 +261,11 @@ public class Parser extends Handle
 		this.handle = New2(context.handle, descriptor.handle, data);
 	}
 
+	public void SetDownsample(int npoints)
+	{
+		SetDownsample(handle, npoints);
+	}
+
 	public Datetime GetDatetime()
 	{
 		Datetime datetime = new Datetime();
@@ -224,6 +356,51 @@ public class Parser extends Handle
 		Foreach(handle, callback);
 	}
 
+	public Dive ParseDive()
+	{
+		Dive dive = new Dive();
+		ParseDive(handle, dive);
+		return dive;
+	}
+
+	public byte[] PackSamples()
+	{
+		return PackSamples(handle);
+	}
+
+	public Buhlmann ComputeBuhlmann(int gflow, int gfhigh)
+	{
+		Buhlmann buhlmann = new Buhlmann();
+		ComputeBuhlmann(handle, gflow, gfhigh, buhlmann);
+		return buhlmann;
+	}
+
+	public Consumption ComputeConsumption(int window)
+	{
+		Consumption consumption = new Consumption();
+		ComputeConsumption(handle, window, consumption);
+		return consumption;
+	}
+
+	private static long[] Handles(Parser[] parsers)
+	{
+		long[] handles = new long[parsers.length];
+		for (int i = 0; i < parsers.length; i++) {
+			handles[i] = parsers[i].handle;
+		}
+		return handles;
+	}
+
+	public static byte[] Export(int format, Parser[] parsers)
+	{
+		return ExportDives(format, Handles(parsers));
+	}
+
+	public static void Export(int format, Parser[] parsers, int fd)
+	{
+		ExportDivesFd(format, Handles(parsers), fd);
+	}
+
 	@Override
 	public void close()
 	{
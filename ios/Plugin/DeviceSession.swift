@@ -0,0 +1,128 @@
+import Foundation
+import Clibdivecomputer
+import LibDCBridge
+
+/**
+ * A connection to a dive computer that stays open for several operations
+ *
+ * The libdivecomputer device is not thread-safe, so the session runs the
+ * open, every operation and the close on a single serial queue, in
+ * submission order, like the DeviceSession of the Android plugin. The
+ * device data is opened once, and only closed by close().
+ */
+public class DeviceSession {
+    // Number of operations kept in the statistics
+    private static let maxStats = 64
+
+    public struct OperationStats {
+        let name: String
+        let queued: Int     // Milliseconds waiting in the queue
+        let latency: Int    // Milliseconds running
+        let success: Bool
+    }
+
+    public struct SessionError: LocalizedError {
+        let message: String
+
+        public var errorDescription: String? {
+            return message
+        }
+    }
+
+    private let queue = DispatchQueue(label: "com.libdc.session", qos: .userInitiated)
+    private let lock = NSLock()
+    private var stats: [OperationStats] = []
+
+    // Only accessed on the session queue
+    private var device: UnsafeMutablePointer<device_data_t>?
+
+    /**
+     * Queue an operation, and call the completion on the session queue
+     */
+    public func submit<T>(_ name: String, _ operation: @escaping () throws -> T, completion: @escaping (Result<T, Error>) -> Void) {
+        let submitted = DispatchTime.now().uptimeNanoseconds
+        queue.async {
+            let started = DispatchTime.now().uptimeNanoseconds
+            let result = Result { try operation() }
+            let finished = DispatchTime.now().uptimeNanoseconds
+
+            var success = false
+            if case .success = result {
+                success = true
+            }
+            self.record(OperationStats(
+                name: name,
+                queued: Int((started - submitted) / 1_000_000),
+                latency: Int((finished - started) / 1_000_000),
+                success: success
+            ))
+
+            completion(result)
+        }
+    }
+
+    /**
+     * Queue an operation on the open device
+     */
+    public func perform<T>(_ name: String, _ operation: @escaping (UnsafeMutablePointer<device_data_t>) throws -> T, completion: @escaping (Result<T, Error>) -> Void) {
+        submit(name, {
+            guard let device = self.device else {
+                throw SessionError(message: "No device connected")
+            }
+            return try operation(device)
+        }, completion: completion)
+    }
+
+    /**
+     * Open the device. The stored family and model are tried first, then
+     * the device is identified from its advertised name.
+     */
+    public func open(name: String, address: String, family: dc_family_t, model: UInt32, completion: @escaping (Result<Void, Error>) -> Void) {
+        submit("open", {
+            guard self.device == nil else {
+                throw SessionError(message: "A device is already connected")
+            }
+
+            var data: UnsafeMutablePointer<device_data_t>?
+            let status = open_ble_device_with_identification(&data, name, address, family, model)
+            guard status == DC_STATUS_SUCCESS, let device = data else {
+                throw SessionError(message: "Failed to open the device (status \(status.rawValue))")
+            }
+            self.device = device
+        }, completion: completion)
+    }
+
+    /**
+     * Close the device, after the queued operations are finished
+     */
+    public func close(completion: @escaping (Result<Void, Error>) -> Void) {
+        submit("close", {
+            if let device = self.device {
+                self.device = nil
+                close_ble_device(device)
+            }
+        }, completion: completion)
+    }
+
+    /**
+     * Latency of the most recent operations, oldest first
+     */
+    public func getStats() -> [OperationStats] {
+        lock.lock()
+        defer { lock.unlock() }
+        return stats
+    }
+
+    private func record(_ entry: OperationStats) {
+        lock.lock()
+        if stats.count == DeviceSession.maxStats {
+            stats.removeFirst()
+        }
+        stats.append(entry)
+        lock.unlock()
+
+        NSLog("DeviceSession: %@: queued %d ms, ran %d ms%@",
+              entry.name, entry.queued, entry.latency,
+              entry.success ? "" : " (failed)")
+    }
+}
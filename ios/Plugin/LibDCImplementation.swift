@@ -1,5 +1,7 @@
 import Foundation
 import CoreBluetooth
+import Clibdivecomputer
+import LibDCBridge
 
 /**
  * Implementation of the LibDC plugin functionality for iOS
@@ -15,6 +17,9 @@ public class LibDCImplementation: NSObject {
     // Dive log retriever for downloading dives
     private var diveLogRetriever: DiveLogRetriever?
     
+    // Connection to the device, from connectDevice to disconnectDevice
+    private var session: DeviceSession?
+    
     // Device models
     public struct DeviceInfo {
         let name: String?
@@ -98,13 +103,22 @@ public class LibDCImplementation: NSObject {
     // MARK: - Device Connection
     
     public func connectDevice(address: String, family: String?, timeout: Int?, completion: @escaping (Bool, String?) -> Void) {
-        guard let bleManager = bleManager else {
+        guard bleManager != nil else {
             completion(false, "BLE Manager not initialized")
             return
         }
         
-        // Find the peripheral with the given address
-        guard let peripheral = bleManager.retrievePeripheral(withIdentifier: address) else {
+        guard session == nil else {
+            completion(false, "A device is already connected")
+            return
+        }
+        
+        // Find the peripheral with the given address, or the stored device
+        let storedDevice = DeviceStorage.shared.getStoredDevice(uuid: address)
+        let peripheral = UUID(uuidString: address).flatMap {
+            CoreBluetoothManager.sharedManager.centralManager?.retrievePeripherals(withIdentifiers: [$0]).first
+        }
+        guard let name = peripheral?.name ?? storedDevice?.name else {
             completion(false, "Device not found")
             return
         }
@@ -115,12 +129,28 @@ public class LibDCImplementation: NSObject {
             deviceFamily = DeviceConfiguration.DeviceFamily(rawValue: family)
         }
         
-        // Connect to the device
-        do {
-            deviceConfig = try DeviceConfiguration.openBLEDevice(name: peripheral.name ?? "Unknown", deviceAddress: address, family: deviceFamily)
-            completion(true, nil)
-        } catch {
-            completion(false, error.localizedDescription)
+        // The device stays open on the session queue until disconnectDevice
+        let session = DeviceSession()
+        self.session = session
+        session.open(name: name,
+                     address: address,
+                     family: storedDevice?.family.asDCFamily ?? DC_FAMILY_NULL,
+                     model: storedDevice?.model ?? 0) { result in
+            switch result {
+            case .success:
+                do {
+                    self.deviceConfig = try DeviceConfiguration.openBLEDevice(name: name, deviceAddress: address, family: deviceFamily)
+                    completion(true, nil)
+                } catch {
+                    self.disconnectDevice { _, _ in }
+                    completion(false, error.localizedDescription)
+                }
+            case .failure(let error):
+                if self.session === session {
+                    self.session = nil
+                }
+                completion(false, error.localizedDescription)
+            }
         }
     }
     
@@ -190,16 +220,93 @@ public class LibDCImplementation: NSObject {
     // MARK: - Device Disconnection
     
     public func disconnectDevice(completion: @escaping (Bool, String?) -> Void) {
-        guard deviceConfig != nil else {
+        guard let session = session else {
             completion(false, "No device connected")
             return
         }
         
         // Clean up resources
+        self.session = nil
         diveLogRetriever = nil
         deviceConfig = nil
         
-        completion(true, nil)
+        // Closed after the queued operations
+        session.close { result in
+            switch result {
+            case .success:
+                completion(true, nil)
+            case .failure(let error):
+                completion(false, error.localizedDescription)
+            }
+        }
+    }
+    
+    // MARK: - Device Operations
+    
+    // The operations run on the session queue, with the device opened by
+    // connectDevice.
+    
+    public func timesync(completion: @escaping (Bool, String?) -> Void) {
+        perform("timesync", { device in
+            try DeviceOperations.timesync(device)
+        }) { result, error in
+            completion(result != nil, error)
+        }
+    }
+    
+    public func displayText(_ text: String, completion: @escaping (Bool, String?) -> Void) {
+        perform("display", { device in
+            try DeviceOperations.display(device, text: text)
+        }) { result, error in
+            completion(result != nil, error)
+        }
+    }
+    
+    public func readConfig(config: Int, size: Int, completion: @escaping (Data?, String?) -> Void) {
+        perform("config_read", { device in
+            try DeviceOperations.configRead(device, config: config, size: size)
+        }, completion: completion)
+    }
+    
+    public func writeConfig(config: Int, data: Data, completion: @escaping (Bool, String?) -> Void) {
+        perform("config_write", { device in
+            try DeviceOperations.configWrite(device, config: config, data: data)
+        }) { result, error in
+            completion(result != nil, error)
+        }
+    }
+    
+    public func getSessionStats(completion: @escaping ([[String: Any]]?, String?) -> Void) {
+        guard let session = session else {
+            completion(nil, "No device connected")
+            return
+        }
+        
+        let operations = session.getStats().map { stats -> [String: Any] in
+            return [
+                "name": stats.name,
+                "queued": stats.queued,
+                "latency": stats.latency,
+                "success": stats.success
+            ]
+        }
+        completion(operations, nil)
+    }
+    
+    private func perform<T>(_ name: String, _ operation: @escaping (UnsafeMutablePointer<device_data_t>) throws -> T, completion: @escaping (T?, String?) -> Void) {
+        guard let session = session else {
+            completion(nil, "No device connected")
+            return
+        }
+        
+        session.perform(name, operation) { result in
+            switch result {
+            case .success(let value):
+                completion(value, nil)
+            case .failure(let error):
+                completion(nil, error.localizedDescription)
+            }
+        }
     }
 }
 
@@ -8,4 +8,9 @@ CAP_PLUGIN(LibDCPlugin, "LibDC",
            CAP_PLUGIN_METHOD(connectDevice, CAPPluginReturnPromise);
            CAP_PLUGIN_METHOD(downloadDives, CAPPluginReturnPromise);
            CAP_PLUGIN_METHOD(disconnectDevice, CAPPluginReturnPromise);
+           CAP_PLUGIN_METHOD(timesync, CAPPluginReturnPromise);
+           CAP_PLUGIN_METHOD(displayText, CAPPluginReturnPromise);
+           CAP_PLUGIN_METHOD(readConfig, CAPPluginReturnPromise);
+           CAP_PLUGIN_METHOD(writeConfig, CAPPluginReturnPromise);
+           CAP_PLUGIN_METHOD(getSessionStats, CAPPluginReturnPromise);
 )
\ No newline at end of file
@@ -139,4 +139,93 @@ public class LibDCPlugin: CAPPlugin {
             }
         }
     }
+    
+    @objc func timesync(_ call: CAPPluginCall) {
+        guard let implementation = implementation else {
+            call.reject("Plugin not initialized")
+            return
+        }
+        
+        implementation.timesync { success, error in
+            if success {
+                call.resolve(["success": true])
+            } else {
+                call.reject(error ?? "Failed to synchronize the clock")
+            }
+        }
+    }
+    
+    @objc func displayText(_ call: CAPPluginCall) {
+        guard let implementation = implementation else {
+            call.reject("Plugin not initialized")
+            return
+        }
+        
+        let text = call.getString("text") ?? ""
+        
+        implementation.displayText(text) { success, error in
+            if success {
+                call.resolve(["success": true])
+            } else {
+                call.reject(error ?? "Failed to display text")
+            }
+        }
+    }
+    
+    @objc func readConfig(_ call: CAPPluginCall) {
+        guard let implementation = implementation else {
+            call.reject("Plugin not initialized")
+            return
+        }
+        
+        guard let config = call.getInt("config"), let size = call.getInt("size") else {
+            call.reject("Config and size are required")
+            return
+        }
+        
+        implementation.readConfig(config: config, size: size) { data, error in
+            if let data = data {
+                call.resolve(["data": data.base64EncodedString()])
+            } else {
+                call.reject(error ?? "Failed to read config")
+            }
+        }
+    }
+    
+    @objc func writeConfig(_ call: CAPPluginCall) {
+        guard let implementation = implementation else {
+            call.reject("Plugin not initialized")
+            return
+        }
+        
+        guard let config = call.getInt("config"),
+              let string = call.getString("data"),
+              let data = Data(base64Encoded: string) else {
+            call.reject("Config and data are required")
+            return
+        }
+        
+        implementation.writeConfig(config: config, data: data) { success, error in
+            if success {
+                call.resolve(["success": true])
+            } else {
+                call.reject(error ?? "Failed to write config")
+            }
+        }
+    }
+    
+    @objc func getSessionStats(_ call: CAPPluginCall) {
+        guard let implementation = implementation else {
+            call.reject("Plugin not initialized")
+            return
+        }
+        
+        implementation.getSessionStats { operations, error in
+            if let operations = operations {
+                call.resolve(["operations": operations])
+            } else {
+                call.reject(error ?? "Failed to get session statistics")
+            }
+        }
+    }
 }
\ No newline at end of file
@@ -0,0 +1,67 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_BUHLMANN_H
+#define DC_BUHLMANN_H
+
+#include "common.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Bühlmann ZHL-16C
+ *
+ * Replays the profile of a parsed dive through the 16 nitrogen and
+ * helium compartments of the ZHL-16C model, and reports the
+ * decompression status after every sample:
+ *
+ *   ceiling    Ceiling depth (m), or zero without a ceiling.
+ *   gf99       Supersaturation at the current depth, as a percentage of
+ *              the M-value of the leading compartment.
+ *   surfacegf  Supersaturation at the surface, in the same units.
+ *   tts        Time to surface (s), for an ascent at 10 m/min with
+ *              stops every 3 m, on the gas in use.
+ *
+ * The gradient factors are in percent. With zero values, the gradient
+ * factors of the dive are used if available, or 100/100 otherwise. For
+ * CCR dives, the inspired gas is derived from the setpoint samples and
+ * the diluent.
+ *
+ * The results table must have room for one entry per dive sample.
+ */
+
+typedef struct dc_buhlmann_sample_t {
+	double ceiling;
+	double gf99;
+	double surfacegf;
+	unsigned int tts;
+} dc_buhlmann_sample_t;
+
+dc_status_t
+dc_buhlmann_compute (const dc_dive_t *dive, unsigned int gflow, unsigned int gfhigh, dc_buhlmann_sample_t results[]);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_BUHLMANN_H */
@@ -0,0 +1,91 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#ifndef DC_CONSUMPTION_H
+#define DC_CONSUMPTION_H
+
+#include "common.h"
+#include "parser.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Gas consumption
+ *
+ * Computes the gas consumption of a parsed dive from its tank pressure
+ * samples, in a single pass over the profile. All rates are normalized
+ * to the surface pressure: the SAC is the pressure drop in bar/min, and
+ * the RMV the gas volume in l/min. The RMV (and the consumed volume) is
+ * only available for tanks with a known volume, and zero otherwise.
+ *
+ * The points table contains the SAC and RMV series of every tank, with
+ * one entry for every pressure sample that has an earlier sample within
+ * the smoothing window (in seconds). The rate is measured over the
+ * window, and negative rates (e.g. due to temperature changes) are
+ * reported as zero.
+ *
+ * The dive is split into segments at every gas switch. The segments
+ * table contains the consumption of every tank with pressure samples
+ * within the segment, together with the gas mix that was in use. The
+ * sample at a gas switch is shared by both segments, so no consumption
+ * is lost between them.
+ *
+ * The result is stored in a single memory block, which is released with
+ * dc_consumption_free.
+ */
+
+typedef struct dc_consumption_point_t {
+	unsigned int tank;
+	unsigned int time;   /* Milliseconds */
+	double sac;          /* bar/min */
+	double rmv;          /* l/min */
+} dc_consumption_point_t;
+
+typedef struct dc_consumption_segment_t {
+	unsigned int tank;
+	unsigned int gasmix; /* Gas mix index, or DC_GASMIX_UNKNOWN */
+	unsigned int begintime, endtime; /* Milliseconds */
+	double beginpressure, endpressure; /* bar */
+	double avgdepth;     /* m */
+	double volume;       /* Consumed gas (liter at the surface) */
+	double sac;          /* bar/min */
+	double rmv;          /* l/min */
+} dc_consumption_segment_t;
+
+typedef struct dc_consumption_t {
+	unsigned int npoints;
+	dc_consumption_point_t *points;
+	unsigned int nsegments;
+	dc_consumption_segment_t *segments;
+} dc_consumption_t;
+
+dc_status_t
+dc_consumption_compute (const dc_dive_t *dive, unsigned int window, dc_consumption_t **consumption);
+
+void
+dc_consumption_free (dc_consumption_t *consumption);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+#endif /* DC_CONSUMPTION_H */
@@ -32,6 +32,9 @@ extern "C" {
 dc_status_t
 divesystem_idive_device_fwupdate (dc_device_t *abstract, const char *filename);
 
+dc_status_t
+divesystem_idive_device_fwupdate_buffer (dc_device_t *abstract, const unsigned char data[], size_t size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
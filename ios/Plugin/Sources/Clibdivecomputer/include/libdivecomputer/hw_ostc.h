@@ -58,6 +58,9 @@ hw_ostc_device_screenshot (dc_device_t *device, dc_buffer_t *buffer, hw_ostc_for
 dc_status_t
 hw_ostc_device_fwupdate (dc_device_t *abstract, const char *filename);
 
+dc_status_t
+hw_ostc_device_fwupdate_buffer (dc_device_t *abstract, const unsigned char data[], size_t size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
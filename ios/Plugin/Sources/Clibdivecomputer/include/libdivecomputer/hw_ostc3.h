@@ -57,6 +57,9 @@ hw_ostc3_device_config_reset (dc_device_t *abstract);
 dc_status_t
 hw_ostc3_device_fwupdate (dc_device_t *abstract, const char *filename);
 
+dc_status_t
+hw_ostc3_device_fwupdate_buffer (dc_device_t *abstract, const unsigned char data[], size_t size);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -13,10 +13,18 @@
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/descriptor.h>
 #include <libdivecomputer/device.h>
+#include <libdivecomputer/datetime.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/buhlmann.h>
+#include <libdivecomputer/consumption.h>
+#include <libdivecomputer/export.h>
+#include <libdivecomputer/fingerprint.h>
 #include <libdivecomputer/iostream.h>
 #include <libdivecomputer/custom.h>
 #include <libdivecomputer/array.h>
+#include <libdivecomputer/hw_ostc.h>
+#include <libdivecomputer/hw_ostc3.h>
+#include <libdivecomputer/divesystem_idive.h>
 
 dc_status_t dc_parser_new2(dc_parser_t **parser, dc_context_t *context, dc_descriptor_t *descriptor, const unsigned char *data, size_t size);
 dc_descriptor_t *dc_descriptor_get(dc_family_t family, unsigned int model);
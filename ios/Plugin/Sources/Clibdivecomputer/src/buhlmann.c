@@ -0,0 +1,425 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <string.h>
+#include <math.h>
+
+#include <libdivecomputer/buhlmann.h>
+#include <libdivecomputer/units.h>
+
+#include "parser-private.h"
+
+#ifndef M_LN2
+#define M_LN2 0.69314718055994530942
+#endif
+
+#define NCOMPARTMENTS 16
+
+#define WATERVAPOUR 0.0627 // bar
+#define AIR_N2      0.7902
+
+#define ASCENTRATE  10.0   // m/min
+#define STOPSTEP    3.0    // m
+#define STOPTIME    60     // s
+#define MAXTTS      (24 * 3600)
+
+/*
+ * ZHL-16C coefficients: half-times (min), and the a (bar) and b values
+ * of the M-value lines.
+ */
+static const double n2_halftime[NCOMPARTMENTS] = {
+	5.0, 8.0, 12.5, 18.5, 27.0, 38.3, 54.3, 77.0,
+	109.0, 146.0, 187.0, 239.0, 305.0, 390.0, 498.0, 635.0};
+static const double n2_a[NCOMPARTMENTS] = {
+	1.1696, 1.0000, 0.8618, 0.7562, 0.6200, 0.5043, 0.4410, 0.4000,
+	0.3750, 0.3500, 0.3295, 0.3065, 0.2835, 0.2610, 0.2480, 0.2327};
+static const double n2_b[NCOMPARTMENTS] = {
+	0.5578, 0.6514, 0.7222, 0.7825, 0.8126, 0.8434, 0.8693, 0.8910,
+	0.9092, 0.9222, 0.9319, 0.9403, 0.9477, 0.9544, 0.9602, 0.9653};
+
+static const double he_halftime[NCOMPARTMENTS] = {
+	1.88, 3.02, 4.72, 6.99, 10.21, 14.48, 20.53, 29.11,
+	41.20, 55.19, 70.69, 90.34, 115.29, 147.42, 188.24, 240.03};
+static const double he_a[NCOMPARTMENTS] = {
+	1.6189, 1.3830, 1.1919, 1.0458, 0.9220, 0.8205, 0.7305, 0.6502,
+	0.5950, 0.5545, 0.5333, 0.5189, 0.5181, 0.5176, 0.5172, 0.5119};
+static const double he_b[NCOMPARTMENTS] = {
+	0.4770, 0.5747, 0.6527, 0.7223, 0.7582, 0.7957, 0.8279, 0.8553,
+	0.8757, 0.8903, 0.8997, 0.9073, 0.9122, 0.9171, 0.9217, 0.9267};
+
+typedef struct buhlmann_tissues_t {
+	double n2[NCOMPARTMENTS];
+	double he[NCOMPARTMENTS];
+} buhlmann_tissues_t;
+
+/*
+ * Fraction of the pressure difference that is taken up during an
+ * interval, for every compartment. The exponentials only depend on the
+ * length of the interval, so they are computed once and reused for as
+ * long as the interval does not change.
+ */
+typedef struct buhlmann_factors_t {
+	unsigned int interval; // ms
+	double n2[NCOMPARTMENTS];
+	double he[NCOMPARTMENTS];
+} buhlmann_factors_t;
+
+typedef struct buhlmann_t {
+	double surface;   // bar
+	double density;   // bar/m
+	double gflow, gfhigh;
+	double anchor;    // Pressure of the deepest gflow ceiling (bar)
+	// Gas in use.
+	double fn2, fhe;
+	double setpoint;
+	int ccr;
+	buhlmann_factors_t sample, ascent, stop;
+} buhlmann_t;
+
+static void
+buhlmann_factors (buhlmann_factors_t *factors, unsigned int interval)
+{
+	if (factors->interval == interval)
+		return;
+
+	double minutes = interval / 60000.0;
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		factors->n2[i] = 1.0 - exp (-M_LN2 * minutes / n2_halftime[i]);
+		factors->he[i] = 1.0 - exp (-M_LN2 * minutes / he_halftime[i]);
+	}
+
+	factors->interval = interval;
+}
+
+static void
+buhlmann_update (buhlmann_tissues_t *tissues, const buhlmann_factors_t *factors, double pn2, double phe)
+{
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		tissues->n2[i] += (pn2 - tissues->n2[i]) * factors->n2[i];
+		tissues->he[i] += (phe - tissues->he[i]) * factors->he[i];
+	}
+}
+
+static void
+buhlmann_inspired (const buhlmann_t *model, double pressure, double *pn2, double *phe)
+{
+	double alveolar = pressure - WATERVAPOUR;
+	if (alveolar < 0.0)
+		alveolar = 0.0;
+
+	double finert = model->fn2 + model->fhe;
+	double inert = alveolar * finert;
+	if (model->ccr && model->setpoint > 0.0 && alveolar - model->setpoint < inert) {
+		inert = alveolar - model->setpoint;
+		if (inert < 0.0)
+			inert = 0.0;
+	}
+
+	if (finert > 0.0) {
+		*pn2 = inert * model->fn2 / finert;
+		*phe = inert * model->fhe / finert;
+	} else {
+		*pn2 = 0.0;
+		*phe = 0.0;
+	}
+}
+
+static void
+buhlmann_gasmix (buhlmann_t *model, const dc_gasmix_t *gasmix)
+{
+	double oxygen = gasmix->oxygen, helium = gasmix->helium;
+
+	if (helium < 0.0)
+		helium = 0.0;
+	if (helium > 1.0)
+		helium = 1.0;
+	if (oxygen < 0.0)
+		oxygen = 0.0;
+
+	model->fhe = helium;
+	model->fn2 = 1.0 - oxygen - helium;
+	if (model->fn2 < 0.0)
+		model->fn2 = 0.0;
+}
+
+static void
+buhlmann_step (const buhlmann_t *model, buhlmann_tissues_t *tissues, const buhlmann_factors_t *factors, double pressure)
+{
+	double pn2 = 0.0, phe = 0.0;
+
+	buhlmann_inspired (model, pressure, &pn2, &phe);
+	buhlmann_update (tissues, factors, pn2, phe);
+}
+
+/*
+ * Gradient factor at the given ambient pressure, interpolated between
+ * gflow at the deepest ceiling and gfhigh at the surface.
+ */
+static double
+buhlmann_gf (const buhlmann_t *model, double pressure)
+{
+	if (model->anchor <= model->surface || pressure <= model->surface)
+		return model->gfhigh;
+	if (pressure >= model->anchor)
+		return model->gflow;
+
+	return model->gfhigh + (model->gflow - model->gfhigh) *
+		(pressure - model->surface) / (model->anchor - model->surface);
+}
+
+/*
+ * Lowest tolerated ambient pressure for a fixed gradient factor.
+ */
+static double
+buhlmann_tolerated (const buhlmann_tissues_t *tissues, double gf)
+{
+	double result = 0.0;
+
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		double p = tissues->n2[i] + tissues->he[i];
+		if (p <= 0.0)
+			continue;
+		double a = (n2_a[i] * tissues->n2[i] + he_a[i] * tissues->he[i]) / p;
+		double b = (n2_b[i] * tissues->n2[i] + he_b[i] * tissues->he[i]) / p;
+		double tolerated = (p - a * gf) / (gf / b + 1.0 - gf);
+		if (result < tolerated)
+			result = tolerated;
+	}
+
+	return result;
+}
+
+/*
+ * Check whether all compartments tolerate the given ambient pressure.
+ * This is the hot path of the time to surface calculation, so the test
+ * p <= P + gf * (P / b + a - P) is multiplied by the (positive) weighted
+ * sums behind a and b, to avoid the divisions.
+ */
+static int
+buhlmann_allowed (const buhlmann_tissues_t *tissues, double pressure, double gf)
+{
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		double p = tissues->n2[i] + tissues->he[i];
+		double pa = n2_a[i] * tissues->n2[i] + he_a[i] * tissues->he[i];
+		double pb = n2_b[i] * tissues->n2[i] + he_b[i] * tissues->he[i];
+		if (p * pb * (p - pressure) > gf * (pressure * p * (p - pb) + pa * pb))
+			return 0;
+	}
+
+	return 1;
+}
+
+/*
+ * Supersaturation of the leading compartment at the given ambient
+ * pressure, as a fraction of its M-value.
+ */
+static double
+buhlmann_gradient (const buhlmann_tissues_t *tissues, double pressure)
+{
+	double result = 0.0;
+
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		double p = tissues->n2[i] + tissues->he[i];
+		if (p <= 0.0)
+			continue;
+		double a = (n2_a[i] * tissues->n2[i] + he_a[i] * tissues->he[i]) / p;
+		double b = (n2_b[i] * tissues->n2[i] + he_b[i] * tissues->he[i]) / p;
+		double gradient = (p - pressure) / (pressure / b + a - pressure);
+		if (result < gradient)
+			result = gradient;
+	}
+
+	return result;
+}
+
+/*
+ * Ceiling with the gradient factor interpolated over the depth. The
+ * result lies between the ceilings for gfhigh and gflow, and is located
+ * with a bisection.
+ */
+static double
+buhlmann_ceiling (const buhlmann_t *model, const buhlmann_tissues_t *tissues)
+{
+	double lo = buhlmann_tolerated (tissues, model->gfhigh);
+	double hi = buhlmann_tolerated (tissues, model->gflow);
+
+	if (hi <= model->surface)
+		return model->surface;
+	if (lo < model->surface)
+		lo = model->surface;
+
+	for (unsigned int i = 0; i < 20 && hi - lo > 1e-4; ++i) {
+		double mid = (lo + hi) / 2.0;
+		if (buhlmann_allowed (tissues, mid, buhlmann_gf (model, mid)))
+			hi = mid;
+		else
+			lo = mid;
+	}
+
+	return hi;
+}
+
+static unsigned int
+buhlmann_tts (const buhlmann_t *model, const buhlmann_tissues_t *current, double depth)
+{
+	buhlmann_tissues_t tissues = *current;
+	unsigned int tts = 0;
+
+	while (depth > 0.0 && tts < MAXTTS) {
+		double next = STOPSTEP * ceil (depth / STOPSTEP - 1e-9) - STOPSTEP;
+		if (next < 0.0)
+			next = 0.0;
+
+		double pressure = model->surface + depth * model->density;
+		double pnext = model->surface + next * model->density;
+
+		if (!buhlmann_allowed (&tissues, pnext, buhlmann_gf (model, pnext))) {
+			buhlmann_step (model, &tissues, &model->stop, pressure);
+			tts += STOPTIME;
+			continue;
+		}
+
+		// Ascent to the next stop, with the average pressure over the
+		// segment. Only the first segment can be shorter than a full
+		// stop step.
+		unsigned int interval = (unsigned int) ((depth - next) * 60000.0 / ASCENTRATE + 0.5);
+		buhlmann_factors_t partial = {0};
+		const buhlmann_factors_t *factors = &model->ascent;
+		if (interval != model->ascent.interval) {
+			buhlmann_factors (&partial, interval);
+			factors = &partial;
+		}
+		buhlmann_step (model, &tissues, factors, (pressure + pnext) / 2.0);
+
+		tts += (interval + 500) / 1000;
+		depth = next;
+	}
+
+	return tts;
+}
+
+dc_status_t
+dc_buhlmann_compute (const dc_dive_t *dive, unsigned int gflow, unsigned int gfhigh, dc_buhlmann_sample_t results[])
+{
+	buhlmann_t model;
+	buhlmann_tissues_t tissues;
+
+	if (dive == NULL || (results == NULL && dive->nsamples))
+		return DC_STATUS_INVALIDARGS;
+
+	if (gflow == 0 || gfhigh == 0) {
+		if ((dive->fields & DC_FIELD_MASK (DC_FIELD_DECOMODEL)) &&
+			dive->decomodel.type == DC_DECOMODEL_BUHLMANN &&
+			dive->decomodel.params.gf.low && dive->decomodel.params.gf.high) {
+			gflow = dive->decomodel.params.gf.low;
+			gfhigh = dive->decomodel.params.gf.high;
+		} else {
+			gflow = 100;
+			gfhigh = 100;
+		}
+	}
+
+	if (gflow > 100 || gfhigh > 100)
+		return DC_STATUS_INVALIDARGS;
+
+	memset (&model, 0, sizeof (model));
+	model.gflow = gflow / 100.0;
+	model.gfhigh = gfhigh / 100.0;
+
+	model.surface = DEF_ATMOSPHERIC / BAR;
+	if ((dive->fields & DC_FIELD_MASK (DC_FIELD_ATMOSPHERIC)) && dive->atmospheric > 0.0)
+		model.surface = dive->atmospheric;
+
+	double density = DEF_DENSITY_SALT;
+	if ((dive->fields & DC_FIELD_MASK (DC_FIELD_SALINITY)) && dive->salinity.density > 0.0)
+		density = dive->salinity.density;
+	model.density = density * GRAVITY / BAR;
+
+	model.ccr = (dive->fields & DC_FIELD_MASK (DC_FIELD_DIVEMODE)) &&
+		dive->divemode == DC_DIVEMODE_CCR;
+
+	// Start with the first gas mix, or air.
+	model.fn2 = AIR_N2;
+	model.fhe = 0.0;
+	if (dive->ngasmixes)
+		buhlmann_gasmix (&model, dive->gasmixes);
+
+	// Fixed intervals of the time to surface calculation.
+	model.ascent.interval = ~0u;
+	model.stop.interval = ~0u;
+	model.sample.interval = ~0u;
+	buhlmann_factors (&model.ascent, (unsigned int) (STOPSTEP * 60000.0 / ASCENTRATE + 0.5));
+	buhlmann_factors (&model.stop, STOPTIME * 1000);
+
+	// Tissues saturated with air at the surface.
+	for (unsigned int i = 0; i < NCOMPARTMENTS; ++i) {
+		tissues.n2[i] = (model.surface - WATERVAPOUR) * AIR_N2;
+		tissues.he[i] = 0.0;
+	}
+
+	unsigned int time = 0;
+	double depth = 0.0;
+	for (unsigned int i = 0; i < dive->nsamples; ++i) {
+		const dc_dive_sample_t *sample = dive->samples + i;
+
+		unsigned int t = time;
+		if ((sample->fields & DC_SAMPLE_MASK (DC_SAMPLE_TIME)) && sample->time > time)
+			t = sample->time;
+
+		double d = depth;
+		if (sample->fields & DC_SAMPLE_MASK (DC_SAMPLE_DEPTH))
+			d = sample->depth > 0.0 ? sample->depth : 0.0;
+
+		// The interval since the previous sample is breathed on the
+		// previous gas, at the average pressure.
+		if (t > time) {
+			buhlmann_factors (&model.sample, t - time);
+			buhlmann_step (&model, &tissues, &model.sample,
+				model.surface + (depth + d) / 2.0 * model.density);
+		}
+
+		time = t;
+		depth = d;
+
+		if ((sample->fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX)) &&
+			sample->gasmix < dive->ngasmixes) {
+			buhlmann_gasmix (&model, dive->gasmixes + sample->gasmix);
+		}
+
+		if (sample->fields & DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT))
+			model.setpoint = sample->setpoint;
+
+		// Anchor the gradient factors at the deepest gflow ceiling.
+		double anchor = buhlmann_tolerated (&tissues, model.gflow);
+		if (model.anchor < anchor)
+			model.anchor = anchor;
+
+		double pressure = model.surface + depth * model.density;
+		double ceiling = buhlmann_ceiling (&model, &tissues);
+
+		results[i].ceiling = (ceiling - model.surface) / model.density;
+		results[i].gf99 = buhlmann_gradient (&tissues, pressure) * 100.0;
+		results[i].surfacegf = buhlmann_gradient (&tissues, model.surface) * 100.0;
+		results[i].tts = buhlmann_tts (&model, &tissues, depth);
+	}
+
+	return DC_STATUS_SUCCESS;
+}
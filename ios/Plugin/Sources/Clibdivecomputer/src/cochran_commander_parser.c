@@ -556,7 +556,7 @@ cochran_commander_parser_samples_foreach_tm (dc_parser_t *abstract, dc_sample_ca
 	const unsigned char *data = abstract->data;
 	const unsigned char *samples = data + layout->headersize;
 
-	if (abstract->size < layout->headersize)
+	if (abstract->size < layout->headersize + 2)
 		return DC_STATUS_DATAFORMAT;
 
 	unsigned int size = abstract->size - layout->headersize;
@@ -752,7 +752,10 @@ cochran_commander_parser_samples_foreach_emc (dc_parser_t *abstract, dc_sample_c
 
 		// Check for event
 		if (s[0] & 0x80) {
-			offset += cochran_commander_handle_event(parser, s[0], callback, userdata);
+			unsigned int length = cochran_commander_handle_event(parser, s[0], callback, userdata);
+			if (offset + length > size)
+				break;
+			offset += length;
 
 			// Events indicating change in deco status
 			switch (s[0]) {
@@ -58,6 +58,9 @@ extern "C" {
 #define DEBUG(context, ...) UNUSED(context)
 #endif
 
+dc_loglevel_t
+dc_context_get_loglevel (dc_context_t *context);
+
 dc_status_t
 dc_context_log (dc_context_t *context, dc_loglevel_t loglevel, const char *file, unsigned int line, const char *function, const char *format, ...) DC_ATTR_FORMAT_PRINTF(6, 7);
 
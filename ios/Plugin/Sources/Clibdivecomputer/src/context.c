@@ -163,6 +163,19 @@ dc_context_set_loglevel (dc_context_t *context, dc_loglevel_t loglevel)
 	return DC_STATUS_SUCCESS;
 }
 
+dc_loglevel_t
+dc_context_get_loglevel (dc_context_t *context)
+{
+	if (context == NULL)
+		return DC_LOGLEVEL_NONE;
+
+#ifdef ENABLE_LOGGING
+	return context->loglevel;
+#else
+	return DC_LOGLEVEL_NONE;
+#endif
+}
+
 dc_status_t
 dc_context_set_logfunc (dc_context_t *context, dc_logfunc_t logfunc, void *userdata)
 {
@@ -161,6 +161,9 @@ cressi_leonardo_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callbac
 	const unsigned char *data = abstract->data;
 	unsigned int size = abstract->size;
 
+	if (size < SZ_HEADER)
+		return DC_STATUS_DATAFORMAT;
+
 	unsigned int time = 0;
 	unsigned int interval = 20;
 	if (parser->model == DRAKE) {
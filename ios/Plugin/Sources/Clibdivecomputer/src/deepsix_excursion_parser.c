@@ -609,7 +609,8 @@ deepsix_excursion_parser_samples_foreach_v1 (dc_parser_t *abstract, dc_sample_ca
 			unsigned int event_offset = 2;
 
 			for (unsigned int i = 0; i < nevents; i++) {
-				if ((events & (1 << event_info[i].type)) == 0)
+				if (event_info[i].type >= 16 ||
+					(events & (1 << event_info[i].type)) == 0)
 					continue;
 
 				if (event_offset + event_info[i].size > length) {
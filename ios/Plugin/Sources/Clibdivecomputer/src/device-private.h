@@ -26,6 +26,7 @@
 
 #include <libdivecomputer/context.h>
 #include <libdivecomputer/device.h>
+#include <libdivecomputer/fingerprint.h>
 
 #include "common-private.h"
 
@@ -54,6 +55,12 @@ struct dc_device_t {
 	// Cached events for the parsers.
 	dc_event_devinfo_t devinfo;
 	dc_event_clock_t clock;
+	int have_devinfo;
+	// Persistent fingerprint store.
+	dc_fingerprint_store_t *fingerprint_store;
+	int have_fingerprint; // Set explicitly by the application.
+	// Warm start data.
+	dc_buffer_t *warmstart;
 };
 
 struct dc_device_vtable_t {
@@ -91,6 +98,12 @@ device_event_emit (dc_device_t *device, dc_event_type_t event, const void *data)
 int
 device_is_cancelled (dc_device_t *device);
 
+int
+device_warmstart_get (dc_device_t *device, unsigned int serial, unsigned char data[], unsigned int size);
+
+void
+device_warmstart_set (dc_device_t *device, unsigned int serial, const unsigned char data[], unsigned int size);
+
 dc_status_t
 device_dump_read (dc_device_t *device, unsigned int address, unsigned char data[], unsigned int size, unsigned int blocksize);
 
@@ -70,6 +70,12 @@
 
 #include "device-private.h"
 #include "context-private.h"
+#include "array.h"
+
+// Warm start header: magic, version, payload size, family and serial.
+#define WARMSTART_MAGIC   0x53574344 // "DCWS"
+#define WARMSTART_VERSION 1
+#define WARMSTART_HEADER  16
 
 dc_device_t *
 dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
@@ -99,6 +105,12 @@ dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 
 	memset (&device->devinfo, 0, sizeof (device->devinfo));
 	memset (&device->clock, 0, sizeof (device->clock));
+	device->have_devinfo = 0;
+
+	device->fingerprint_store = NULL;
+	device->have_fingerprint = 0;
+
+	device->warmstart = NULL;
 
 	return device;
 }
@@ -106,6 +118,7 @@ dc_device_allocate (dc_context_t *context, const dc_device_vtable_t *vtable)
 void
 dc_device_deallocate (dc_device_t *device)
 {
+	dc_buffer_free (device->warmstart);
 	free (device);
 }
 
@@ -319,7 +332,154 @@ dc_device_set_fingerprint (dc_device_t *device, const unsigned char data[], unsi
 
 	HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Fingerprint", data, size);
 
-	return device->vtable->set_fingerprint (device, data, size);
+	dc_status_t status = device->vtable->set_fingerprint (device, data, size);
+	if (status == DC_STATUS_SUCCESS)
+		device->have_fingerprint = 1;
+
+	return status;
+}
+
+dc_status_t
+dc_device_set_warmstart (dc_device_t *device, const unsigned char data[], unsigned int size)
+{
+	if (device == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (size == 0) {
+		dc_buffer_clear (device->warmstart);
+		return DC_STATUS_SUCCESS;
+	}
+
+	if (data == NULL || size < WARMSTART_HEADER ||
+		array_uint32_le (data) != WARMSTART_MAGIC ||
+		array_uint16_le (data + 4) != WARMSTART_VERSION ||
+		array_uint16_le (data + 6) != size - WARMSTART_HEADER) {
+		WARNING (device->context, "Invalid warm start data.");
+		return DC_STATUS_INVALIDARGS;
+	}
+
+	if (array_uint32_le (data + 8) != device->vtable->type)
+		return DC_STATUS_INVALIDARGS;
+
+	if (device->warmstart == NULL) {
+		device->warmstart = dc_buffer_new (size);
+		if (device->warmstart == NULL)
+			return DC_STATUS_NOMEMORY;
+	}
+
+	if (!dc_buffer_clear (device->warmstart) ||
+		!dc_buffer_append (device->warmstart, data, size))
+		return DC_STATUS_NOMEMORY;
+
+	HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Warm start", data, size);
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_device_get_warmstart (dc_device_t *device, dc_buffer_t *buffer)
+{
+	if (device == NULL || buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (!dc_buffer_clear (buffer))
+		return DC_STATUS_NOMEMORY;
+
+	if (device->warmstart && dc_buffer_get_size (device->warmstart)) {
+		if (!dc_buffer_append (buffer,
+			dc_buffer_get_data (device->warmstart),
+			dc_buffer_get_size (device->warmstart)))
+			return DC_STATUS_NOMEMORY;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+int
+device_warmstart_get (dc_device_t *device, unsigned int serial, unsigned char data[], unsigned int size)
+{
+	if (device->warmstart == NULL ||
+		dc_buffer_get_size (device->warmstart) != WARMSTART_HEADER + size)
+		return 0;
+
+	const unsigned char *blob = dc_buffer_get_data (device->warmstart);
+	if (array_uint32_le (blob + 12) != serial) {
+		DEBUG (device->context, "Warm start data of another device.");
+		return 0;
+	}
+
+	memcpy (data, blob + WARMSTART_HEADER, size);
+
+	return 1;
+}
+
+void
+device_warmstart_set (dc_device_t *device, unsigned int serial, const unsigned char data[], unsigned int size)
+{
+	unsigned char header[WARMSTART_HEADER] = {0};
+
+	if (size > 0xFFFF)
+		return;
+
+	if (device->warmstart == NULL) {
+		device->warmstart = dc_buffer_new (WARMSTART_HEADER + size);
+		if (device->warmstart == NULL)
+			return;
+	}
+
+	array_uint32_le_set (header + 0, WARMSTART_MAGIC);
+	array_uint16_le_set (header + 4, WARMSTART_VERSION);
+	array_uint16_le_set (header + 6, size);
+	array_uint32_le_set (header + 8, device->vtable->type);
+	array_uint32_le_set (header + 12, serial);
+
+	// On failure, no stale data is left behind.
+	if (!dc_buffer_clear (device->warmstart) ||
+		!dc_buffer_append (device->warmstart, header, sizeof (header)) ||
+		!dc_buffer_append (device->warmstart, data, size))
+		dc_buffer_clear (device->warmstart);
+}
+
+static void
+device_fingerprint_load (dc_device_t *device)
+{
+	unsigned char data[DC_FINGERPRINT_MAXSIZE];
+	unsigned int size = 0;
+
+	if (device->fingerprint_store == NULL || device->have_fingerprint ||
+		device->vtable->set_fingerprint == NULL)
+		return;
+
+	dc_status_t status = dc_fingerprint_store_get (device->fingerprint_store,
+		device->vtable->type, device->devinfo.model, device->devinfo.serial,
+		data, sizeof (data), &size);
+	if (status != DC_STATUS_SUCCESS || size == 0)
+		return;
+
+	HEXDUMP (device->context, DC_LOGLEVEL_INFO, "Stored fingerprint", data, size);
+
+	status = device->vtable->set_fingerprint (device, data, size);
+	if (status != DC_STATUS_SUCCESS) {
+		WARNING (device->context, "Failed to apply the stored fingerprint.");
+	}
+}
+
+dc_status_t
+dc_device_set_fingerprint_store (dc_device_t *device, dc_fingerprint_store_t *store)
+{
+	if (device == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	if (device->vtable->set_fingerprint == NULL)
+		return DC_STATUS_UNSUPPORTED;
+
+	device->fingerprint_store = store;
+
+	// Some devices are already identified when they are opened.
+	if (device->have_devinfo)
+		device_fingerprint_load (device);
+
+	return DC_STATUS_SUCCESS;
 }
 
 
@@ -404,6 +564,37 @@ device_dump_read (dc_device_t *device, unsigned int address, unsigned char data[
 }
 
 
+typedef struct device_foreach_t {
+	dc_dive_callback_t callback;
+	void *userdata;
+	unsigned int ndives;
+	unsigned int stopped;
+	unsigned int size;
+	unsigned char fingerprint[DC_FINGERPRINT_MAXSIZE];
+} device_foreach_t;
+
+static int
+device_foreach_cb (const unsigned char *data, unsigned int size, const unsigned char *fingerprint, unsigned int fsize, void *userdata)
+{
+	device_foreach_t *state = (device_foreach_t *) userdata;
+
+	// The dives are downloaded in reverse order, and the first one is
+	// the most recent dive.
+	if (state->ndives++ == 0 && fingerprint && fsize <= sizeof (state->fingerprint)) {
+		memcpy (state->fingerprint, fingerprint, fsize);
+		state->size = fsize;
+	}
+
+	if (state->callback == NULL)
+		return 1;
+
+	int rc = state->callback (data, size, fingerprint, fsize, state->userdata);
+	if (!rc)
+		state->stopped = 1;
+
+	return rc;
+}
+
 dc_status_t
 dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userdata)
 {
@@ -413,7 +604,31 @@ dc_device_foreach (dc_device_t *device, dc_dive_callback_t callback, void *userd
 	if (device->vtable->foreach == NULL)
 		return DC_STATUS_UNSUPPORTED;
 
-	return device->vtable->foreach (device, callback, userdata);
+	if (device->fingerprint_store == NULL)
+		return device->vtable->foreach (device, callback, userdata);
+
+	device_foreach_t state;
+	state.callback = callback;
+	state.userdata = userdata;
+	state.ndives = 0;
+	state.stopped = 0;
+	state.size = 0;
+
+	dc_status_t status = device->vtable->foreach (device, device_foreach_cb, &state);
+
+	// Only a complete download updates the store. A download stopped by
+	// the callback still returns success, but the older dives it skipped
+	// have not been seen, and must be downloaded again next time.
+	if (status == DC_STATUS_SUCCESS && !state.stopped && state.size && device->have_devinfo) {
+		dc_status_t rc = dc_fingerprint_store_set (device->fingerprint_store,
+			device->vtable->type, device->devinfo.model, device->devinfo.serial,
+			state.fingerprint, state.size);
+		if (rc != DC_STATUS_SUCCESS) {
+			WARNING (device->context, "Failed to update the fingerprint store.");
+		}
+	}
+
+	return status;
 }
 
 
@@ -487,6 +702,8 @@ device_event_emit (dc_device_t *device, dc_event_type_t event, const void *data)
 	switch (event) {
 	case DC_EVENT_DEVINFO:
 		device->devinfo = *(const dc_event_devinfo_t *) data;
+		device->have_devinfo = 1;
+		device_fingerprint_load (device);
 		break;
 	case DC_EVENT_CLOCK:
 		device->clock = *(const dc_event_clock_t *) data;
@@ -21,7 +21,6 @@
 
 #include <string.h> // memcmp, memcpy
 #include <stdlib.h> // malloc, free
-#include <stdio.h>
 
 #include "divesystem_idive.h"
 #include "context-private.h"
@@ -30,6 +29,7 @@
 #include "checksum.h"
 #include "array.h"
 #include "packet.h"
+#include "image.h"
 
 #define ISINSTANCE(device) dc_device_isinstance((device), &divesystem_idive_device_vtable)
 
@@ -700,68 +700,30 @@ divesystem_idive_device_timesync (dc_device_t *abstract, const dc_datetime_t *da
 }
 
 static dc_status_t
-divesystem_idive_firmware_readfile (dc_buffer_t *buffer, dc_context_t *context, const char *filename)
+divesystem_idive_firmware_readfile (dc_buffer_t *buffer, dc_context_t *context, dc_image_t *image)
 {
-	dc_status_t status = DC_STATUS_SUCCESS;
-	dc_buffer_t *tmp = NULL;
-	FILE *fp = NULL;
-
 	if (!dc_buffer_clear (buffer)) {
 		ERROR (context, "Invalid arguments.");
 		return DC_STATUS_INVALIDARGS;
 	}
 
-	// Allocate a temporary buffer.
-	tmp = dc_buffer_new (0x20000);
-	if (tmp == NULL) {
-		ERROR (context, "Failed to allocate memory.");
-		status = DC_STATUS_NOMEMORY;
-		goto error_exit;
-	}
-
-	// Open the file.
-	fp = fopen (filename, "rb");
-	if (fp == NULL) {
-		ERROR (context, "Failed to open the file.");
-		status = DC_STATUS_IO;
-		goto error_free;
-	}
-
-	// Read the entire file into the buffer.
-	size_t n = 0;
-	unsigned char block[4096] = {0};
-	while ((n = fread (block, 1, sizeof (block), fp)) > 0) {
-		if (!dc_buffer_append (tmp, block, n)) {
-			ERROR (context, "Insufficient buffer space available.");
-			status = DC_STATUS_NOMEMORY;
-			goto error_close;
-		}
-	}
-
 	// Resize the output buffer.
-	size_t nbytes = dc_buffer_get_size (tmp);
+	size_t nbytes = image->size;
 	if (!dc_buffer_resize (buffer, nbytes / 2)) {
 		ERROR (context, "Insufficient buffer space available.");
-		status = DC_STATUS_NOMEMORY;
-		goto error_close;
+		return DC_STATUS_NOMEMORY;
 	}
 
-	// Convert to binary data.
+	// Convert to binary data, directly from the image.
 	int rc = array_convert_hex2bin (
-		dc_buffer_get_data (tmp), dc_buffer_get_size (tmp),
+		image->data, nbytes,
 		dc_buffer_get_data (buffer), dc_buffer_get_size (buffer));
 	if (rc != 0) {
 		ERROR (context, "Unexpected data format.");
-		status = DC_STATUS_DATAFORMAT;
-		goto error_close;
+		return DC_STATUS_DATAFORMAT;
 	}
 
-error_close:
-	fclose (fp);
-error_free:
-	dc_buffer_free (tmp);
-error_exit:
-	return status;
+	return DC_STATUS_SUCCESS;
 }
 
 static dc_status_t
@@ -830,8 +792,8 @@ divesystem_idive_firmware_send (divesystem_idive_device_t *device, const divesys
 	return DC_STATUS_SUCCESS;
 }
 
-dc_status_t
-divesystem_idive_device_fwupdate (dc_device_t *abstract, const char *filename)
+static dc_status_t
+divesystem_idive_device_fwupdate_image (dc_device_t *abstract, dc_image_t *image)
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	divesystem_idive_device_t *device = (divesystem_idive_device_t *) abstract;
@@ -846,7 +808,7 @@ divesystem_idive_device_fwupdate (dc_device_t *abstract, const char *filename)
 	}
 
 	// Read the firmware file.
-	status = divesystem_idive_firmware_readfile (buffer, abstract->context, filename);
+	status = divesystem_idive_firmware_readfile (buffer, abstract->context, image);
 	if (status != DC_STATUS_SUCCESS) {
 		ERROR (abstract->context, "Failed to read the firmware file.");
 		goto error_free;
@@ -959,4 +921,42 @@ error_free:
 	dc_buffer_free (buffer);
 error_exit:
 	return status;
-}
\ No newline at end of file
+}
+
+dc_status_t
+divesystem_idive_device_fwupdate (dc_device_t *abstract, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_image_t image;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_image_open (&image, abstract->context, filename);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (abstract->context, "Failed to open the file.");
+		return status;
+	}
+
+	status = divesystem_idive_device_fwupdate_image (abstract, &image);
+
+	dc_image_close (&image);
+
+	return status;
+}
+
+dc_status_t
+divesystem_idive_device_fwupdate_buffer (dc_device_t *abstract, const unsigned char data[], size_t size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_image_t image;
+
+	if (!ISINSTANCE (abstract))
+		return DC_STATUS_INVALIDARGS;
+
+	status = dc_image_open_buffer (&image, abstract->context, data, size);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	return divesystem_idive_device_fwupdate_image (abstract, &image);
+}
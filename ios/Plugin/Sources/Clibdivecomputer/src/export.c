@@ -0,0 +1,677 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include <libdivecomputer/export.h>
+#include <libdivecomputer/units.h>
+
+#include "context-private.h"
+#include "parser-private.h"
+
+#define CELSIUS 273.15
+
+// Size of the staging buffer for the file descriptor output.
+#define CHUNK 65536
+
+#define C_ARRAY_SIZE(a) (sizeof (a) / sizeof (*(a)))
+
+typedef struct export_mix_t {
+	unsigned int oxygen; // Permille
+	unsigned int helium; // Permille
+} export_mix_t;
+
+typedef struct export_t {
+	dc_export_format_t format;
+	dc_buffer_t *buffer;
+	int fd;
+	dc_status_t status;
+	unsigned int number;
+	// Header of the current dive.
+	unsigned int divemode;
+	unsigned int ngasmixes;
+	dc_gasmix_t *gasmixes;
+	unsigned int ntanks;
+	dc_tank_t *tanks;
+	// Profile state of the current dive.
+	unsigned int nrecords;
+	unsigned int deco;
+} export_t;
+
+static const char *subsurface_events[] = {
+	"none", "deco stop", "rbt", "ascent", "ceiling", "workload",
+	"transmitter", "violation", "bookmark", "surface", "safety stop",
+	"gaschange", "safety stop (voluntary)", "safety stop (mandatory)",
+	"deepstop", "ceiling (safety stop)", "floor", "divetime", "maxdepth",
+	"OLF", "PO2", "airtime", "rgbm", "heading", "tissue level warning",
+	"gaschange",
+};
+
+static const char *subsurface_divemodes[] = {
+	"Freedive", NULL, NULL, "CCR", "PSCR",
+};
+
+static const char *uddf_divemodes[] = {
+	"apnoe", NULL, "opencircuit", "closedcircuit", "semiclosedcircuit",
+};
+
+static void
+export_flush (export_t *state)
+{
+	const unsigned char *data = dc_buffer_get_data (state->buffer);
+	size_t size = dc_buffer_get_size (state->buffer);
+	size_t nbytes = 0;
+
+	while (nbytes < size) {
+		ssize_t n = write (state->fd, data + nbytes, size - nbytes);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			state->status = DC_STATUS_IO;
+			return;
+		}
+		nbytes += n;
+	}
+
+	dc_buffer_clear (state->buffer);
+}
+
+static void
+export_printf (export_t *state, const char *format, ...)
+{
+	char line[256];
+	va_list ap;
+
+	if (state->status != DC_STATUS_SUCCESS)
+		return;
+
+	va_start (ap, format);
+	int n = vsnprintf (line, sizeof (line), format, ap);
+	va_end (ap);
+
+	if (n < 0)
+		return;
+	if ((size_t) n >= sizeof (line))
+		n = sizeof (line) - 1;
+
+	if (!dc_buffer_append (state->buffer, (const unsigned char *) line, n)) {
+		state->status = DC_STATUS_NOMEMORY;
+		return;
+	}
+
+	if (state->fd >= 0 && dc_buffer_get_size (state->buffer) >= CHUNK)
+		export_flush (state);
+}
+
+static export_mix_t
+export_mix (const dc_gasmix_t *gasmix)
+{
+	export_mix_t mix;
+	double oxygen = gasmix->oxygen, helium = gasmix->helium;
+
+	if (oxygen < 0.0) oxygen = 0.0;
+	if (oxygen > 1.0) oxygen = 1.0;
+	if (helium < 0.0) helium = 0.0;
+	if (helium > 1.0 - oxygen) helium = 1.0 - oxygen;
+
+	mix.oxygen = (unsigned int) (oxygen * 1000.0 + 0.5);
+	mix.helium = (unsigned int) (helium * 1000.0 + 0.5);
+
+	return mix;
+}
+
+static unsigned int
+export_get_count (dc_parser_t *parser, dc_field_type_t type)
+{
+	unsigned int count = 0;
+	if (dc_parser_get_field (parser, type, 0, &count) != DC_STATUS_SUCCESS)
+		return 0;
+	return count;
+}
+
+static dc_status_t
+export_header (export_t *state, dc_parser_t *parser, dc_buffer_t *header)
+{
+	state->divemode = DC_DIVEMODE_OC;
+	dc_parser_get_field (parser, DC_FIELD_DIVEMODE, 0, &state->divemode);
+
+	unsigned int ngasmixes = export_get_count (parser, DC_FIELD_GASMIX_COUNT);
+	unsigned int ntanks = export_get_count (parser, DC_FIELD_TANK_COUNT);
+
+	size_t size = ngasmixes * sizeof (dc_gasmix_t) + ntanks * sizeof (dc_tank_t);
+	if (!dc_buffer_clear (header) || !dc_buffer_resize (header, size))
+		return DC_STATUS_NOMEMORY;
+
+	unsigned char *data = dc_buffer_get_data (header);
+	state->gasmixes = (dc_gasmix_t *) data;
+	state->ngasmixes = ngasmixes;
+	state->tanks = (dc_tank_t *) (data + ngasmixes * sizeof (dc_gasmix_t));
+	state->ntanks = ntanks;
+
+	if (size)
+		memset (data, 0, size);
+	for (unsigned int i = 0; i < ngasmixes; ++i)
+		dc_parser_get_field (parser, DC_FIELD_GASMIX, i, state->gasmixes + i);
+	for (unsigned int i = 0; i < ntanks; ++i)
+		dc_parser_get_field (parser, DC_FIELD_TANK, i, state->tanks + i);
+
+	return DC_STATUS_SUCCESS;
+}
+
+static void
+export_time (export_t *state, const char *name, unsigned int seconds)
+{
+	export_printf (state, " %s='%u:%02u min'", name, seconds / 60, seconds % 60);
+}
+
+/*
+ * Subsurface XML
+ */
+
+static unsigned int
+subsurface_cylinder (export_t *state, unsigned int gasmix)
+{
+	if (state->ntanks == 0)
+		return gasmix;
+
+	for (unsigned int i = 0; i < state->ntanks; ++i) {
+		if (state->tanks[i].gasmix == gasmix)
+			return i;
+	}
+
+	return DC_GASMIX_UNKNOWN;
+}
+
+static void
+subsurface_sample (const dc_sample_record_t *record, void *userdata)
+{
+	export_t *state = (export_t *) userdata;
+	unsigned int time = record->time / 1000;
+
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX)) {
+		unsigned int cylinder = subsurface_cylinder (state, record->gasmix);
+		export_printf (state, "<event");
+		export_time (state, "time", time);
+		export_printf (state, " type='25' name='gaschange'");
+		if (cylinder != DC_GASMIX_UNKNOWN)
+			export_printf (state, " cylinder='%u'", cylinder);
+		if (record->gasmix < state->ngasmixes) {
+			export_mix_t mix = export_mix (state->gasmixes + record->gasmix);
+			export_printf (state, " value='%u'", (mix.helium / 10) << 16 | (mix.oxygen / 10));
+		}
+		export_printf (state, " />\n");
+	}
+
+	for (unsigned int i = 0; i < record->nevents; ++i) {
+		unsigned int type = record->event[i].type;
+		if (type == SAMPLE_EVENT_NONE || type == SAMPLE_EVENT_GASCHANGE ||
+			type == SAMPLE_EVENT_GASCHANGE2 || type >= C_ARRAY_SIZE (subsurface_events))
+			continue;
+		export_printf (state, "<event");
+		export_time (state, "time", time + record->event[i].time);
+		export_printf (state, " type='%u'", type);
+		if (record->event[i].flags)
+			export_printf (state, " flags='%u'", record->event[i].flags);
+		if (record->event[i].value)
+			export_printf (state, " value='%u'", record->event[i].value);
+		export_printf (state, " name='%s' />\n", subsurface_events[type]);
+	}
+
+	export_printf (state, "<sample");
+	export_time (state, "time", time);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_DEPTH))
+		export_printf (state, " depth='%.2f m'", record->depth);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_TEMPERATURE))
+		export_printf (state, " temp='%.1f C'", record->temperature);
+	for (unsigned int i = 0; i < record->npressure; ++i) {
+		if (record->pressure[i].tank == 0)
+			export_printf (state, " pressure='%.1f bar'", record->pressure[i].value);
+		else
+			export_printf (state, " pressure%u='%.1f bar'", record->pressure[i].tank, record->pressure[i].value);
+	}
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_DECO)) {
+		unsigned int deco = record->deco.type == DC_DECO_DECOSTOP || record->deco.type == DC_DECO_DEEPSTOP;
+		if (record->deco.type == DC_DECO_NDL) {
+			export_time (state, "ndl", record->deco.time);
+		} else {
+			export_time (state, "stoptime", record->deco.time);
+			export_printf (state, " stopdepth='%.1f m'", record->deco.depth);
+		}
+		if (record->deco.tts)
+			export_time (state, "tts", record->deco.tts);
+		if (deco != state->deco)
+			export_printf (state, " in_deco='%u'", deco);
+		state->deco = deco;
+	}
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_RBT))
+		export_time (state, "rbt", record->rbt * 60);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_HEARTBEAT))
+		export_printf (state, " heartbeat='%u'", record->heartbeat);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_BEARING))
+		export_printf (state, " bearing='%u'", record->bearing);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT))
+		export_printf (state, " po2='%.2f bar'", record->setpoint);
+	for (unsigned int i = 0; i < record->nppo2 && i < 3; ++i)
+		export_printf (state, " sensor%u='%.2f bar'", i + 1, record->ppo2[i].value);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_CNS))
+		export_printf (state, " cns='%.0f%%'", record->cns * 100.0);
+	export_printf (state, " />\n");
+
+	state->nrecords++;
+}
+
+static dc_status_t
+subsurface_dive (export_t *state, dc_parser_t *parser)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_datetime_t dt;
+	unsigned int divetime = 0;
+	double value = 0.0;
+	dc_salinity_t salinity;
+
+	export_printf (state, "<dive number='%u'", state->number);
+	if (dc_parser_get_datetime (parser, &dt) == DC_STATUS_SUCCESS)
+		export_printf (state, " date='%04d-%02d-%02d' time='%02d:%02d:%02d'",
+			dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second);
+	if (dc_parser_get_field (parser, DC_FIELD_DIVETIME, 0, &divetime) == DC_STATUS_SUCCESS)
+		export_time (state, "duration", divetime);
+	export_printf (state, ">\n");
+
+	if (state->ntanks) {
+		for (unsigned int i = 0; i < state->ntanks; ++i) {
+			const dc_tank_t *tank = state->tanks + i;
+			export_printf (state, "<cylinder");
+			if (tank->volume > 0.0)
+				export_printf (state, " size='%.1f l'", tank->volume);
+			if (tank->workpressure > 0.0)
+				export_printf (state, " workpressure='%.1f bar'", tank->workpressure);
+			if (tank->gasmix < state->ngasmixes) {
+				export_mix_t mix = export_mix (state->gasmixes + tank->gasmix);
+				export_printf (state, " o2='%.1f%%' he='%.1f%%'", mix.oxygen / 10.0, mix.helium / 10.0);
+			}
+			if (tank->beginpressure > 0.0)
+				export_printf (state, " start='%.1f bar'", tank->beginpressure);
+			if (tank->endpressure > 0.0)
+				export_printf (state, " end='%.1f bar'", tank->endpressure);
+			export_printf (state, " />\n");
+		}
+	} else {
+		for (unsigned int i = 0; i < state->ngasmixes; ++i) {
+			export_mix_t mix = export_mix (state->gasmixes + i);
+			export_printf (state, "<cylinder o2='%.1f%%' he='%.1f%%' />\n", mix.oxygen / 10.0, mix.helium / 10.0);
+		}
+	}
+
+	export_printf (state, "<divecomputer");
+	if (state->divemode < C_ARRAY_SIZE (subsurface_divemodes) && subsurface_divemodes[state->divemode])
+		export_printf (state, " dctype='%s'", subsurface_divemodes[state->divemode]);
+	export_printf (state, ">\n");
+
+	if (dc_parser_get_field (parser, DC_FIELD_MAXDEPTH, 0, &value) == DC_STATUS_SUCCESS) {
+		export_printf (state, "<depth max='%.2f m'", value);
+		if (dc_parser_get_field (parser, DC_FIELD_AVGDEPTH, 0, &value) == DC_STATUS_SUCCESS)
+			export_printf (state, " mean='%.2f m'", value);
+		export_printf (state, " />\n");
+	}
+	if (dc_parser_get_field (parser, DC_FIELD_TEMPERATURE_MINIMUM, 0, &value) == DC_STATUS_SUCCESS) {
+		export_printf (state, "<temperature water='%.1f C'", value);
+		if (dc_parser_get_field (parser, DC_FIELD_TEMPERATURE_SURFACE, 0, &value) == DC_STATUS_SUCCESS)
+			export_printf (state, " air='%.1f C'", value);
+		export_printf (state, " />\n");
+	}
+	if (dc_parser_get_field (parser, DC_FIELD_ATMOSPHERIC, 0, &value) == DC_STATUS_SUCCESS)
+		export_printf (state, "<surface pressure='%.3f bar' />\n", value);
+	if (dc_parser_get_field (parser, DC_FIELD_SALINITY, 0, &salinity) == DC_STATUS_SUCCESS && salinity.density > 0.0)
+		export_printf (state, "<water salinity='%.0f g/l' />\n", salinity.density);
+
+	status = dc_parser_samples_foreach_records (parser, subsurface_sample, state);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	export_printf (state, "</divecomputer>\n</dive>\n");
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * UDDF
+ */
+
+static void
+uddf_sample (const dc_sample_record_t *record, void *userdata)
+{
+	export_t *state = (export_t *) userdata;
+
+	export_printf (state, "<waypoint>");
+	if (state->nrecords == 0 && state->divemode < C_ARRAY_SIZE (uddf_divemodes) && uddf_divemodes[state->divemode])
+		export_printf (state, "<divemode type=\"%s\"/>", uddf_divemodes[state->divemode]);
+	export_printf (state, "<depth>%.2f</depth><divetime>%u</divetime>",
+		(record->fields & DC_SAMPLE_MASK (DC_SAMPLE_DEPTH)) ? record->depth : 0.0,
+		record->time / 1000);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_TEMPERATURE))
+		export_printf (state, "<temperature>%.2f</temperature>", record->temperature + CELSIUS);
+	for (unsigned int i = 0; i < record->npressure; ++i) {
+		if (record->pressure[i].tank < state->ntanks)
+			export_printf (state, "<tankpressure ref=\"dive%u_tank%u\">%.0f</tankpressure>",
+				state->number, record->pressure[i].tank, record->pressure[i].value * BAR);
+		else
+			export_printf (state, "<tankpressure>%.0f</tankpressure>", record->pressure[i].value * BAR);
+	}
+	if ((record->fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX)) && record->gasmix < state->ngasmixes) {
+		export_mix_t mix = export_mix (state->gasmixes + record->gasmix);
+		export_printf (state, "<switchmix ref=\"mix%u_%u\"/>", mix.oxygen, mix.helium);
+	}
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_DECO)) {
+		if (record->deco.type == DC_DECO_NDL)
+			export_printf (state, "<nodecotime>%u</nodecotime>", record->deco.time);
+		else
+			export_printf (state, "<decostop kind=\"%s\" decodepth=\"%.1f\" duration=\"%u\"/>",
+				record->deco.type == DC_DECO_SAFETYSTOP ? "safety" : "mandatory",
+				record->deco.depth, record->deco.time);
+	}
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_RBT))
+		export_printf (state, "<remainingbottomtime>%u</remainingbottomtime>", record->rbt * 60);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_HEARTBEAT))
+		export_printf (state, "<heartrate>%u</heartrate>", record->heartbeat);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_BEARING))
+		export_printf (state, "<heading>%u</heading>", record->bearing);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT))
+		export_printf (state, "<setpo2 setby=\"computer\">%.0f</setpo2>", record->setpoint * BAR);
+	for (unsigned int i = 0; i < record->nppo2; ++i)
+		export_printf (state, "<measuredpo2>%.0f</measuredpo2>", record->ppo2[i].value * BAR);
+	if (record->fields & DC_SAMPLE_MASK (DC_SAMPLE_CNS))
+		export_printf (state, "<cns>%.1f</cns>", record->cns * 100.0);
+	for (unsigned int i = 0; i < record->nevents; ++i) {
+		const char *alarm = NULL;
+		switch (record->event[i].type) {
+		case SAMPLE_EVENT_ASCENT:
+			alarm = "ascent";
+			break;
+		case SAMPLE_EVENT_RBT:
+			alarm = "rbt";
+			break;
+		case SAMPLE_EVENT_SURFACE:
+			alarm = "surface";
+			break;
+		case SAMPLE_EVENT_DECOSTOP:
+		case SAMPLE_EVENT_CEILING:
+		case SAMPLE_EVENT_VIOLATION:
+			alarm = "deco";
+			break;
+		case SAMPLE_EVENT_TRANSMITTER:
+			alarm = "link";
+			break;
+		default:
+			break;
+		}
+		if (alarm && !(record->event[i].flags & SAMPLE_FLAGS_END))
+			export_printf (state, "<alarm>%s</alarm>", alarm);
+	}
+	export_printf (state, "</waypoint>\n");
+
+	state->nrecords++;
+}
+
+static dc_status_t
+uddf_dive (export_t *state, dc_parser_t *parser)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_datetime_t dt;
+	unsigned int divetime = 0;
+	double value = 0.0;
+
+	export_printf (state, "<repetitiongroup id=\"group%u\">\n<dive id=\"dive%u\">\n", state->number, state->number);
+
+	export_printf (state, "<informationbeforedive>\n<divenumber>%u</divenumber>\n", state->number);
+	if (dc_parser_get_datetime (parser, &dt) == DC_STATUS_SUCCESS)
+		export_printf (state, "<datetime>%04d-%02d-%02dT%02d:%02d:%02d</datetime>\n",
+			dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second);
+	if (dc_parser_get_field (parser, DC_FIELD_TEMPERATURE_SURFACE, 0, &value) == DC_STATUS_SUCCESS)
+		export_printf (state, "<airtemperature>%.2f</airtemperature>\n", value + CELSIUS);
+	export_printf (state, "</informationbeforedive>\n");
+
+	for (unsigned int i = 0; i < state->ntanks; ++i) {
+		const dc_tank_t *tank = state->tanks + i;
+		export_printf (state, "<tankdata id=\"dive%u_tank%u\">\n", state->number, i);
+		if (tank->gasmix < state->ngasmixes) {
+			export_mix_t mix = export_mix (state->gasmixes + tank->gasmix);
+			export_printf (state, "<link ref=\"mix%u_%u\"/>\n", mix.oxygen, mix.helium);
+		}
+		if (tank->volume > 0.0)
+			export_printf (state, "<tankvolume>%.4f</tankvolume>\n", tank->volume / 1000.0);
+		if (tank->beginpressure > 0.0)
+			export_printf (state, "<tankpressurebegin>%.0f</tankpressurebegin>\n", tank->beginpressure * BAR);
+		if (tank->endpressure > 0.0)
+			export_printf (state, "<tankpressureend>%.0f</tankpressureend>\n", tank->endpressure * BAR);
+		export_printf (state, "</tankdata>\n");
+	}
+
+	export_printf (state, "<samples>\n");
+	status = dc_parser_samples_foreach_records (parser, uddf_sample, state);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+	export_printf (state, "</samples>\n");
+
+	export_printf (state, "<informationafterdive>\n");
+	if (dc_parser_get_field (parser, DC_FIELD_MAXDEPTH, 0, &value) == DC_STATUS_SUCCESS)
+		export_printf (state, "<greatestdepth>%.2f</greatestdepth>\n", value);
+	if (dc_parser_get_field (parser, DC_FIELD_AVGDEPTH, 0, &value) == DC_STATUS_SUCCESS)
+		export_printf (state, "<averagedepth>%.2f</averagedepth>\n", value);
+	if (dc_parser_get_field (parser, DC_FIELD_DIVETIME, 0, &divetime) == DC_STATUS_SUCCESS)
+		export_printf (state, "<diveduration>%u</diveduration>\n", divetime);
+	if (dc_parser_get_field (parser, DC_FIELD_TEMPERATURE_MINIMUM, 0, &value) == DC_STATUS_SUCCESS)
+		export_printf (state, "<lowesttemperature>%.2f</lowesttemperature>\n", value + CELSIUS);
+	export_printf (state, "</informationafterdive>\n");
+
+	export_printf (state, "</dive>\n</repetitiongroup>\n");
+
+	return DC_STATUS_SUCCESS;
+}
+
+/*
+ * UDDF declares the gas mixes before the dives. The mixes are collected
+ * from the headers in a first pass, and referenced by their composition.
+ */
+static dc_status_t
+uddf_gasdefinitions (export_t *state, dc_parser_t *parsers[], unsigned int count, dc_buffer_t *header)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_buffer_t *mixes = dc_buffer_new (0);
+	if (mixes == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		status = export_header (state, parsers[i], header);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_free;
+
+		for (unsigned int j = 0; j < state->ngasmixes; ++j) {
+			export_mix_t mix = export_mix (state->gasmixes + j);
+
+			const export_mix_t *list = (const export_mix_t *) dc_buffer_get_data (mixes);
+			unsigned int n = dc_buffer_get_size (mixes) / sizeof (export_mix_t), k = 0;
+			while (k < n && (list[k].oxygen != mix.oxygen || list[k].helium != mix.helium))
+				k++;
+			if (k < n)
+				continue;
+
+			if (!dc_buffer_append (mixes, (const unsigned char *) &mix, sizeof (mix))) {
+				status = DC_STATUS_NOMEMORY;
+				goto error_free;
+			}
+		}
+	}
+
+	const export_mix_t *list = (const export_mix_t *) dc_buffer_get_data (mixes);
+	unsigned int n = dc_buffer_get_size (mixes) / sizeof (export_mix_t);
+
+	export_printf (state, "<gasdefinitions>\n");
+	for (unsigned int i = 0; i < n; ++i) {
+		export_printf (state, "<mix id=\"mix%u_%u\"><o2>%.3f</o2><n2>%.3f</n2><he>%.3f</he></mix>\n",
+			list[i].oxygen, list[i].helium,
+			list[i].oxygen / 1000.0,
+			(1000 - list[i].oxygen - list[i].helium) / 1000.0,
+			list[i].helium / 1000.0);
+	}
+	export_printf (state, "</gasdefinitions>\n");
+
+error_free:
+	dc_buffer_free (mixes);
+	return status;
+}
+
+static dc_status_t
+export_dives (export_t *state, dc_parser_t *parsers[], unsigned int count)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+
+	// Small buffer with the gas mixes and tanks of the current dive.
+	dc_buffer_t *header = dc_buffer_new (0);
+	if (header == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	if (state->format == DC_EXPORT_UDDF) {
+		export_printf (state,
+			"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			"<uddf xmlns=\"http://www.streit.cc/uddf/3.2/\" version=\"3.2.0\">\n"
+			"<generator>\n<name>libdivecomputer</name>\n<type>converter</type>\n</generator>\n");
+		status = uddf_gasdefinitions (state, parsers, count, header);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_free;
+		export_printf (state, "<profiledata>\n");
+	} else {
+		export_printf (state,
+			"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			"<divelog program='libdivecomputer' version='3'>\n<dives>\n");
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		dc_parser_t *parser = parsers[i];
+
+		state->number = i + 1;
+		state->nrecords = 0;
+		state->deco = 0;
+
+		status = export_header (state, parser, header);
+		if (status != DC_STATUS_SUCCESS)
+			goto error_free;
+
+		if (state->format == DC_EXPORT_UDDF)
+			status = uddf_dive (state, parser);
+		else
+			status = subsurface_dive (state, parser);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (parser->context, "Failed to export dive %u.", state->number);
+			goto error_free;
+		}
+
+		if (state->status != DC_STATUS_SUCCESS) {
+			status = state->status;
+			goto error_free;
+		}
+	}
+
+	if (state->format == DC_EXPORT_UDDF) {
+		export_printf (state, "</profiledata>\n</uddf>\n");
+	} else {
+		export_printf (state, "</dives>\n</divelog>\n");
+	}
+
+	status = state->status;
+
+error_free:
+	dc_buffer_free (header);
+	return status;
+}
+
+static dc_status_t
+export_check (dc_export_format_t format, dc_parser_t *parsers[], unsigned int count)
+{
+	if (format != DC_EXPORT_UDDF && format != DC_EXPORT_SUBSURFACE)
+		return DC_STATUS_INVALIDARGS;
+
+	if (parsers == NULL && count)
+		return DC_STATUS_INVALIDARGS;
+
+	for (unsigned int i = 0; i < count; ++i) {
+		if (parsers[i] == NULL)
+			return DC_STATUS_INVALIDARGS;
+	}
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_export_buffer (dc_export_format_t format, dc_parser_t *parsers[], unsigned int count, dc_buffer_t *buffer)
+{
+	export_t state;
+
+	if (buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_status_t status = export_check (format, parsers, count);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	memset (&state, 0, sizeof (state));
+	state.format = format;
+	state.buffer = buffer;
+	state.fd = -1;
+	state.status = DC_STATUS_SUCCESS;
+
+	return export_dives (&state, parsers, count);
+}
+
+dc_status_t
+dc_export_fd (dc_export_format_t format, dc_parser_t *parsers[], unsigned int count, int fd)
+{
+	export_t state;
+
+	if (fd < 0)
+		return DC_STATUS_INVALIDARGS;
+
+	dc_status_t status = export_check (format, parsers, count);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	memset (&state, 0, sizeof (state));
+	state.format = format;
+	state.buffer = dc_buffer_new (CHUNK + 256);
+	state.fd = fd;
+	state.status = DC_STATUS_SUCCESS;
+	if (state.buffer == NULL)
+		return DC_STATUS_NOMEMORY;
+
+	status = export_dives (&state, parsers, count);
+	if (status == DC_STATUS_SUCCESS) {
+		export_flush (&state);
+		status = state.status;
+	}
+
+	dc_buffer_free (state.buffer);
+
+	return status;
+}
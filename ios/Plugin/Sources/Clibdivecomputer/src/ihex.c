@@ -22,24 +22,25 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdio.h>
 
 #include "ihex.h"
+#include "image.h"
 #include "context-private.h"
 #include "checksum.h"
 #include "array.h"
 
 struct dc_ihex_file_t {
 	dc_context_t *context;
-	FILE *fp;
+	dc_image_t image;
+	size_t offset;
 };
 
-dc_status_t
-dc_ihex_file_open (dc_ihex_file_t **result, dc_context_t *context, const char *filename)
+static dc_status_t
+dc_ihex_file_allocate (dc_ihex_file_t **result, dc_context_t *context)
 {
 	dc_ihex_file_t *file = NULL;
 
-	if (result == NULL || filename == NULL) {
+	if (result == NULL) {
 		ERROR (context, "Invalid arguments.");
 		return DC_STATUS_INVALIDARGS;
 	}
@@ -51,12 +52,54 @@ dc_ihex_file_open (dc_ihex_file_t **result, dc_context_t *context, const char *f
 	}
 
 	file->context = context;
+	file->offset = 0;
+
+	*result = file;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_ihex_file_open (dc_ihex_file_t **result, dc_context_t *context, const char *filename)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_ihex_file_t *file = NULL;
+
+	if (result == NULL || filename == NULL) {
+		ERROR (context, "Invalid arguments.");
+		return DC_STATUS_INVALIDARGS;
+	}
 
-	file->fp = fopen (filename, "rb");
-	if (file->fp == NULL) {
+	status = dc_ihex_file_allocate (&file, context);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_image_open (&file->image, context, filename);
+	if (status != DC_STATUS_SUCCESS) {
 		ERROR (context, "Failed to open the file.");
 		free (file);
-		return DC_STATUS_IO;
+		return status;
+	}
+
+	*result = file;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_ihex_file_open_buffer (dc_ihex_file_t **result, dc_context_t *context, const unsigned char data[], size_t size)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_ihex_file_t *file = NULL;
+
+	status = dc_ihex_file_allocate (&file, context);
+	if (status != DC_STATUS_SUCCESS)
+		return status;
+
+	status = dc_image_open_buffer (&file->image, context, data, size);
+	if (status != DC_STATUS_SUCCESS) {
+		free (file);
+		return status;
 	}
 
 	*result = file;
@@ -67,67 +110,59 @@ dc_ihex_file_open (dc_ihex_file_t **result, dc_context_t *context, const char *f
 dc_status_t
 dc_ihex_file_read (dc_ihex_file_t *file, dc_ihex_entry_t *entry)
 {
-	unsigned char ascii[9 + 2 * 255 + 2] = {0};
 	unsigned char data[4 + 255 + 1] = {0};
 	unsigned int type, length, address;
 	unsigned char csum_a, csum_b;
-	size_t n;
 
 	if (file == NULL || entry == NULL) {
 		ERROR (file ? file->context : NULL, "Invalid arguments.");
 		return DC_STATUS_INVALIDARGS;
 	}
 
-	/* Read the start code. */
+	const unsigned char *ascii = file->image.data;
+	size_t size = file->image.size;
+
+	/* Skip to the start code. */
 	while (1) {
-		n = fread (ascii, 1, 1, file->fp);
-		if (n != 1) {
-			if (feof (file->fp)) {
-				return DC_STATUS_DONE;
-			} else {
-				ERROR (file->context, "Failed to read the start code.");
-				return DC_STATUS_IO;
-			}
+		if (file->offset >= size) {
+			return DC_STATUS_DONE;
 		}
 
-		if (ascii[0] == ':')
+		unsigned char c = ascii[file->offset++];
+		if (c == ':')
 			break;
 
 		/* Ignore CR and LF characters. */
-		if (ascii[0] != '\n' && ascii[0] != '\r') {
-			ERROR (file->context, "Unexpected character (0x%02x).", ascii[0]);
+		if (c != '\n' && c != '\r') {
+			ERROR (file->context, "Unexpected character (0x%02x).", c);
 			return DC_STATUS_DATAFORMAT;
 		}
 	}
 
-	/* Read the record length, address and type. */
-	n = fread (ascii + 1, 1, 8, file->fp);
-	if (n != 8) {
+	/* Convert the record length, address and type to binary representation. */
+	if (size - file->offset < 8) {
 		ERROR (file->context, "Failed to read the header.");
 		return DC_STATUS_IO;
 	}
-
-	/* Convert to binary representation. */
-	if (array_convert_hex2bin (ascii + 1, 8, data, 4) != 0) {
+	if (array_convert_hex2bin (ascii + file->offset, 8, data, 4) != 0) {
 		ERROR (file->context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
+	file->offset += 8;
 
 	/* Get the record length. */
 	length = data[0];
 
-	/* Read the record payload. */
-	n = fread (ascii + 9, 1, 2 * length + 2, file->fp);
-	if (n != 2 * length + 2) {
+	/* Convert the record payload to binary representation. */
+	if (size - file->offset < 2 * length + 2) {
 		ERROR (file->context, "Failed to read the data.");
 		return DC_STATUS_IO;
 	}
-
-	/* Convert to binary representation. */
-	if (array_convert_hex2bin (ascii + 9, 2 * length + 2, data + 4, length + 1) != 0) {
+	if (array_convert_hex2bin (ascii + file->offset, 2 * length + 2, data + 4, length + 1) != 0) {
 		ERROR (file->context, "Invalid hexadecimal character.");
 		return DC_STATUS_DATAFORMAT;
 	}
+	file->offset += 2 * length + 2;
 
 	/* Verify the checksum. */
 	csum_a = data[4 + length];
@@ -189,7 +224,7 @@ dc_ihex_file_reset (dc_ihex_file_t *file)
 		return DC_STATUS_INVALIDARGS;
 	}
 
-	rewind (file->fp);
+	file->offset = 0;
 
 	return DC_STATUS_SUCCESS;
 }
@@ -198,7 +233,7 @@ dc_status_t
 dc_ihex_file_close (dc_ihex_file_t *file)
 {
 	if (file) {
-		fclose (file->fp);
+		dc_image_close (&file->image);
 		free (file);
 	}
 
@@ -22,6 +22,8 @@
 #ifndef DC_IHEX_H
 #define DC_IHEX_H
 
+#include <stddef.h>
+
 #include <libdivecomputer/common.h>
 #include <libdivecomputer/context.h>
 
@@ -41,6 +43,9 @@ typedef struct dc_ihex_entry_t {
 dc_status_t
 dc_ihex_file_open (dc_ihex_file_t **file, dc_context_t *context, const char *filename);
 
+dc_status_t
+dc_ihex_file_open_buffer (dc_ihex_file_t **file, dc_context_t *context, const unsigned char data[], size_t size);
+
 dc_status_t
 dc_ihex_file_read (dc_ihex_file_t *file, dc_ihex_entry_t *entry);
 
@@ -195,9 +195,13 @@ dc_iostream_read (dc_iostream_t *iostream, void *data, size_t size, size_t *actu
 		goto out;
 	}
 
+	// A read blocked in a custom stream may return after another thread
+	// closed the stream, so the stream is not touched afterwards.
+	dc_context_t *context = iostream->context;
+
 	status = iostream->vtable->read (iostream, data, size, &nbytes);
 
-	HEXDUMP (iostream->context, DC_LOGLEVEL_INFO, "Read", (unsigned char *) data, nbytes);
+	HEXDUMP (context, DC_LOGLEVEL_INFO, "Read", (unsigned char *) data, nbytes);
 
 out:
 	if (actual)
@@ -271,6 +271,9 @@ liquivision_lynx_parser_get_field (dc_parser_t *abstract, dc_field_type_t type,
 			}
 			break;
 		case DC_FIELD_DECOMODEL:
+			// The deco model is not present in the shorter Xen header.
+			if (parser->model == XEN)
+				return DC_STATUS_UNSUPPORTED;
 			switch (abstract->data[93]) {
 			case ZHL16GF:
 				decomodel->type = DC_DECOMODEL_BUHLMANN;
@@ -370,7 +373,7 @@ liquivision_lynx_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callba
 				break;
 			}
 
-			if (offset + 4 > size) {
+			if (offset + 6 > size) {
 				ERROR (abstract->context, "Buffer overflow at offset %u", offset);
 				return DC_STATUS_DATAFORMAT;
 			}
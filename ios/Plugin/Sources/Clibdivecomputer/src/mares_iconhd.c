@@ -22,6 +22,8 @@
 #include <string.h> // memcpy, memcmp
 #include <stdlib.h> // malloc, free
 
+#include <libdivecomputer/ble.h>
+
 #include "mares_iconhd.h"
 #include "context-private.h"
 #include "device-private.h"
@@ -75,6 +77,7 @@
 #define MAXRETRIES 4
 
 #define MAXPACKET 244
+#define MAXPACKET_BLE (DC_BLE_MTU_MAX - 3)
 
 #define FIXED    0
 #define VARIABLE 1
@@ -125,6 +128,7 @@ typedef struct mares_iconhd_device_t {
 	unsigned int model;
 	unsigned int packetsize;
 	unsigned int ble;
+	unsigned int blesize;
 } mares_iconhd_device_t;
 
 static dc_status_t mares_iconhd_device_set_fingerprint (dc_device_t *abstract, const unsigned char data[], unsigned int size);
@@ -306,7 +310,7 @@ mares_iconhd_packet_variable (mares_iconhd_device_t *device,
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_device_t *abstract = (dc_device_t *) device;
-	unsigned char packet[MAXPACKET] = {0};
+	unsigned char packet[MAXPACKET_BLE] = {0};
 	size_t length = 0;
 
 	if (device_is_cancelled (abstract))
@@ -428,7 +432,7 @@ mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *pro
 	dc_device_t *abstract = (dc_device_t *) device;
 	dc_transport_t transport = dc_iostream_get_transport (device->iostream);
 	const unsigned int maxpacket = (transport == DC_TRANSPORT_BLE) ?
-		(device->ble == VARIABLE ? MAXPACKET - 3 : 124) :
+		(device->ble == VARIABLE ? device->blesize - 3 : 124) :
 		504;
 
 	// Update and emit a progress event.
@@ -502,7 +506,7 @@ mares_iconhd_read_object(mares_iconhd_device_t *device, dc_event_progress_t *pro
 
 		// Transfer the segment packet.
 		unsigned int length = 0;
-		unsigned char rsp_segment[1 + 504];
+		unsigned char rsp_segment[1 + MAXPACKET_BLE];
 		status = mares_iconhd_transfer (device, cmd, NULL, 0, rsp_segment, len + 1, &length);
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (abstract->context, "Failed to transfer the segment packet.");
@@ -566,10 +570,22 @@ mares_iconhd_device_open (dc_device_t **out, dc_context_t *context, dc_iostream_
 	device->model = 0;
 	device->packetsize = 0;
 	device->ble = ISSIRIUS(model) ? VARIABLE : FIXED;
+	device->blesize = MAXPACKET;
+
+	// Request a fast BLE link, and size the packets to it.
+	unsigned int packetsize = 0;
+	status = dc_ble_setup_link (iostream, &packetsize);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to set up the BLE link.");
+		goto error_free;
+	}
+
+	if (packetsize > MAXPACKET)
+		device->blesize = packetsize;
 
 	// Create the packet stream.
 	if (transport == DC_TRANSPORT_BLE && device->ble == FIXED) {
-		status = dc_packet_open (&device->iostream, context, iostream, 244, 20);
+		status = dc_packet_open (&device->iostream, context, iostream, device->blesize, 20);
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (context, "Failed to create the packet stream.");
 			goto error_free;
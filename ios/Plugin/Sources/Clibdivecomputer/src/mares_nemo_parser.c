@@ -103,7 +103,7 @@ mares_nemo_parser_create (dc_parser_t **out, dc_context_t *context, const unsign
 	}
 
 	unsigned int length = array_uint16_le (data);
-	if (length > size) {
+	if (length < 2 + 3 || length > size) {
 		status = DC_STATUS_DATAFORMAT;
 		goto error_free;
 	}
@@ -40,6 +40,10 @@ struct oceanic_veo250_parser_t {
 	unsigned int cached;
 	unsigned int divetime;
 	double maxdepth;
+	double avgdepth;
+	unsigned int ntemperatures;
+	double mintemperature;
+	double maxtemperature;
 };
 
 static dc_status_t oceanic_veo250_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
@@ -79,6 +83,10 @@ oceanic_veo250_parser_create (dc_parser_t **out, dc_context_t *context, const un
 	parser->cached = 0;
 	parser->divetime = 0;
 	parser->maxdepth = 0.0;
+	parser->avgdepth = 0.0;
+	parser->ntemperatures = 0;
+	parser->mintemperature = 0.0;
+	parser->maxtemperature = 0.0;
 
 	*out = (dc_parser_t*) parser;
 
@@ -115,6 +123,17 @@ oceanic_veo250_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *dateti
 }
 
 
+static dc_status_t
+oceanic_veo250_parser_cache (oceanic_veo250_parser_t *parser)
+{
+	if (parser->cached)
+		return DC_STATUS_SUCCESS;
+
+	// The statistics are collected as a side effect of decoding the profile.
+	return oceanic_veo250_parser_samples_foreach ((dc_parser_t *) parser, NULL, NULL);
+}
+
+
 static dc_status_t
 oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
@@ -126,16 +145,12 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
 
-	if (!parser->cached) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		dc_status_t rc = oceanic_veo250_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+	// Only the profile derived fields require decoding the samples.
+	if (type == DC_FIELD_MAXDEPTH || type == DC_FIELD_AVGDEPTH ||
+		type == DC_FIELD_TEMPERATURE_MINIMUM || type == DC_FIELD_TEMPERATURE_MAXIMUM) {
+		dc_status_t rc = oceanic_veo250_parser_cache (parser);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
-
-		parser->cached = 1;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	unsigned int footer = size - PAGESIZE;
@@ -162,6 +177,19 @@ oceanic_veo250_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, un
 				gasmix->oxygen = 0.21;
 			gasmix->nitrogen = 1.0 - gasmix->oxygen - gasmix->helium;
 			break;
+		case DC_FIELD_AVGDEPTH:
+			*((double *) value) = parser->avgdepth;
+			break;
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+			if (parser->ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->mintemperature;
+			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			if (parser->ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->maxtemperature;
+			break;
 		default:
 			return DC_STATUS_UNSUPPORTED;
 		}
@@ -181,6 +209,16 @@ oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
 
+	// Collect the statistics during the first pass over the profile.
+	unsigned int collect = !parser->cached;
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
+	if (collect) {
+		statistics.callback = callback;
+		statistics.userdata = userdata;
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	unsigned int time = 0;
 	unsigned int interval = 0;
 	unsigned int interval_idx = data[0x27] & 0x03;
@@ -269,5 +307,15 @@ oceanic_veo250_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback
 		offset += PAGESIZE / 2;
 	}
 
+	if (collect) {
+		parser->cached = 1;
+		parser->divetime = statistics.divetime;
+		parser->maxdepth = statistics.maxdepth;
+		parser->avgdepth = statistics.avgdepth;
+		parser->ntemperatures = statistics.ntemperatures;
+		parser->mintemperature = statistics.mintemperature;
+		parser->maxtemperature = statistics.maxtemperature;
+	}
+
 	return DC_STATUS_SUCCESS;
 }
@@ -40,6 +40,10 @@ struct oceanic_vtpro_parser_t {
 	unsigned int cached;
 	unsigned int divetime;
 	double maxdepth;
+	double avgdepth;
+	unsigned int ntemperatures;
+	double mintemperature;
+	double maxtemperature;
 };
 
 static dc_status_t oceanic_vtpro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetime);
@@ -79,6 +83,10 @@ oceanic_vtpro_parser_create (dc_parser_t **out, dc_context_t *context, const uns
 	parser->cached = 0;
 	parser->divetime = 0;
 	parser->maxdepth = 0.0;
+	parser->avgdepth = 0.0;
+	parser->ntemperatures = 0;
+	parser->mintemperature = 0.0;
+	parser->maxtemperature = 0.0;
 
 	*out = (dc_parser_t*) parser;
 
@@ -132,6 +140,17 @@ oceanic_vtpro_parser_get_datetime (dc_parser_t *abstract, dc_datetime_t *datetim
 }
 
 
+static dc_status_t
+oceanic_vtpro_parser_cache (oceanic_vtpro_parser_t *parser)
+{
+	if (parser->cached)
+		return DC_STATUS_SUCCESS;
+
+	// The statistics are collected as a side effect of decoding the profile.
+	return oceanic_vtpro_parser_samples_foreach ((dc_parser_t *) parser, NULL, NULL);
+}
+
+
 static dc_status_t
 oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, unsigned int flags, void *value)
 {
@@ -143,16 +162,12 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
 
-	if (!parser->cached) {
-		sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
-		dc_status_t rc = oceanic_vtpro_parser_samples_foreach (
-			abstract, sample_statistics_cb, &statistics);
+	// Only the profile derived fields require decoding the samples.
+	if (type == DC_FIELD_DIVETIME || type == DC_FIELD_AVGDEPTH ||
+		type == DC_FIELD_TEMPERATURE_MINIMUM || type == DC_FIELD_TEMPERATURE_MAXIMUM) {
+		dc_status_t rc = oceanic_vtpro_parser_cache (parser);
 		if (rc != DC_STATUS_SUCCESS)
 			return rc;
-
-		parser->cached = 1;
-		parser->divetime = statistics.divetime;
-		parser->maxdepth = statistics.maxdepth;
 	}
 
 	unsigned int footer = size - PAGESIZE;
@@ -207,6 +222,19 @@ oceanic_vtpro_parser_get_field (dc_parser_t *abstract, dc_field_type_t type, uns
 			tank->endpressure = endpressure * 2 * PSI / BAR;
 			tank->usage = DC_USAGE_NONE;
 			break;
+		case DC_FIELD_AVGDEPTH:
+			*((double *) value) = parser->avgdepth;
+			break;
+		case DC_FIELD_TEMPERATURE_MINIMUM:
+			if (parser->ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->mintemperature;
+			break;
+		case DC_FIELD_TEMPERATURE_MAXIMUM:
+			if (parser->ntemperatures == 0)
+				return DC_STATUS_UNSUPPORTED;
+			*((double *) value) = parser->maxtemperature;
+			break;
 		default:
 			return DC_STATUS_UNSUPPORTED;
 		}
@@ -227,6 +255,16 @@ oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 	if (size < 7 * PAGESIZE / 2)
 		return DC_STATUS_DATAFORMAT;
 
+	// Collect the statistics during the first pass over the profile.
+	unsigned int collect = !parser->cached;
+	sample_statistics_t statistics = SAMPLE_STATISTICS_INITIALIZER;
+	if (collect) {
+		statistics.callback = callback;
+		statistics.userdata = userdata;
+		callback = sample_statistics_cb;
+		userdata = &statistics;
+	}
+
 	unsigned int time = 0;
 	unsigned int interval = 0;
 	if (parser->model == AERIS500AI) {
@@ -365,5 +403,15 @@ oceanic_vtpro_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_
 		offset += PAGESIZE / 2;
 	}
 
+	if (collect) {
+		parser->cached = 1;
+		parser->divetime = statistics.divetime;
+		parser->maxdepth = statistics.maxdepth;
+		parser->avgdepth = statistics.avgdepth;
+		parser->ntemperatures = statistics.ntemperatures;
+		parser->mintemperature = statistics.mintemperature;
+		parser->maxtemperature = statistics.maxtemperature;
+	}
+
 	return DC_STATUS_SUCCESS;
 }
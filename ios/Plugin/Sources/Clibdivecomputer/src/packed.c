@@ -0,0 +1,569 @@
+/*
+ * libdivecomputer
+ *
+ * Copyright (C) 2026 Immersea
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301 USA
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#include <libdivecomputer/parser.h>
+
+#include "context-private.h"
+#include "parser-private.h"
+
+/*
+ * Packed sample format
+ *
+ * The packed format stores the sample records column by column. All
+ * integers are stored as unsigned LEB128 varints. Signed values are
+ * zigzag encoded first.
+ *
+ *   'D' 'C' 'P' version
+ *   varint  number of records
+ *   varint  number of columns
+ *   columns × { u8 id, varint length }
+ *   column data, in the same order as the directory
+ *
+ * The fields column (id 0x80) contains the bitmask of every record,
+ * xor'ed with the bitmask of the previous record. The other columns
+ * use the sample type as id, and contain one entry for every record
+ * with the corresponding bit set:
+ *
+ *   TIME         delta of the time interval (ms)
+ *   DEPTH        delta (mm)
+ *   TEMPERATURE  delta (0.01 °C)
+ *   PRESSURE     count, count × { tank, delta per tank (0.01 bar) }
+ *   EVENT        count, count × { type, time, flags, value }
+ *   RBT          value
+ *   HEARTBEAT    value
+ *   BEARING      value
+ *   SETPOINT     delta (mbar)
+ *   PPO2         count, count × { sensor, delta per sensor (mbar) }
+ *   CNS          delta (0.01 %)
+ *   DECO         type, time, depth (mm), tts
+ *   GASMIX       value
+ *
+ * The decoder skips columns with an unknown id, and a missing column is
+ * only an error if a record needs it.
+ */
+
+#define PACKED_FIELDS 0x80
+#define PACKED_IDX_FIELDS (DC_PACKED_NCOLUMNS - 1)
+
+#define PACKED_DEPTH       1000.0
+#define PACKED_TEMPERATURE 100.0
+#define PACKED_PRESSURE    100.0
+#define PACKED_PPO2        1000.0
+#define PACKED_CNS         10000.0
+
+typedef struct dc_packed_encoder_t {
+	dc_buffer_t *column[DC_PACKED_NCOLUMNS];
+	unsigned int nrecords;
+	unsigned int fields;
+	unsigned int time, interval;
+	unsigned int depth, temperature, setpoint, cns;
+	unsigned int pressure[DC_SAMPLE_RECORD_MAXTANKS];
+	unsigned int ppo2[DC_SAMPLE_RECORD_MAXSENSORS];
+	int nomemory;
+} dc_packed_encoder_t;
+
+static unsigned int
+packed_quantize (double value, double scale)
+{
+	double scaled = value * scale;
+
+	// Round to the nearest integer, and store negative values in two's
+	// complement form.
+	if (scaled >= 0.0) {
+		if (scaled >= INT_MAX)
+			return INT_MAX;
+		return (unsigned int) (scaled + 0.5);
+	} else {
+		if (scaled <= INT_MIN)
+			return (unsigned int) INT_MIN;
+		return 0u - (unsigned int) (0.5 - scaled);
+	}
+}
+
+static double
+packed_dequantize (unsigned int value, double scale)
+{
+	if (value & 0x80000000)
+		return -(double) (0u - value) / scale;
+	return value / scale;
+}
+
+static unsigned int
+packed_zigzag (unsigned int value)
+{
+	return (value << 1) ^ (0u - (value >> 31));
+}
+
+static unsigned int
+packed_unzigzag (unsigned int value)
+{
+	return (value >> 1) ^ (0u - (value & 1));
+}
+
+static int
+packed_append (dc_buffer_t *buffer, unsigned int value)
+{
+	unsigned char data[5];
+	unsigned int n = 0;
+
+	while (value >= 0x80) {
+		data[n++] = (value & 0x7F) | 0x80;
+		value >>= 7;
+	}
+	data[n++] = value;
+
+	return dc_buffer_append (buffer, data, n);
+}
+
+static void
+packed_put (dc_packed_encoder_t *encoder, unsigned int column, unsigned int value)
+{
+	if (!packed_append (encoder->column[column], value))
+		encoder->nomemory = 1;
+}
+
+static void
+packed_put_delta (dc_packed_encoder_t *encoder, unsigned int column, unsigned int value, unsigned int *previous)
+{
+	packed_put (encoder, column, packed_zigzag (value - *previous));
+	*previous = value;
+}
+
+static void
+dc_packed_record_cb (const dc_sample_record_t *record, void *userdata)
+{
+	dc_packed_encoder_t *encoder = (dc_packed_encoder_t *) userdata;
+	unsigned int fields = record->fields;
+
+	encoder->nrecords++;
+
+	packed_put (encoder, PACKED_IDX_FIELDS, fields ^ encoder->fields);
+	encoder->fields = fields;
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_TIME)) {
+		unsigned int interval = record->time - encoder->time;
+		packed_put_delta (encoder, DC_SAMPLE_TIME, interval, &encoder->interval);
+		encoder->time = record->time;
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_DEPTH)) {
+		packed_put_delta (encoder, DC_SAMPLE_DEPTH,
+			packed_quantize (record->depth, PACKED_DEPTH), &encoder->depth);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_TEMPERATURE)) {
+		packed_put_delta (encoder, DC_SAMPLE_TEMPERATURE,
+			packed_quantize (record->temperature, PACKED_TEMPERATURE), &encoder->temperature);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_PRESSURE)) {
+		packed_put (encoder, DC_SAMPLE_PRESSURE, record->npressure);
+		for (unsigned int i = 0; i < record->npressure; ++i) {
+			unsigned int tank = record->pressure[i].tank;
+			unsigned int unused = 0;
+			packed_put (encoder, DC_SAMPLE_PRESSURE, tank);
+			packed_put_delta (encoder, DC_SAMPLE_PRESSURE,
+				packed_quantize (record->pressure[i].value, PACKED_PRESSURE),
+				tank < DC_SAMPLE_RECORD_MAXTANKS ? &encoder->pressure[tank] : &unused);
+		}
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_EVENT)) {
+		packed_put (encoder, DC_SAMPLE_EVENT, record->nevents);
+		for (unsigned int i = 0; i < record->nevents; ++i) {
+			packed_put (encoder, DC_SAMPLE_EVENT, record->event[i].type);
+			packed_put (encoder, DC_SAMPLE_EVENT, record->event[i].time);
+			packed_put (encoder, DC_SAMPLE_EVENT, record->event[i].flags);
+			packed_put (encoder, DC_SAMPLE_EVENT, record->event[i].value);
+		}
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_RBT))
+		packed_put (encoder, DC_SAMPLE_RBT, record->rbt);
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_HEARTBEAT))
+		packed_put (encoder, DC_SAMPLE_HEARTBEAT, record->heartbeat);
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_BEARING))
+		packed_put (encoder, DC_SAMPLE_BEARING, record->bearing);
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT)) {
+		packed_put_delta (encoder, DC_SAMPLE_SETPOINT,
+			packed_quantize (record->setpoint, PACKED_PPO2), &encoder->setpoint);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_PPO2)) {
+		packed_put (encoder, DC_SAMPLE_PPO2, record->nppo2);
+		for (unsigned int i = 0; i < record->nppo2; ++i) {
+			unsigned int sensor = record->ppo2[i].sensor;
+			unsigned int unused = 0;
+			packed_put (encoder, DC_SAMPLE_PPO2, sensor);
+			packed_put_delta (encoder, DC_SAMPLE_PPO2,
+				packed_quantize (record->ppo2[i].value, PACKED_PPO2),
+				sensor < DC_SAMPLE_RECORD_MAXSENSORS ? &encoder->ppo2[sensor] : &unused);
+		}
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_CNS)) {
+		packed_put_delta (encoder, DC_SAMPLE_CNS,
+			packed_quantize (record->cns, PACKED_CNS), &encoder->cns);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_DECO)) {
+		packed_put (encoder, DC_SAMPLE_DECO, record->deco.type);
+		packed_put (encoder, DC_SAMPLE_DECO, record->deco.time);
+		packed_put (encoder, DC_SAMPLE_DECO,
+			packed_zigzag (packed_quantize (record->deco.depth, PACKED_DEPTH)));
+		packed_put (encoder, DC_SAMPLE_DECO, record->deco.tts);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX))
+		packed_put (encoder, DC_SAMPLE_GASMIX, record->gasmix);
+}
+
+static unsigned int
+packed_column_id (unsigned int idx)
+{
+	return idx == PACKED_IDX_FIELDS ? PACKED_FIELDS : idx;
+}
+
+dc_status_t
+dc_parser_samples_pack (dc_parser_t *parser, dc_buffer_t *buffer)
+{
+	dc_status_t status = DC_STATUS_SUCCESS;
+	dc_packed_encoder_t encoder;
+
+	if (parser == NULL || buffer == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	memset (&encoder, 0, sizeof (encoder));
+
+	for (unsigned int i = 0; i < DC_PACKED_NCOLUMNS; ++i) {
+		encoder.column[i] = dc_buffer_new (0);
+		if (encoder.column[i] == NULL) {
+			ERROR (parser->context, "Failed to allocate memory.");
+			status = DC_STATUS_NOMEMORY;
+			goto error_free;
+		}
+	}
+
+	status = dc_parser_samples_foreach_records (parser, dc_packed_record_cb, &encoder);
+	if (status != DC_STATUS_SUCCESS)
+		goto error_free;
+
+	// Header and column directory. The fields column goes first, because
+	// every record starts with it.
+	const unsigned char magic[] = {'D', 'C', 'P', DC_PACKED_VERSION};
+	unsigned int ncolumns = 0;
+	for (unsigned int i = 0; i < DC_PACKED_NCOLUMNS; ++i) {
+		if (dc_buffer_get_size (encoder.column[i]))
+			ncolumns++;
+	}
+
+	dc_buffer_clear (buffer);
+	if (encoder.nomemory ||
+		!dc_buffer_append (buffer, magic, sizeof (magic)) ||
+		!packed_append (buffer, encoder.nrecords) ||
+		!packed_append (buffer, ncolumns)) {
+		encoder.nomemory = 1;
+	}
+
+	for (unsigned int n = 0; n < DC_PACKED_NCOLUMNS && !encoder.nomemory; ++n) {
+		unsigned int i = (n + PACKED_IDX_FIELDS) % DC_PACKED_NCOLUMNS;
+		size_t length = dc_buffer_get_size (encoder.column[i]);
+		if (length == 0)
+			continue;
+
+		unsigned char id = packed_column_id (i);
+		if (!dc_buffer_append (buffer, &id, 1) ||
+			!packed_append (buffer, length)) {
+			encoder.nomemory = 1;
+		}
+	}
+
+	for (unsigned int n = 0; n < DC_PACKED_NCOLUMNS && !encoder.nomemory; ++n) {
+		unsigned int i = (n + PACKED_IDX_FIELDS) % DC_PACKED_NCOLUMNS;
+		if (!dc_buffer_append (buffer,
+			dc_buffer_get_data (encoder.column[i]),
+			dc_buffer_get_size (encoder.column[i]))) {
+			encoder.nomemory = 1;
+		}
+	}
+
+	if (encoder.nomemory) {
+		ERROR (parser->context, "Failed to allocate memory.");
+		dc_buffer_clear (buffer);
+		status = DC_STATUS_NOMEMORY;
+	}
+
+error_free:
+	for (unsigned int i = 0; i < DC_PACKED_NCOLUMNS; ++i) {
+		dc_buffer_free (encoder.column[i]);
+	}
+	return status;
+}
+
+
+static int
+packed_read (const unsigned char **data, const unsigned char *end, unsigned int *value)
+{
+	const unsigned char *p = *data;
+	unsigned int result = 0;
+	unsigned int shift = 0;
+
+	while (p < end && shift < 35) {
+		unsigned char byte = *p++;
+		result |= (unsigned int) (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
+			*data = p;
+			*value = result;
+			return 1;
+		}
+		shift += 7;
+	}
+
+	return 0;
+}
+
+static int
+packed_get (dc_packed_reader_t *reader, unsigned int column, unsigned int *value)
+{
+	if (reader->column[column] == NULL)
+		return 0;
+
+	return packed_read (&reader->column[column], reader->end[column], value);
+}
+
+static int
+packed_get_delta (dc_packed_reader_t *reader, unsigned int column, unsigned int *previous)
+{
+	unsigned int delta = 0;
+
+	if (!packed_get (reader, column, &delta))
+		return 0;
+
+	*previous += packed_unzigzag (delta);
+
+	return 1;
+}
+
+dc_status_t
+dc_packed_reader_init (dc_packed_reader_t *reader, const unsigned char data[], size_t size)
+{
+	const unsigned char *p = data;
+	const unsigned char *end = data + size;
+	unsigned int nrecords = 0, ncolumns = 0;
+
+	if (reader == NULL || (data == NULL && size))
+		return DC_STATUS_INVALIDARGS;
+
+	memset (reader, 0, sizeof (*reader));
+
+	if (size < 4 || data[0] != 'D' || data[1] != 'C' || data[2] != 'P')
+		return DC_STATUS_DATAFORMAT;
+
+	if (data[3] != DC_PACKED_VERSION)
+		return DC_STATUS_UNSUPPORTED;
+
+	p += 4;
+	if (!packed_read (&p, end, &nrecords) ||
+		!packed_read (&p, end, &ncolumns))
+		return DC_STATUS_DATAFORMAT;
+
+	// The column data starts right after the directory, so the directory
+	// is walked twice: once to find its end, and once to assign the data.
+	const unsigned char *directory = p;
+	for (unsigned int i = 0; i < ncolumns; ++i) {
+		unsigned int length = 0;
+		if (p >= end)
+			return DC_STATUS_DATAFORMAT;
+		p++;
+		if (!packed_read (&p, end, &length))
+			return DC_STATUS_DATAFORMAT;
+	}
+
+	const unsigned char *column = p;
+	p = directory;
+	for (unsigned int i = 0; i < ncolumns; ++i) {
+		unsigned int id = *p++;
+		unsigned int length = 0;
+		packed_read (&p, end, &length);
+
+		if (length > (size_t) (end - column))
+			return DC_STATUS_DATAFORMAT;
+
+		unsigned int idx = DC_PACKED_NCOLUMNS;
+		if (id == PACKED_FIELDS)
+			idx = PACKED_IDX_FIELDS;
+		else if (id < PACKED_IDX_FIELDS)
+			idx = id;
+
+		if (idx < DC_PACKED_NCOLUMNS) {
+			if (reader->column[idx] != NULL)
+				return DC_STATUS_DATAFORMAT;
+			reader->column[idx] = column;
+			reader->end[idx] = column + length;
+		}
+
+		column += length;
+	}
+
+	reader->nrecords = nrecords;
+
+	return DC_STATUS_SUCCESS;
+}
+
+dc_status_t
+dc_packed_reader_next (dc_packed_reader_t *reader, dc_sample_record_t *record)
+{
+	unsigned int value = 0;
+
+	if (reader == NULL || record == NULL)
+		return DC_STATUS_INVALIDARGS;
+
+	if (reader->nrecords == 0)
+		return DC_STATUS_DONE;
+
+	memset (record, 0, sizeof (*record));
+
+	if (!packed_get (reader, PACKED_IDX_FIELDS, &value))
+		return DC_STATUS_DATAFORMAT;
+	reader->fields ^= value;
+
+	unsigned int fields = reader->fields;
+	record->fields = fields;
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_TIME)) {
+		if (!packed_get_delta (reader, DC_SAMPLE_TIME, &reader->interval))
+			return DC_STATUS_DATAFORMAT;
+		reader->time += reader->interval;
+		record->time = reader->time;
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_DEPTH)) {
+		if (!packed_get_delta (reader, DC_SAMPLE_DEPTH, &reader->depth))
+			return DC_STATUS_DATAFORMAT;
+		record->depth = packed_dequantize (reader->depth, PACKED_DEPTH);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_TEMPERATURE)) {
+		if (!packed_get_delta (reader, DC_SAMPLE_TEMPERATURE, &reader->temperature))
+			return DC_STATUS_DATAFORMAT;
+		record->temperature = packed_dequantize (reader->temperature, PACKED_TEMPERATURE);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_PRESSURE)) {
+		if (!packed_get (reader, DC_SAMPLE_PRESSURE, &record->npressure) ||
+			record->npressure > DC_SAMPLE_RECORD_MAXTANKS)
+			return DC_STATUS_DATAFORMAT;
+		for (unsigned int i = 0; i < record->npressure; ++i) {
+			unsigned int tank = 0, unused = 0;
+			if (!packed_get (reader, DC_SAMPLE_PRESSURE, &tank))
+				return DC_STATUS_DATAFORMAT;
+			unsigned int *previous = tank < DC_SAMPLE_RECORD_MAXTANKS ?
+				&reader->pressure[tank] : &unused;
+			if (!packed_get_delta (reader, DC_SAMPLE_PRESSURE, previous))
+				return DC_STATUS_DATAFORMAT;
+			record->pressure[i].tank = tank;
+			record->pressure[i].value = packed_dequantize (*previous, PACKED_PRESSURE);
+		}
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_EVENT)) {
+		if (!packed_get (reader, DC_SAMPLE_EVENT, &record->nevents) ||
+			record->nevents > DC_SAMPLE_RECORD_MAXEVENTS)
+			return DC_STATUS_DATAFORMAT;
+		for (unsigned int i = 0; i < record->nevents; ++i) {
+			if (!packed_get (reader, DC_SAMPLE_EVENT, &record->event[i].type) ||
+				!packed_get (reader, DC_SAMPLE_EVENT, &record->event[i].time) ||
+				!packed_get (reader, DC_SAMPLE_EVENT, &record->event[i].flags) ||
+				!packed_get (reader, DC_SAMPLE_EVENT, &record->event[i].value))
+				return DC_STATUS_DATAFORMAT;
+		}
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_RBT)) {
+		if (!packed_get (reader, DC_SAMPLE_RBT, &record->rbt))
+			return DC_STATUS_DATAFORMAT;
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_HEARTBEAT)) {
+		if (!packed_get (reader, DC_SAMPLE_HEARTBEAT, &record->heartbeat))
+			return DC_STATUS_DATAFORMAT;
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_BEARING)) {
+		if (!packed_get (reader, DC_SAMPLE_BEARING, &record->bearing))
+			return DC_STATUS_DATAFORMAT;
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_SETPOINT)) {
+		if (!packed_get_delta (reader, DC_SAMPLE_SETPOINT, &reader->setpoint))
+			return DC_STATUS_DATAFORMAT;
+		record->setpoint = packed_dequantize (reader->setpoint, PACKED_PPO2);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_PPO2)) {
+		if (!packed_get (reader, DC_SAMPLE_PPO2, &record->nppo2) ||
+			record->nppo2 > DC_SAMPLE_RECORD_MAXSENSORS)
+			return DC_STATUS_DATAFORMAT;
+		for (unsigned int i = 0; i < record->nppo2; ++i) {
+			unsigned int sensor = 0, unused = 0;
+			if (!packed_get (reader, DC_SAMPLE_PPO2, &sensor))
+				return DC_STATUS_DATAFORMAT;
+			unsigned int *previous = sensor < DC_SAMPLE_RECORD_MAXSENSORS ?
+				&reader->ppo2[sensor] : &unused;
+			if (!packed_get_delta (reader, DC_SAMPLE_PPO2, previous))
+				return DC_STATUS_DATAFORMAT;
+			record->ppo2[i].sensor = sensor;
+			record->ppo2[i].value = packed_dequantize (*previous, PACKED_PPO2);
+		}
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_CNS)) {
+		if (!packed_get_delta (reader, DC_SAMPLE_CNS, &reader->cns))
+			return DC_STATUS_DATAFORMAT;
+		record->cns = packed_dequantize (reader->cns, PACKED_CNS);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_DECO)) {
+		unsigned int depth = 0;
+		if (!packed_get (reader, DC_SAMPLE_DECO, &record->deco.type) ||
+			!packed_get (reader, DC_SAMPLE_DECO, &record->deco.time) ||
+			!packed_get (reader, DC_SAMPLE_DECO, &depth) ||
+			!packed_get (reader, DC_SAMPLE_DECO, &record->deco.tts))
+			return DC_STATUS_DATAFORMAT;
+		record->deco.depth = packed_dequantize (packed_unzigzag (depth), PACKED_DEPTH);
+	}
+
+	if (fields & DC_SAMPLE_MASK (DC_SAMPLE_GASMIX)) {
+		if (!packed_get (reader, DC_SAMPLE_GASMIX, &record->gasmix))
+			return DC_STATUS_DATAFORMAT;
+	}
+
+	reader->nrecords--;
+
+	return DC_STATUS_SUCCESS;
+}
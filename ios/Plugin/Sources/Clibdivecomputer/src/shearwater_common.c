@@ -22,6 +22,8 @@
 #include <string.h> // memcmp, memcpy
 #include <stdlib.h> // malloc, free
 
+#include <libdivecomputer/ble.h>
+
 #include "shearwater_common.h"
 
 #include "context-private.h"
@@ -65,6 +67,13 @@ shearwater_common_setup (shearwater_common_device_t *device, dc_context_t *conte
 		return status;
 	}
 
+	// Request a fast BLE link.
+	status = dc_ble_setup_link (device->iostream, NULL);
+	if (status != DC_STATUS_SUCCESS) {
+		ERROR (context, "Failed to set up the BLE link.");
+		return status;
+	}
+
 	// Make sure everything is in a sane state.
 	dc_iostream_sleep (device->iostream, 300);
 	dc_iostream_purge (device->iostream, DC_DIRECTION_ALL);
@@ -229,11 +238,11 @@ shearwater_common_slip_read (shearwater_common_device_t *device, unsigned char d
 {
 	dc_status_t status = DC_STATUS_SUCCESS;
 	dc_transport_t transport = dc_iostream_get_transport(device->iostream);
-	unsigned char buffer[256];
+	unsigned char buffer[DC_BLE_MTU_MAX - 3];
 	unsigned int escaped = 0;
 	unsigned int nbytes = 0;
 
-	// Get the packet size.
+	// Get the packet size. A BLE packet can be as large as the MTU allows.
 	size_t packetsize = (transport == DC_TRANSPORT_BLE) ? sizeof(buffer) : 1;
 
 	// Read bytes until a complete packet has been received. If the
@@ -188,12 +188,35 @@ shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 	// Convert to a number.
 	unsigned int firmware = str2num (rsp_firmware, sizeof(rsp_firmware), 1);
 
-	// Read the hardware type.
+	// The hardware type and the logbook type of the previous session can be
+	// reused, as long as the serial number and the firmware version are
+	// unchanged.
 	unsigned char rsp_hardware[2] = {0};
-	rc = shearwater_common_rdbi (&device->base, ID_HARDWARE, rsp_hardware, sizeof(rsp_hardware));
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR (abstract->context, "Failed to read the hardware type.");
-		return rc;
+	unsigned char rsp_logupload[9] = {0};
+	unsigned char warmstart[sizeof(rsp_firmware) + sizeof(rsp_hardware) + sizeof(rsp_logupload)] = {0};
+	if (device_warmstart_get (abstract, array_uint32_be (serial), warmstart, sizeof(warmstart)) &&
+		memcmp (warmstart, rsp_firmware, sizeof(rsp_firmware)) == 0) {
+		memcpy (rsp_hardware, warmstart + sizeof(rsp_firmware), sizeof(rsp_hardware));
+		memcpy (rsp_logupload, warmstart + sizeof(rsp_firmware) + sizeof(rsp_hardware), sizeof(rsp_logupload));
+	} else {
+		// Read the hardware type.
+		rc = shearwater_common_rdbi (&device->base, ID_HARDWARE, rsp_hardware, sizeof(rsp_hardware));
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to read the hardware type.");
+			return rc;
+		}
+
+		// Read the logbook type
+		rc = shearwater_common_rdbi (&device->base, ID_LOGUPLOAD, rsp_logupload, sizeof(rsp_logupload));
+		if (rc != DC_STATUS_SUCCESS) {
+			ERROR (abstract->context, "Failed to read the logbook type.");
+			return rc;
+		}
+
+		memcpy (warmstart, rsp_firmware, sizeof(rsp_firmware));
+		memcpy (warmstart + sizeof(rsp_firmware), rsp_hardware, sizeof(rsp_hardware));
+		memcpy (warmstart + sizeof(rsp_firmware) + sizeof(rsp_hardware), rsp_logupload, sizeof(rsp_logupload));
+		device_warmstart_set (abstract, array_uint32_be (serial), warmstart, sizeof(warmstart));
 	}
 
 	HEXDUMP(abstract->context, DC_LOGLEVEL_DEBUG, "Hardware", rsp_hardware, sizeof(rsp_hardware));
@@ -209,14 +232,6 @@ shearwater_petrel_device_foreach (dc_device_t *abstract, dc_dive_callback_t call
 	devinfo.serial = array_uint32_be (serial);
 	device_event_emit (abstract, DC_EVENT_DEVINFO, &devinfo);
 
-	// Read the logbook type
-	unsigned char rsp_logupload[9] = {0};
-	rc = shearwater_common_rdbi (&device->base, ID_LOGUPLOAD, rsp_logupload, sizeof(rsp_logupload));
-	if (rc != DC_STATUS_SUCCESS) {
-		ERROR (abstract->context, "Failed to read the logbook type.");
-		return rc;
-	}
-
 	unsigned int base_addr = array_uint32_be (rsp_logupload + 1);
 	switch (base_addr) {
 	case 0xDD000000: // Predator - we shouldn't get here, we could give up or we can try 0xC0000000
@@ -133,6 +133,8 @@ suunto_d9_parser_cache (suunto_d9_parser_t *parser)
 	}
 
 	// Get the logbook id tag.
+	if (size < 5)
+		return DC_STATUS_DATAFORMAT;
 	unsigned int id = array_uint32_le (data + 1);
 
 	// Gasmix information.
@@ -431,6 +433,10 @@ suunto_d9_parser_samples_foreach (dc_parser_t *abstract, dc_sample_callback_t ca
 		ERROR (abstract->context, "Invalid number of parameters.");
 		return DC_STATUS_DATAFORMAT;
 	}
+	if (parser->config + 2 + nparams * 3 > size) {
+		ERROR (abstract->context, "Buffer overflow detected!");
+		return DC_STATUS_DATAFORMAT;
+	}
 
 	// Available divisor values.
 	const unsigned int divisors[] = {1, 2, 4, 5, 10, 50, 100, 1000};
@@ -23,6 +23,8 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <libdivecomputer/ble.h>
+
 #include "suunto_eonsteel.h"
 #include "context-private.h"
 #include "device-private.h"
@@ -635,7 +637,19 @@ suunto_eonsteel_device_open(dc_device_t **out, dc_context_t *context, dc_iostrea
 	memset (eon->fingerprint, 0, sizeof (eon->fingerprint));
 
 	if (transport == DC_TRANSPORT_BLE) {
-		status = dc_hdlc_open (&eon->iostream, context, iostream, 20, 20);
+		// Request a fast link, and size the incoming HDLC packets to it.
+		// The outgoing packets stay at the 20 bytes the device expects.
+		unsigned int packetsize = 0;
+		status = dc_ble_setup_link (iostream, &packetsize);
+		if (status != DC_STATUS_SUCCESS) {
+			ERROR (context, "Failed to set up the BLE link.");
+			goto error_free;
+		}
+
+		if (packetsize == 0)
+			packetsize = DC_BLE_MTU_MIN - 3;
+
+		status = dc_hdlc_open (&eon->iostream, context, iostream, packetsize, 20);
 		if (status != DC_STATUS_SUCCESS) {
 			ERROR (context, "Failed to create the HDLC stream.");
 			goto error_free;
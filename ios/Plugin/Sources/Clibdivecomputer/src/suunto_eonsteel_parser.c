@@ -59,12 +59,50 @@ enum eon_sample {
 	ES_bookmark,
 };
 
+enum eon_field {
+	EF_none = 0,
+	EF_maxdepth,		// float32,precision=2
+	EF_surfacepressure,	// uint32 (Pascal)
+	EF_divemode,		// utf8
+	EF_algorithm,		// utf8
+	EF_conservatism,	// int8
+	EF_lowsetpoint,		// uint32 (Pascal)
+	EF_highsetpoint,	// uint32 (Pascal)
+	EF_gas_state,		// enum:0=Off,1=Primary,3=Diluent,4=Oxygen
+	EF_gas_oxygen,		// uint8,precision=2
+	EF_gas_helium,		// uint8,precision=2
+	EF_gas_tanksize,	// float32,precision=5
+	EF_gas_fillpressure,	// float32,precision=0
+};
+
+enum eon_setpoint {
+	EON_SETPOINT_LOW,
+	EON_SETPOINT_HIGH,
+	EON_SETPOINT_CUSTOM,
+};
+
+enum eon_gas {
+	EON_GAS_PRIMARY,
+	EON_GAS_DILUENT,
+	EON_GAS_OXYGEN,
+	EON_GAS_NONE,
+};
+
 #define EON_MAX_GROUP 16
+#define EON_MAX_ENUM  100
+
+// Resolved enumeration values that have no integer code.
+#define ENUM_MISSING 0xFFFF	// Value not present in the enumeration
+#define ENUM_UNKNOWN 0xFFFE	// Value present, but with an unknown string
 
 struct type_desc {
 	char *desc, *format, *mod;
+	const char *raw;
+	unsigned int rawlen;
 	unsigned int size;
 	enum eon_sample type[EON_MAX_GROUP];
+	enum eon_field field;
+	unsigned short *enums;
 };
 
 #define MAXTYPE 512
@@ -97,10 +135,10 @@ typedef struct suunto_eonsteel_parser_t {
 
 typedef int (*eon_data_cb_t)(unsigned short type, const struct type_desc *desc, const unsigned char *data, unsigned int len, void *user);
 
-typedef struct eon_event_t {
+typedef struct eon_enum_t {
 	const char *name;
-	parser_sample_event_t type;
-} eon_event_t;
+	unsigned int value;
+} eon_enum_t;
 
 static const struct {
 	const char *name;
@@ -135,6 +173,142 @@ static const struct {
 	{ "Events.DiveTimer.Time",		ES_none },
 };
 
+// "sml.DeviceLog.Header." fields of interest. The other
+// header fields are:
+//
+//   Activity (utf8)
+//   DateTime (utf8)
+//   Depth.Avg (float32,precision=2)
+//   Duration (uint32)
+//   PauseDuration (uint32)
+//   SampleInterval (uint8)
+//
+// and the "Diving." ones:
+//
+//   SurfaceTime (uint32)
+//   NumberInSeries (uint32)
+//   Altitude (uint16)
+//   AlgorithmTransitionDepth (uint8)
+//   DaysInSeries (uint32)
+//   PreviousDiveDepth (float32,precision=2)
+//   SwitchHighSetPoint.Enabled (bool)
+//   SwitchHighSetPoint.Depth (float32,precision=1)
+//   SwitchLowSetPoint.Enabled (bool)
+//   SwitchLowSetPoint.Depth (float32,precision=1)
+//   StartTissue.* and EndTissue.* (CNS, OTU, OLF, pressures)
+//   AlgorithmBottomTime (uint32)
+//   AlgorithmAscentTime (uint32)
+//   AlgorithmBottomMixture.Oxygen (uint8,precision=2)
+//   AlgorithmBottomMixture.Helium (uint8,precision=2)
+//   DesaturationTime (uint32)
+//
+// plus the per-gas fields:
+//
+//   .Gas.PO2 (uint32)
+//   .Gas.TransmitterID (utf8)
+//   .Gas.StartPressure (float32,precision=0)
+//   .Gas.EndPressure (float32,precision=0)
+//   .Gas.TransmitterStartBatteryCharge (int8,precision=2)
+//   .Gas.TransmitterEndBatteryCharge (int8,precision=2)
+//
+// The "sml.DeviceLog.Device." fields (battery, firmware versions,
+// name and serial number) are all utf8 and unused.
+static const struct {
+	const char *name;
+	enum eon_field field;
+} field_translation[] = {
+	{ "Depth.Max",				EF_maxdepth },
+	{ "Diving.SurfacePressure",		EF_surfacepressure },
+	{ "Diving.DiveMode",			EF_divemode },
+	{ "Diving.Algorithm",			EF_algorithm },
+	{ "Diving.Conservatism",		EF_conservatism },
+	{ "Diving.LowSetPoint",			EF_lowsetpoint },
+	{ "Diving.HighSetPoint",		EF_highsetpoint },
+	{ "Diving.Gases+Gas.State",		EF_gas_state },
+	{ "Diving.Gases.Gas.Oxygen",		EF_gas_oxygen },
+	{ "Diving.Gases.Gas.Helium",		EF_gas_helium },
+	{ "Diving.Gases.Gas.TankSize",		EF_gas_tanksize },
+	{ "Diving.Gases.Gas.TankFillPressure",	EF_gas_fillpressure },
+};
+
+/*
+ * The EON Steel has four different sample events: "state", "notification",
+ * "warning" and "alarm". All end up having two fields: type and a boolean value.
+ */
+static const eon_enum_t eon_states[] = {
+	{"Wet Outside",                SAMPLE_EVENT_NONE},
+	{"Below Wet Activation Depth", SAMPLE_EVENT_NONE},
+	{"Below Surface",              SAMPLE_EVENT_NONE},
+	{"Dive Active",                SAMPLE_EVENT_NONE},
+	{"Surface Calculation",        SAMPLE_EVENT_NONE},
+	{"Tank pressure available",    SAMPLE_EVENT_NONE},
+	{"Closed Circuit Mode",        SAMPLE_EVENT_NONE},
+};
+
+static const eon_enum_t eon_notifications[] = {
+	{"NoFly Time",         SAMPLE_EVENT_NONE},
+	{"Depth",              SAMPLE_EVENT_NONE},
+	{"Surface Time",       SAMPLE_EVENT_NONE},
+	{"Tissue Level",       SAMPLE_EVENT_TISSUELEVEL},
+	{"Deco",               SAMPLE_EVENT_NONE},
+	{"Deco Window",        SAMPLE_EVENT_NONE},
+	{"Safety Stop Ahead",  SAMPLE_EVENT_NONE},
+	{"Safety Stop",        SAMPLE_EVENT_SAFETYSTOP},
+	{"Safety Stop Broken", SAMPLE_EVENT_CEILING_SAFETYSTOP},
+	{"Deep Stop Ahead",    SAMPLE_EVENT_NONE},
+	{"Deep Stop",          SAMPLE_EVENT_DEEPSTOP},
+	{"Dive Time",          SAMPLE_EVENT_DIVETIME},
+	{"Gas Available",      SAMPLE_EVENT_NONE},
+	{"SetPoint Switch",    SAMPLE_EVENT_NONE},
+	{"Diluent Hypoxia",    SAMPLE_EVENT_NONE},
+	{"Air Time",           SAMPLE_EVENT_NONE},
+	{"Tank Pressure",      SAMPLE_EVENT_NONE},
+};
+
+static const eon_enum_t eon_warnings[] = {
+	{"ICD Penalty",           SAMPLE_EVENT_NONE},
+	{"Deep Stop Penalty",     SAMPLE_EVENT_VIOLATION},
+	{"Mandatory Safety Stop", SAMPLE_EVENT_SAFETYSTOP_MANDATORY},
+	{"OTU250",                SAMPLE_EVENT_NONE},
+	{"OTU300",                SAMPLE_EVENT_NONE},
+	{"CNS80%",                SAMPLE_EVENT_NONE},
+	{"CNS100%",               SAMPLE_EVENT_NONE},
+	{"Max.Depth",             SAMPLE_EVENT_MAXDEPTH},
+	{"Air Time",              SAMPLE_EVENT_AIRTIME},
+	{"Tank Pressure",         SAMPLE_EVENT_NONE},
+	{"Safety Stop Broken",    SAMPLE_EVENT_CEILING_SAFETYSTOP},
+	{"Deep Stop Broken",      SAMPLE_EVENT_CEILING_SAFETYSTOP},
+	{"Ceiling Broken",        SAMPLE_EVENT_CEILING},
+	{"PO2 High",              SAMPLE_EVENT_PO2},
+};
+
+static const eon_enum_t eon_alarms[] = {
+	{"Mandatory Safety Stop Broken", SAMPLE_EVENT_CEILING_SAFETYSTOP},
+	{"Ascent Speed",                 SAMPLE_EVENT_ASCENT},
+	{"Diluent Hyperoxia",            SAMPLE_EVENT_NONE},
+	{"Violated Deep Stop",           SAMPLE_EVENT_VIOLATION},
+	{"Ceiling Broken",               SAMPLE_EVENT_CEILING},
+	{"PO2 High",                     SAMPLE_EVENT_PO2},
+	{"PO2 Low",                      SAMPLE_EVENT_PO2},
+};
+
+// enum:0=Low,1=High,2=Custom
+static const eon_enum_t eon_setpoints[] = {
+	{"Low",    EON_SETPOINT_LOW},
+	{"High",   EON_SETPOINT_HIGH},
+	{"Custom", EON_SETPOINT_CUSTOM},
+};
+
+// Two versions so far:
+//   "enum:0=Off,1=Primary,2=?,3=Diluent"
+//   "enum:0=Off,1=Primary,3=Diluent,4=Oxygen"
+static const eon_enum_t eon_gases[] = {
+	{"Primary", EON_GAS_PRIMARY},
+	{"Diluent", EON_GAS_DILUENT},
+	{"Oxygen",  EON_GAS_OXYGEN},
+	{"None",    EON_GAS_NONE},
+};
+
 static enum eon_sample lookup_descriptor_type(suunto_eonsteel_parser_t *eon, struct type_desc *desc)
 {
 	const char *name = desc->desc;
@@ -166,14 +340,105 @@ static enum eon_sample lookup_descriptor_type(suunto_eonsteel_parser_t *eon, str
 	return ES_none;
 }
 
-static parser_sample_event_t lookup_event(const char *name, const eon_event_t events[], size_t n)
+static enum eon_field lookup_descriptor_field(suunto_eonsteel_parser_t *eon, struct type_desc *desc)
+{
+	const char *name = desc->desc;
+
+	// Not a header field? Skip it
+	if (strncmp(name, "sml.DeviceLog.Header.", 21))
+		return EF_none;
+
+	// Skip the common base
+	name += 21;
+
+	for (size_t i = 0; i < C_ARRAY_SIZE(field_translation); i++) {
+		if (!strcmp(name, field_translation[i].name))
+			return field_translation[i].field;
+	}
+	return EF_none;
+}
+
+/*
+ * Resolve the strings of an enumeration into integer codes.
+ *
+ * Enumerations have the enum values in the "format" string,
+ * and all start with "enum:" followed by a comma-separated list
+ * of enumeration values and strings. Example:
+ *
+ * "enum:0=NoFly Time,1=Depth,2=Surface Time,3=..."
+ *
+ * This is done once per descriptor, so that the samples only
+ * need to index the resulting table.
+ */
+static int resolve_enum(suunto_eonsteel_parser_t *eon, struct type_desc *desc, const eon_enum_t table[], size_t count)
 {
-	for (size_t i = 0; i < n; ++i) {
-		if (!strcasecmp(name, events[i].name))
-			return events[i].type;
+	const char *str = desc->format;
+	unsigned char c;
+
+	if (!str)
+		return 0;
+	if (strncmp(str, "enum:", 5))
+		return 0;
+	str += 5;
+
+	desc->enums = (unsigned short *) malloc(EON_MAX_ENUM * sizeof(unsigned short));
+	if (!desc->enums) {
+		ERROR(eon->base.context, "out of memory");
+		return -1;
+	}
+	for (unsigned int i = 0; i < EON_MAX_ENUM; ++i)
+		desc->enums[i] = ENUM_MISSING;
+
+	while ((c = *str) != 0) {
+		unsigned char n;
+		const char *begin, *end;
+
+		str++;
+		if (!isdigit(c))
+			continue;
+		n = c - '0';
+
+		// We only handle one or two digits
+		if (isdigit(*str)) {
+			n = n*10 + *str - '0';
+			str++;
+		}
+
+		begin = end = str;
+		while ((c = *str) != 0) {
+			str++;
+			if (c == ',')
+				break;
+			end = str;
+		}
+
+		// Verify that it has the 'n=string' format and skip the equals sign
+		if (*begin != '=')
+			continue;
+		begin++;
+
+		// The first string for a value wins
+		if (desc->enums[n] != ENUM_MISSING)
+			continue;
+
+		desc->enums[n] = ENUM_UNKNOWN;
+		for (size_t i = 0; i < count; ++i) {
+			size_t len = end - begin;
+			if (strlen(table[i].name) == len && !strncasecmp(table[i].name, begin, len)) {
+				desc->enums[n] = table[i].value;
+				break;
+			}
+		}
 	}
+	return 0;
+}
+
+static unsigned int lookup_enum(const struct type_desc *desc, unsigned char value)
+{
+	if (!desc->enums || value >= EON_MAX_ENUM)
+		return ENUM_MISSING;
 
-	return SAMPLE_EVENT_NONE;
+	return desc->enums[value];
 }
 
 static const char *desc_type_name(enum eon_sample type)
@@ -271,17 +536,45 @@ static int fill_in_group_details(suunto_eonsteel_parser_t *eon, struct type_desc
  * base types) or are "GRP" types that are a group of said
  * types and are a set of numbers.
  */
+static int fill_in_enum_details(suunto_eonsteel_parser_t *eon, struct type_desc *desc)
+{
+	if (desc->field == EF_gas_state)
+		return resolve_enum(eon, desc, eon_gases, C_ARRAY_SIZE(eon_gases));
+
+	for (unsigned int i = 0; i < EON_MAX_GROUP; i++) {
+		switch (desc->type[i]) {
+		case ES_state:
+			return resolve_enum(eon, desc, eon_states, C_ARRAY_SIZE(eon_states));
+		case ES_notify:
+			return resolve_enum(eon, desc, eon_notifications, C_ARRAY_SIZE(eon_notifications));
+		case ES_warning:
+			return resolve_enum(eon, desc, eon_warnings, C_ARRAY_SIZE(eon_warnings));
+		case ES_alarm:
+			return resolve_enum(eon, desc, eon_alarms, C_ARRAY_SIZE(eon_alarms));
+		case ES_setpoint_type:
+			return resolve_enum(eon, desc, eon_setpoints, C_ARRAY_SIZE(eon_setpoints));
+		default:
+			break;
+		}
+	}
+	return 0;
+}
+
 static int fill_in_desc_details(suunto_eonsteel_parser_t *eon, struct type_desc *desc)
 {
 	if (!desc->desc)
 		return 0;
 
-	if (isdigit(desc->desc[0]))
-		return fill_in_group_details(eon, desc);
+	if (isdigit(desc->desc[0])) {
+		if (fill_in_group_details(eon, desc) < 0)
+			return -1;
+	} else {
+		desc->size = lookup_descriptor_size(eon, desc);
+		desc->type[0] = lookup_descriptor_type(eon, desc);
+		desc->field = lookup_descriptor_field(eon, desc);
+	}
 
-	desc->size = lookup_descriptor_size(eon, desc);
-	desc->type[0] = lookup_descriptor_type(eon, desc);
-	return 0;
+	return fill_in_enum_details(eon, desc);
 }
 
 static void
@@ -291,14 +584,25 @@ desc_free (struct type_desc desc[], unsigned int count)
 		free(desc[i].desc);
 		free(desc[i].format);
 		free(desc[i].mod);
+		free(desc[i].enums);
 	}
 }
 
 static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const char *name, int namelen)
 {
 	struct type_desc desc;
+	const char *raw = name;
 	const char *next;
 
+	// Every traversal of the dive sees the same descriptors again,
+	// so only parse them when they differ from the cached ones.
+	if (type < MAXTYPE && namelen > 0) {
+		const struct type_desc *cached = eon->type_desc + type;
+		if (cached->raw && cached->rawlen == (unsigned int) namelen &&
+			!memcmp(cached->raw, raw, namelen))
+			return 0;
+	}
+
 	memset(&desc, 0, sizeof(desc));
 	do {
 		int len;
@@ -357,6 +661,11 @@ static int record_type(suunto_eonsteel_parser_t *eon, unsigned short type, const
 		return -1;
 	}
 
+	if (namelen > 0) {
+		desc.raw = raw;
+		desc.rawlen = namelen;
+	}
+
 	fill_in_desc_details(eon, &desc);
 
 	desc_free(eon->type_desc + type, 1);
@@ -461,8 +770,8 @@ struct sample_data {
 	dc_sample_callback_t callback;
 	void *userdata;
 	unsigned int time;
-	char *state_type, *notify_type;
-	char *warning_type, *alarm_type;
+	unsigned int state_type, notify_type;
+	unsigned int warning_type, alarm_type;
 
 	/* We gather up deco and cylinder pressure information */
 	int gasnr;
@@ -604,217 +913,19 @@ static void sample_gas_switch_event(struct sample_data *info, unsigned short idx
 	if (info->callback) info->callback(DC_SAMPLE_GASMIX, &sample, info->userdata);
 }
 
-/*
- * Look up the string from an enumeration.
- *
- * Enumerations have the enum values in the "format" string,
- * and all start with "enum:" followed by a comma-separated list
- * of enumeration values and strings. Example:
- *
- * "enum:0=NoFly Time,1=Depth,2=Surface Time,3=..."
- */
-static char *lookup_enum(const struct type_desc *desc, unsigned char value)
-{
-	const char *str = desc->format;
-	unsigned char c;
-
-	if (!str)
-		return NULL;
-	if (strncmp(str, "enum:", 5))
-		return NULL;
-	str += 5;
-
-	while ((c = *str) != 0) {
-		unsigned char n;
-		const char *begin, *end;
-		char *ret;
-
-		str++;
-		if (!isdigit(c))
-			continue;
-		n = c - '0';
-
-		// We only handle one or two digits
-		if (isdigit(*str)) {
-			n = n*10 + *str - '0';
-			str++;
-		}
-
-		begin = end = str;
-		while ((c = *str) != 0) {
-			str++;
-			if (c == ',')
-				break;
-			end = str;
-		}
-
-		// Verify that it has the 'n=string' format and skip the equals sign
-		if (*begin != '=')
-			continue;
-		begin++;
-
-		// Is it the value we're looking for?
-		if (n != value)
-			continue;
-
-		ret = (char *)malloc(end - begin + 1);
-		if (!ret)
-			break;
-
-		memcpy(ret, begin, end-begin);
-		ret[end-begin] = 0;
-		return ret;
-	}
-	return NULL;
-}
-
 /*
  * The EON Steel has four different sample events: "state", "notification",
- * "warning" and "alarm". All end up having two fields: type and a boolean value.
+ * "warning" and "alarm". All end up having two fields: type and a boolean
+ * value. The type has already been resolved to an event type.
  */
-static void sample_event_state_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
-{
-	free(info->state_type);
-	info->state_type = lookup_enum(desc, type);
-}
-
-static void sample_event_state_value(const struct type_desc *desc, struct sample_data *info, unsigned char value)
-{
-	dc_sample_value_t sample = {0};
-	static const eon_event_t states[] = {
-		{"Wet Outside",                SAMPLE_EVENT_NONE},
-		{"Below Wet Activation Depth", SAMPLE_EVENT_NONE},
-		{"Below Surface",              SAMPLE_EVENT_NONE},
-		{"Dive Active",                SAMPLE_EVENT_NONE},
-		{"Surface Calculation",        SAMPLE_EVENT_NONE},
-		{"Tank pressure available",    SAMPLE_EVENT_NONE},
-		{"Closed Circuit Mode",        SAMPLE_EVENT_NONE},
-	};
-	const char *name;
-
-	name = info->state_type;
-	if (!name)
-		return;
-
-	sample.event.type = lookup_event(name, states, C_ARRAY_SIZE(states));
-	if (sample.event.type == SAMPLE_EVENT_NONE)
-		return;
-
-	sample.event.flags = value ? SAMPLE_FLAGS_BEGIN : SAMPLE_FLAGS_END;
-	if (info->callback) info->callback(DC_SAMPLE_EVENT, &sample, info->userdata);
-}
-
-static void sample_event_notify_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
-{
-	free(info->notify_type);
-	info->notify_type = lookup_enum(desc, type);
-}
-
-static void sample_event_notify_value(const struct type_desc *desc, struct sample_data *info, unsigned char value)
-{
-	static const eon_event_t notifications[] = {
-		{"NoFly Time",         SAMPLE_EVENT_NONE},
-		{"Depth",              SAMPLE_EVENT_NONE},
-		{"Surface Time",       SAMPLE_EVENT_NONE},
-		{"Tissue Level",       SAMPLE_EVENT_TISSUELEVEL},
-		{"Deco",               SAMPLE_EVENT_NONE},
-		{"Deco Window",        SAMPLE_EVENT_NONE},
-		{"Safety Stop Ahead",  SAMPLE_EVENT_NONE},
-		{"Safety Stop",        SAMPLE_EVENT_SAFETYSTOP},
-		{"Safety Stop Broken", SAMPLE_EVENT_CEILING_SAFETYSTOP},
-		{"Deep Stop Ahead",    SAMPLE_EVENT_NONE},
-		{"Deep Stop",          SAMPLE_EVENT_DEEPSTOP},
-		{"Dive Time",          SAMPLE_EVENT_DIVETIME},
-		{"Gas Available",      SAMPLE_EVENT_NONE},
-		{"SetPoint Switch",    SAMPLE_EVENT_NONE},
-		{"Diluent Hypoxia",    SAMPLE_EVENT_NONE},
-		{"Air Time",           SAMPLE_EVENT_NONE},
-		{"Tank Pressure",      SAMPLE_EVENT_NONE},
-	};
-	dc_sample_value_t sample = {0};
-	const char *name;
-
-	name = info->notify_type;
-	if (!name)
-		return;
-
-	sample.event.type = lookup_event(name, notifications, C_ARRAY_SIZE(notifications));
-	if (sample.event.type == SAMPLE_EVENT_NONE)
-		return;
-
-	sample.event.flags = value ? SAMPLE_FLAGS_BEGIN : SAMPLE_FLAGS_END;
-	if (info->callback) info->callback(DC_SAMPLE_EVENT, &sample, info->userdata);
-}
-
-
-static void sample_event_warning_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
-{
-	free(info->warning_type);
-	info->warning_type = lookup_enum(desc, type);
-}
-
-static void sample_event_warning_value(const struct type_desc *desc, struct sample_data *info, unsigned char value)
-{
-	static const eon_event_t warnings[] = {
-		{"ICD Penalty",           SAMPLE_EVENT_NONE},
-		{"Deep Stop Penalty",     SAMPLE_EVENT_VIOLATION},
-		{"Mandatory Safety Stop", SAMPLE_EVENT_SAFETYSTOP_MANDATORY},
-		{"OTU250",                SAMPLE_EVENT_NONE},
-		{"OTU300",                SAMPLE_EVENT_NONE},
-		{"CNS80%",                SAMPLE_EVENT_NONE},
-		{"CNS100%",               SAMPLE_EVENT_NONE},
-		{"Max.Depth",             SAMPLE_EVENT_MAXDEPTH},
-		{"Air Time",              SAMPLE_EVENT_AIRTIME},
-		{"Tank Pressure",         SAMPLE_EVENT_NONE},
-		{"Safety Stop Broken",    SAMPLE_EVENT_CEILING_SAFETYSTOP},
-		{"Deep Stop Broken",      SAMPLE_EVENT_CEILING_SAFETYSTOP},
-		{"Ceiling Broken",        SAMPLE_EVENT_CEILING},
-		{"PO2 High",              SAMPLE_EVENT_PO2},
-	};
-	dc_sample_value_t sample = {0};
-	const char *name;
-
-	name = info->warning_type;
-	if (!name)
-		return;
-
-	sample.event.type = lookup_event(name, warnings, C_ARRAY_SIZE(warnings));
-	if (sample.event.type == SAMPLE_EVENT_NONE)
-		return;
-
-	sample.event.flags = value ? SAMPLE_FLAGS_BEGIN : SAMPLE_FLAGS_END;
-	if (info->callback) info->callback(DC_SAMPLE_EVENT, &sample, info->userdata);
-}
-
-static void sample_event_alarm_type(const struct type_desc *desc, struct sample_data *info, unsigned char type)
+static void sample_event(struct sample_data *info, unsigned int type, unsigned char value)
 {
-	free(info->alarm_type);
-	info->alarm_type = lookup_enum(desc, type);
-}
-
-
-static void sample_event_alarm_value(const struct type_desc *desc, struct sample_data *info, unsigned char value)
-{
-	static const eon_event_t alarms[] = {
-		{"Mandatory Safety Stop Broken", SAMPLE_EVENT_CEILING_SAFETYSTOP},
-		{"Ascent Speed",                 SAMPLE_EVENT_ASCENT},
-		{"Diluent Hyperoxia",            SAMPLE_EVENT_NONE},
-		{"Violated Deep Stop",           SAMPLE_EVENT_VIOLATION},
-		{"Ceiling Broken",               SAMPLE_EVENT_CEILING},
-		{"PO2 High",                     SAMPLE_EVENT_PO2},
-		{"PO2 Low",                      SAMPLE_EVENT_PO2},
-	};
 	dc_sample_value_t sample = {0};
-	const char *name;
-
-	name = info->alarm_type;
-	if (!name)
-		return;
 
-	sample.event.type = lookup_event(name, alarms, C_ARRAY_SIZE(alarms));
-	if (sample.event.type == SAMPLE_EVENT_NONE)
+	if (type == ENUM_MISSING || type == ENUM_UNKNOWN || type == SAMPLE_EVENT_NONE)
 		return;
 
+	sample.event.type = type;
 	sample.event.flags = value ? SAMPLE_FLAGS_BEGIN : SAMPLE_FLAGS_END;
 	if (info->callback) info->callback(DC_SAMPLE_EVENT, &sample, info->userdata);
 }
@@ -823,27 +934,26 @@ static void sample_event_alarm_value(const struct type_desc *desc, struct sample
 static void sample_setpoint_type(const struct type_desc *desc, struct sample_data *info, unsigned char value)
 {
 	dc_sample_value_t sample = {0};
-	char *type = lookup_enum(desc, value);
-
-	if (!type) {
-		DEBUG(info->eon->base.context, "sample_setpoint_type(%u) did not match anything in %s", value, desc->format);
-		return;
-	}
 
-	if (!strcasecmp(type, "Low"))
+	switch (lookup_enum(desc, value)) {
+	case EON_SETPOINT_LOW:
 		sample.setpoint = info->eon->cache.lowsetpoint;
-	else if (!strcasecmp(type, "High"))
+		break;
+	case EON_SETPOINT_HIGH:
 		sample.setpoint = info->eon->cache.highsetpoint;
-	else if (!strcasecmp(type, "Custom"))
+		break;
+	case EON_SETPOINT_CUSTOM:
 		sample.setpoint = info->eon->cache.customsetpoint;
-	else {
-		DEBUG(info->eon->base.context, "sample_setpoint_type(%u) unknown type '%s'", value, type);
-		free(type);
+		break;
+	case ENUM_MISSING:
+		DEBUG(info->eon->base.context, "sample_setpoint_type(%u) did not match anything in %s", value, desc->format);
+		return;
+	default:
+		DEBUG(info->eon->base.context, "sample_setpoint_type(%u) unknown type in %s", value, desc->format);
 		return;
 	}
 
 	if (info->callback) info->callback(DC_SAMPLE_SETPOINT, &sample, info->userdata);
-	free(type);
 }
 
 // uint32
@@ -911,35 +1021,35 @@ static unsigned int handle_sample_type(const struct type_desc *desc, struct samp
 		return 2;
 
 	case ES_state:
-		sample_event_state_type(desc, info, data[0]);
+		info->state_type = lookup_enum(desc, data[0]);
 		return 1;
 
 	case ES_state_active:
-		sample_event_state_value(desc, info, data[0]);
+		sample_event(info, info->state_type, data[0]);
 		return 1;
 
 	case ES_notify:
-		sample_event_notify_type(desc, info, data[0]);
+		info->notify_type = lookup_enum(desc, data[0]);
 		return 1;
 
 	case ES_notify_active:
-		sample_event_notify_value(desc, info, data[0]);
+		sample_event(info, info->notify_type, data[0]);
 		return 1;
 
 	case ES_warning:
-		sample_event_warning_type(desc, info, data[0]);
+		info->warning_type = lookup_enum(desc, data[0]);
 		return 1;
 
 	case ES_warning_active:
-		sample_event_warning_value(desc, info, data[0]);
+		sample_event(info, info->warning_type, data[0]);
 		return 1;
 
 	case ES_alarm:
-		sample_event_alarm_type(desc, info, data[0]);
+		info->alarm_type = lookup_enum(desc, data[0]);
 		return 1;
 
 	case ES_alarm_active:
-		sample_event_alarm_value(desc, info, data[0]);
+		sample_event(info, info->alarm_type, data[0]);
 		return 1;
 
 	case ES_bookmark:
@@ -1016,12 +1126,10 @@ suunto_eonsteel_parser_samples_foreach(dc_parser_t *abstract, dc_sample_callback
 	suunto_eonsteel_parser_t *eon = (suunto_eonsteel_parser_t *) abstract;
 	struct sample_data data = { eon, callback, userdata, 0 };
 
-	traverse_data(eon, traverse_samples, &data);
+	data.state_type = data.notify_type = ENUM_MISSING;
+	data.warning_type = data.alarm_type = ENUM_MISSING;
 
-	free(data.state_type);
-	free(data.notify_type);
-	free(data.warning_type);
-	free(data.alarm_type);
+	traverse_data(eon, traverse_samples, &data);
 
 	return DC_STATUS_SUCCESS;
 }
@@ -1148,10 +1256,8 @@ static void set_depth_field(suunto_eonsteel_parser_t *eon, unsigned short d)
 // new gas:
 //  "sml.DeviceLog.Header.Diving.Gases+Gas.State"
 //
-// We eventually need to parse the descriptor for that 'enum type'.
-// Two versions so far:
-//   "enum:0=Off,1=Primary,2=?,3=Diluent"
-//   "enum:0=Off,1=Primary,3=Diluent,4=Oxygen"
+// The 'enum type' of the descriptor has already been
+// resolved into an EON_GAS_* value.
 //
 // We turn that into the DC_TANKVOLUME data here, but
 // initially consider all non-off tanks to me METRIC.
@@ -1163,23 +1269,30 @@ static int add_gas_type(suunto_eonsteel_parser_t *eon, const struct type_desc *d
 	int idx = eon->cache.ngases;
 	dc_tankvolume_t tankinfo = DC_TANKVOLUME_METRIC;
 	dc_usage_t usage = DC_USAGE_NONE;
-	char *name;
 
 	if (idx >= MAXGASES)
 		return 0;
 
 	eon->cache.ngases = idx+1;
-	name = lookup_enum(desc, type);
-	if (!name)
-		DEBUG(eon->base.context, "Unable to look up gas type %u in %s", type, desc->format);
-	else if (!strcasecmp(name, "Diluent"))
+	switch (lookup_enum(desc, type)) {
+	case EON_GAS_PRIMARY:
+		break;
+	case EON_GAS_DILUENT:
 		usage = DC_USAGE_DILUENT;
-	else if (!strcasecmp(name, "Oxygen"))
+		break;
+	case EON_GAS_OXYGEN:
 		usage = DC_USAGE_OXYGEN;
-	else if (!strcasecmp(name, "None"))
+		break;
+	case EON_GAS_NONE:
 		tankinfo = DC_TANKVOLUME_NONE;
-	else if (strcasecmp(name, "Primary"))
-		DEBUG(eon->base.context, "Unknown gas type %u (%s)", type, name);
+		break;
+	case ENUM_MISSING:
+		DEBUG(eon->base.context, "Unable to look up gas type %u in %s", type, desc->format);
+		break;
+	default:
+		DEBUG(eon->base.context, "Unknown gas type %u in %s", type, desc->format);
+		break;
+	}
 
 	eon->cache.tankinfo[idx] = tankinfo;
 	eon->cache.tankusage[idx] = usage;
@@ -1187,7 +1300,6 @@ static int add_gas_type(suunto_eonsteel_parser_t *eon, const struct type_desc *d
 
 	eon->cache.initialized |= 1 << DC_FIELD_GASMIX_COUNT;
 	eon->cache.initialized |= 1 << DC_FIELD_TANK_COUNT;
-	free(name);
 	return 0;
 }
 
@@ -1241,110 +1353,23 @@ static float get_le32_float(const unsigned char *src)
 	return u.result;
 }
 
-// "Device" fields are all utf8:
-//   Info.BatteryAtEnd
-//   Info.BatteryAtStart
-//   Info.BSL
-//   Info.HW
-//   Info.SW
-//   Name
-//   SerialNumber
-static int traverse_device_fields(suunto_eonsteel_parser_t *eon, const struct type_desc *desc,
-                                  const unsigned char *data, int len)
-{
-	return 0;
-}
-
-// "sml.DeviceLog.Header.Diving.Gases"
-//
-//   +Gas.State (enum:0=Off,1=Primary,3=Diluent,4=Oxygen)
-//   .Gas.Oxygen (uint8,precision=2)
-//   .Gas.Helium (uint8,precision=2)
-//   .Gas.PO2 (uint32)
-//   .Gas.TransmitterID (utf8)
-//   .Gas.TankSize (float32,precision=5)
-//   .Gas.TankFillPressure (float32,precision=0)
-//   .Gas.StartPressure (float32,precision=0)
-//   .Gas.EndPressure (float32,precision=0)
-//   .Gas.TransmitterStartBatteryCharge (int8,precision=2)
-//   .Gas.TransmitterEndBatteryCharge (int8,precision=2)
-static int traverse_gas_fields(suunto_eonsteel_parser_t *eon, const struct type_desc *desc,
-                               const unsigned char *data, int len)
-{
-	const char *name = desc->desc + strlen("sml.DeviceLog.Header.Diving.Gases");
-
-	if (!strcmp(name, "+Gas.State"))
-		return add_gas_type(eon, desc, data[0]);
-
-	if (!strcmp(name, ".Gas.Oxygen"))
-		return add_gas_o2(eon, data[0]);
-
-	if (!strcmp(name, ".Gas.Helium"))
-		return add_gas_he(eon, data[0]);
-
-	if (!strcmp(name, ".Gas.TankSize"))
-		return add_gas_size(eon, get_le32_float(data));
-
-	if (!strcmp(name, ".Gas.TankFillPressure"))
-		return add_gas_workpressure(eon, get_le32_float(data));
-
-	return 0;
-}
-
-
-// "sml.DeviceLog.Header.Diving."
-//
-//   SurfaceTime (uint32)
-//   NumberInSeries (uint32)
-//   Algorithm (utf8)
-//   SurfacePressure (uint32)
-//   Conservatism (int8)
-//   Altitude (uint16)
-//   AlgorithmTransitionDepth (uint8)
-//   DaysInSeries (uint32)
-//   PreviousDiveDepth (float32,precision=2)
-//   LowSetPoint (uint32)
-//   HighSetPoint (uint32)
-//   SwitchHighSetPoint.Enabled (bool)
-//   SwitchHighSetPoint.Depth (float32,precision=1)
-//   SwitchLowSetPoint.Enabled (bool)
-//   SwitchLowSetPoint.Depth (float32,precision=1)
-//   StartTissue.CNS (float32,precision=3)
-//   StartTissue.OTU (float32)
-//   StartTissue.OLF (float32,precision=3)
-//   StartTissue.Nitrogen+Pressure (uint32)
-//   StartTissue.Helium+Pressure (uint32)
-//   StartTissue.RgbmNitrogen (float32,precision=3)
-//   StartTissue.RgbmHelium (float32,precision=3)
-//   DiveMode (utf8)
-//   AlgorithmBottomTime (uint32)
-//   AlgorithmAscentTime (uint32)
-//   AlgorithmBottomMixture.Oxygen (uint8,precision=2)
-//   AlgorithmBottomMixture.Helium (uint8,precision=2)
-//   DesaturationTime (uint32)
-//   EndTissue.CNS (float32,precision=3)
-//   EndTissue.OTU (float32)
-//   EndTissue.OLF (float32,precision=3)
-//   EndTissue.Nitrogen+Pressure (uint32)
-//   EndTissue.Helium+Pressure (uint32)
-//   EndTissue.RgbmNitrogen (float32,precision=3)
-//   EndTissue.RgbmHelium (float32,precision=3)
-static int traverse_diving_fields(suunto_eonsteel_parser_t *eon, const struct type_desc *desc,
-                                  const unsigned char *data, int len)
+static int traverse_dynamic_fields(suunto_eonsteel_parser_t *eon, const struct type_desc *desc, const unsigned char *data, int len)
 {
-	const char *name = desc->desc + strlen("sml.DeviceLog.Header.Diving.");
-
-	if (!strncmp(name, "Gases", 5))
-		return traverse_gas_fields(eon, desc, data, len);
+	unsigned int pressure;
+	double d;
 
-	if (!strcmp(name, "SurfacePressure")) {
-		unsigned int pressure = array_uint32_le(data); // in SI units - Pascal
+	switch (desc->field) {
+	case EF_maxdepth:
+		d = get_le32_float(data);
+		if (d > eon->cache.maxdepth)
+			eon->cache.maxdepth = d;
+		break;
+	case EF_surfacepressure:
+		pressure = array_uint32_le(data); // in SI units - Pascal
 		eon->cache.surface_pressure = pressure / 100000.0; // bar
 		eon->cache.initialized |= 1 << DC_FIELD_ATMOSPHERIC;
-		return 0;
-	}
-
-	if (!strcmp(name, "DiveMode")) {
+		break;
+	case EF_divemode:
 		if (!strncmp((const char *)data, "Air", 3) || !strncmp((const char *)data, "Nitrox", 6)) {
 			eon->cache.divemode = DC_DIVEMODE_OC;
 			eon->cache.initialized |= 1 << DC_FIELD_DIVEMODE;
@@ -1352,79 +1377,37 @@ static int traverse_diving_fields(suunto_eonsteel_parser_t *eon, const struct ty
 			eon->cache.divemode = DC_DIVEMODE_CCR;
 			eon->cache.initialized |= 1 << DC_FIELD_DIVEMODE;
 		}
-		return 0;
-	}
-
-	if (!strcmp(name, "Algorithm")) {
+		break;
+	case EF_algorithm:
 		if (!strcmp((const char *)data, "Suunto Fused RGBM")) {
 			eon->cache.decomodel.type = DC_DECOMODEL_RGBM;
 			eon->cache.initialized |= 1 << DC_FIELD_DECOMODEL;
 		}
-		return 0;
-	}
-
-	if (!strcmp(name, "Conservatism")) {
+		break;
+	case EF_conservatism:
 		eon->cache.decomodel.conservatism = *(const signed char *)data;
 		eon->cache.initialized |= 1 << DC_FIELD_DECOMODEL;
-		return 0;
-	}
-
-	if (!strcmp(name, "LowSetPoint")) {
-		unsigned int pressure = array_uint32_le(data); // in SI units - Pascal
+		break;
+	case EF_lowsetpoint:
+		pressure = array_uint32_le(data); // in SI units - Pascal
 		eon->cache.lowsetpoint = pressure / 100000.0; // bar
-		return 0;
-	}
-
-	if (!strcmp(name, "HighSetPoint")) {
-		unsigned int pressure = array_uint32_le(data); // in SI units - Pascal
+		break;
+	case EF_highsetpoint:
+		pressure = array_uint32_le(data); // in SI units - Pascal
 		eon->cache.highsetpoint = pressure / 100000.0; // bar
-		return 0;
-	}
-
-	return 0;
-}
-
-// "Header" fields are:
-//   Activity (utf8)
-//   DateTime (utf8)
-//   Depth.Avg (float32,precision=2)
-//   Depth.Max (float32,precision=2)
-//   Diving.*
-//   Duration (uint32)
-//   PauseDuration (uint32)
-//   SampleInterval (uint8)
-static int traverse_header_fields(suunto_eonsteel_parser_t *eon, const struct type_desc *desc,
-                                  const unsigned char *data, int len)
-{
-	const char *name = desc->desc + strlen("sml.DeviceLog.Header.");
-
-	if (!strncmp(name, "Diving.", 7))
-		return traverse_diving_fields(eon, desc, data, len);
-
-	if (!strcmp(name, "Depth.Max")) {
-		double d = get_le32_float(data);
-		if (d > eon->cache.maxdepth)
-			eon->cache.maxdepth = d;
-		return 0;
-	}
-
-	return 0;
-}
-
-static int traverse_dynamic_fields(suunto_eonsteel_parser_t *eon, const struct type_desc *desc, const unsigned char *data, int len)
-{
-	const char *name = desc->desc;
-
-	if (!strncmp(name, "sml.", 4)) {
-		name += 4;
-		if (!strncmp(name, "DeviceLog.", 10)) {
-			name += 10;
-			if (!strncmp(name, "Device.", 7))
-				return traverse_device_fields(eon, desc, data, len);
-			if (!strncmp(name, "Header.", 7)) {
-				return traverse_header_fields(eon, desc, data, len);
-			}
-		}
+		break;
+	case EF_gas_state:
+		return add_gas_type(eon, desc, data[0]);
+	case EF_gas_oxygen:
+		return add_gas_o2(eon, data[0]);
+	case EF_gas_helium:
+		return add_gas_he(eon, data[0]);
+	case EF_gas_tanksize:
+		return add_gas_size(eon, get_le32_float(data));
+	case EF_gas_fillpressure:
+		return add_gas_workpressure(eon, get_le32_float(data));
+	default:
+		break;
 	}
 	return 0;
 }
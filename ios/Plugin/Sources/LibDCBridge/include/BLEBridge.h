@@ -44,15 +44,32 @@ typedef struct ble_object {
     void* manager;
 } ble_object_t;
 
+// Receive ring buffer
+//
+// Single producer (the CoreBluetooth notification callback), single
+// consumer (the iostream read). Every notification is stored as one
+// packet, so the reader gets the same packet boundaries as the device
+// sent. The producer never blocks: packets that do not fit are dropped.
+typedef struct ble_ring ble_ring_t;
+
+ble_ring_t* ble_ring_new(void);
+void ble_ring_free(ble_ring_t *ring);
+dc_status_t ble_ring_read(ble_ring_t *ring, void *data, size_t size, size_t *actual, int timeout);
+dc_status_t ble_ring_poll(ble_ring_t *ring, int timeout);
+size_t ble_ring_available(ble_ring_t *ring);
+
+// Routes notifications to the ring, or back to the manager when detached.
+void ble_ring_attach(ble_ring_t *ring);
+void ble_ring_detach(ble_ring_t *ring);
+bool ble_receive(const void *data, size_t size);
+
 // BLE object functions
 ble_object_t* createBLEObject(void);
 void freeBLEObject(ble_object_t* obj);
 
 // BLE operations
-dc_status_t ble_set_timeout(ble_object_t *io, int timeout);
 dc_status_t ble_ioctl(ble_object_t *io, unsigned int request, void *data, size_t size);
 dc_status_t ble_sleep(ble_object_t *io, unsigned int milliseconds);
-dc_status_t ble_read(ble_object_t *io, void *data, size_t size, size_t *actual);
 dc_status_t ble_write(ble_object_t *io, const void *data, size_t size, size_t *actual);
 dc_status_t ble_close(ble_object_t *io);
 
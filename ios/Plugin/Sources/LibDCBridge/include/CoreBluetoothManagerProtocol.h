@@ -7,9 +7,11 @@
 @protocol CoreBluetoothManagerProtocol <NSObject>
 + (id)shared;
 - (BOOL)connectToDevice:(NSString *)address;
+- (BOOL)connectToDevice:(NSString *)address timeout:(NSTimeInterval)timeout;
 - (BOOL)discoverServices;
 - (BOOL)enableNotifications;
 - (BOOL)writeData:(NSData *)data;
+- (NSInteger)maximumWriteLength;
 - (NSData *)readDataPartial:(int)requested;
 - (void)close;
 @end
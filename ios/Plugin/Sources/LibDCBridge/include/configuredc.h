@@ -102,6 +102,18 @@ dc_status_t find_descriptor_by_name(dc_descriptor_t **out_descriptor, const char
  */
 dc_status_t get_device_info_from_name(const char *name, dc_family_t *family, unsigned int *model);
 
+/**
+ * Resolves the descriptor of a discovered BLE device, cached for the connect
+ * @param address: BLE device address/UUID
+ * @param name: Advertised device name
+ * @param family: Output parameter for device family (may be NULL)
+ * @param model: Output parameter for device model (may be NULL)
+ * @return DC_STATUS_SUCCESS on success, DC_STATUS_UNSUPPORTED if not supported
+ * @note Also prepares the context for the next device that is opened
+ */
+dc_status_t resolve_ble_device(const char *address, const char *name,
+    dc_family_t *family, unsigned int *model);
+
 /**
  * Gets formatted display name for a device
  * @param name: Device name to match
@@ -133,6 +145,14 @@ dc_status_t open_ble_device_with_identification(device_data_t **out_data,
     const char *name, const char *address,
     dc_family_t stored_family, unsigned int stored_model);
 
+/**
+ * Closes a device opened with open_ble_device_with_identification
+ * @param data: Device data to close, freed afterwards (may be NULL)
+ * @note The device stays open for any number of operations, so only call
+ *       this on disconnect
+ */
+void close_ble_device(device_data_t *data);
+
 /*--------------------------------------------------------------------
  * Parser Functions
  *------------------------------------------------------------------*/
@@ -149,6 +169,13 @@ dc_status_t open_ble_device_with_identification(device_data_t **out_data,
 dc_status_t create_parser_for_device(dc_parser_t **parser, dc_context_t *context,
     dc_family_t family, unsigned int model, const unsigned char *data, size_t size);
 
+/**
+ * Opens the persistent fingerprint store, attached to every device opened afterwards
+ * @param filename: Path of the store file, created if missing
+ * @return DC_STATUS_SUCCESS on success
+ */
+dc_status_t open_fingerprint_store(const char *filename);
+
 /*--------------------------------------------------------------------
  * Utility Functions
  *------------------------------------------------------------------*/
@@ -1,8 +1,206 @@
 #import "BLEBridge.h"
 #import <Foundation/Foundation.h>
+#include <libdivecomputer/ble.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+// Overall timeout (seconds) for connecting and preparing a device
+#define BLE_CONNECT_TIMEOUT 10.0
+
+#define BLE_RING_SIZE   65536 // Power of two
+#define BLE_RING_MASK   (BLE_RING_SIZE - 1)
+#define BLE_RING_HEADER 2     // Packet length, little endian
+
+struct ble_ring {
+    unsigned char buffer[BLE_RING_SIZE];
+    _Atomic size_t head;        // Written by the producer only
+    _Atomic size_t tail;        // Written by the consumer only
+    _Atomic size_t available;   // Payload bytes in the ring
+    _Atomic int waiting;        // The consumer is blocked on the condition
+    size_t offset;              // Consumer offset within the current packet
+    unsigned int dropped;       // Producer only
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+};
 
 static id<CoreBluetoothManagerProtocol> bleManager = nil;
 
+// Ring receiving the notifications, and the number of producers using it
+static _Atomic(ble_ring_t *) activeRing = NULL;
+static _Atomic int activeProducers = 0;
+
+static void ring_copy_in(ble_ring_t *ring, size_t pos, const unsigned char *data, size_t size) {
+    size_t index = pos & BLE_RING_MASK;
+    size_t first = BLE_RING_SIZE - index < size ? BLE_RING_SIZE - index : size;
+    memcpy(ring->buffer + index, data, first);
+    memcpy(ring->buffer, data + first, size - first);
+}
+
+static void ring_copy_out(ble_ring_t *ring, size_t pos, unsigned char *data, size_t size) {
+    size_t index = pos & BLE_RING_MASK;
+    size_t first = BLE_RING_SIZE - index < size ? BLE_RING_SIZE - index : size;
+    memcpy(data, ring->buffer + index, first);
+    memcpy(data + first, ring->buffer, size - first);
+}
+
+static bool ring_empty(ble_ring_t *ring) {
+    return atomic_load(&ring->head) == atomic_load_explicit(&ring->tail, memory_order_relaxed);
+}
+
+static bool ring_push(ble_ring_t *ring, const unsigned char *data, size_t size) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (size == 0 || size > 0xFFFF || BLE_RING_SIZE - (head - tail) < BLE_RING_HEADER + size) {
+        if (size && ring->dropped++ == 0) {
+            NSLog(@"BLE receive buffer full, dropping packets");
+        }
+        return false;
+    }
+
+    const unsigned char header[BLE_RING_HEADER] = {size & 0xFF, (size >> 8) & 0xFF};
+    ring_copy_in(ring, head, header, BLE_RING_HEADER);
+    ring_copy_in(ring, head + BLE_RING_HEADER, data, size);
+    atomic_fetch_add(&ring->available, size);
+
+    // Publish the packet, then wake the consumer if it is blocked. The
+    // consumer sets the flag before its final check, so one of the two
+    // always sees the other.
+    atomic_store(&ring->head, head + BLE_RING_HEADER + size);
+    if (atomic_load(&ring->waiting)) {
+        pthread_mutex_lock(&ring->lock);
+        pthread_cond_signal(&ring->cond);
+        pthread_mutex_unlock(&ring->lock);
+    }
+    return true;
+}
+
+// Waits until a packet is available, for at most timeout milliseconds (negative blocks)
+static bool ring_wait(ble_ring_t *ring, int timeout) {
+    if (!ring_empty(ring)) {
+        return true;
+    }
+    if (timeout == 0) {
+        return false;
+    }
+
+    struct timespec deadline;
+    if (timeout > 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout / 1000;
+        deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+    }
+
+    pthread_mutex_lock(&ring->lock);
+    atomic_store(&ring->waiting, 1);
+    int rc = 0;
+    while (ring_empty(ring) && rc == 0) {
+        if (timeout < 0) {
+            rc = pthread_cond_wait(&ring->cond, &ring->lock);
+        } else {
+            rc = pthread_cond_timedwait(&ring->cond, &ring->lock, &deadline);
+        }
+    }
+    atomic_store(&ring->waiting, 0);
+    pthread_mutex_unlock(&ring->lock);
+
+    return !ring_empty(ring);
+}
+
+ble_ring_t* ble_ring_new(void) {
+    ble_ring_t *ring = malloc(sizeof(ble_ring_t));
+    if (!ring) {
+        return NULL;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->available, 0);
+    atomic_init(&ring->waiting, 0);
+    ring->offset = 0;
+    ring->dropped = 0;
+    pthread_mutex_init(&ring->lock, NULL);
+    pthread_cond_init(&ring->cond, NULL);
+    return ring;
+}
+
+void ble_ring_free(ble_ring_t *ring) {
+    if (ring) {
+        ble_ring_detach(ring);
+        if (ring->dropped) {
+            NSLog(@"BLE receive buffer dropped %u packets", ring->dropped);
+        }
+        pthread_cond_destroy(&ring->cond);
+        pthread_mutex_destroy(&ring->lock);
+        free(ring);
+    }
+}
+
+dc_status_t ble_ring_read(ble_ring_t *ring, void *data, size_t size, size_t *actual, int timeout) {
+    size_t nbytes = 0;
+
+    if (size && ring_wait(ring, timeout)) {
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        unsigned char header[BLE_RING_HEADER];
+        ring_copy_out(ring, tail, header, BLE_RING_HEADER);
+        size_t length = header[0] | (header[1] << 8);
+
+        // A packet larger than the buffer is returned over several reads.
+        nbytes = length - ring->offset < size ? length - ring->offset : size;
+        ring_copy_out(ring, tail + BLE_RING_HEADER + ring->offset, data, nbytes);
+        atomic_fetch_sub(&ring->available, nbytes);
+
+        ring->offset += nbytes;
+        if (ring->offset == length) {
+            ring->offset = 0;
+            atomic_store_explicit(&ring->tail, tail + BLE_RING_HEADER + length, memory_order_release);
+        }
+    }
+
+    if (actual) {
+        *actual = nbytes;
+    }
+
+    return (nbytes || !size) ? DC_STATUS_SUCCESS : DC_STATUS_TIMEOUT;
+}
+
+dc_status_t ble_ring_poll(ble_ring_t *ring, int timeout) {
+    return ring_wait(ring, timeout) ? DC_STATUS_SUCCESS : DC_STATUS_TIMEOUT;
+}
+
+size_t ble_ring_available(ble_ring_t *ring) {
+    return atomic_load(&ring->available);
+}
+
+void ble_ring_attach(ble_ring_t *ring) {
+    atomic_store(&activeRing, ring);
+}
+
+void ble_ring_detach(ble_ring_t *ring) {
+    ble_ring_t *expected = ring;
+    if (atomic_compare_exchange_strong(&activeRing, &expected, NULL)) {
+        // Wait for a notification that is still being stored.
+        while (atomic_load(&activeProducers)) {
+            sched_yield();
+        }
+    }
+}
+
+bool ble_receive(const void *data, size_t size) {
+    atomic_fetch_add(&activeProducers, 1);
+    ble_ring_t *ring = atomic_load(&activeRing);
+    if (ring) {
+        ring_push(ring, (const unsigned char *)data, size);
+    }
+    atomic_fetch_sub(&activeProducers, 1);
+    return ring != NULL;
+}
+
 void initializeBLEManager(void) {
     Class CoreBluetoothManagerClass = NSClassFromString(@"CoreBluetoothManager");
     bleManager = [CoreBluetoothManagerClass shared];
@@ -30,31 +228,13 @@ bool connectToBLEDevice(ble_object_t *io, const char *deviceAddress) {
     id<CoreBluetoothManagerProtocol> manager = [CoreBluetoothManagerClass shared];
     NSString *address = [NSString stringWithUTF8String:deviceAddress];
     
-    bool success = [manager connectToDevice:address];
-    if (!success) {
+    // Connecting, service discovery and enabling notifications are chained
+    // from the CoreBluetooth delegate callbacks, under one overall timeout.
+    if (![manager connectToDevice:address timeout:BLE_CONNECT_TIMEOUT]) {
         NSLog(@"Failed to connect to device");
         return false;
     }
     
-    // Wait for initial connection
-    [NSThread sleepForTimeInterval:1.0];
-    
-    // Discover services
-    success = [manager discoverServices];
-    if (!success) {
-        NSLog(@"Service discovery failed");
-        [manager close];
-        return false;
-    }
-    
-    // Enable notifications
-    success = [manager enableNotifications];
-    if (!success) {
-        NSLog(@"Failed to enable notifications");
-        [manager close];
-        return false;
-    }
-    
     return true;
 }
 
@@ -70,61 +250,34 @@ bool enableNotifications(ble_object_t *io) {
     return [manager enableNotifications];
 }
 
-dc_status_t ble_set_timeout(ble_object_t *io, int timeout) {
-    return DC_STATUS_SUCCESS;
-}
-
 dc_status_t ble_ioctl(ble_object_t *io, unsigned int request, void *data, size_t size) {
-    return DC_STATUS_UNSUPPORTED;
-}
-
-dc_status_t ble_sleep(ble_object_t *io, unsigned int milliseconds) {
-    [NSThread sleepForTimeInterval:milliseconds / 1000.0];
-    return DC_STATUS_SUCCESS;
-}
+    id<CoreBluetoothManagerProtocol> manager = (__bridge id<CoreBluetoothManagerProtocol>)io->manager;
 
-dc_status_t ble_read(ble_object_t *io, void *buffer, size_t requested, size_t *actual)
-{
-    if (!io || !buffer || !actual) {
-        return DC_STATUS_INVALIDARGS;
-    }
-    
-    Class CoreBluetoothManagerClass = NSClassFromString(@"CoreBluetoothManager");
-    id<CoreBluetoothManagerProtocol> manager = [CoreBluetoothManagerClass shared];
-    uint8_t *outPtr = (uint8_t *)buffer;
-    size_t total = 0;
-    
-    // Keep reading until we've gathered 'requested' bytes or no more data is arriving
-    while (total < requested) {
-        size_t needed = requested - total;
-        // readDataPartial returns up to 'needed' bytes but might return fewer
-        NSData *partialData = [manager readDataPartial:(int)needed];
-        
-        // If no data arrived this iteration, break out
-        if (!partialData || partialData.length == 0) {
-            break;
+    switch (request) {
+    case DC_IOCTL_BLE_GET_MTU: {
+        // CoreBluetooth only reports the packet size that results from the MTU
+        NSInteger length = [manager maximumWriteLength];
+        if (length <= 0) {
+            return DC_STATUS_UNSUPPORTED;
         }
-        
-        // Copy new data into our output buffer
-        memcpy(outPtr + total, partialData.bytes, partialData.length);
-        total += partialData.length;
+        *(unsigned int *) data = (unsigned int) length + 3;
+        return DC_STATUS_SUCCESS;
     }
-    
-    // If we received no data at all, treat it as an I/O error
-    if (total == 0) {
-        *actual = 0;
-        return DC_STATUS_IO;
+    default:
+        // The MTU, PHY and connection interval are negotiated by the system
+        return DC_STATUS_UNSUPPORTED;
     }
-    
-    // Otherwise, we successfully read some or all requested bytes
-    *actual = total;
+}
+
+dc_status_t ble_sleep(ble_object_t *io, unsigned int milliseconds) {
+    [NSThread sleepForTimeInterval:milliseconds / 1000.0];
     return DC_STATUS_SUCCESS;
 }
 
 dc_status_t ble_write(ble_object_t *io, const void *data, size_t size, size_t *actual) {
-    Class CoreBluetoothManagerClass = NSClassFromString(@"CoreBluetoothManager");
-    id<CoreBluetoothManagerProtocol> manager = [CoreBluetoothManagerClass shared];
-    NSData *nsData = [NSData dataWithBytes:data length:size];
+    id<CoreBluetoothManagerProtocol> manager = (__bridge id<CoreBluetoothManagerProtocol>)io->manager;
+    // The manager queues the packets before returning, so the buffer is not copied.
+    NSData *nsData = [NSData dataWithBytesNoCopy:(void *)data length:size freeWhenDone:NO];
     
     if ([manager writeData:nsData]) {
         *actual = size;
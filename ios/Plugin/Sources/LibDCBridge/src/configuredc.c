@@ -4,10 +4,12 @@
 #include <libdivecomputer/descriptor.h>
 #include <libdivecomputer/iostream.h>
 #include <libdivecomputer/parser.h>
+#include <libdivecomputer/fingerprint.h>
 #include "iostream-private.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
 
 /*--------------------------------------------------------------------
  * BLE stream structures
@@ -15,12 +17,46 @@
 typedef struct ble_stream_t {
     dc_iostream_t base;      
     ble_object_t *ble_object; 
+    ble_ring_t *ring;        // Notifications received from the device
+    int timeout;             // Read timeout in milliseconds
 } ble_stream_t;
 
+// Read timeout until the backend sets its own (milliseconds)
+#define BLE_DEFAULT_TIMEOUT 10000
+
+/*--------------------------------------------------------------------
+ * Persistent fingerprint store, opened once by the application
+ *------------------------------------------------------------------*/
+static dc_fingerprint_store_t *fingerprint_store = NULL;
+
+/*--------------------------------------------------------------------
+ * Descriptor resolution cache, filled while scanning
+ * 
+ * Maps the identifier and advertised name of a discovered device to its
+ * descriptor (NULL if unsupported), so connecting does not repeat the
+ * name matching and iterator scans. A spare context is created along
+ * with it, and handed to the next device that is opened.
+ *------------------------------------------------------------------*/
+#define RESOLVE_CACHE_SIZE 16
+
+typedef struct resolve_entry_t {
+    char address[64];
+    char name[64];
+    dc_descriptor_t *descriptor;
+} resolve_entry_t;
+
+static resolve_entry_t resolve_cache[RESOLVE_CACHE_SIZE];
+static unsigned int resolve_count = 0;
+static unsigned int resolve_next = 0;   // Oldest entry, replaced when full
+static dc_context_t *spare_context = NULL;
+static pthread_mutex_t resolve_lock = PTHREAD_MUTEX_INITIALIZER;
+
 /*--------------------------------------------------------------------
  * Forward declarations for our custom vtable
  *------------------------------------------------------------------*/
 static dc_status_t ble_stream_set_timeout   (dc_iostream_t *iostream, int timeout);
+static dc_status_t ble_stream_get_available (dc_iostream_t *iostream, size_t *value);
+static dc_status_t ble_stream_poll          (dc_iostream_t *iostream, int timeout);
 static dc_status_t ble_stream_read          (dc_iostream_t *iostream, void *data, size_t size, size_t *actual);
 static dc_status_t ble_stream_write         (dc_iostream_t *iostream, const void *data, size_t size, size_t *actual);
 static dc_status_t ble_stream_ioctl         (dc_iostream_t *iostream, unsigned int request, void *data_, size_t size_);
@@ -37,9 +73,9 @@ static const dc_iostream_vtable_t ble_iostream_vtable = {
     .set_dtr       = NULL,
     .set_rts       = NULL,
     .get_lines     = NULL,
-    .get_available = NULL,
+    .get_available = ble_stream_get_available,
     .configure     = NULL,
-    .poll          = NULL,
+    .poll          = ble_stream_poll,
     .read          = ble_stream_read,
     .write         = ble_stream_write,
     .ioctl         = ble_stream_ioctl,
@@ -57,7 +93,8 @@ static const dc_iostream_vtable_t ble_iostream_vtable = {
  * @param bleobj:  BLE object to associate with the stream
  * 
  * @return: DC_STATUS_SUCCESS on success, error code otherwise
- * @note: Takes ownership of the bleobj
+ * @note: Takes ownership of the bleobj. Notifications are routed to
+ *        the stream's ring buffer from now on.
  *------------------------------------------------------------------*/
 static dc_status_t ble_iostream_create(dc_iostream_t **out, dc_context_t *context, ble_object_t *bleobj)
 {
@@ -70,10 +107,18 @@ static dc_status_t ble_iostream_create(dc_iostream_t **out, dc_context_t *contex
     }
     memset(stream, 0, sizeof(*stream));
 
+    stream->ring = ble_ring_new();
+    if (!stream->ring) {
+        free(stream);
+        return DC_STATUS_NOMEMORY;
+    }
+
     stream->base.vtable = &ble_iostream_vtable;
     stream->base.context = context;
     stream->base.transport = DC_TRANSPORT_BLE;
     stream->ble_object = bleobj;
+    stream->timeout = BLE_DEFAULT_TIMEOUT;
+    ble_ring_attach(stream->ring);
 
     *out = (dc_iostream_t *)stream;
     return DC_STATUS_SUCCESS;
@@ -90,11 +135,42 @@ static dc_status_t ble_iostream_create(dc_iostream_t **out, dc_context_t *contex
 static dc_status_t ble_stream_set_timeout(dc_iostream_t *iostream, int timeout)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    return ble_set_timeout(s->ble_object, timeout);
+    s->timeout = timeout;
+    return DC_STATUS_SUCCESS;
 }
 
 /*--------------------------------------------------------------------
- * Reads data from the BLE device
+ * Gets the number of received bytes that have not been read yet
+ * 
+ * @param iostream: The iostream instance
+ * @param value:    Output parameter for the number of bytes
+ * 
+ * @return: DC_STATUS_SUCCESS on success, error code otherwise
+ *------------------------------------------------------------------*/
+static dc_status_t ble_stream_get_available(dc_iostream_t *iostream, size_t *value)
+{
+    ble_stream_t *s = (ble_stream_t *) iostream;
+    *value = ble_ring_available(s->ring);
+    return DC_STATUS_SUCCESS;
+}
+
+/*--------------------------------------------------------------------
+ * Waits until data has been received from the BLE device
+ * 
+ * @param iostream: The iostream instance
+ * @param timeout:  Timeout in milliseconds (negative blocks)
+ * 
+ * @return: DC_STATUS_SUCCESS when data is available, DC_STATUS_TIMEOUT otherwise
+ *------------------------------------------------------------------*/
+static dc_status_t ble_stream_poll(dc_iostream_t *iostream, int timeout)
+{
+    ble_stream_t *s = (ble_stream_t *) iostream;
+    return ble_ring_poll(s->ring, timeout);
+}
+
+/*--------------------------------------------------------------------
+ * Reads one received packet (or the rest of it) from the BLE device,
+ * waiting up to the configured timeout
  * 
  * @param iostream: The iostream instance
  * @param data:     Buffer to store read data
@@ -106,7 +182,7 @@ static dc_status_t ble_stream_set_timeout(dc_iostream_t *iostream, int timeout)
 static dc_status_t ble_stream_read(dc_iostream_t *iostream, void *data, size_t size, size_t *actual)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
-    return ble_read(s->ble_object, data, size, actual);
+    return ble_ring_read(s->ring, data, size, actual, s->timeout);
 }
 
 /*--------------------------------------------------------------------
@@ -165,8 +241,10 @@ static dc_status_t ble_stream_sleep(dc_iostream_t *iostream, unsigned int millis
 static dc_status_t ble_stream_close(dc_iostream_t *iostream)
 {
     ble_stream_t *s = (ble_stream_t *) iostream;
+    ble_ring_detach(s->ring);
     dc_status_t rc = ble_close(s->ble_object);
     freeBLEObject(s->ble_object);
+    ble_ring_free(s->ring);
     free(s);
     return rc;
 }
@@ -192,14 +270,8 @@ dc_status_t ble_packet_open(dc_iostream_t **iostream, dc_context_t *context, con
         return DC_STATUS_NOMEMORY;
     }
 
-    // Connect to the device
-    if (!connectToBLEDevice(io, devaddr)) {
-        printf("ble_packet_open: Failed to connect to device\n");
-        freeBLEObject(io);
-        return DC_STATUS_IO;
-    }
-
-    // Create a custom BLE iostream
+    // Create a custom BLE iostream first, so its ring buffer receives
+    // the notifications as soon as they are enabled
     dc_status_t status = ble_iostream_create(iostream, context, io);
     if (status != DC_STATUS_SUCCESS) {
         printf("ble_packet_open: Failed to create iostream\n");
@@ -207,6 +279,17 @@ dc_status_t ble_packet_open(dc_iostream_t **iostream, dc_context_t *context, con
         return status;
     }
 
+    // Connect to the device
+    if (!connectToBLEDevice(io, devaddr)) {
+        printf("ble_packet_open: Failed to connect to device\n");
+        ble_stream_t *s = (ble_stream_t *) *iostream;
+        ble_ring_free(s->ring);
+        freeBLEObject(io);
+        free(s);
+        *iostream = NULL;
+        return DC_STATUS_IO;
+    }
+
     return DC_STATUS_SUCCESS;
 }
 
@@ -296,41 +379,48 @@ static void close_device_data(device_data_t *data) {
 }
 
 /*--------------------------------------------------------------------
- * Opens a BLE device using a provided descriptor
+ * Takes the spare context created while scanning, or creates one
+ * 
+ * @param out_context: Output parameter for the context
+ * 
+ * @return: DC_STATUS_SUCCESS on success, error code otherwise
+ *------------------------------------------------------------------*/
+static dc_status_t take_context(dc_context_t **out_context) {
+    pthread_mutex_lock(&resolve_lock);
+    dc_context_t *context = spare_context;
+    spare_context = NULL;
+    pthread_mutex_unlock(&resolve_lock);
+
+    if (context) {
+        *out_context = context;
+        return DC_STATUS_SUCCESS;
+    }
+
+    return dc_context_new(out_context);
+}
+
+/*--------------------------------------------------------------------
+ * Opens a BLE device using a resolved descriptor
  * 
  * @param data:       Pointer to device_data_t to store device info
  * @param devaddr:    BLE device address/UUID
  * @param descriptor: Device descriptor for the dive computer
  * 
  * @return: DC_STATUS_SUCCESS on success, error code otherwise
- * @note: Takes ownership of the device_data_t structure
  *------------------------------------------------------------------*/
-dc_status_t open_ble_device(device_data_t *data, const char *devaddr, dc_family_t family, unsigned int model) {
+static dc_status_t open_ble_device_with_descriptor(device_data_t *data, const char *devaddr, dc_descriptor_t *descriptor) {
     dc_status_t rc;
-    dc_descriptor_t *descriptor = NULL;
-
-    if (!data || !devaddr) {
-        return DC_STATUS_INVALIDARGS;
-    }
 
     // Initialize all pointers to NULL
     memset(data, 0, sizeof(device_data_t));
     
     // Create context
-    rc = dc_context_new(&data->context);
+    rc = take_context(&data->context);
     if (rc != DC_STATUS_SUCCESS) {
         printf("Failed to create context, rc=%d\n", rc);
         return rc;
     }
 
-    // Get descriptor for the device
-    rc = find_descriptor_by_model(&descriptor, family, model);
-    if (rc != DC_STATUS_SUCCESS) {
-        printf("Failed to find descriptor, rc=%d\n", rc);
-        close_device_data(data);
-        return rc;
-    }
-
     // Create BLE iostream
     rc = ble_packet_open(&data->iostream, data->context, devaddr, data);
     if (rc != DC_STATUS_SUCCESS) {
@@ -356,6 +446,11 @@ dc_status_t open_ble_device(device_data_t *data, const char *devaddr, dc_family_
         return rc;
     }
 
+    // Resume from the last downloaded dive, unless the caller sets a fingerprint
+    if (fingerprint_store) {
+        dc_device_set_fingerprint_store(data->device, fingerprint_store);
+    }
+
     // Store the descriptor
     data->descriptor = descriptor;
 
@@ -377,6 +472,76 @@ dc_status_t open_ble_device(device_data_t *data, const char *devaddr, dc_family_
     return DC_STATUS_SUCCESS;
 }
 
+/*--------------------------------------------------------------------
+ * Opens a BLE device by family and model
+ * 
+ * @param data:    Pointer to device_data_t to store device info
+ * @param devaddr: BLE device address/UUID
+ * @param family:  Device family
+ * @param model:   Device model
+ * 
+ * @return: DC_STATUS_SUCCESS on success, error code otherwise
+ * @note: Takes ownership of the device_data_t structure
+ *------------------------------------------------------------------*/
+dc_status_t open_ble_device(device_data_t *data, const char *devaddr, dc_family_t family, unsigned int model) {
+    dc_status_t rc;
+    dc_descriptor_t *descriptor = NULL;
+
+    if (!data || !devaddr) {
+        return DC_STATUS_INVALIDARGS;
+    }
+
+    // Get descriptor for the device
+    rc = find_descriptor_by_model(&descriptor, family, model);
+    if (rc != DC_STATUS_SUCCESS) {
+        printf("Failed to find descriptor, rc=%d\n", rc);
+        memset(data, 0, sizeof(device_data_t));
+        return rc;
+    }
+
+    return open_ble_device_with_descriptor(data, devaddr, descriptor);
+}
+
+/*--------------------------------------------------------------------
+ * Closes a device opened with open_ble_device_with_identification
+ * 
+ * @param data: Device data to close, freed afterwards (may be NULL)
+ * 
+ * @note: Only called on disconnect, the device stays open in between
+ *------------------------------------------------------------------*/
+void close_ble_device(device_data_t *data) {
+    if (!data) return;
+
+    close_device_data(data);
+    free(data);
+}
+
+/*--------------------------------------------------------------------
+ * Opens the persistent fingerprint store shared by all devices
+ * 
+ * @param filename: Path of the store file, created if missing
+ * 
+ * @return: DC_STATUS_SUCCESS on success, error code otherwise
+ * @note: Devices opened afterwards resume from their last download
+ *------------------------------------------------------------------*/
+dc_status_t open_fingerprint_store(const char *filename) {
+    if (!filename) {
+        return DC_STATUS_INVALIDARGS;
+    }
+
+    if (fingerprint_store) {
+        return DC_STATUS_SUCCESS;
+    }
+
+    dc_status_t rc = dc_fingerprint_store_open(&fingerprint_store, NULL, filename);
+    if (rc != DC_STATUS_SUCCESS) {
+        printf("Failed to open fingerprint store, rc=%d\n", rc);
+        fingerprint_store = NULL;
+    }
+
+    return rc;
+}
+
 /*--------------------------------------------------------------------
  * Helper function to find a matching device descriptor
  * 
@@ -630,6 +795,102 @@ dc_status_t get_device_info_from_name(const char *name, dc_family_t *family, uns
     return DC_STATUS_SUCCESS;
 }
 
+/*--------------------------------------------------------------------
+ * Looks up a device in the resolution cache
+ * 
+ * @param address:    BLE device address/UUID
+ * @param name:       Advertised device name
+ * @param descriptor: Output parameter for the cached descriptor (NULL if unsupported)
+ * 
+ * @return: True if the device is cached
+ * @note: Must be called with the resolve_lock held
+ *------------------------------------------------------------------*/
+static bool resolve_cache_lookup(const char *address, const char *name, dc_descriptor_t **descriptor) {
+    for (unsigned int i = 0; i < resolve_count; i++) {
+        if (strcmp(resolve_cache[i].address, address) == 0 &&
+            strcmp(resolve_cache[i].name, name) == 0) {
+            *descriptor = resolve_cache[i].descriptor;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*--------------------------------------------------------------------
+ * Resolves the descriptor of a discovered BLE device, and caches it
+ * 
+ * @param address: BLE device address/UUID
+ * @param name:    Advertised device name
+ * @param family:  Output parameter for device family (may be NULL)
+ * @param model:   Output parameter for device model (may be NULL)
+ * 
+ * @return: DC_STATUS_SUCCESS on success, DC_STATUS_UNSUPPORTED if the
+ *          name matches no descriptor, error code otherwise
+ * @note: Also prepares the context for the next device that is opened
+ *------------------------------------------------------------------*/
+dc_status_t resolve_ble_device(const char *address, const char *name, dc_family_t *family, unsigned int *model) {
+    dc_descriptor_t *descriptor = NULL;
+    dc_status_t rc = DC_STATUS_SUCCESS;
+
+    if (!address || !name) {
+        return DC_STATUS_INVALIDARGS;
+    }
+
+    pthread_mutex_lock(&resolve_lock);
+    if (!resolve_cache_lookup(address, name, &descriptor)) {
+        rc = find_descriptor_by_name(&descriptor, name);
+        if (rc != DC_STATUS_SUCCESS && rc != DC_STATUS_UNSUPPORTED) {
+            pthread_mutex_unlock(&resolve_lock);
+            return rc;
+        }
+
+        // Remember unsupported names as well, the scan reports them repeatedly.
+        if (rc != DC_STATUS_SUCCESS) {
+            descriptor = NULL;
+        }
+
+        // Replace the entry of the same device (its name changed), or the oldest one
+        unsigned int index = resolve_count < RESOLVE_CACHE_SIZE ? resolve_count : resolve_next;
+        for (unsigned int i = 0; i < resolve_count; i++) {
+            if (strcmp(resolve_cache[i].address, address) == 0) {
+                index = i;
+                break;
+            }
+        }
+        if (index == resolve_count) {
+            resolve_count++;
+        } else if (index == resolve_next) {
+            resolve_next = (resolve_next + 1) % RESOLVE_CACHE_SIZE;
+        }
+
+        // The descriptors are static, so a replaced one may still be in use.
+        resolve_entry_t *entry = &resolve_cache[index];
+        snprintf(entry->address, sizeof(entry->address), "%s", address);
+        snprintf(entry->name, sizeof(entry->name), "%s", name);
+        entry->descriptor = descriptor;
+    }
+
+    // Prepare the context now, rather than on the tap-to-download path
+    if (descriptor && !spare_context) {
+        if (dc_context_new(&spare_context) != DC_STATUS_SUCCESS) {
+            spare_context = NULL;
+        }
+    }
+    pthread_mutex_unlock(&resolve_lock);
+
+    if (!descriptor) {
+        return DC_STATUS_UNSUPPORTED;
+    }
+
+    if (family) {
+        *family = dc_descriptor_get_type(descriptor);
+    }
+    if (model) {
+        *model = dc_descriptor_get_model(descriptor);
+    }
+    return DC_STATUS_SUCCESS;
+}
+
 /*--------------------------------------------------------------------
  * Gets formatted display name for a device (vendor + product)
  * 
@@ -680,13 +941,23 @@ dc_status_t open_ble_device_with_identification(device_data_t **out_data,
     device_data_t *data = (device_data_t*)calloc(1, sizeof(device_data_t));
     if (!data) return DC_STATUS_NOMEMORY;
     
-    dc_family_t family;
-    unsigned int model;
+    dc_descriptor_t *resolved = NULL;
     dc_status_t rc;
     
+    // Use the descriptor resolved while scanning, if any
+    pthread_mutex_lock(&resolve_lock);
+    bool cached = name && address && resolve_cache_lookup(address, name, &resolved);
+    pthread_mutex_unlock(&resolve_lock);
+    
     // Try stored configuration first if provided
     if (stored_family != DC_FAMILY_NULL && stored_model != 0) {
-        rc = open_ble_device(data, address, stored_family, stored_model);
+        if (resolved &&
+            dc_descriptor_get_type(resolved) == stored_family &&
+            dc_descriptor_get_model(resolved) == stored_model) {
+            rc = open_ble_device_with_descriptor(data, address, resolved);
+        } else {
+            rc = open_ble_device(data, address, stored_family, stored_model);
+        }
         if (rc == DC_STATUS_SUCCESS) {
             *out_data = data;
             return DC_STATUS_SUCCESS;
@@ -694,13 +965,18 @@ dc_status_t open_ble_device_with_identification(device_data_t **out_data,
     }
     
     // Fall back to identification if stored config failed or wasn't provided
-    rc = get_device_info_from_name(name, &family, &model);
-    if (rc != DC_STATUS_SUCCESS) {
+    if (!cached) {
+        rc = find_descriptor_by_name(&resolved, name);
+        if (rc != DC_STATUS_SUCCESS) {
+            free(data);
+            return rc;
+        }
+    } else if (!resolved) {
         free(data);
-        return rc;
+        return DC_STATUS_UNSUPPORTED;
     }
     
-    rc = open_ble_device(data, address, family, model);
+    rc = open_ble_device_with_descriptor(data, address, resolved);
     if (rc != DC_STATUS_SUCCESS) {
         free(data);
         return rc;
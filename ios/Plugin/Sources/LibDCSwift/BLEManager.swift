@@ -80,6 +80,22 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
     private var averageTransferRate: Double = 0
     private var preferredService: CBService?
     private var pendingOperations: [() -> Void] = []
+    private var connectionStage: ConnectionStage = .idle
+    private let connectionSignal = DispatchSemaphore(value: 0)
+    private var pendingServiceCount = 0
+    private var connectStartTime: Date?
+    private let writeSignal = DispatchSemaphore(value: 0)
+    private var writeResult: Bool? // Outcome of the last write with response
+    /// Bound for a single write call, including the flow control
+    private let writeTimeout: TimeInterval = 5.0
+    
+    /// Stages of the connection setup, advanced by the CoreBluetooth delegate callbacks
+    private enum ConnectionStage {
+        case idle, connecting, discovering, subscribing, ready, failed
+    }
+    
+    /// Time from the connect request to the first received byte, for the last connection
+    public private(set) var connectToFirstByteLatency: TimeInterval?
     
     // MARK: - Public Properties
     public var openedDeviceDataPtr: UnsafeMutablePointer<device_data_t>? { // Public access to device data pointer with change notification
@@ -128,27 +144,71 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
     }
     
     // MARK: - Service Discovery
+    /// Default bound for the service discovery and notification setup steps
+    private let setupTimeout: TimeInterval = 10.0
+    
     @objc(discoverServices)
     public func discoverServices() -> Bool {
         guard let peripheral = self.peripheral else { return false }
-        peripheral.discoverServices(nil)
-        while writeCharacteristic == nil || notifyCharacteristic == nil {
-            RunLoop.current.run(until: Date(timeIntervalSinceNow: 0.05))
+        if connectionStage != .ready {
+            connectionStage = .discovering
+            peripheral.discoverServices(nil)
+        }
+        return waitForConnectionStage(until: Date(timeIntervalSinceNow: setupTimeout)) {
+            self.connectionStage == .subscribing || self.connectionStage == .ready
         }
-        
-        return writeCharacteristic != nil && notifyCharacteristic != nil
     }
     
     @objc(enableNotifications)
     public func enableNotifications() -> Bool {
         guard let notifyCharacteristic = self.notifyCharacteristic,
               let peripheral = self.peripheral else { return false }
-        peripheral.setNotifyValue(true, for: notifyCharacteristic)
-        while !notifyCharacteristic.isNotifying {
-            RunLoop.current.run(until: Date(timeIntervalSinceNow: 0.05))
+        if !notifyCharacteristic.isNotifying {
+            connectionStage = .subscribing
+            peripheral.setNotifyValue(true, for: notifyCharacteristic)
+        }
+        return waitForConnectionStage(until: Date(timeIntervalSinceNow: setupTimeout)) {
+            self.connectionStage == .ready
+        }
+    }
+    
+    /// Waits until the condition holds, woken by the delegate callbacks instead of polling.
+    /// On the main thread the run loop is serviced, since the delegate callbacks are delivered there.
+    /// - Returns: True if the condition holds, false on failure or when the deadline passes
+    private func waitForConnectionStage(until deadline: Date, _ condition: () -> Bool) -> Bool {
+        while !condition() {
+            if connectionStage == .failed || Date() >= deadline {
+                return false
+            }
+            if Thread.isMainThread {
+                RunLoop.current.run(mode: .default, before: deadline)
+            } else {
+                _ = connectionSignal.wait(timeout: .now() + deadline.timeIntervalSinceNow)
+            }
+        }
+        return true
+    }
+    
+    /// Advances the connection setup once all services have reported their characteristics,
+    /// and once the notify characteristic is subscribed.
+    private func advanceConnectionStage() {
+        if connectionStage == .discovering && pendingServiceCount == 0 {
+            if writeCharacteristic == nil || notifyCharacteristic == nil {
+                logError("No usable write/notify characteristics found")
+                connectionStage = .failed
+            } else {
+                connectionStage = .subscribing
+            }
+        }
+        
+        if connectionStage == .subscribing, let notifyCharacteristic = notifyCharacteristic, notifyCharacteristic.isNotifying {
+            connectionStage = .ready
+            if let start = connectStartTime {
+                logInfo("Connection ready in \(Int(Date().timeIntervalSince(start) * 1000)) ms")
+            }
         }
         
-        return notifyCharacteristic.isNotifying
+        connectionSignal.signal()
     }
     
     // MARK: - Data Handling
@@ -176,13 +236,68 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
         return frameToReturn
     }
     
+    /// Sends the data, split into packets of at most the negotiated size.
+    /// Writes without response are queued back to back, and only pause while the system queue
+    /// is full (until peripheralIsReady(toSendWriteWithoutResponse:)). Characteristics without
+    /// that property fall back to writes with response, one acknowledged packet at a time.
+    /// Every call starts a new packet, since several protocols frame their data per packet.
+    /// - Returns: True once all packets are queued (or acknowledged)
     @objc public func write(_ data: Data!) -> Bool {
         guard let peripheral = self.peripheral,
               let characteristic = self.writeCharacteristic else { return false }
-        peripheral.writeValue(data, for: characteristic, type: .withoutResponse)
+        
+        let type: CBCharacteristicWriteType = characteristic.properties.contains(.writeWithoutResponse) ? .withoutResponse : .withResponse
+        let length = max(peripheral.maximumWriteValueLength(for: type), 1)
+        let deadline = Date(timeIntervalSinceNow: writeTimeout)
+        
+        var offset = data.startIndex
+        while offset < data.endIndex {
+            let end = min(offset + length, data.endIndex)
+            let packet = data.subdata(in: offset..<end)
+            
+            if type == .withoutResponse {
+                guard waitForWrite(until: deadline, { peripheral.canSendWriteWithoutResponse }) else {
+                    logError("Timeout waiting for the write queue")
+                    return false
+                }
+                peripheral.writeValue(packet, for: characteristic, type: .withoutResponse)
+            } else {
+                queue.sync { writeResult = nil }
+                peripheral.writeValue(packet, for: characteristic, type: .withResponse)
+                guard waitForWrite(until: deadline, { self.queue.sync { self.writeResult != nil } }),
+                      queue.sync(execute: { writeResult == true }) else {
+                    logError("Write with response failed")
+                    return false
+                }
+            }
+            
+            offset = end
+        }
+        return true
+    }
+    
+    /// Waits until the condition holds, woken by the write callbacks.
+    /// On the main thread the run loop is serviced, since the delegate callbacks are delivered there.
+    private func waitForWrite(until deadline: Date, _ condition: () -> Bool) -> Bool {
+        while !condition() {
+            if Date() >= deadline {
+                return false
+            }
+            if Thread.isMainThread {
+                RunLoop.current.run(mode: .default, before: Date(timeIntervalSinceNow: 0.005))
+            } else {
+                _ = writeSignal.wait(timeout: .now() + deadline.timeIntervalSinceNow)
+            }
+        }
         return true
     }
     
+    /// Largest packet for a write without response, as negotiated by the system (ATT MTU - 3).
+    @objc public func maximumWriteLength() -> Int {
+        guard let peripheral = self.peripheral else { return 0 }
+        return peripheral.maximumWriteValueLength(for: .withoutResponse)
+    }
+    
     @objc public func readDataPartial(_ requested: Int32) -> Data! {
         let startTime = Date()
         let partialTimeout: TimeInterval = 0.5
@@ -225,16 +340,14 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
         if clearDevicePtr {
             if let devicePtr = self.openedDeviceDataPtr {
                 logDebug("Closing device data pointer")
-                if devicePtr.pointee.device != nil {
-                    logDebug("Closing device")
-                    dc_device_close(devicePtr.pointee.device)
-                }
-                logDebug("Deallocating device data pointer")
-                devicePtr.deallocate()
                 self.openedDeviceDataPtr = nil
+                close_ble_device(devicePtr)
             }
         }
         
+        connectionStage = .idle
+        connectStartTime = nil
+        
         if let peripheral = self.peripheral {
             logDebug("Disconnecting peripheral")
             self.writeCharacteristic = nil
@@ -268,10 +381,35 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
         
         self.peripheral = peripheral
         peripheral.delegate = self
+        connectionStage = .connecting
+        connectStartTime = Date()
+        connectToFirstByteLatency = nil
         centralManager.connect(peripheral, options: nil)
         return true  // Return immediately, connection status will be handled by delegate
     }
     
+    /// Connects to a device and waits until it is ready for communication.
+    /// Service discovery and notification setup are chained from the delegate callbacks,
+    /// so the only wait is for the device itself, bounded by a single overall timeout.
+    /// - Parameters:
+    ///   - address: The peripheral UUID
+    ///   - timeout: Overall timeout in seconds for connecting, discovery and subscription
+    /// - Returns: True if the device is ready, false otherwise
+    @objc(connectToDevice:timeout:)
+    public func connect(toDevice address: String!, timeout: TimeInterval) -> Bool {
+        let deadline = Date(timeIntervalSinceNow: timeout)
+        guard connect(toDevice: address) else {
+            return false
+        }
+        
+        if !waitForConnectionStage(until: deadline, { self.connectionStage == .ready }) {
+            logError("Connection setup failed (stage: \(connectionStage))")
+            close()
+            return false
+        }
+        return true
+    }
+    
     public func connectToStoredDevice(_ uuid: String) -> Bool {
         guard let storedDevice = DeviceStorage.shared.getStoredDevice(uuid: uuid) else {
             return false
@@ -404,10 +542,20 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
             self.isPeripheralReady = true
             self.connectedDevice = peripheral
         }
+        
+        if connectionStage == .connecting {
+            connectionStage = .discovering
+            peripheral.discoverServices(nil)
+        }
+        connectionSignal.signal()
     }
 
     public func centralManager(_ central: CBCentralManager, didFailToConnect peripheral: CBPeripheral, error: Error?) {
         logError("Failed to connect to \(peripheral.name ?? "Unknown Device"): \(error?.localizedDescription ?? "No error description")")
+        if connectionStage != .idle {
+            connectionStage = .failed
+        }
+        connectionSignal.signal()
     }
 
     public func centralManager(_ central: CBCentralManager, didDisconnectPeripheral peripheral: CBPeripheral, error: Error?) {
@@ -416,6 +564,11 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
             logError("Disconnect error: \(error.localizedDescription)")
         }
         
+        if connectionStage != .idle && connectionStage != .ready {
+            connectionStage = .failed
+        }
+        connectionSignal.signal()
+        
         DispatchQueue.main.async {
             self.isPeripheralReady = false
             self.connectedDevice = nil
@@ -435,15 +588,18 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
     }
     
     public func centralManager(_ central: CBCentralManager, didDiscover peripheral: CBPeripheral, advertisementData: [String : Any], rssi RSSI: NSNumber) {
-        if peripheral.name != nil {
-            logDebug("Discovered \(peripheral.name ?? "unnamed device")")
+        if let name = peripheral.name {
+            logDebug("Discovered \(name)")
+            
+            // Resolved now, so connecting reuses the cached descriptor
+            let address = peripheral.identifier.uuidString
+            let supported = DeviceConfiguration.resolve(name: name, deviceAddress: address) != nil
             
             // Add the peripheral if:
             // 1. It's a stored device
             // 2. It's a supported device
             // 3. We haven't already added it
-            if DeviceStorage.shared.getStoredDevice(uuid: peripheral.identifier.uuidString) != nil ||
-               DeviceConfiguration.fromName(peripheral.name ?? "") != nil {
+            if DeviceStorage.shared.getStoredDevice(uuid: address) != nil || supported {
                 addDiscoveredPeripheral(peripheral)
             }
         }
@@ -453,17 +609,23 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
     public func peripheral(_ peripheral: CBPeripheral, didDiscoverServices error: Error?) {
         if let error = error {
             logError("Error discovering services: \(error.localizedDescription)")
+            connectionStage = .failed
+            connectionSignal.signal()
             return
         }
         
         guard let services = peripheral.services else {
             logWarning("No services found")
+            connectionStage = .failed
+            connectionSignal.signal()
             return
         }
         
+        pendingServiceCount = services.count
         for service in services {
             if isExcludedService(service.uuid) {
                 logInfo("Ignoring known firmware service: \(service.uuid)")
+                pendingServiceCount -= 1
                 continue
             }
             
@@ -477,9 +639,13 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
             }
             peripheral.discoverCharacteristics(nil, for: service)
         }
+        advanceConnectionStage()
     }
 
     public func peripheral(_ peripheral: CBPeripheral, didDiscoverCharacteristicsFor service: CBService, error: Error?) {
+        pendingServiceCount -= 1
+        defer { advanceConnectionStage() }
+        
         if let error = error {
             logError("Error discovering characteristics: \(error.localizedDescription)")
             return
@@ -521,14 +687,27 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
             logDebug("Received data: \(preview)... (\(data.count) bytes)")
         }
         
-        queue.sync {
-            // Append new data to our buffer immediately
-            receivedData.append(data)
-            if Logger.shared.shouldShowRawData {
-                logDebug("Buffer: \(receivedData.hexEncodedString())")
+        // Hand the packet straight to the native ring buffer of the open
+        // iostream, and only buffer it here when no stream is attached
+        let routed = data.withUnsafeBytes { bytes in
+            ble_receive(bytes.baseAddress, bytes.count)
+        }
+        if !routed {
+            queue.sync {
+                // Append new data to our buffer immediately
+                receivedData.append(data)
+                if Logger.shared.shouldShowRawData {
+                    logDebug("Buffer: \(receivedData.hexEncodedString())")
+                }
             }
         }
         
+        if let start = connectStartTime {
+            connectToFirstByteLatency = Date().timeIntervalSince(start)
+            connectStartTime = nil
+            logInfo("Connect to first byte: \(Int(connectToFirstByteLatency! * 1000)) ms")
+        }
+        
         updateTransferStats(data.count)
     }
 
@@ -538,14 +717,24 @@ public class CoreBluetoothManager: NSObject, CoreBluetoothManagerProtocol, Obser
         } else {
             logDebug("Successfully wrote to characteristic")
         }
+        queue.sync { writeResult = (error == nil) }
+        writeSignal.signal()
+    }
+    
+    public func peripheralIsReady(toSendWriteWithoutResponse peripheral: CBPeripheral) {
+        writeSignal.signal()
     }
 
     public func peripheral(_ peripheral: CBPeripheral, didUpdateNotificationStateFor characteristic: CBCharacteristic, error: Error?) {
         if let error = error {
             logError("Error changing notification state: \(error.localizedDescription)")
+            if characteristic == notifyCharacteristic && connectionStage == .subscribing {
+                connectionStage = .failed
+            }
         } else {
             logInfo("Notification state updated: \(characteristic.isNotifying ? "enabled" : "disabled")")
         }
+        advanceConnectionStage()
     }
 
     // MARK: - Private Helpers
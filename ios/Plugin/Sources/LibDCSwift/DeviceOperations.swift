@@ -0,0 +1,144 @@
+import Foundation
+import Clibdivecomputer
+import LibDCBridge
+
+/// Operations on an open dive computer, other than the dive download.
+/// The calls block until the device has answered, so they must run on the
+/// queue that owns the device, and never on the main thread.
+public enum DeviceOperations {
+    /// Error types that can occur during a device operation
+    public enum OperationError: LocalizedError {
+        case notConnected /// The device data has no open device
+        case failed(dc_status_t) /// The device returned an error
+
+        public var errorDescription: String? {
+            switch self {
+            case .notConnected:
+                return "No device connected"
+            case .failed(DC_STATUS_UNSUPPORTED):
+                return "Not supported by this device"
+            case .failed(let status):
+                return "Device error (status \(status.rawValue))"
+            }
+        }
+    }
+
+    /// Sets the clock of the dive computer to the local time.
+    /// - Parameters:
+    ///   - devicePtr: Pointer to the device data structure
+    ///   - date: The time to set
+    /// - Throws: OperationError if the device rejects the time
+    public static func timesync(_ devicePtr: UnsafeMutablePointer<device_data_t>, date: Date = Date()) throws {
+        guard let device = devicePtr.pointee.device else {
+            throw OperationError.notConnected
+        }
+
+        // Dive computers keep the local time.
+        var datetime = dc_datetime_t()
+        guard dc_datetime_localtime(&datetime, dc_ticks_t(date.timeIntervalSince1970)) != nil else {
+            throw OperationError.failed(DC_STATUS_INVALIDARGS)
+        }
+
+        let status = dc_device_timesync(device, &datetime)
+        guard status == DC_STATUS_SUCCESS else {
+            throw OperationError.failed(status)
+        }
+    }
+
+    /// Shows a text on the screen of the dive computer.
+    /// Only the hw_ostc3 family supports it.
+    /// - Parameters:
+    ///   - devicePtr: Pointer to the device data structure
+    ///   - text: The text to show
+    /// - Throws: OperationError if the device rejects the text
+    public static func display(_ devicePtr: UnsafeMutablePointer<device_data_t>, text: String) throws {
+        guard let device = devicePtr.pointee.device else {
+            throw OperationError.notConnected
+        }
+
+        let status = hw_ostc3_device_display(device, text)
+        guard status == DC_STATUS_SUCCESS else {
+            throw OperationError.failed(status)
+        }
+    }
+
+    /// Reads a setting of the dive computer.
+    /// Only the hw_ostc3 family supports it.
+    /// - Parameters:
+    ///   - devicePtr: Pointer to the device data structure
+    ///   - config: Number of the setting
+    ///   - size: Size of the setting (at most 4 bytes)
+    /// - Returns: The value of the setting
+    /// - Throws: OperationError if the read fails
+    public static func configRead(_ devicePtr: UnsafeMutablePointer<device_data_t>, config: Int, size: Int) throws -> Data {
+        guard let device = devicePtr.pointee.device else {
+            throw OperationError.notConnected
+        }
+
+        var data = [UInt8](repeating: 0, count: 4)
+        guard config >= 0, size >= 0, size <= data.count else {
+            throw OperationError.failed(DC_STATUS_INVALIDARGS)
+        }
+
+        let status = hw_ostc3_device_config_read(device, UInt32(config), &data, UInt32(size))
+        guard status == DC_STATUS_SUCCESS else {
+            throw OperationError.failed(status)
+        }
+
+        return Data(data.prefix(size))
+    }
+
+    /// Writes a setting of the dive computer.
+    /// Only the hw_ostc3 family supports it.
+    /// - Parameters:
+    ///   - devicePtr: Pointer to the device data structure
+    ///   - config: Number of the setting
+    ///   - data: The new value of the setting
+    /// - Throws: OperationError if the write fails
+    public static func configWrite(_ devicePtr: UnsafeMutablePointer<device_data_t>, config: Int, data: Data) throws {
+        guard let device = devicePtr.pointee.device else {
+            throw OperationError.notConnected
+        }
+
+        guard config >= 0 else {
+            throw OperationError.failed(DC_STATUS_INVALIDARGS)
+        }
+
+        let bytes = [UInt8](data)
+        let status = hw_ostc3_device_config_write(device, UInt32(config), bytes, UInt32(bytes.count))
+        guard status == DC_STATUS_SUCCESS else {
+            throw OperationError.failed(status)
+        }
+    }
+
+    /// Uploads a firmware image to the dive computer.
+    /// Only the hw_ostc, hw_ostc3 and divesystem_idive families support it.
+    /// The progress is reported through the progress of the device data.
+    /// - Parameters:
+    ///   - devicePtr: Pointer to the device data structure
+    ///   - image: Contents of the firmware file of the manufacturer
+    /// - Throws: OperationError if the upload fails, with DC_STATUS_UNSUPPORTED for the other families
+    public static func firmwareUpdate(_ devicePtr: UnsafeMutablePointer<device_data_t>, image: Data) throws {
+        guard let device = devicePtr.pointee.device else {
+            throw OperationError.notConnected
+        }
+
+        let status: dc_status_t = image.withUnsafeBytes { raw in
+            let data = raw.bindMemory(to: UInt8.self).baseAddress
+            switch dc_device_get_type(device) {
+            case DC_FAMILY_HW_OSTC:
+                return hw_ostc_device_fwupdate_buffer(device, data, raw.count)
+            case DC_FAMILY_HW_OSTC3:
+                return hw_ostc3_device_fwupdate_buffer(device, data, raw.count)
+            case DC_FAMILY_DIVESYSTEM_IDIVE:
+                return divesystem_idive_device_fwupdate_buffer(device, data, raw.count)
+            default:
+                return DC_STATUS_UNSUPPORTED
+            }
+        }
+
+        guard status == DC_STATUS_SUCCESS else {
+            throw OperationError.failed(status)
+        }
+    }
+}
@@ -87,6 +87,25 @@ import LibDCBridge
         return knownServiceUUIDs
     }
     
+    /// Opens the native fingerprint store once, in Application Support.
+    /// Devices opened afterwards resume from their last complete download.
+    private static let fingerprintStoreOpened: Bool = {
+        guard let directory = FileManager.default.urls(for: .applicationSupportDirectory, in: .userDomainMask).first else {
+            return false
+        }
+        do {
+            try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        } catch {
+            logError("Failed to create \(directory.path): \(error)")
+            return false
+        }
+        let status = open_fingerprint_store(directory.appendingPathComponent("fingerprints.db").path)
+        if status != DC_STATUS_SUCCESS {
+            logError("Failed to open fingerprint store (status: \(status))")
+        }
+        return status == DC_STATUS_SUCCESS
+    }()
+    
     /// Attempts to open a BLE connection to a dive computer.
     /// This function will try multiple methods to identify and connect to the device:
     /// 1. Use stored device information if available
@@ -98,6 +117,8 @@ import LibDCBridge
     @objc public static func openBLEDevice(name: String, deviceAddress: String) -> Bool {
         logDebug("Attempting to open BLE device: \(name) at address: \(deviceAddress)")
         
+        _ = fingerprintStoreOpened
+        
         var deviceData: UnsafeMutablePointer<device_data_t>?
         let storedDevice = DeviceStorage.shared.getStoredDevice(uuid: deviceAddress)
         
@@ -151,6 +172,21 @@ import LibDCBridge
         return nil
     }
     
+    /// Identifies a discovered BLE device, and caches its descriptor for the connect
+    /// - Parameters:
+    ///   - name: The advertised name of the BLE device
+    ///   - deviceAddress: The device's UUID/MAC address
+    /// - Returns: A tuple containing the device family and model number, or nil if not identified
+    public static func resolve(name: String, deviceAddress: String) -> (family: DeviceFamily, model: UInt32)? {
+        var family = DC_FAMILY_NULL
+        var model: UInt32 = 0
+        guard resolve_ble_device(deviceAddress, name, &family, &model) == DC_STATUS_SUCCESS,
+              let deviceFamily = DeviceFamily(dcFamily: family) else {
+            return nil
+        }
+        return (deviceFamily, model)
+    }
+    
     /// Returns a human-readable display name for a device using libdivecomputer's vendor and product information.
     /// Only considers BLE-capable devices.
     /// - Parameter name: The device name to get display name for
@@ -155,6 +155,7 @@ public class GenericParser {
     ///   - diveData: Raw data from the dive computer
     ///   - dataSize: Size of the raw data
     ///   - context: Optional parser context
+    ///   - maxPoints: Optional limit on the number of points per profile series
     /// - Returns: A structured DiveData object
     /// - Throws: ParserError if parsing fails
     public static func parseDiveData(
@@ -163,7 +164,8 @@ public class GenericParser {
         diveNumber: Int,
         diveData: UnsafePointer<UInt8>,
         dataSize: Int,
-        context: OpaquePointer? = nil
+        context: OpaquePointer? = nil,
+        maxPoints: UInt32 = 0
     ) throws -> DiveData {
         var parser: OpaquePointer?
         
@@ -178,149 +180,125 @@ public class GenericParser {
         defer {
             dc_parser_destroy(parser)
         }
-        
-        // Get dive time
-        var datetime = dc_datetime_t()
-        let datetimeStatus = dc_parser_get_datetime(parser, &datetime)
-        
-        guard datetimeStatus == DC_STATUS_SUCCESS else {
-            throw ParserError.datetimeRetrievalFailed(datetimeStatus)
+
+        if maxPoints > 0 {
+            let status = dc_parser_set_downsample(parser, maxPoints)
+            guard status == DC_STATUS_SUCCESS else {
+                throw ParserError.invalidParameters
+            }
         }
         
+        // Parse the header fields and the whole profile in a single call
+        var divePtr: UnsafeMutablePointer<dc_dive_t>?
+        let diveStatus = dc_parser_parse_dive(parser, &divePtr)
+
+        guard diveStatus == DC_STATUS_SUCCESS, let dive = divePtr?.pointee else {
+            throw ParserError.sampleProcessingFailed(diveStatus)
+        }
+
+        defer {
+            dc_dive_free(divePtr)
+        }
+
+        guard hasBit(dive.fields, UInt32(1) << 31) else {  // DC_DIVE_DATETIME
+            throw ParserError.datetimeRetrievalFailed(DC_STATUS_UNSUPPORTED)
+        }
+        let datetime = dive.datetime
+
         let wrapper = SampleDataWrapper()
-        
-        // Convert wrapper to UnsafeMutableRawPointer
-        let wrapperPtr = UnsafeMutableRawPointer(Unmanaged.passRetained(wrapper).toOpaque())
-        
-        let sampleCallback: dc_sample_callback_t = { type, valuePtr, userData in
-            guard let userData = userData,
-                  let value = valuePtr?.pointee else { return }
-            
-            let wrapper = Unmanaged<SampleDataWrapper>.fromOpaque(userData).takeUnretainedValue()
-            
-            switch type {
-            case DC_SAMPLE_TIME:
-                wrapper.data.time = TimeInterval(value.time) / 1000.0
-                wrapper.addProfilePoint()
-                
-            case DC_SAMPLE_DEPTH:
-                wrapper.data.depth = value.depth
-                wrapper.data.maxDepth = max(wrapper.data.maxDepth, value.depth)
-                
-            case DC_SAMPLE_PRESSURE:
+        let samples = UnsafeBufferPointer(start: dive.samples, count: Int(dive.nsamples))
+        let pressures = UnsafeBufferPointer(start: dive.pressures, count: Int(dive.npressures))
+        let events = UnsafeBufferPointer(start: dive.events, count: Int(dive.nevents))
+        let ppo2 = UnsafeBufferPointer(start: dive.ppo2, count: Int(dive.nppo2))
+
+        for sample in samples {
+            let has = { (type: dc_sample_type_t) in GenericParser.hasBit(sample.fields, 1 << type.rawValue) }
+
+            if has(DC_SAMPLE_TIME) {
+                wrapper.data.time = TimeInterval(sample.time) / 1000.0
+            }
+            if has(DC_SAMPLE_DEPTH) {
+                wrapper.data.depth = sample.depth
+                wrapper.data.maxDepth = max(wrapper.data.maxDepth, sample.depth)
+            }
+            if has(DC_SAMPLE_TEMPERATURE) {
+                wrapper.data.temperature = sample.temperature
+            }
+            for i in Int(sample.pressure)..<Int(sample.pressure + sample.npressure) {
                 wrapper.data.pressure.append((
-                    tank: Int(value.pressure.tank),
-                    value: value.pressure.value
+                    tank: Int(pressures[i].tank),
+                    value: pressures[i].value
                 ))
-                
-            case DC_SAMPLE_TEMPERATURE:
-                wrapper.data.temperature = value.temperature
-                
-            case DC_SAMPLE_EVENT:
-                let eventType = value.event.type
-                var events: [DiveEvent] = []
-                
-                switch eventType {
-                case SAMPLE_EVENT_ASCENT.rawValue:
-                    events.append(.ascent)
-                case SAMPLE_EVENT_VIOLATION.rawValue:
-                    events.append(.violation)
-                case SAMPLE_EVENT_DECOSTOP.rawValue:
-                    events.append(.decoStop)
-                case SAMPLE_EVENT_GASCHANGE.rawValue:
-                    events.append(.gasChange)
-                case SAMPLE_EVENT_BOOKMARK.rawValue:
-                    events.append(.bookmark)
-                case SAMPLE_EVENT_SAFETYSTOP.rawValue:
-                    events.append(.safetyStop(mandatory: false))
-                case SAMPLE_EVENT_SAFETYSTOP_MANDATORY.rawValue:
-                    events.append(.safetyStop(mandatory: true))
-                case SAMPLE_EVENT_CEILING.rawValue:
-                    events.append(.ceiling)
-                case SAMPLE_EVENT_DEEPSTOP.rawValue:
-                    events.append(.deepStop)
-                default:
-                    break
-                }
-                
-                // Add the events to the current point
+            }
+            for i in Int(sample.ppo2)..<Int(sample.ppo2 + sample.nppo2) {
+                wrapper.data.ppo2.append((
+                    sensor: ppo2[i].sensor,
+                    value: ppo2[i].value
+                ))
+            }
+            if has(DC_SAMPLE_RBT) {
+                wrapper.data.rbt = sample.rbt
+            }
+            if has(DC_SAMPLE_HEARTBEAT) {
+                wrapper.data.heartbeat = sample.heartbeat
+            }
+            if has(DC_SAMPLE_BEARING) {
+                wrapper.data.bearing = sample.bearing
+            }
+            if has(DC_SAMPLE_SETPOINT) {
+                wrapper.data.setpoint = sample.setpoint
+            }
+            if has(DC_SAMPLE_CNS) {
+                wrapper.data.cns = sample.cns * 100.0  // Convert to percentage
+            }
+            if has(DC_SAMPLE_DECO) {
+                wrapper.data.deco = SampleData.DecoData(
+                    type: dc_deco_type_t(rawValue: sample.deco.type),
+                    depth: sample.deco.depth,
+                    time: sample.deco.time,
+                    tts: sample.deco.tts
+                )
+            }
+            if has(DC_SAMPLE_GASMIX) {
+                wrapper.data.gasmix = Int(sample.gasmix)
+            }
+
+            if has(DC_SAMPLE_TIME) {
+                wrapper.addProfilePoint()
+            }
+
+            for i in Int(sample.event)..<Int(sample.event + sample.nevents) {
+                guard let event = convertEvent(events[i].type) else { continue }
+
+                // Add the event to the current point
                 let point = DiveProfilePoint(
                     time: wrapper.data.time,
                     depth: wrapper.data.depth,
                     temperature: wrapper.data.temperature,
                     pressure: wrapper.data.pressure.last?.value,
                     po2: wrapper.data.ppo2.last?.value,
-                    events: events
+                    events: [event]
                 )
                 wrapper.data.profile.append(point)
-                
-            case DC_SAMPLE_RBT:
-                wrapper.data.rbt = value.rbt
-                
-            case DC_SAMPLE_HEARTBEAT:
-                wrapper.data.heartbeat = value.heartbeat
-                
-            case DC_SAMPLE_BEARING:
-                wrapper.data.bearing = value.bearing
-                
-            case DC_SAMPLE_SETPOINT:
-                wrapper.data.setpoint = value.setpoint
-                
-            case DC_SAMPLE_PPO2:
-                wrapper.data.ppo2.append((
-                    sensor: value.ppo2.sensor,
-                    value: value.ppo2.value
-                ))
-                
-            case DC_SAMPLE_CNS:
-                wrapper.data.cns = value.cns * 100.0  // Convert to percentage
-                
-            case DC_SAMPLE_DECO:
-                wrapper.data.deco = SampleData.DecoData(
-                    type: dc_deco_type_t(rawValue: value.deco.type),
-                    depth: value.deco.depth,
-                    time: value.deco.time,
-                    tts: value.deco.tts
-                )
-                
-            case DC_SAMPLE_GASMIX:
-                wrapper.data.gasmix = Int(value.gasmix)
-                
-            default:
-                break
             }
         }
-        
-        let samplesStatus = dc_parser_samples_foreach(parser, sampleCallback, wrapperPtr)
-        
-        // Release the wrapper after we're done
-        Unmanaged<SampleDataWrapper>.fromOpaque(wrapperPtr).release()
-        guard samplesStatus == DC_STATUS_SUCCESS else {
-            throw ParserError.sampleProcessingFailed(samplesStatus)
-        }
-        
+
         // Get tank information
-        if let tankCount: UInt32 = getField(parser, type: DC_FIELD_TANK_COUNT) {
-            for i in 0..<tankCount {
-                if let tank: dc_tank_t = getField(parser, type: DC_FIELD_TANK, flags: UInt32(i)) {
-                    wrapper.addTank(tank)
-                }
-            }
+        for tank in UnsafeBufferPointer(start: dive.tanks, count: Int(dive.ntanks)) {
+            wrapper.addTank(tank)
         }
-        
+
         // Get deco model
-        var decoValue = dc_decomodel_t()
-        _ = dc_parser_get_field(parser, DC_FIELD_DECOMODEL, 0, &decoValue)
-        if let decoModel: dc_decomodel_t = getField(parser, type: DC_FIELD_DECOMODEL) {
-            wrapper.setDecoModel(decoModel)
+        if hasBit(dive.fields, 1 << DC_FIELD_DECOMODEL.rawValue) {
+            wrapper.setDecoModel(dive.decomodel)
         } else {
             logInfo("❌ Failed to get decompression model field")
         }
-        
+
         // Get dive mode
         let diveMode: DiveData.DiveMode
-        if let modeValue: UInt32 = getField(parser, type: DC_FIELD_DIVEMODE) {
-            diveMode = switch modeValue {
+        if hasBit(dive.fields, 1 << DC_FIELD_DIVEMODE.rawValue) {
+            diveMode = switch dive.divemode.rawValue {
             case DC_DIVEMODE_FREEDIVE.rawValue: .freedive
             case DC_DIVEMODE_GAUGE.rawValue: .gauge
             case DC_DIVEMODE_OC.rawValue: .openCircuit
@@ -382,6 +360,267 @@ public class GenericParser {
         )
     }
     
+    /// Encodes the samples of a dive in the compact packed format
+    /// - Parameters:
+    ///   - family: The family of the dive computer
+    ///   - model: The specific model number
+    ///   - diveData: Raw data from the dive computer
+    ///   - dataSize: Size of the raw data
+    ///   - context: Optional parser context
+    /// - Returns: The packed samples, readable with dc_packed_reader_init
+    /// - Throws: ParserError if parsing fails
+    public static func packSamples(
+        family: DeviceConfiguration.DeviceFamily,
+        model: UInt32,
+        diveData: UnsafePointer<UInt8>,
+        dataSize: Int,
+        context: OpaquePointer? = nil
+    ) throws -> Data {
+        var parser: OpaquePointer?
+
+        let rc = create_parser_for_device(&parser, context, family.asDCFamily, model, diveData, size_t(dataSize))
+
+        guard rc == DC_STATUS_SUCCESS, parser != nil else {
+            logError("❌ Parser creation failed with status: \(rc)")
+            throw ParserError.parserCreationFailed(rc)
+        }
+
+        defer {
+            dc_parser_destroy(parser)
+        }
+
+        guard let buffer = dc_buffer_new(0) else {
+            throw ParserError.sampleProcessingFailed(DC_STATUS_NOMEMORY)
+        }
+
+        defer {
+            dc_buffer_free(buffer)
+        }
+
+        let status = dc_parser_samples_pack(parser, buffer)
+        guard status == DC_STATUS_SUCCESS else {
+            throw ParserError.sampleProcessingFailed(status)
+        }
+
+        guard let data = dc_buffer_get_data(buffer) else {
+            return Data()
+        }
+
+        return Data(bytes: data, count: dc_buffer_get_size(buffer))
+    }
+
+    /// Decompression status after a sample of the profile
+    public struct DecoStatus {
+        public let time: TimeInterval     /// Sample time (seconds)
+        public let ceiling: Double        /// Ceiling depth (meters), zero without a ceiling
+        public let gf99: Double           /// Supersaturation at the current depth (percent)
+        public let surfaceGf: Double      /// Supersaturation at the surface (percent)
+        public let tts: TimeInterval      /// Time to surface (seconds)
+    }
+    
+    /// Replays a dive through the Bühlmann ZHL-16C model.
+    /// The tissue loading integrates over every sample, so the full resolution profile is used.
+    /// - Parameters:
+    ///   - family: The family of the dive computer
+    ///   - model: The specific model number
+    ///   - diveData: Raw data from the dive computer
+    ///   - dataSize: Size of the raw data
+    ///   - context: Optional parser context
+    ///   - gfLow: Low gradient factor (percent), zero for the settings of the dive
+    ///   - gfHigh: High gradient factor (percent), zero for the settings of the dive
+    /// - Returns: The decompression status after every sample
+    /// - Throws: ParserError if parsing fails
+    public static func computeBuhlmann(
+        family: DeviceConfiguration.DeviceFamily,
+        model: UInt32,
+        diveData: UnsafePointer<UInt8>,
+        dataSize: Int,
+        context: OpaquePointer? = nil,
+        gfLow: UInt32 = 0,
+        gfHigh: UInt32 = 0
+    ) throws -> [DecoStatus] {
+        var parser: OpaquePointer?
+
+        let rc = create_parser_for_device(&parser, context, family.asDCFamily, model, diveData, size_t(dataSize))
+
+        guard rc == DC_STATUS_SUCCESS, parser != nil else {
+            logError("❌ Parser creation failed with status: \(rc)")
+            throw ParserError.parserCreationFailed(rc)
+        }
+
+        defer {
+            dc_parser_destroy(parser)
+        }
+
+        var divePtr: UnsafeMutablePointer<dc_dive_t>?
+        let diveStatus = dc_parser_parse_dive(parser, &divePtr)
+
+        guard diveStatus == DC_STATUS_SUCCESS, let dive = divePtr else {
+            throw ParserError.sampleProcessingFailed(diveStatus)
+        }
+
+        defer {
+            dc_dive_free(dive)
+        }
+
+        let count = Int(dive.pointee.nsamples)
+        var results = [dc_buhlmann_sample_t](repeating: dc_buhlmann_sample_t(), count: max(count, 1))
+        let status = dc_buhlmann_compute(dive, gfLow, gfHigh, &results)
+        guard status == DC_STATUS_SUCCESS else {
+            throw ParserError.sampleProcessingFailed(status)
+        }
+
+        let samples = UnsafeBufferPointer(start: dive.pointee.samples, count: count)
+        return (0..<count).map { i in
+            DecoStatus(
+                time: TimeInterval(samples[i].time) / 1000.0,
+                ceiling: results[i].ceiling,
+                gf99: results[i].gf99,
+                surfaceGf: results[i].surfacegf,
+                tts: TimeInterval(results[i].tts)
+            )
+        }
+    }
+
+    /// Gas consumption rate of a tank, measured over the smoothing window
+    public struct ConsumptionPoint {
+        public let tank: Int              /// Tank index
+        public let time: TimeInterval     /// Sample time (seconds)
+        public let sac: Double            /// Surface air consumption (bar/min)
+        public let rmv: Double            /// Respiratory minute volume (l/min), zero without a tank volume
+    }
+
+    /// Gas consumption of a tank between two gas switches
+    public struct ConsumptionSegment {
+        public let tank: Int              /// Tank index
+        public let gasMix: Int?           /// Gas mix in use, nil if unknown
+        public let beginTime: TimeInterval /// Start of the segment (seconds)
+        public let endTime: TimeInterval  /// End of the segment (seconds)
+        public let beginPressure: Double  /// Tank pressure at the start (bar)
+        public let endPressure: Double    /// Tank pressure at the end (bar)
+        public let avgDepth: Double       /// Average depth (meters)
+        public let volume: Double         /// Consumed gas (liter at the surface), zero without a tank volume
+        public let sac: Double            /// Surface air consumption (bar/min)
+        public let rmv: Double            /// Respiratory minute volume (l/min), zero without a tank volume
+    }
+
+    /// Gas consumption of a dive
+    public struct Consumption {
+        public let points: [ConsumptionPoint]     /// SAC and RMV series of every tank
+        public let segments: [ConsumptionSegment] /// Consumption per tank, split at the gas switches
+    }
+
+    /// Computes the gas consumption of a dive from its tank pressure samples.
+    /// The rates integrate over the samples, so the full resolution profile is used.
+    /// - Parameters:
+    ///   - family: The family of the dive computer
+    ///   - model: The specific model number
+    ///   - diveData: Raw data from the dive computer
+    ///   - dataSize: Size of the raw data
+    ///   - context: Optional parser context
+    ///   - window: Smoothing window of the rates (seconds)
+    /// - Returns: The per tank SAC and RMV series, and the segments between the gas switches
+    /// - Throws: ParserError if parsing fails
+    public static func computeConsumption(
+        family: DeviceConfiguration.DeviceFamily,
+        model: UInt32,
+        diveData: UnsafePointer<UInt8>,
+        dataSize: Int,
+        context: OpaquePointer? = nil,
+        window: UInt32
+    ) throws -> Consumption {
+        var parser: OpaquePointer?
+
+        let rc = create_parser_for_device(&parser, context, family.asDCFamily, model, diveData, size_t(dataSize))
+
+        guard rc == DC_STATUS_SUCCESS, parser != nil else {
+            logError("❌ Parser creation failed with status: \(rc)")
+            throw ParserError.parserCreationFailed(rc)
+        }
+
+        defer {
+            dc_parser_destroy(parser)
+        }
+
+        var divePtr: UnsafeMutablePointer<dc_dive_t>?
+        let diveStatus = dc_parser_parse_dive(parser, &divePtr)
+
+        guard diveStatus == DC_STATUS_SUCCESS, let dive = divePtr else {
+            throw ParserError.sampleProcessingFailed(diveStatus)
+        }
+
+        defer {
+            dc_dive_free(dive)
+        }
+
+        var consumptionPtr: UnsafeMutablePointer<dc_consumption_t>?
+        let status = dc_consumption_compute(dive, window, &consumptionPtr)
+        guard status == DC_STATUS_SUCCESS, let consumption = consumptionPtr else {
+            throw ParserError.sampleProcessingFailed(status)
+        }
+
+        defer {
+            dc_consumption_free(consumption)
+        }
+
+        let points = UnsafeBufferPointer(start: consumption.pointee.points, count: Int(consumption.pointee.npoints))
+        let segments = UnsafeBufferPointer(start: consumption.pointee.segments, count: Int(consumption.pointee.nsegments))
+
+        return Consumption(
+            points: points.map { point in
+                ConsumptionPoint(
+                    tank: Int(point.tank),
+                    time: TimeInterval(point.time) / 1000.0,
+                    sac: point.sac,
+                    rmv: point.rmv
+                )
+            },
+            segments: segments.map { segment in
+                ConsumptionSegment(
+                    tank: Int(segment.tank),
+                    gasMix: segment.gasmix == UInt32(DC_GASMIX_UNKNOWN) ? nil : Int(segment.gasmix),
+                    beginTime: TimeInterval(segment.begintime) / 1000.0,
+                    endTime: TimeInterval(segment.endtime) / 1000.0,
+                    beginPressure: segment.beginpressure,
+                    endPressure: segment.endpressure,
+                    avgDepth: segment.avgdepth,
+                    volume: segment.volume,
+                    sac: segment.sac,
+                    rmv: segment.rmv
+                )
+            }
+        )
+    }
+
+    private static func hasBit(_ mask: UInt32, _ bit: UInt32) -> Bool {
+        return mask & bit != 0
+    }
+    
+    private static func convertEvent(_ type: UInt32) -> DiveEvent? {
+        switch type {
+        case SAMPLE_EVENT_ASCENT.rawValue:
+            return .ascent
+        case SAMPLE_EVENT_VIOLATION.rawValue:
+            return .violation
+        case SAMPLE_EVENT_DECOSTOP.rawValue:
+            return .decoStop
+        case SAMPLE_EVENT_GASCHANGE.rawValue:
+            return .gasChange
+        case SAMPLE_EVENT_BOOKMARK.rawValue:
+            return .bookmark
+        case SAMPLE_EVENT_SAFETYSTOP.rawValue:
+            return .safetyStop(mandatory: false)
+        case SAMPLE_EVENT_SAFETYSTOP_MANDATORY.rawValue:
+            return .safetyStop(mandatory: true)
+        case SAMPLE_EVENT_CEILING.rawValue:
+            return .ceiling
+        case SAMPLE_EVENT_DEEPSTOP.rawValue:
+            return .deepStop
+        default:
+            return nil
+        }
+    }
+    
     private static func convertTank(_ tank: dc_tank_t) -> DiveData.Tank {
         return DiveData.Tank(
             volume: tank.volume,
@@ -30,6 +30,39 @@ export interface LibDCPlugin {
    * @returns Promise with success status
    */
   disconnectDevice(): Promise<{ success: boolean }>;
+
+  /**
+   * Set the clock of the connected device to the local time
+   * @returns Promise with success status
+   */
+  timesync(): Promise<{ success: boolean }>;
+
+  /**
+   * Show a text on the screen of the connected device (OSTC only)
+   * @param options Display options
+   * @returns Promise with success status
+   */
+  displayText(options: DisplayOptions): Promise<{ success: boolean }>;
+
+  /**
+   * Read a setting of the connected device (OSTC only)
+   * @param options Config options
+   * @returns Promise with the base64 encoded value
+   */
+  readConfig(options: ConfigReadOptions): Promise<{ data: string }>;
+
+  /**
+   * Write a setting of the connected device (OSTC only)
+   * @param options Config options
+   * @returns Promise with success status
+   */
+  writeConfig(options: ConfigWriteOptions): Promise<{ success: boolean }>;
+
+  /**
+   * Latency of the operations run over the current connection
+   * @returns Promise with the most recent operations, oldest first
+   */
+  getSessionStats(): Promise<{ operations: OperationStats[] }>;
 }
 
 export interface DeviceInfo {
@@ -118,4 +151,57 @@ export interface DiveLog {
    * Additional dive information
    */
   [key: string]: any;
-}
\ No newline at end of file
+}
+
+export interface DisplayOptions {
+  /**
+   * Text to display (up to 16 characters)
+   */
+  text: string;
+}
+
+export interface ConfigReadOptions {
+  /**
+   * Setting identifier
+   */
+  config: number;
+
+  /**
+   * Size of the value in bytes
+   */
+  size: number;
+}
+
+export interface ConfigWriteOptions {
+  /**
+   * Setting identifier
+   */
+  config: number;
+
+  /**
+   * Base64 encoded value
+   */
+  data: string;
+}
+
+export interface OperationStats {
+  /**
+   * Operation name (open, download, timesync, ...)
+   */
+  name: string;
+
+  /**
+   * Time spent waiting for earlier operations, in milliseconds
+   */
+  queued: number;
+
+  /**
+   * Time spent running, in milliseconds
+   */
+  latency: number;
+
+  /**
+   * Whether the operation succeeded
+   */
+  success: boolean;
+}
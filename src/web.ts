@@ -1,6 +1,16 @@
 import { WebPlugin } from '@capacitor/core';
 
-import type { ConnectOptions, DeviceInfo, DownloadOptions, DiveLog, LibDCPlugin } from './definitions';
+import type {
+  ConfigReadOptions,
+  ConfigWriteOptions,
+  ConnectOptions,
+  DeviceInfo,
+  DisplayOptions,
+  DownloadOptions,
+  DiveLog,
+  LibDCPlugin,
+  OperationStats,
+} from './definitions';
 
 export class LibDCWeb extends WebPlugin implements LibDCPlugin {
   async initialize(): Promise<{ success: boolean }> {
@@ -27,4 +37,29 @@ export class LibDCWeb extends WebPlugin implements LibDCPlugin {
     console.warn('LibDC.disconnectDevice(): This method is not implemented on web');
     return { success: false };
   }
+
+  async timesync(): Promise<{ success: boolean }> {
+    console.warn('LibDC.timesync(): This method is not implemented on web');
+    return { success: false };
+  }
+
+  async displayText(options: DisplayOptions): Promise<{ success: boolean }> {
+    console.warn('LibDC.displayText(): This method is not implemented on web', options);
+    return { success: false };
+  }
+
+  async readConfig(options: ConfigReadOptions): Promise<{ data: string }> {
+    console.warn('LibDC.readConfig(): This method is not implemented on web', options);
+    return { data: '' };
+  }
+
+  async writeConfig(options: ConfigWriteOptions): Promise<{ success: boolean }> {
+    console.warn('LibDC.writeConfig(): This method is not implemented on web', options);
+    return { success: false };
+  }
+
+  async getSessionStats(): Promise<{ operations: OperationStats[] }> {
+    console.warn('LibDC.getSessionStats(): This method is not implemented on web');
+    return { operations: [] };
+  }
 }
\ No newline at end of file